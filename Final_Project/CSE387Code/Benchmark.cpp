@@ -0,0 +1,591 @@
+#include "Benchmark.h"
+#include "Game.h"
+#include "GameObject.h"
+#include "BoxMeshComponent.h"
+#include "SphereMeshComponent.h"
+#include "ModelMeshComponent.h"
+#include "RigidBodyComponent.h"
+#include "SteeringComponent.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+#define VERBOSE false
+
+// Size of the scenarios
+#define DEEP_LEVELS 256
+#define WIDE_CHILDREN 64
+#define BODY_COUNT 1000
+#define AGENT_COUNT 1000
+
+// Iterations of each scenario unless others are given
+#define SCENE_GRAPH_ITERATIONS 1000
+#define RIGID_BODY_ITERATIONS 600
+#define STEERING_ITERATIONS 600
+#define MODEL_IMPORT_ITERATIONS 5
+#define RENDER_ITERATIONS 300
+
+// Results of operations are written here so they are not optimized away
+static volatile float sink = 0.0f;
+
+
+/**
+ * @class	BenchmarkGame
+ *
+ * @brief	A game whose scene is built by a scenario and that is stepped by the benchmark
+ * 			rather than by its game loop. Without a load function the demo scene is loaded.
+ */
+class BenchmarkGame : public Game
+{
+public:
+
+	typedef std::function<void(BenchmarkGame&)> LoadFunction;
+
+	BenchmarkGame(const LoadFunction& load = nullptr) : Game("CSE387 Benchmark"), load(load) {}
+
+	/**
+	 * @fn	void BenchmarkGame::step()
+	 *
+	 * @brief	Updates the game by one fixed step.
+	 */
+	void step() {
+		updateGame(static_cast<float>(getFrameScheduler().getFixedTimeStep()));
+	}
+
+	/**
+	 * @fn	void BenchmarkGame::updateSceneGraph()
+	 *
+	 * @brief	Updates the game objects by one fixed step without physics or sound.
+	 */
+	void updateSceneGraph() {
+
+		sceneNode.savePreviousTransformations();
+		sceneNode.updateSceneGraph(static_cast<float>(getFrameScheduler().getFixedTimeStep()));
+	}
+
+	/**
+	 * @fn	void BenchmarkGame::renderFrame()
+	 *
+	 * @brief	Updates the game by one fixed step and renders a frame on this thread. Waits
+	 * 			until the frame is finished so the time of rendering it is included.
+	 */
+	void renderFrame() {
+
+		step();
+		buildSnapshot(singleThreadSnapshot, 1.0f);
+		renderScene(singleThreadSnapshot);
+		glFinish();
+	}
+
+protected:
+
+	virtual void loadData() override {
+
+		if (load) {
+			load(*this);
+		}
+		else {
+			Game::loadData();
+		}
+	}
+
+	LoadFunction load;
+
+}; // end BenchmarkGame
+
+
+int Benchmark::run(int argc, char** argv)
+{
+	std::vector<std::string> scenarios;
+	int iterations = 0;
+	std::string outputFile;
+	int width = 640;
+	int height = 360;
+#ifdef __linux__
+	// Mesa renders in software through EGL when LIBGL_ALWAYS_SOFTWARE is set
+	int contextCreationApi = GLFW_EGL_CONTEXT_API;
+#else
+	int contextCreationApi = GLFW_NATIVE_CONTEXT_API;
+#endif
+
+	for (int i = 0; i < argc; i++) {
+
+		std::string arg = argv[i];
+
+		if (arg == "-iterations" && i + 1 < argc) {
+
+			iterations = std::stoi(argv[++i]);
+		}
+		else if (arg == "-output" && i + 1 < argc) {
+
+			outputFile = argv[++i];
+		}
+		else if (arg == "-size" && i + 2 < argc) {
+
+			width = std::stoi(argv[++i]);
+			height = std::stoi(argv[++i]);
+		}
+		else if (arg == "-egl") {
+
+			contextCreationApi = GLFW_EGL_CONTEXT_API;
+		}
+		else if (arg == "-native") {
+
+			contextCreationApi = GLFW_NATIVE_CONTEXT_API;
+		}
+		else if (arg == "-osmesa") {
+
+			contextCreationApi = GLFW_OSMESA_CONTEXT_API;
+		}
+		else {
+
+			scenarios.push_back(arg);
+		}
+	}
+
+	if (scenarios.empty()) {
+
+		scenarios = { "sceneGraph", "rigidBodies", "steering", "modelImport", "render" };
+	}
+
+	// The window and OpenGL context are not created again after the game that renders shuts down
+	std::stable_partition(scenarios.begin(), scenarios.end(), [](const std::string& scenario) { return scenario != "render"; });
+
+	std::ofstream file;
+	std::ostream* out = &std::cout;
+
+	if (outputFile.empty() == false) {
+
+		file.open(outputFile);
+
+		if (!file) {
+
+			std::cerr << "Unable to open " << outputFile << std::endl;
+			return 1;
+		}
+
+		out = &file;
+	}
+
+	int failures = 0;
+
+	for (auto& scenario : scenarios) {
+
+		std::vector<Result> results;
+		bool ran = false;
+
+		if (scenario == "sceneGraph") {
+
+			ran = runSceneGraph(iterations > 0 ? iterations : SCENE_GRAPH_ITERATIONS, results);
+		}
+		else if (scenario == "rigidBodies") {
+
+			ran = runRigidBodies(iterations > 0 ? iterations : RIGID_BODY_ITERATIONS, results);
+		}
+		else if (scenario == "steering") {
+
+			ran = runSteering(iterations > 0 ? iterations : STEERING_ITERATIONS, results);
+		}
+		else if (scenario == "modelImport") {
+
+			ran = runModelImport(iterations > 0 ? iterations : MODEL_IMPORT_ITERATIONS, results);
+		}
+		else if (scenario == "render") {
+
+			ran = runRender(iterations > 0 ? iterations : RENDER_ITERATIONS, width, height, contextCreationApi, results);
+		}
+		else {
+
+			std::cerr << "Unknown benchmark scenario " << scenario << std::endl;
+		}
+
+		for (auto& result : results) {
+
+			writeResult(*out, result);
+		}
+
+		out->flush();
+
+		if (ran == false) {
+
+			std::cerr << "Benchmark scenario " << scenario << " did not run." << std::endl;
+			failures++;
+		}
+	}
+
+	return failures == 0 ? 0 : 1;
+
+} // end run
+
+
+Benchmark::Result Benchmark::measure(const std::string& name, int iterations, const std::function<void()>& operation,
+									 const std::function<void()>& setup, const std::function<void()>& teardown)
+{
+	iterations = std::max(iterations, 1);
+
+	// Caches, pools and lazily built state are filled before timing starts
+	int warmup = std::max(1, iterations / 10);
+
+	for (int i = 0; i < warmup; i++) {
+
+		if (setup) setup();
+		operation();
+		if (teardown) teardown();
+	}
+
+	std::vector<double> times(iterations);
+
+	unsigned long long allocations = 0;
+	unsigned long long bytes = 0;
+
+	for (int i = 0; i < iterations; i++) {
+
+		if (setup) setup();
+
+		unsigned long long startAllocations = getAllocationCount();
+		unsigned long long startBytes = getAllocatedBytes();
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		operation();
+
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		allocations += getAllocationCount() - startAllocations;
+		bytes += getAllocatedBytes() - startBytes;
+
+		times[i] = std::chrono::duration<double, std::nano>(end - start).count();
+
+		if (teardown) teardown();
+	}
+
+	std::sort(times.begin(), times.end());
+
+	// Nearest rank percentiles
+	auto percentile = [&times](double fraction) {
+		size_t rank = static_cast<size_t>(std::ceil(fraction * times.size()));
+		return times[std::min(std::max(rank, size_t(1)), times.size()) - 1];
+	};
+
+	Result result;
+
+	result.name = name;
+	result.iterations = iterations;
+
+	double total = 0.0;
+
+	for (auto time : times) {
+		total += time;
+	}
+
+	result.meanNanoseconds = total / iterations;
+	result.minNanoseconds = times.front();
+	result.p50Nanoseconds = percentile(0.50);
+	result.p90Nanoseconds = percentile(0.90);
+	result.p99Nanoseconds = percentile(0.99);
+	result.maxNanoseconds = times.back();
+	result.allocationsPerOperation = static_cast<double>(allocations) / iterations;
+	result.bytesPerOperation = static_cast<double>(bytes) / iterations;
+
+	if (VERBOSE) std::cout << name << " " << result.meanNanoseconds << " ns/op" << std::endl;
+
+	return result;
+
+} // end measure
+
+
+void Benchmark::writeResult(std::ostream& out, const Result& result)
+{
+	std::string name;
+
+	for (char character : result.name) {
+
+		if (character == '"' || character == '\\') {
+			name += '\\';
+		}
+
+		name += character;
+	}
+
+	char numbers[512];
+
+	snprintf(numbers, sizeof(numbers),
+			 "\"iterations\": %d, \"ns_per_op\": %.1f, \"min_ns\": %.1f, \"p50_ns\": %.1f, \"p90_ns\": %.1f, \"p99_ns\": %.1f, "
+			 "\"max_ns\": %.1f, \"allocs_per_op\": %.2f, \"bytes_per_op\": %.1f",
+			 result.iterations, result.meanNanoseconds, result.minNanoseconds, result.p50Nanoseconds, result.p90Nanoseconds,
+			 result.p99Nanoseconds, result.maxNanoseconds, result.allocationsPerOperation, result.bytesPerOperation);
+
+	out << "{ \"name\": \"" << name << "\", " << numbers << " }" << std::endl;
+
+} // end writeResult
+
+
+bool Benchmark::runSceneGraph(int iterations, std::vector<Result>& results)
+{
+	Game::setHeadless(true);
+
+	// A chain in which every node is the child of the one before and a tree two levels deep
+	struct Shape {
+
+		std::string name;
+
+		int levels;
+
+		int branching;
+	};
+
+	std::vector<Shape> shapes = {
+		{ "sceneGraph/deep" + std::to_string(DEEP_LEVELS), DEEP_LEVELS, 1 },
+		{ "sceneGraph/wide" + std::to_string(WIDE_CHILDREN) + "x" + std::to_string(WIDE_CHILDREN), 2, WIDE_CHILDREN }
+	};
+
+	for (auto& shape : shapes) {
+
+		std::vector<GameObject*> nodes;
+
+		BenchmarkGame game([&shape, &nodes](BenchmarkGame& game) {
+
+			std::mt19937 generator(SEED);
+			std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+
+			// Null stands for the root of the scene graph
+			std::vector<GameObject*> parents = { nullptr };
+
+			for (int level = 0; level < shape.levels; level++) {
+
+				std::vector<GameObject*> children;
+
+				for (auto parent : parents) {
+
+					for (int i = 0; i < shape.branching; i++) {
+
+						GameObject* node = new GameObject(&game);
+
+						if (parent == nullptr) {
+							game.addChild(node);
+						}
+						else {
+							parent->addChild(node);
+						}
+
+						node->sceneNode.setPosition(vec3(offset(generator), offset(generator), offset(generator)), LOCAL);
+
+						children.push_back(node);
+						nodes.push_back(node);
+					}
+				}
+
+				parents = children;
+			}
+		});
+
+		if (game.initialize() == false) {
+			return false;
+		}
+
+		float angle = 0.0f;
+
+		// Every node turns, then the world transformation of every node is found as it is for rendering
+		results.push_back(measure(shape.name, iterations, [&game, &nodes, &angle]() {
+
+			angle += 0.01f;
+
+			for (auto node : nodes) {
+				node->sceneNode.setRotation(glm::rotate(angle, UNIT_Y_V3), LOCAL);
+			}
+
+			game.updateSceneGraph();
+
+			float total = 0.0f;
+
+			for (auto node : nodes) {
+				total += node->sceneNode.getModelingTransformation()[3][0];
+			}
+
+			sink = total;
+		}));
+
+		game.shutdown();
+	}
+
+	return true;
+
+} // end runSceneGraph
+
+
+bool Benchmark::runRigidBodies(int iterations, std::vector<Result>& results)
+{
+	Game::setHeadless(true);
+
+	BenchmarkGame game([](BenchmarkGame& game) {
+
+		GameObject* platform = new GameObject(&game);
+		game.addChild(platform);
+		platform->sceneNode.setPosition(vec3(0.0f, -1.0f, 0.0f), WORLD);
+
+		BoxMeshComponent* box = new BoxMeshComponent(new Material(), 100.0f, 1.0f, 100.0f);
+		platform->addComponent(box);
+		platform->addComponent(new RigidBodyComponent(box, KINEMATIC_STATIONARY));
+
+		// Layers of ten by ten spheres that are not quite above each other so the stacks topple
+		std::mt19937 generator(SEED);
+		std::uniform_real_distribution<float> jitter(-0.1f, 0.1f);
+
+		for (int i = 0; i < BODY_COUNT; i++) {
+
+			float x = (i % 10 - 4.5f) * 1.5f + jitter(generator);
+			float y = 5.0f + (i / 100) * 1.5f;
+			float z = ((i / 10) % 10 - 4.5f) * 1.5f + jitter(generator);
+
+			GameObject* body = new GameObject(&game);
+			game.addChild(body);
+			body->sceneNode.setPosition(vec3(x, y, z), WORLD);
+
+			SphereMeshComponent* sphere = new SphereMeshComponent(0, new Material(), 0.5f);
+			body->addComponent(sphere);
+			body->addComponent(new RigidBodyComponent(sphere, DYNAMIC));
+		}
+	});
+
+	if (game.initialize() == false) {
+		return false;
+	}
+
+	results.push_back(measure("rigidBodies/" + std::to_string(BODY_COUNT), iterations, [&game]() { game.step(); }));
+
+	game.shutdown();
+
+	return true;
+
+} // end runRigidBodies
+
+
+bool Benchmark::runSteering(int iterations, std::vector<Result>& results)
+{
+	Game::setHeadless(true);
+
+	BenchmarkGame game([](BenchmarkGame& game) {
+
+		std::mt19937 generator(SEED);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+
+		// Each agent circles a square of waypoints around where it starts
+		for (int i = 0; i < AGENT_COUNT; i++) {
+
+			vec3 start(position(generator), 0.0f, position(generator));
+
+			std::vector<vec3> waypoints = { start + vec3(20.0f, 0.0f, 20.0f), start + vec3(20.0f, 0.0f, -20.0f),
+											start + vec3(-20.0f, 0.0f, -20.0f), start + vec3(-20.0f, 0.0f, 20.0f) };
+
+			GameObject* agent = new GameObject(&game);
+			game.addChild(agent);
+			agent->sceneNode.setPosition(start, WORLD);
+			agent->addComponent(new SteeringComponent(waypoints));
+		}
+	});
+
+	if (game.initialize() == false) {
+		return false;
+	}
+
+	results.push_back(measure("steering/" + std::to_string(AGENT_COUNT), iterations, [&game]() { game.step(); }));
+
+	game.shutdown();
+
+	return true;
+
+} // end runSteering
+
+
+bool Benchmark::runModelImport(int iterations, std::vector<Result>& results)
+{
+	Game::setHeadless(true);
+
+	std::vector<std::string> fileNames = {
+		"Assets/jet_models/F-15C_Eagle.obj",
+		"Assets/Dinosaur/TrexModel.fbx",
+		"Assets/Orange_obj/Orange.obj",
+		"Assets/apple_textured_obj/apple textured obj.obj",
+		"Assets/man/nanosuit.obj"
+	};
+
+	BenchmarkGame game([](BenchmarkGame& game) {});
+
+	if (game.initialize() == false) {
+		return false;
+	}
+
+	for (auto& fileName : fileNames) {
+
+		if (!std::ifstream(fileName)) {
+
+			std::cerr << "Skipping import of " << fileName << ", which was not found." << std::endl;
+			continue;
+		}
+
+		GameObject* model = nullptr;
+
+		bool cacheReleased = true;
+
+		// The component is added before the game object enters the scene graph so it is not
+		// initialized until addChild, which is timed. The model is deleted after each import
+		// so the next one is not retrieved from those already loaded.
+		results.push_back(measure("modelImport/" + fileName.substr(fileName.find_last_of('/') + 1), iterations,
+			[&game, &model]() {
+
+				game.addChild(model);
+			},
+			[&game, &model, &fileName]() {
+
+				model = new GameObject(&game);
+				model->addComponent(new ModelMeshComponent(fileName, 0));
+			},
+			[&model, &fileName, &cacheReleased]() {
+
+				delete model;
+				model = nullptr;
+
+				if (ModelMeshComponent::isModelLoaded(fileName)) {
+					cacheReleased = false;
+				}
+			}));
+
+		if (cacheReleased == false) {
+
+			std::cerr << "ERROR: " << fileName << " was still loaded after its last copy was deleted." << std::endl;
+			game.shutdown();
+			return false;
+		}
+	}
+
+	game.shutdown();
+
+	return true;
+
+} // end runModelImport
+
+
+bool Benchmark::runRender(int iterations, int width, int height, int contextCreationApi, std::vector<Result>& results)
+{
+	Game::setHeadless(false);
+
+	BenchmarkGame game;
+
+	game.setOffscreen(width, height, contextCreationApi);
+
+	if (game.initialize() == false) {
+		return false;
+	}
+
+	results.push_back(measure("render/demo" + std::to_string(width) + "x" + std::to_string(height), iterations,
+							  [&game]() { game.renderFrame(); }));
+
+	game.shutdown();
+
+	return true;
+
+} // end runRender
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @class	Benchmark
+ *
+ * @brief	Runs fixed scenarios of the hot paths of the engine and reports how long each
+ * 			operation took and how many allocations it made. Scenarios are built the same way
+ * 			every run, with positions from a seeded generator, so results can be compared
+ * 			between builds to find regressions.
+ *
+ * 			Scenarios:
+ * 			- sceneGraph: animates and updates a deep chain and a wide tree of game objects
+ * 			  and computes the world transformation of every node.
+ * 			- rigidBodies: drops spheres with RigidBodyComponents onto a platform.
+ * 			- steering: moves agents along waypoints with SteeringComponents.
+ * 			- modelImport: imports each bundled model that is found.
+ * 			- render: updates and renders the demo scene offscreen, by default with an EGL
+ * 			  context on Linux, which Mesa renders in software when LIBGL_ALWAYS_SOFTWARE
+ * 			  is set, and with the native context elsewhere.
+ *
+ * 			Every scenario except render runs headless. Render must run last since it
+ * 			creates the window and OpenGL context, which are not created again.
+ *
+ * 			Each result is written as soon as its scenario finishes as one line of JSON, so
+ * 			a scenario that fails does not lose the results of the ones before it.
+ *
+ * 			The benchmark is a separate executable built by CMakeLists.txt from BenchmarkMain.cpp.
+ * 			Allocations are counted by replacing the global operator new in
+ * 			BenchmarkAllocator.cpp, which only the benchmark executable links.
+ */
+class Benchmark
+{
+public:
+
+	/**
+	 * @struct	Result
+	 *
+	 * @brief	Statistics of the timed iterations of one operation.
+	 */
+	struct Result {
+
+		std::string name;
+
+		int iterations = 0;
+
+		double meanNanoseconds = 0.0;
+
+		double minNanoseconds = 0.0;
+
+		double p50Nanoseconds = 0.0;
+
+		double p90Nanoseconds = 0.0;
+
+		double p99Nanoseconds = 0.0;
+
+		double maxNanoseconds = 0.0;
+
+		double allocationsPerOperation = 0.0;
+
+		double bytesPerOperation = 0.0;
+
+	}; // end Result
+
+	/**
+	 * @fn	static int Benchmark::run(int argc, char** argv);
+	 *
+	 * @brief	Runs the benchmarks selected by the command line arguments of the benchmark
+	 * 			executable: the names of the scenarios to run, all of them if none are given,
+	 * 			and the options
+	 * 			"-iterations count" to time every operation a number of times instead of the
+	 * 			default of its scenario.
+	 * 			"-output file" to write the results to a file instead of the console.
+	 * 			"-size width height" for the size the render scenario renders at.
+	 * 			"-egl", "-native" or "-osmesa" to render with an EGL, native or OSMesa context
+	 * 			instead of the default.
+	 *
+	 * @returns	Zero if every scenario ran.
+	 */
+	static int run(int argc, char** argv);
+
+	/**
+	 * @fn	static Result Benchmark::measure(const std::string& name, int iterations, const std::function<void()>& operation, const std::function<void()>& setup = nullptr, const std::function<void()>& teardown = nullptr);
+	 *
+	 * @brief	Times an operation. A tenth of the iterations are run first without being timed.
+	 * 			Only the operation is timed and counted, not the setup and teardown that are
+	 * 			run before and after each iteration.
+	 */
+	static Result measure(const std::string& name, int iterations, const std::function<void()>& operation,
+						  const std::function<void()>& setup = nullptr, const std::function<void()>& teardown = nullptr);
+
+	/**
+	 * @fn	static void Benchmark::writeResult(std::ostream& out, const Result& result);
+	 *
+	 * @brief	Writes a result as one line of JSON.
+	 */
+	static void writeResult(std::ostream& out, const Result& result);
+
+	/**
+	 * @fn	static unsigned long long Benchmark::getAllocationCount();
+	 *
+	 * @brief	Gets the number of allocations made by the benchmark executable.
+	 */
+	static unsigned long long getAllocationCount();
+
+	/**
+	 * @fn	static unsigned long long Benchmark::getAllocatedBytes();
+	 *
+	 * @brief	Gets the number of bytes allocated by the benchmark executable.
+	 */
+	static unsigned long long getAllocatedBytes();
+
+protected:
+
+	/**
+	 * @fn	static bool Benchmark::runSceneGraph(int iterations, std::vector<Result>& results);
+	 *
+	 * @brief	Runs a scenario and adds its results. The other scenarios are run the same way.
+	 *
+	 * @returns	False if the scenario could not be set up.
+	 */
+	static bool runSceneGraph(int iterations, std::vector<Result>& results);
+
+	static bool runRigidBodies(int iterations, std::vector<Result>& results);
+
+	static bool runSteering(int iterations, std::vector<Result>& results);
+
+	static bool runModelImport(int iterations, std::vector<Result>& results);
+
+	static bool runRender(int iterations, int width, int height, int contextCreationApi, std::vector<Result>& results);
+
+	/** @brief	Seed of the generator that places the objects of the scenarios */
+	static const unsigned int SEED = 387;
+
+}; // end Benchmark class
@@ -0,0 +1,65 @@
+#include "Benchmark.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#define VERBOSE false
+
+// Replaces the global operator new of the benchmark executable only. It is not part of
+// the game so the allocations of the game are not counted.
+
+static std::atomic<unsigned long long> allocationCount(0);
+static std::atomic<unsigned long long> allocatedBytes(0);
+
+
+void* operator new(std::size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+	// Allocations of zero bytes must still return distinct pointers
+	void* memory = std::malloc(size > 0 ? size : 1);
+
+	if (memory == nullptr) {
+		throw std::bad_alloc();
+	}
+
+	return memory;
+
+} // end operator new
+
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+
+} // end operator new[]
+
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+
+} // end operator delete
+
+
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+
+} // end operator delete[]
+
+
+unsigned long long Benchmark::getAllocationCount()
+{
+	return allocationCount.load(std::memory_order_relaxed);
+
+} // end getAllocationCount
+
+
+unsigned long long Benchmark::getAllocatedBytes()
+{
+	return allocatedBytes.load(std::memory_order_relaxed);
+
+} // end getAllocatedBytes
@@ -0,0 +1,13 @@
+#include "Benchmark.h"
+
+/**
+ * @fn	int main(int argc, char** argv)
+ *
+ * @brief	Entry point of the benchmark executable. See Benchmark::run for the scenarios and
+ * 			options. Run from the project directory so the shaders and assets are found.
+ */
+int main(int argc, char** argv)
+{
+	return Benchmark::run(argc - 1, argv + 1);
+
+} // end main
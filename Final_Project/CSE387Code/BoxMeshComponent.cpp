@@ -1,4 +1,5 @@
 #include "BoxMeshComponent.h"
+#include "PrimitiveGeometryCache.h"
 
 BoxMeshComponent::BoxMeshComponent(Material* material, float width , float height , float depth, int updateOrder)
 	: material(material), MeshComponent(updateOrder), halfWidth(width / 2), halfHeight(height / 2), halfDepth(depth / 2)
@@ -7,7 +8,44 @@ BoxMeshComponent::BoxMeshComponent(Material* material, float width , float heigh
 }
 
 
+BoxMeshComponent::~BoxMeshComponent()
+{
+	PrimitiveGeometryCache::release(geometryKey);
+
+	// Buffers belong to the geometry cache. Keep the super class from deleting them.
+	for (auto& subMesh : subMeshes) {
+
+		subMesh.vao = 0;
+		subMesh.vertexBuffer = 0;
+		subMesh.indexBuffer = 0;
+	}
+
+} // end destructor
+
+
 void BoxMeshComponent::initialize()
+{
+	geometryKey = PrimitiveGeometryCache::getBoxKey(2 * halfWidth, 2 * halfHeight, 2 * halfDepth);
+
+	PrimitiveGeometry* geometry = PrimitiveGeometryCache::acquire(geometryKey);
+
+	if (geometry == nullptr) {
+
+		geometry = buildBox();
+	}
+
+	// Share the buffers but use the material for this box
+	SubMesh subMesh = geometry->subMesh;
+	subMesh.material = material;
+
+	this->subMeshes.push_back(subMesh);
+
+	this->collisionShape = geometry->collisionShape;
+
+} // end initialize
+
+
+PrimitiveGeometry* BoxMeshComponent::buildBox()
 {
 	std::vector<pntVertexData> vData;
 	std::vector<unsigned int> indices;
@@ -79,8 +117,7 @@ void BoxMeshComponent::initialize()
 		indices.push_back(0 + 4 * i);
 	}
 
-	this->collisionShape = new btBoxShape(btVector3(halfWidth, halfHeight, halfDepth));
+	return PrimitiveGeometryCache::add(geometryKey, MeshComponent::buildSubMesh(vData, indices, nullptr),
+									   new btBoxShape(btVector3(halfWidth, halfHeight, halfDepth)));
 
-	this->subMeshes.push_back(MeshComponent::buildSubMesh(vData, indices, material));
-
-} // end initialize
+} // end buildBox
@@ -1,5 +1,5 @@
 #pragma once
-#include "MeshComponent.H"
+#include "MeshComponent.h"
 
 
 class BoxMeshComponent : public MeshComponent
@@ -7,14 +7,41 @@ class BoxMeshComponent : public MeshComponent
 	public:
 	BoxMeshComponent(Material* material, float width = 1.0f, float height = 1.0f, float depth = 1.0f, int updateOrder = 100);
 
+	/**
+	 * @fn	BoxMeshComponent::~BoxMeshComponent();
+	 *
+	 * @brief	Destructor. Releases the shared geometry. The buffers are deleted by the
+	 * 			geometry cache when the last box with the same dimensions is deleted.
+	 */
+	~BoxMeshComponent();
+
+	/**
+	 * @fn	virtual void BoxMeshComponent::initialize() override;
+	 *
+	 * @brief	Retrieves the geometry for boxes with the same dimensions from the geometry
+	 * 			cache. The geometry is built if this is the first one.
+	 */
 	virtual void initialize() override;
 ;
 
 	protected:
 
+	/**
+	 * @fn	struct PrimitiveGeometry* BoxMeshComponent::buildBox();
+	 *
+	 * @brief	Builds the vertex data, buffers and collision shape for the box and adds
+	 * 			them to the geometry cache.
+	 *
+	 * @returns	The geometry.
+	 */
+	struct PrimitiveGeometry* buildBox();
+
 	float halfWidth, halfHeight, halfDepth;
 
 	Material * material;
 
+	/** @brief	Key of the shared geometry in the geometry cache */
+	std::string geometryKey;
+
 };
 
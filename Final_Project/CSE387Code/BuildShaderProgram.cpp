@@ -1,5 +1,11 @@
 #include "BuildShaderProgram.h"
+#include "CpuProfiler.h"
 #include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
 
 #define VERBOSE false
 
@@ -9,8 +15,7 @@ static std::vector<GLuint> shaderProgramsCreated;
 // Reads in the source code of a shader program.  
 const GLchar* ReadShader(const char* filename)
 {
-	FILE* infile;
-	fopen_s(&infile, filename, "rb");
+	std::ifstream infile(filename, std::ios::binary);
 
 	if (!infile) {
 
@@ -23,14 +28,13 @@ const GLchar* ReadShader(const char* filename)
 		if ( VERBOSE ) std::cout << std::endl << "Reading '" << filename << "' shader source code." << std::endl;
 	}
 
-	fseek(infile, 0, SEEK_END);
-	size_t len = ftell(infile);
-	fseek(infile, 0, SEEK_SET);
+	infile.seekg(0, std::ios::end);
+	size_t len = static_cast<size_t>(infile.tellg());
+	infile.seekg(0, std::ios::beg);
 
-	GLchar* source = new GLchar[len + (__int64)1];
+	GLchar* source = new GLchar[len + 1];
 
-	fread(source, (size_t)1, len, infile);
-	fclose(infile);
+	infile.read(source, len);
 
 	source[len] = 0;
 
@@ -39,68 +43,347 @@ const GLchar* ReadShader(const char* filename)
 } // end ReadShader
 
 
-GLuint BuildShaderProgram(ShaderInfo* shaders)
+// Directory in which linked program binaries are saved
+static const std::string shaderCacheDirectory = "ShaderCache/";
+
+// True if GL_KHR_parallel_shader_compile is available and enabled
+static bool parallelCompileEnabled = false;
+
+// State of a shader program that is being built
+struct ProgramBuild {
+
+	ShaderInfo* shaders = nullptr; // Shaders that make up the program
+
+	std::vector<GLuint> shaderObjects; // Shader objects of this build, in the order of the shaders
+
+	GLuint program = 0; // Shader program object. Zero if building failed.
+
+	std::string defines; // Preprocessor definitions added to every shader
+
+	std::string cacheFileName; // File holding the binary for the program
+
+	bool loadedFromCache = false; // True if the program was created from a cached binary
+
+	bool finished = false; // True once the compile and link results have been checked
+
+};
+
+
+// Determines if the OpenGL context supports an extension
+static bool isExtensionSupported(const std::string& extensionName)
 {
-	if (shaders == nullptr) { return 0; }
+	GLint extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
 
-	// Creates an empty Shader Program object and returns an unsigned int by which
-	// it can be referenced. Shader objects will be attached to the program
-	// object.
-	GLuint program = glCreateProgram();
+	for (GLint i = 0; i < extensionCount; i++) {
 
-	// Declare and array of structures to hold information particular shaders.
-	ShaderInfo* entry = shaders;
+		const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
 
-	// Loop though all shaders specified in entry array until a GL_NONE
-	// is encountered in the type field. All shaders will be attached
-	// to the shader program.
-	while (entry->type != GL_NONE) {
+		if (extension != nullptr && extensionName == extension) {
+			return true;
+		}
+	}
 
-		// Creates an empty Shader object and returns an unsigned int by which
-		// it can be referenced.  A shader object is used to maintain the 
-		// source code strings that define a shader.
-		GLuint shader = glCreateShader(entry->type);
+	return false;
+
+} // end isExtensionSupported
+
+
+// Lets the driver compile and link shaders on background threads if it supports
+// GL_KHR_parallel_shader_compile. Status queries then only block for the object
+// being queried.
+static void enableParallelShaderCompile()
+{
+	static bool checked = false;
+
+	if (checked) {
+		return;
+	}
+	checked = true;
+
+	const char* functionName = nullptr;
+
+	if (isExtensionSupported("GL_KHR_parallel_shader_compile")) {
+		functionName = "glMaxShaderCompilerThreadsKHR";
+	}
+	else if (isExtensionSupported("GL_ARB_parallel_shader_compile")) {
+		functionName = "glMaxShaderCompilerThreadsARB";
+	}
+
+	if (functionName != nullptr) {
+
+		// Extension functions are not loaded by gl3wInit
+		PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxShaderCompilerThreads =
+			reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(gl3wGetProcAddress(functionName));
+
+		if (maxShaderCompilerThreads != nullptr) {
+
+			// Let the implementation decide how many threads to use
+			maxShaderCompilerThreads(0xFFFFFFFF);
+			parallelCompileEnabled = true;
+		}
+	}
+
+	if (VERBOSE) std::cout << "Parallel shader compile " << (parallelCompileEnabled ? "enabled" : "not available") << std::endl;
+
+} // end enableParallelShaderCompile
+
+
+// 64 bit FNV-1a hash
+static unsigned long long hashString(const std::string& text, unsigned long long hash = 14695981039346656037ULL)
+{
+	for (unsigned char c : text) {
+
+		hash ^= c;
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+
+} // end hashString
+
+
+// Builds the name of the file holding the program binary. Binaries are only valid for
+// the driver that created them so the driver strings are part of the hash.
+static std::string getCacheFileName(ShaderInfo* shaders, const std::vector<std::string>& sources)
+{
+	unsigned long long hash = hashString(reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+	hash = hashString(reinterpret_cast<const char*>(glGetString(GL_RENDERER)), hash);
+	hash = hashString(reinterpret_cast<const char*>(glGetString(GL_VERSION)), hash);
+
+	int i = 0;
+	for (ShaderInfo* entry = shaders; entry->type != GL_NONE; ++entry, ++i) {
+
+		hash = hashString(std::to_string(entry->type), hash);
+		hash = hashString(sources[i], hash);
+	}
+
+	std::stringstream fileName;
+	fileName << shaderCacheDirectory << std::hex << std::setw(16) << std::setfill('0') << hash << ".bin";
+
+	return fileName.str();
+
+} // end getCacheFileName
+
+
+// Creates the program from a previously saved binary. Fails if there is no binary
+// or the driver rejects it.
+static bool loadProgramBinary(GLuint program, const std::string& cacheFileName)
+{
+	std::ifstream file(cacheFileName, std::ios::binary);
+
+	if (!file) {
+		return false;
+	}
+
+	GLenum binaryFormat = 0;
+	file.read(reinterpret_cast<char*>(&binaryFormat), sizeof(binaryFormat));
+
+	std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	if (!file.eof() || binary.empty()) {
+		return false;
+	}
+
+	glProgramBinary(program, binaryFormat, &binary[0], static_cast<GLsizei>(binary.size()));
+
+	GLint linked;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+	if (VERBOSE) std::cout << (linked ? "Loaded program binary " : "Rejected program binary ") << cacheFileName << std::endl;
+
+	return linked == GL_TRUE;
+
+} // end loadProgramBinary
+
+
+// Saves the binary of a linked program so that it does not have to be compiled again
+static void saveProgramBinary(GLuint program, const std::string& cacheFileName)
+{
+	GLint formatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+	if (formatCount == 0 || length == 0) {
+		return;
+	}
+
+	std::vector<char> binary(length);
+	GLenum binaryFormat = 0;
+
+	glGetProgramBinary(program, length, &length, &binaryFormat, &binary[0]);
+
+	// Failing to create the directory is reported when the file cannot be created
+	std::error_code error;
+	std::filesystem::create_directories(shaderCacheDirectory, error);
+
+	std::ofstream file(cacheFileName, std::ios::binary);
+
+	if (!file) {
+
+		if (VERBOSE) std::cout << "Unable to save program binary " << cacheFileName << std::endl;
+		return;
+	}
+
+	file.write(reinterpret_cast<const char*>(&binaryFormat), sizeof(binaryFormat));
+	file.write(&binary[0], length);
+
+} // end saveProgramBinary
+
+
+// Inserts preprocessor definitions after the #version directive which
+// must be the first line of the shader
+static void insertDefines(std::string& source, const std::string& defines)
+{
+	if (defines.empty()) {
+		return;
+	}
+
+	size_t lineEnd = source.find('\n');
+
+	if (source.compare(0, 8, "#version") == 0 && lineEnd != std::string::npos) {
+
+		source.insert(lineEnd + 1, defines);
+	}
+	else {
+
+		source.insert(0, defines);
+	}
+
+} // end insertDefines
+
+
+// Releases the shader objects of a program that could not be built
+static void deleteShaders(ProgramBuild& build)
+{
+	for (GLuint shader : build.shaderObjects) {
+
+		// Shaders that are still attached are deleted with the program
+		if (build.program != 0) {
+			glDetachShader(build.program, shader);
+		}
+
+		// Release the name (ID) that was allocated.
+		glDeleteShader(shader);
+	}
+
+	build.shaderObjects.clear();
 
-		// Store the int ID for the shader in a ShaderInfo structure
-		entry->shader = shader;
+} // end deleteShaders
+
+
+// Creates the program from a cached binary if possible. Otherwise starts compiling
+// and linking the program. Results are not checked so that programs can be compiled
+// in parallel.
+static void startProgram(ProgramBuild& build)
+{
+	std::vector<std::string> sources;
+
+	for (ShaderInfo* entry = build.shaders; entry->type != GL_NONE; ++entry) {
 
 		// Read in the source code for a shader
 		const GLchar* source = ReadShader(entry->filename);
 		if (source == nullptr) {
-			for (entry = shaders; entry->type != GL_NONE; ++entry) {
-
-				// Release the name (ID) that was allocated.
-				glDeleteShader(entry->shader);
-				entry->shader = 0;
-			}
-
-			return 0;
+			return;
 		}
 
-		// Associate the shader source code with the Shader object
-		glShaderSource(shader, 1, &source, nullptr);
+		sources.push_back(source);
+		insertDefines(sources.back(), build.defines);
 
 		// Release the memory holding the character array into which
 		// the shader source was read
 		delete[] source;
+	}
+
+	build.cacheFileName = getCacheFileName(build.shaders, sources);
+
+	// Creates an empty Shader Program object and returns an unsigned int by which
+	// it can be referenced. Shader objects will be attached to the program
+	// object.
+	build.program = glCreateProgram();
+
+	if (loadProgramBinary(build.program, build.cacheFileName)) {
+
+		build.loadedFromCache = true;
+		return;
+	}
+
+	int i = 0;
+	for (ShaderInfo* entry = build.shaders; entry->type != GL_NONE; ++entry, ++i) {
+
+		// Creates an empty Shader object and returns an unsigned int by which
+		// it can be referenced.  A shader object is used to maintain the 
+		// source code strings that define a shader. The shader objects belong to the
+		// build so that a set of shaders can be in the same batch more than once.
+		GLuint shader = glCreateShader(entry->type);
+		build.shaderObjects.push_back(shader);
+
+		// Associate the shader source code with the Shader object
+		const GLchar* source = sources[i].c_str();
+		glShaderSource(shader, 1, &source, nullptr);
 
 		// Complie the shader source code
 		glCompileShader(shader);
 
+		// Associate the compiled shader with the shader program.
+		// Shader functionality will not be available until it has be linked.
+		glAttachShader(build.program, shader);
+	}
+
+	// Allow the linked program to be saved
+	glProgramParameteri(build.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+	// Generates a complete shader program. All required shader objects
+	// must be attached prior to linking.
+	glLinkProgram(build.program);
+
+} // end startProgram
+
+
+// Checks the results of compiling and linking a program. Saves the binary of
+// programs that were successfully built from source.
+static GLuint finishProgram(ProgramBuild& build)
+{
+	build.finished = true;
+
+	if (build.program == 0) {
+		return 0;
+	}
+
+	// Programs loaded from binaries were linked and validated when they were saved
+	if (build.loadedFromCache) {
+
+		shaderProgramsCreated.push_back(build.program);
+
+		return build.program;
+	}
+
+	int i = 0;
+	for (ShaderInfo* entry = build.shaders; entry->type != GL_NONE; ++entry, ++i) {
+
+		GLuint shader = build.shaderObjects[i];
+
 		// Determine if the shader compiled without errors.
 		// "complied" will be set to GL_TRUE if compile operation 
 		// is a success.
-		GLint compiled;
+		GLint compiled = GL_FALSE;
 		glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
 		if (!compiled) {
 
-			GLsizei len;
+			GLsizei len = 0;
 			glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &len);
 
-			GLchar* log = new GLchar[len + (__int64)1];
+			GLchar* log = new GLchar[static_cast<size_t>(len) + 1];
+			log[0] = 0;
 			glGetShaderInfoLog(shader, len, &len, log);
-			std::cerr << "\nShader compilation failed: \n" << log << "\n" << std::endl;
+			std::cerr << "\n" << entry->filename << " compilation failed: \n" << log << "\n" << std::endl;
 			delete[] log;
+
+			deleteShaders(build);
+			glDeleteProgram(build.program);
+
 			return 0;
 		}
 		else {
@@ -108,70 +391,49 @@ GLuint BuildShaderProgram(ShaderInfo* shaders)
 			if (VERBOSE) std::cout << entry->filename << " successfully compiled. " << std::endl;
 
 		}
-
-		// Associate the compiled shader with the shader program.
-		// Shader functionality will not be available until it has be linked.
-		glAttachShader(program, shader);
-
-		++entry;
-	}
-/**
- * Uncommenting the preprocessor statements below makes it necessary to
- * redeclare the gl_PerVertex built-in block in the vertex shader as follows:
- * 
- * out gl_PerVertex {
- *	 vec4 gl_Position;
- * };
-*/
-//#ifdef GL_VERSION_4_1
-//	if (GLEW_VERSION_4_1) {
-//		glProgramParameteri( program, GL_PROGRAM_SEPARABLE, GL_TRUE );
-//	}
-//#endif /* GL_VERSION_4_1 */
-
-	// Generates a complete shader program. All required shader objects
-	// must be attached prior to linking.
-	glLinkProgram(program);
+	}
 
 	// Determine if the shader program successfully linked.
 	// "linked" will be set to GL_TRUE if link is a success.
-	GLint linked;
-	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	GLint linked = GL_FALSE;
+	glGetProgramiv(build.program, GL_LINK_STATUS, &linked);
 	if (!linked) {
 	
-		GLsizei len;
-		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &len);
+		GLsizei len = 0;
+		glGetProgramiv(build.program, GL_INFO_LOG_LENGTH, &len);
 
-		GLchar* log = new GLchar[len + (__int64)1];
-		glGetProgramInfoLog(program, len, &len, log);
+		GLchar* log = new GLchar[static_cast<size_t>(len) + 1];
+		glGetProgramInfoLog(build.program, len, &len, log);
 		std::cerr << "\nShader linking failed: \n" << log << "\n" << std::endl;
 		delete[] log;
 
-
-		for (entry = shaders; entry->type != GL_NONE; ++entry) {
-			glDeleteShader(entry->shader);
-			entry->shader = 0;
-		}
+		deleteShaders(build);
+		glDeleteProgram(build.program);
 
 		return 0;
 	}
 	else {
 
-		if (VERBOSE) std::cout << std::endl << "Shader Program " << program << " successfully linked";
+		if (VERBOSE) std::cout << std::endl << "Shader Program " << build.program << " successfully linked";
 
 	}
+
+	// The linked program no longer needs the shader objects
+	deleteShaders(build);
+
 	// Check whether the program can execute given the current pipeline state.
-	glValidateProgram(program);
-	GLint valid;
-	glGetProgramiv(program, GL_VALIDATE_STATUS, &valid);
+	glValidateProgram(build.program);
+	GLint valid = GL_FALSE;
+	glGetProgramiv(build.program, GL_VALIDATE_STATUS, &valid);
 	if (!valid) {
 
-		GLsizei len;
-		glGetProgramiv(program, GL_VALIDATE_STATUS, &len);
+		GLsizei len = 0;
+		glGetProgramiv(build.program, GL_INFO_LOG_LENGTH, &len);
 
-		GLchar* log = new GLchar[len + (__int64)1];
-		glGetProgramInfoLog(program, len, &len, log);
+		GLchar* log = new GLchar[static_cast<size_t>(len) + 1];
+		glGetProgramInfoLog(build.program, len, &len, log);
 		std::cerr << "." << std::endl << "Shader program is invalid: " << log << std::endl;
+		delete[] log;
 
 		return 0;
 	}
@@ -180,13 +442,95 @@ GLuint BuildShaderProgram(ShaderInfo* shaders)
 		if (VERBOSE) std::cout << " and is valid. " << std::endl << std::endl;
 	}
 
-	shaderProgramsCreated.push_back(program);
+	saveProgramBinary(build.program, build.cacheFileName);
+
+	shaderProgramsCreated.push_back(build.program);
+
+	return build.program;
+
+} // end finishProgram
 
-	return program;
+
+GLuint BuildShaderProgram(ShaderInfo* shaders, const std::string& defines)
+{
+	CPU_PROFILE_SCOPE("BuildShaderProgram");
+
+	if (shaders == nullptr) { return 0; }
+
+	std::vector<ShaderInfo*> shaderSets = { shaders };
+	std::vector<std::string> programDefines = { defines };
+
+	return BuildShaderPrograms(shaderSets, programDefines)[0];
 
 } // end BuildShaderProgram
 
 
+std::vector<GLuint> BuildShaderPrograms(const std::vector<ShaderInfo*>& shaderSets, const std::vector<std::string>& defines)
+{
+	enableParallelShaderCompile();
+
+	std::vector<ProgramBuild> builds(shaderSets.size());
+
+	// Start building all of the programs before checking any results
+	for (size_t i = 0; i < shaderSets.size(); i++) {
+
+		builds[i].shaders = shaderSets[i];
+
+		if (i < defines.size()) {
+			builds[i].defines = defines[i];
+		}
+
+		if (shaderSets[i] != nullptr) {
+			startProgram(builds[i]);
+		}
+	}
+
+	std::vector<GLuint> programs(shaderSets.size(), 0);
+
+	if (parallelCompileEnabled) {
+
+		// Finish programs in the order they complete
+		size_t remaining = builds.size();
+
+		while (remaining > 0) {
+
+			for (size_t i = 0; i < builds.size(); i++) {
+
+				if (builds[i].finished) {
+					continue;
+				}
+
+				GLint complete = GL_TRUE;
+
+				if (builds[i].program != 0 && !builds[i].loadedFromCache) {
+					glGetProgramiv(builds[i].program, GL_COMPLETION_STATUS_KHR, &complete);
+				}
+
+				if (complete) {
+
+					programs[i] = finishProgram(builds[i]);
+					remaining--;
+				}
+			}
+
+			if (remaining > 0) {
+				std::this_thread::yield();
+			}
+		}
+	}
+	else {
+
+		for (size_t i = 0; i < builds.size(); i++) {
+
+			programs[i] = finishProgram(builds[i]);
+		}
+	}
+
+	return programs;
+
+} // end BuildShaderPrograms
+
+
 void deleteAllShaderPrograms()
 {
 	for (auto& shaderProgram : shaderProgramsCreated) {
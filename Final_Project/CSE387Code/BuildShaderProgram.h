@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MathLibsConstsFuncs.h"
+#include <string>
 
 typedef struct {
 	GLenum       type;
@@ -8,7 +9,35 @@ typedef struct {
 	GLuint       shader;
 } ShaderInfo;
 
-GLuint BuildShaderProgram(ShaderInfo* shaders);
+/**
+ * @fn	GLuint BuildShaderProgram(ShaderInfo* shaders, const std::string& defines = "");
+ *
+ * @brief	Builds a shader program from the shader source files listed in the array.
+ * 			The array ends with an entry with a type of GL_NONE. Linked programs are
+ * 			saved as binaries in the ShaderCache directory. The binary is used instead
+ * 			of compiling the sources if neither the sources nor the driver have changed.
+ *
+ * @param	shaders	The shaders.
+ * @param	defines	(Optional) Preprocessor definitions inserted after the #version
+ * 					directive of every shader. Used to build specialized variants.
+ *
+ * @returns	Zero if it fails, else the shader program.
+ */
+GLuint BuildShaderProgram(ShaderInfo* shaders, const std::string& defines = "");
+
+/**
+ * @fn	std::vector<GLuint> BuildShaderPrograms(const std::vector<ShaderInfo*>& shaderSets, const std::vector<std::string>& defines = {});
+ *
+ * @brief	Builds several shader programs at once. All compiles and links are started
+ * 			before any results are checked so drivers that support
+ * 			GL_KHR_parallel_shader_compile can build the programs in parallel.
+ *
+ * @param	shaderSets	Arrays of shaders for each program. See BuildShaderProgram.
+ * @param	defines   	(Optional) Preprocessor definitions for each program.
+ *
+ * @returns	The shader programs in the same order. Zero for programs that failed.
+ */
+std::vector<GLuint> BuildShaderPrograms(const std::vector<ShaderInfo*>& shaderSets, const std::vector<std::string>& defines = {});
 
 void deleteAllShaderPrograms();
 
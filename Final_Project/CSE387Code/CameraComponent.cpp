@@ -8,39 +8,73 @@ CameraComponent::CameraComponent(int updateOrder)
 
 }
 
+CameraComponent::~CameraComponent()
+{
+	auto iter = std::find(activeCameras.begin(), activeCameras.end(), this);
+
+	if (iter != activeCameras.end()) {
+		activeCameras.erase(iter);
+	}
+
+	SharedProjectionAndViewing::removeCamera(cameraSlot);
+}
+
 void CameraComponent::initialize()
 {
 	activeCameras.push_back(this);
 	std::sort(activeCameras.begin(), activeCameras.end(), CompareDepth);
+
+	cameraSlot = SharedProjectionAndViewing::addCamera();
+	cameraDataChanged = true;
 }
 
 /**
-* Called before the scene is rendered from the perspective of this camera.
-* Sets the viewport, projection matrix, and viewing transformation based upon this Camera so
-* that the scene can be rendered in the specified viewport without distortion from the
-* viewpoint of the Camera. Uses methods of the SharedProjectionAndViewing class to accomplish
-* this task.
+* Called once per frame on the update thread. Computes the projection and viewing
+* transformations, the viewport and the frustum of this Camera if the camera moved or
+* the size of its viewport changed, and copies them into its view in the render snapshot.
 */
-void CameraComponent::setViewingTransformation()
+void CameraComponent::updateCameraData(CameraView& view, float interpolation)
 {
-	int width, height;
-	// Get the current width and height of the rendering window
-	width = this->owningGameObject->getOwningGame()->getWindowWidth();
-	height = this->owningGameObject->getOwningGame()->getWindowHeight();
+	// Framebuffer size is cached by the game
+	int width = this->owningGameObject->getOwningGame()->getWindowWidth();
+	int height = this->owningGameObject->getOwningGame()->getWindowHeight();
+
+	// Moves smoothly with the meshes between fixed updates
+	glm::mat4 worldTransform = this->owningGameObject->sceneNode.getInterpolatedTransformation(interpolation);
+
+	view.cameraChanged = false;
+
+	// Nothing can be rendered while the window is minimized
+	if ((cameraDataChanged == true || width != framebufferWidth || height != framebufferHeight ||
+		worldTransform != cameraWorldTransform) &&
+		viewPortWidth * width >= 1.0f && viewPortHeight * height >= 1.0f) {
+
+		framebufferWidth = width;
+		framebufferHeight = height;
+		cameraWorldTransform = worldTransform;
+		cameraDataChanged = false;
 
-	glViewport(static_cast<GLint>(xLowerLeft * width), 
-		static_cast<GLint>(yLowerLeft * height), 
-		static_cast<GLint>(viewPortWidth * width), 
-		static_cast<GLint>(viewPortHeight * height));
+		viewport[0] = static_cast<GLint>(xLowerLeft * width);
+		viewport[1] = static_cast<GLint>(yLowerLeft * height);
+		viewport[2] = static_cast<GLint>(viewPortWidth * width);
+		viewport[3] = static_cast<GLint>(viewPortHeight * height);
 
-	SharedProjectionAndViewing::setViewMatrix(glm::inverse(this->owningGameObject->sceneNode.getTransformation(WORLD)));
+		GLfloat aspect = static_cast<float>(viewPortWidth * width) / (height * viewPortHeight);
 
-	//	GLfloat aspect = static_cast<float>(width) / height;
-	GLfloat aspect = static_cast<float>(viewPortWidth * width) / (height * viewPortHeight);
+		projectionMatrix = glm::perspective(glm::radians(45.0f), aspect, 1.0f, 1000.0f);
+		viewMatrix = glm::inverse(worldTransform);
 
-	mat4 projMat = glm::perspective(glm::radians(45.0f), aspect, 1.0f, 1000.0f);
+		view.cameraChanged = true;
+	}
 
-	SharedProjectionAndViewing::setProjectionMatrix(projMat);
+	view.cameraSlot = cameraSlot;
+	view.viewMatrix = viewMatrix;
+	view.projectionMatrix = projectionMatrix;
+	std::copy(viewport, viewport + 4, view.viewport);
+	view.frustum.setMatrix(projectionMatrix * viewMatrix);
+	view.occlusionCuller = &occlusionCuller;
+	view.depthPrepass = depthPrepass;
+	view.frontToBack = frontToBack;
 
 }
 
@@ -59,6 +93,7 @@ void CameraComponent::setViewPort(GLfloat xLowerLeft, GLfloat yLowerLeft, GLfloa
 	this->yLowerLeft = yLowerLeft;
 	this->viewPortWidth = viewPortWidth;
 	this->viewPortHeight = viewPortHeight;
+	this->cameraDataChanged = true;
 }
 
 void CameraComponent::setDepth(int depth)
@@ -5,6 +5,8 @@
 #include <iostream> 
 
 #include "SharedProjectionAndViewing.h"
+#include "OcclusionCuller.h"
+#include "RenderSnapshot.h"
 
 class CameraComponent : public Component
 {
@@ -20,24 +22,35 @@ public:
 	 */
 	CameraComponent(int updateOrder = 100);
 
+	/**
+	 * @fn	CameraComponent::~CameraComponent();
+	 *
+	 * @brief	Destructor. Removes the camera from the activeCameras vector and frees its slot in
+	 * 			the camera uniform buffer.
+	 */
+	~CameraComponent();
+
 	/**
 	 * @fn	void CameraComponent::initialize() override;
 	 *
 	 * @brief	Initializes the camera by adding it to the activeCameras vector and then sorts the vector
-	 * 			base on camera depth.
+	 * 			base on camera depth. Reserves a slot for the camera in the camera uniform buffer.
 	 */
 	void initialize() override;
 
 	/**
-	 * @fn	void CameraComponent::setViewingTransformation();
+	 * @fn	void CameraComponent::updateCameraData(CameraView& view);
+	 *
+	 * @brief	Called once per frame on the update thread when the render snapshot is built.
+	 * 			Computes the projection matrix, viewing transformation, viewport and frustum of
+	 * 			the camera if the camera moved or its viewport changed since the last frame and
+	 * 			copies them into the view. No OpenGL calls are made. The render thread copies
+	 * 			the matrices into the slot of the camera if cameraChanged is set in the view.
 	 *
-	 * @brief	Called before the scene is rendered from the perspective of this camera. Sets the
-	 * 			viewport (using glViewport), projection matrix, and viewing transformation based upon
-	 * 			this Camera so that the scene can be rendered in the specified viewport without
-	 * 			distortion from the viewpoint of the Camera. Uses methods of the
-	 * 			SharedProjectionAndViewing class to accomplish this task.
+	 * @param [out]	view		 	The view of the camera in the render snapshot.
+	 * @param 	   	interpolation	Fraction of a fixed update that has passed since the last one.
 	 */
-	void setViewingTransformation();
+	void updateCameraData(CameraView& view, float interpolation);
 
 	/**
 	 * @fn	void CameraComponent::setViewPort(GLfloat xLowerLeft, GLfloat yLowerLeft, GLfloat viewPortWidth, GLfloat viewPortHeight);
@@ -64,6 +77,28 @@ public:
 	 */
 	void setDepth(int depth);
 
+	/**
+	 * @fn	void CameraComponent::setDepthPrepass(bool depthPrepass)
+	 *
+	 * @brief	Renders the depth of the visible meshes with a position only program before they
+	 * 			are shaded. The shading pass then only shades the nearest fragment of each
+	 * 			pixel. Worth it when the fragment shader is expensive and meshes overlap.
+	 */
+	void setDepthPrepass(bool depthPrepass) { this->depthPrepass = depthPrepass; }
+
+	bool getDepthPrepass() const { return depthPrepass; }
+
+	/**
+	 * @fn	void CameraComponent::setFrontToBack(bool frontToBack)
+	 *
+	 * @brief	Sorts the meshes of the view front to back instead of by shader program and
+	 * 			texture so that nearer meshes hide the fragments of farther ones. Has little
+	 * 			effect with a depth pre-pass, which is always rendered front to back.
+	 */
+	void setFrontToBack(bool frontToBack) { this->frontToBack = frontToBack; }
+
+	bool getFrontToBack() const { return frontToBack; }
+
 	/**
 	 * @brief	Vector containing the Cameras that are enabled. The vector should be sorted based
 	 * 			upon the depth values of the cameras. Figure out how to the use STL sort method to
@@ -97,5 +132,28 @@ protected:
 	// Render depth of the camera. Higher depth cameras render on top of lower depth cameras.
 	int depth = 0;
 
+	// Slot of the camera in the camera uniform buffer
+	int cameraSlot = -1;
+
+	// World transformation and framebuffer size used to compute the data in the slot
+	glm::mat4 cameraWorldTransform;
+	int framebufferWidth = 0;
+	int framebufferHeight = 0;
+
+	// True if the data in the slot must be computed again
+	bool cameraDataChanged = true;
+
+	// Matrices and viewport in pixels computed by updateCameraData
+	glm::mat4 viewMatrix;
+	glm::mat4 projectionMatrix;
+	GLint viewport[4] = { 0, 0, 0, 0 };
+
+	// Depth pyramid and visible meshes of the view of the camera
+	OcclusionCuller occlusionCuller;
+
+	// Overdraw reduction of the view of the camera
+	bool depthPrepass = false;
+	bool frontToBack = false;
+
 };
 
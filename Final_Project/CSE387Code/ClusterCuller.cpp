@@ -0,0 +1,358 @@
+#include "ClusterCuller.h"
+#include "CpuProfiler.h"
+#include "GLStateCache.h"
+#include "MeshletSet.h"
+
+#include <algorithm>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#include <xmmintrin.h>
+#define CLUSTER_CULLER_SSE 1
+#else
+#define CLUSTER_CULLER_SSE 0
+#endif
+
+#define VERBOSE false
+
+// Meshlets tested by one task. A multiple of four.
+#define TASK_MESHLETS 256
+
+// Fewer meshlets are tested on the calling thread alone
+#define PARALLEL_MESHLETS 2048
+
+// Upper limit on the worker threads
+#define MAX_WORKERS 3
+
+bool ClusterCuller::clusterCullingEnabled = true;
+
+
+int ClusterCuller::addJob(const MeshletSet* meshlets, const glm::mat4& modelViewProjection, const glm::vec3& objectEyePosition, bool backFaceCulling)
+{
+	Job job;
+
+	job.meshlets = meshlets;
+	job.frustum.setMatrix(modelViewProjection);
+	job.eyePosition = objectEyePosition;
+	job.backFaceCulling = backFaceCulling;
+
+	jobs.push_back(std::move(job));
+
+	return static_cast<int>(jobs.size()) - 1;
+
+} // end addJob
+
+
+void ClusterCuller::cull()
+{
+	CPU_PROFILE_SCOPE("ClusterCuller::cull");
+
+	tasks.clear();
+
+	size_t meshletCount = 0;
+
+	for (size_t i = 0; i < jobs.size(); i++) {
+
+		Job& job = jobs[i];
+
+		job.visible.resize(job.meshlets->count);
+
+		for (int first = 0; first < job.meshlets->count; first += TASK_MESHLETS) {
+
+			tasks.push_back({ i, first, std::min(TASK_MESHLETS, job.meshlets->count - first) });
+		}
+
+		meshletCount += job.meshlets->count;
+	}
+
+	if (meshletCount < PARALLEL_MESHLETS) {
+
+		for (auto& task : tasks) {
+
+			cullRange(jobs[task.job], task.first, task.count);
+		}
+	}
+	else {
+
+		if (workers.empty()) {
+
+			unsigned int workerCount = std::min(std::max(std::thread::hardware_concurrency(), 1u) - 1, static_cast<unsigned int>(MAX_WORKERS));
+
+			for (unsigned int i = 0; i < workerCount; i++) {
+
+				workers.push_back(std::thread(&ClusterCuller::workerLoop, this));
+			}
+		}
+
+		nextTask = 0;
+		remainingTasks = tasks.size();
+
+		{
+			std::lock_guard<std::mutex> lock(workerMutex);
+			generation++;
+			tasksOpen = true;
+		}
+
+		startCondition.notify_all();
+
+		runTasks();
+
+		// No worker may still be reading the tasks when they are changed by the next cull
+		std::unique_lock<std::mutex> lock(workerMutex);
+		doneCondition.wait(lock, [this] { return remainingTasks == 0 && activeWorkers == 0; });
+		tasksOpen = false;
+	}
+
+	// Visible meshlets that follow each other in the index buffer are drawn together
+	commands.clear();
+	testedCount = meshletCount;
+	visibleCount = 0;
+
+	for (auto& job : jobs) {
+
+		job.firstCommand = commands.size();
+		job.indexCount = 0;
+
+		const MeshletSet& meshlets = *job.meshlets;
+
+		for (int i = 0; i < meshlets.count; i++) {
+
+			if (job.visible[i] == 0) {
+				continue;
+			}
+
+			visibleCount++;
+			job.indexCount += meshlets.indexCount[i];
+
+			if (commands.size() > job.firstCommand && commands.back().firstIndex + commands.back().count == meshlets.firstIndex[i]) {
+
+				commands.back().count += meshlets.indexCount[i];
+			}
+			else {
+
+				commands.push_back({ meshlets.indexCount[i], 1, meshlets.firstIndex[i], 0, 0 });
+			}
+		}
+
+		job.commandCount = commands.size() - job.firstCommand;
+	}
+
+	if (commands.empty()) {
+		return;
+	}
+
+	if (indirectBuffer == 0) {
+
+		glGenBuffers(1, &indirectBuffer);
+	}
+
+	GLStateCache::bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+
+	// Orphan the storage so commands still being read by earlier draws are not overwritten
+	bufferCapacity = std::max(bufferCapacity, commands.size());
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, bufferCapacity * sizeof(DrawCommand), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commands.size() * sizeof(DrawCommand), &commands[0]);
+
+	if (VERBOSE) cout << visibleCount << " of " << testedCount << " meshlets visible in " << commands.size() << " commands" << endl;
+
+} // end cull
+
+
+void ClusterCuller::getCommands(int job, GLintptr& offset, GLsizei& count, GLuint& indexCount) const
+{
+	offset = static_cast<GLintptr>(jobs[job].firstCommand * sizeof(DrawCommand));
+	count = static_cast<GLsizei>(jobs[job].commandCount);
+	indexCount = jobs[job].indexCount;
+
+} // end getCommands
+
+
+void ClusterCuller::clear()
+{
+	jobs.clear();
+
+} // end clear
+
+
+void ClusterCuller::destroy()
+{
+	if (workers.empty() == false) {
+
+		{
+			std::lock_guard<std::mutex> lock(workerMutex);
+			stopping = true;
+		}
+
+		startCondition.notify_all();
+
+		for (auto& worker : workers) {
+
+			worker.join();
+		}
+
+		workers.clear();
+		stopping = false;
+	}
+
+	if (indirectBuffer != 0) {
+
+		GLStateCache::deleteBuffers(1, &indirectBuffer);
+		indirectBuffer = 0;
+		bufferCapacity = 0;
+	}
+
+	jobs.clear();
+
+} // end destroy
+
+
+void ClusterCuller::cullRange(Job& job, int first, int count)
+{
+	const MeshletSet& meshlets = *job.meshlets;
+
+	int last = first + count;
+
+#if CLUSTER_CULLER_SSE
+
+	const __m128 zero = _mm_setzero_ps();
+
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+
+	for (int p = 0; p < 6; p++) {
+
+		const glm::vec4& plane = job.frustum.getPlane(p);
+
+		planeX[p] = _mm_set1_ps(plane.x);
+		planeY[p] = _mm_set1_ps(plane.y);
+		planeZ[p] = _mm_set1_ps(plane.z);
+		planeW[p] = _mm_set1_ps(plane.w);
+	}
+
+	__m128 eyeX = _mm_set1_ps(job.eyePosition.x);
+	__m128 eyeY = _mm_set1_ps(job.eyePosition.y);
+	__m128 eyeZ = _mm_set1_ps(job.eyePosition.z);
+
+	// The bounds are padded to a multiple of four
+	for (int i = first; i < last; i += 4) {
+
+		__m128 centerX = _mm_loadu_ps(&meshlets.centerX[i]);
+		__m128 centerY = _mm_loadu_ps(&meshlets.centerY[i]);
+		__m128 centerZ = _mm_loadu_ps(&meshlets.centerZ[i]);
+		__m128 radius = _mm_loadu_ps(&meshlets.radius[i]);
+		__m128 negativeRadius = _mm_sub_ps(zero, radius);
+
+		// Inside or touching every plane
+		__m128 visible = _mm_cmpeq_ps(zero, zero);
+
+		for (int p = 0; p < 6; p++) {
+
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], centerX), _mm_mul_ps(planeY[p], centerY)),
+										 _mm_add_ps(_mm_mul_ps(planeZ[p], centerZ), planeW[p]));
+
+			visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		if (job.backFaceCulling) {
+
+			__m128 toCenterX = _mm_sub_ps(centerX, eyeX);
+			__m128 toCenterY = _mm_sub_ps(centerY, eyeY);
+			__m128 toCenterZ = _mm_sub_ps(centerZ, eyeZ);
+
+			__m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(toCenterX, toCenterX), _mm_mul_ps(toCenterY, toCenterY)),
+													 _mm_mul_ps(toCenterZ, toCenterZ)));
+
+			__m128 alongAxis = _mm_add_ps(_mm_add_ps(_mm_mul_ps(toCenterX, _mm_loadu_ps(&meshlets.coneX[i])),
+													 _mm_mul_ps(toCenterY, _mm_loadu_ps(&meshlets.coneY[i]))),
+										  _mm_mul_ps(toCenterZ, _mm_loadu_ps(&meshlets.coneZ[i])));
+
+			// Every point of the sphere sees the back of every triangle
+			__m128 backFacing = _mm_cmpge_ps(alongAxis, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&meshlets.coneCutoff[i]), distance), radius));
+
+			visible = _mm_andnot_ps(backFacing, visible);
+		}
+
+		int mask = _mm_movemask_ps(visible);
+
+		for (int k = 0; k < 4 && i + k < last; k++) {
+
+			job.visible[i + k] = (mask >> k) & 1;
+		}
+	}
+
+#else
+
+	for (int i = first; i < last; i++) {
+
+		glm::vec3 center(meshlets.centerX[i], meshlets.centerY[i], meshlets.centerZ[i]);
+
+		bool visible = job.frustum.intersectsSphere(center, meshlets.radius[i]);
+
+		if (visible && job.backFaceCulling) {
+
+			glm::vec3 toCenter = center - job.eyePosition;
+			glm::vec3 axis(meshlets.coneX[i], meshlets.coneY[i], meshlets.coneZ[i]);
+
+			visible = glm::dot(toCenter, axis) < meshlets.coneCutoff[i] * glm::length(toCenter) + meshlets.radius[i];
+		}
+
+		job.visible[i] = visible ? 1 : 0;
+	}
+
+#endif
+
+} // end cullRange
+
+
+void ClusterCuller::runTasks()
+{
+	CPU_PROFILE_SCOPE("ClusterCuller::runTasks");
+
+	while (true) {
+
+		size_t task = nextTask++;
+
+		if (task >= tasks.size()) {
+			break;
+		}
+
+		cullRange(jobs[tasks[task].job], tasks[task].first, tasks[task].count);
+
+		if (--remainingTasks == 0) {
+
+			std::lock_guard<std::mutex> lock(workerMutex);
+			doneCondition.notify_all();
+		}
+	}
+
+} // end runTasks
+
+
+void ClusterCuller::workerLoop()
+{
+	CpuProfiler::setThreadName("Cluster Culler");
+
+	unsigned int lastGeneration = 0;
+
+	std::unique_lock<std::mutex> lock(workerMutex);
+
+	while (true) {
+
+		startCondition.wait(lock, [&] { return stopping || (tasksOpen && generation != lastGeneration); });
+
+		if (stopping) {
+			return;
+		}
+
+		lastGeneration = generation;
+		activeWorkers++;
+
+		lock.unlock();
+
+		runTasks();
+
+		lock.lock();
+
+		activeWorkers--;
+		doneCondition.notify_all();
+	}
+
+} // end workerLoop
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MathLibsConstsFuncs.h"
+#include "Frustum.h"
+
+struct MeshletSet;
+
+/**
+ * @class	ClusterCuller
+ *
+ * @brief	Culls the meshlets of large sub-meshes on the CPU and writes draw commands for
+ * 			the visible ones into an indirect draw buffer. A meshlet is culled if its bounding
+ * 			sphere is outside of the frustum or if all of its triangles face away from the
+ * 			viewpoint. Visible meshlets that are next to each other in the index buffer are
+ * 			drawn by a single command.
+ *
+ * 			Four meshlets are tested at once with SSE. When there are enough meshlets, the
+ * 			work is split between worker threads. The tests are done in object coordinates,
+ * 			which keeps them exact under any modeling transformation.
+ *
+ * 			Jobs are added while a render queue is filled and culled together before it is
+ * 			drawn. Must be used on the thread that owns the OpenGL context.
+ */
+class ClusterCuller
+{
+public:
+
+	/**
+	 * @struct	DrawCommand
+	 *
+	 * @brief	Layout of the commands read by glMultiDrawElementsIndirect.
+	 */
+	struct DrawCommand {
+
+		GLuint count;
+
+		GLuint instanceCount;
+
+		GLuint firstIndex;
+
+		GLint baseVertex;
+
+		GLuint baseInstance;
+
+	}; // end DrawCommand
+
+	/**
+	 * @fn	ClusterCuller::~ClusterCuller()
+	 *
+	 * @brief	Destructor. Stops the worker threads and deletes the indirect draw buffer.
+	 */
+	~ClusterCuller() { destroy(); }
+
+	/**
+	 * @fn	int ClusterCuller::addJob(const MeshletSet* meshlets, const glm::mat4& modelViewProjection, const glm::vec3& objectEyePosition, bool backFaceCulling);
+	 *
+	 * @brief	Adds the meshlets of a sub-mesh to be culled.
+	 *
+	 * @param	meshlets		   	The meshlets of the sub-mesh.
+	 * @param	modelViewProjection	The projection, viewing and modeling transformations combined.
+	 * @param	objectEyePosition  	The viewpoint in object coordinates.
+	 * @param	backFaceCulling	   	False to keep meshlets that face away from the viewpoint,
+	 * 								such as when the modeling transformation mirrors the mesh.
+	 *
+	 * @returns	The index of the job.
+	 */
+	int addJob(const MeshletSet* meshlets, const glm::mat4& modelViewProjection, const glm::vec3& objectEyePosition, bool backFaceCulling);
+
+	/**
+	 * @fn	size_t ClusterCuller::getJobCount() const
+	 *
+	 * @brief	Gets the number of jobs added since the last clear.
+	 */
+	size_t getJobCount() const { return jobs.size(); }
+
+	/**
+	 * @fn	void ClusterCuller::cull();
+	 *
+	 * @brief	Culls the meshlets of all jobs and uploads the draw commands of the visible
+	 * 			meshlets into the indirect draw buffer.
+	 */
+	void cull();
+
+	/**
+	 * @fn	void ClusterCuller::getCommands(int job, GLintptr& offset, GLsizei& count, GLuint& indexCount) const;
+	 *
+	 * @brief	Gets the draw commands of a job after it has been culled.
+	 *
+	 * @param 	   	job   	The index of the job.
+	 * @param [out]	offset	Offset of the first command in the indirect draw buffer.
+	 * @param [out]	count 	Number of commands. Zero if every meshlet was culled.
+	 * @param [out]	indexCount	Number of indices drawn by the commands.
+	 */
+	void getCommands(int job, GLintptr& offset, GLsizei& count, GLuint& indexCount) const;
+
+	/**
+	 * @fn	void ClusterCuller::clear();
+	 *
+	 * @brief	Removes the jobs. The indirect draw buffer keeps its contents until the next cull.
+	 */
+	void clear();
+
+	/**
+	 * @fn	void ClusterCuller::destroy();
+	 *
+	 * @brief	Stops the worker threads and deletes the indirect draw buffer.
+	 */
+	void destroy();
+
+	GLuint getIndirectBuffer() const { return indirectBuffer; }
+
+	/** @brief	Meshlets tested and found visible by the last cull */
+	size_t getTestedCount() const { return testedCount; }
+	size_t getVisibleCount() const { return visibleCount; }
+
+	/**
+	 * @fn	static void ClusterCuller::setEnabled(bool enabled)
+	 *
+	 * @brief	Turns culling of meshlets on or off. Sub-meshes are drawn whole when it is off.
+	 */
+	static void setEnabled(bool enabled) { clusterCullingEnabled = enabled; }
+
+	static bool isEnabled() { return clusterCullingEnabled; }
+
+protected:
+
+	/**
+	 * @struct	Job
+	 *
+	 * @brief	The meshlets of one sub-mesh and what is needed to test them.
+	 */
+	struct Job {
+
+		const MeshletSet* meshlets = nullptr;
+
+		Frustum frustum; // In object coordinates
+
+		glm::vec3 eyePosition;
+
+		bool backFaceCulling = true;
+
+		std::vector<unsigned char> visible; // Result of the test of each meshlet
+
+		size_t firstCommand = 0;
+
+		size_t commandCount = 0;
+
+		GLuint indexCount = 0; // Indices of the visible meshlets
+
+	}; // end Job
+
+	/**
+	 * @struct	Task
+	 *
+	 * @brief	A range of the meshlets of a job that is tested by one thread.
+	 */
+	struct Task {
+
+		size_t job;
+
+		int first;
+
+		int count;
+
+	}; // end Task
+
+	/**
+	 * @fn	static void ClusterCuller::cullRange(Job& job, int first, int count);
+	 *
+	 * @brief	Tests a range of meshlets of a job. The first meshlet must be a multiple of four.
+	 */
+	static void cullRange(Job& job, int first, int count);
+
+	/**
+	 * @fn	void ClusterCuller::runTasks();
+	 *
+	 * @brief	Takes tasks until none are left. Run by the calling thread and the workers.
+	 */
+	void runTasks();
+
+	/**
+	 * @fn	void ClusterCuller::workerLoop();
+	 *
+	 * @brief	Waits for tasks and runs them until the culler is destroyed.
+	 */
+	void workerLoop();
+
+	std::vector<Job> jobs;
+
+	std::vector<DrawCommand> commands;
+
+	GLuint indirectBuffer = 0;
+
+	/** @brief	Capacity of the indirect draw buffer in commands */
+	size_t bufferCapacity = 0;
+
+	size_t testedCount = 0;
+
+	size_t visibleCount = 0;
+
+	/** @brief	Worker threads. Started by the first cull that has enough meshlets. */
+	std::vector<std::thread> workers;
+
+	std::vector<Task> tasks;
+
+	std::atomic<size_t> nextTask{ 0 };
+
+	std::atomic<size_t> remainingTasks{ 0 };
+
+	/** @brief	Guards the fields below and the start of the workers on a set of tasks */
+	std::mutex workerMutex;
+
+	std::condition_variable startCondition;
+
+	std::condition_variable doneCondition;
+
+	/** @brief	Incremented for each set of tasks so a worker runs each set once */
+	unsigned int generation = 0;
+
+	/** @brief	True while workers may join the current set of tasks */
+	bool tasksOpen = false;
+
+	int activeWorkers = 0;
+
+	bool stopping = false;
+
+	static bool clusterCullingEnabled;
+
+}; // end ClusterCuller class
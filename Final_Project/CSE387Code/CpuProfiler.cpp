@@ -0,0 +1,289 @@
+#include "CpuProfiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define VERBOSE false
+
+// Number of most recent events kept for each thread
+#define EVENTS_PER_THREAD 32768
+
+std::atomic<bool> CpuProfiler::enabled(true);
+
+namespace {
+
+	/**
+	 * @fn	long long getSteadyNanoseconds()
+	 *
+	 * @brief	Gets the time in nanoseconds of the steady clock.
+	 */
+	long long getSteadyNanoseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	} // end getSteadyNanoseconds
+
+	/** @brief	Ticks and steady clock time when the program started. Used to convert ticks to time. */
+	const long long startTicks = CpuProfiler::now();
+
+	const long long startNanoseconds = getSteadyNanoseconds();
+
+	/**
+	 * @struct	Event
+	 *
+	 * @brief	A scope that ended. The members are atomic so the exporter may read an event
+	 * 			while it is being overwritten. The exporter drops those events.
+	 */
+	struct Event {
+
+		std::atomic<const char*> name;
+
+		std::atomic<long long> start;
+
+		std::atomic<long long> duration;
+
+	}; // end Event
+
+	/**
+	 * @struct	ThreadEvents
+	 *
+	 * @brief	Ring of events written by one thread. Kept after the thread ends so its events
+	 * 			can still be exported.
+	 */
+	struct ThreadEvents {
+
+		Event events[EVENTS_PER_THREAD];
+
+		/** @brief	Number of events written. Published after the event is written. */
+		std::atomic<unsigned long long> count{ 0 };
+
+		int threadId = 0;
+
+		std::string threadName; // Guarded by the registry mutex
+
+	}; // end ThreadEvents
+
+	/** @brief	Guards the list of rings and the names of the threads */
+	std::mutex registryMutex;
+
+	std::vector<std::unique_ptr<ThreadEvents>> registry;
+
+	thread_local ThreadEvents* threadEvents = nullptr;
+
+	/**
+	 * @fn	ThreadEvents& getThreadEvents()
+	 *
+	 * @brief	Gets the ring of the calling thread. The ring is created the first time.
+	 */
+	ThreadEvents& getThreadEvents()
+	{
+		if (threadEvents == nullptr) {
+
+			std::lock_guard<std::mutex> lock(registryMutex);
+
+			registry.emplace_back(new ThreadEvents());
+
+			threadEvents = registry.back().get();
+			threadEvents->threadId = static_cast<int>(registry.size());
+		}
+
+		return *threadEvents;
+
+	} // end getThreadEvents
+
+	/**
+	 * @fn	void writeJsonString(std::ostream& stream, const char* text)
+	 *
+	 * @brief	Writes text as a quoted JSON string.
+	 */
+	void writeJsonString(std::ostream& stream, const char* text)
+	{
+		stream << '"';
+
+		for (const char* c = text; *c != '\0'; c++) {
+
+			if (*c == '"' || *c == '\\') {
+				stream << '\\' << *c;
+			}
+			else if (static_cast<unsigned char>(*c) < 0x20) {
+				stream << ' ';
+			}
+			else {
+				stream << *c;
+			}
+		}
+
+		stream << '"';
+
+	} // end writeJsonString
+
+	/**
+	 * @struct	ExportedEvent
+	 *
+	 * @brief	Copy of an event that was taken from a ring.
+	 */
+	struct ExportedEvent {
+
+		const char* name;
+
+		long long start;
+
+		long long duration;
+
+		int threadId;
+
+	}; // end ExportedEvent
+
+} // end namespace
+
+
+void CpuProfiler::record(const char* name, long long start, long long duration)
+{
+	ThreadEvents& ring = getThreadEvents();
+
+	// Only this thread writes the count
+	unsigned long long index = ring.count.load(std::memory_order_relaxed);
+
+	Event& event = ring.events[index % EVENTS_PER_THREAD];
+
+	event.name.store(name, std::memory_order_relaxed);
+	event.start.store(start, std::memory_order_relaxed);
+	event.duration.store(duration, std::memory_order_relaxed);
+
+	ring.count.store(index + 1, std::memory_order_release);
+
+} // end record
+
+
+void CpuProfiler::setThreadName(const std::string& name)
+{
+	ThreadEvents& ring = getThreadEvents();
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+
+	ring.threadName = name;
+
+} // end setThreadName
+
+
+bool CpuProfiler::exportChromeTrace(const std::string& fileName)
+{
+	std::vector<ExportedEvent> events;
+	std::vector<std::pair<int, std::string>> threadNames;
+
+	{
+		std::lock_guard<std::mutex> lock(registryMutex);
+
+		for (auto& ring : registry) {
+
+			threadNames.push_back({ ring->threadId, ring->threadName });
+
+			unsigned long long end = ring->count.load(std::memory_order_acquire);
+			unsigned long long begin = end > EVENTS_PER_THREAD ? end - EVENTS_PER_THREAD : 0;
+
+			size_t firstCopied = events.size();
+
+			for (unsigned long long index = begin; index < end; index++) {
+
+				const Event& event = ring->events[index % EVENTS_PER_THREAD];
+
+				ExportedEvent copy;
+
+				copy.name = event.name.load(std::memory_order_relaxed);
+				copy.start = event.start.load(std::memory_order_relaxed);
+				copy.duration = event.duration.load(std::memory_order_relaxed);
+				copy.threadId = ring->threadId;
+
+				events.push_back(copy);
+			}
+
+			// Events the thread wrote over while they were copied are dropped
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			unsigned long long written = ring->count.load(std::memory_order_relaxed);
+
+			if (written >= EVENTS_PER_THREAD) {
+
+				unsigned long long firstValid = written - EVENTS_PER_THREAD + 1;
+
+				if (firstValid > begin) {
+
+					size_t dropped = static_cast<size_t>(std::min(firstValid - begin, end - begin));
+
+					events.erase(events.begin() + firstCopied, events.begin() + firstCopied + dropped);
+				}
+			}
+		}
+	}
+
+	std::ofstream file(fileName, std::ios::trunc);
+
+	if (file.is_open() == false) {
+
+		std::cerr << "Unable to write the CPU trace to " << fileName << std::endl;
+		return false;
+	}
+
+	// Ticks per microsecond measured since the program started
+	double ticksPerMicrosecond = 1.0e3;
+
+	if (CPU_PROFILE_TSC) {
+
+		long long elapsedNanoseconds = getSteadyNanoseconds() - startNanoseconds;
+
+		if (elapsedNanoseconds > 0) {
+
+			ticksPerMicrosecond = (CpuProfiler::now() - startTicks) * 1.0e3 / elapsedNanoseconds;
+		}
+	}
+
+	// Times are written in microseconds from the first event
+	long long origin = 0;
+
+	if (events.empty() == false) {
+
+		origin = std::min_element(events.begin(), events.end(),
+			[](const ExportedEvent& a, const ExportedEvent& b) { return a.start < b.start; })->start;
+	}
+
+	file << "{\"traceEvents\":[" << std::endl;
+
+	bool first = true;
+
+	for (auto& name : threadNames) {
+
+		if (name.second.empty()) {
+			continue;
+		}
+
+		file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << name.first << ",\"args\":{\"name\":";
+		writeJsonString(file, name.second.c_str());
+		file << "}}";
+
+		first = false;
+	}
+
+	file << std::fixed << std::setprecision(3);
+
+	for (auto& event : events) {
+
+		file << (first ? "" : ",\n") << "{\"name\":";
+		writeJsonString(file, event.name);
+		file << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId
+			<< ",\"ts\":" << (event.start - origin) / ticksPerMicrosecond << ",\"dur\":" << event.duration / ticksPerMicrosecond << "}";
+
+		first = false;
+	}
+
+	file << std::endl << "]}" << std::endl;
+
+	if (VERBOSE) std::cout << "Wrote " << events.size() << " CPU events to " << fileName << std::endl;
+
+	return file.good();
+
+} // end exportChromeTrace
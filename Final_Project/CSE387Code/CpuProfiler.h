@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// The time stamp counter is much cheaper to read than the steady clock
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define CPU_PROFILE_TSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define CPU_PROFILE_TSC 1
+#else
+#define CPU_PROFILE_TSC 0
+#endif
+
+// Set to 0 to compile the scopes out entirely
+#ifndef CPU_PROFILING
+#define CPU_PROFILING 1
+#endif
+
+#define CPU_PROFILE_CONCATENATE_(a, b) a##b
+#define CPU_PROFILE_CONCATENATE(a, b) CPU_PROFILE_CONCATENATE_(a, b)
+
+#if CPU_PROFILING
+
+// Times the rest of the enclosing block. The name must be a string literal or otherwise
+// outlive the profiler since only the pointer is recorded.
+#define CPU_PROFILE_SCOPE(name) CpuProfiler::Scope CPU_PROFILE_CONCATENATE(cpuProfileScope, __LINE__)(name)
+
+// Times the rest of the enclosing function under the name of the function.
+#define CPU_PROFILE_FUNCTION() CPU_PROFILE_SCOPE(__FUNCTION__)
+
+#else
+
+#define CPU_PROFILE_SCOPE(name)
+#define CPU_PROFILE_FUNCTION()
+
+#endif
+
+/**
+ * @class	CpuProfiler
+ *
+ * @brief	Records when scopes of the engine begin and how long they take on each thread so
+ * 			they can be viewed as a Chrome trace (chrome://tracing or https://ui.perfetto.dev).
+ *
+ * 			Every thread records into its own ring of events, so recording a scope takes no
+ * 			locks. Only the thread writes to its ring. Each event is published by advancing
+ * 			an atomic count, and the exporter drops any events that were overwritten while it
+ * 			copied them. The ring keeps the most recent events of each thread. A scope costs
+ * 			two reads of the time stamp counter and one write into the ring. Ticks are
+ * 			converted to time when the trace is exported by comparing the counter to the
+ * 			steady clock, which assumes the invariant counter of current processors.
+ *
+ * 			Scopes are recorded when they end, so scopes that are still open when the trace is
+ * 			exported are left out.
+ */
+class CpuProfiler
+{
+public:
+
+	/**
+	 * @class	Scope
+	 *
+	 * @brief	Records an event from its construction to its destruction. Use CPU_PROFILE_SCOPE.
+	 */
+	class Scope
+	{
+	public:
+
+		explicit Scope(const char* name) : name(name), start(enabled.load(std::memory_order_relaxed) ? now() : -1) {}
+
+		~Scope()
+		{
+			if (start >= 0) {
+				record(name, start, now() - start);
+			}
+		}
+
+		Scope(const Scope&) = delete;
+
+		Scope& operator=(const Scope&) = delete;
+
+	protected:
+
+		const char* name;
+
+		long long start; // Ticks. Negative if the profiler was off when the scope began.
+
+	}; // end Scope
+
+	/**
+	 * @fn	static void CpuProfiler::setEnabled(bool enabled)
+	 *
+	 * @brief	Turns recording on or off. Scopes cost a load of a flag while it is off.
+	 */
+	static void setEnabled(bool enabled) { CpuProfiler::enabled.store(enabled, std::memory_order_relaxed); }
+
+	static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+	/**
+	 * @fn	static void CpuProfiler::setThreadName(const std::string& name);
+	 *
+	 * @brief	Names the calling thread in the trace.
+	 */
+	static void setThreadName(const std::string& name);
+
+	/**
+	 * @fn	static bool CpuProfiler::exportChromeTrace(const std::string& fileName);
+	 *
+	 * @brief	Writes the events that are held by the rings of all threads to a file in the
+	 * 			JSON format of Chrome traces. May be called from any thread while the others
+	 * 			keep recording.
+	 *
+	 * @returns	False if the file could not be written.
+	 */
+	static bool exportChromeTrace(const std::string& fileName);
+
+	/**
+	 * @fn	static void CpuProfiler::record(const char* name, long long start, long long duration);
+	 *
+	 * @brief	Adds an event to the ring of the calling thread.
+	 *
+	 * @param	name		Name of the event. Only the pointer is kept.
+	 * @param	start   	Start in ticks as returned by now.
+	 * @param	duration	Duration in ticks.
+	 */
+	static void record(const char* name, long long start, long long duration);
+
+	/**
+	 * @fn	static long long CpuProfiler::now()
+	 *
+	 * @brief	Gets the time in ticks of the time stamp counter, or in nanoseconds of the
+	 * 			steady clock on processors without one.
+	 */
+	static long long now()
+	{
+#if CPU_PROFILE_TSC
+		return static_cast<long long>(__rdtsc());
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+protected:
+
+	static std::atomic<bool> enabled;
+
+}; // end CpuProfiler class
@@ -0,0 +1,380 @@
+#include "DeferredRenderer.h"
+#include "EngineCounters.h"
+#include "GLStateCache.h"
+#include "BuildShaderProgram.h"
+#include "ShaderVariants.h"
+#include "SharedProjectionAndViewing.h"
+#include "SharedMaterialProperties.h"
+#include "RenderSnapshot.h"
+
+#include <cmath>
+
+#define VERBOSE false
+
+// Texture unit of the first G-buffer texture. Units below it are used by materials and occlusion culling.
+#define gBufferTextureUnit 5
+
+// Number of color textures in the G-buffer
+#define gBufferColorCount 5
+
+// Uniform locations in deferredShading.vs.glsl and deferredShading.fs.glsl
+#define volumeMatrixLocation 0
+#define fullScreenLocation 1
+#define inverseViewProjectionLocation 2
+#define viewportLocation 3
+#define lightIndexLocation 4
+#define lightRangeLocation 5
+#define fogEnabledLocation 6
+#define firstBufferSamplerLocation 10
+
+// Segments around the light volumes
+#define VOLUME_SLICES 16
+#define VOLUME_STACKS 8
+
+// Spotlights with a wider cone than this are covered by a sphere
+#define MIN_CONE_COS 0.5f
+
+
+bool DeferredRenderer::initialize()
+{
+	ShaderInfo geometryShaders[] = {
+		{ GL_VERTEX_SHADER, "Shaders/vertexShader.vs.glsl" },
+		{ GL_FRAGMENT_SHADER, "Shaders/gBuffer.fs.glsl" },
+		{ GL_NONE, NULL } // signals that there are no more shaders
+	};
+
+	ShaderInfo shadingShaders[] = {
+		{ GL_VERTEX_SHADER, "Shaders/deferredShading.vs.glsl" },
+		{ GL_FRAGMENT_SHADER, "Shaders/deferredShading.fs.glsl" },
+		{ GL_NONE, NULL } // signals that there are no more shaders
+	};
+
+	std::vector<GLuint> programs = BuildShaderPrograms({ geometryShaders, shadingShaders });
+
+	geometryProgram = programs[0];
+	shadingProgram = programs[1];
+
+	if (geometryProgram == 0 || shadingProgram == 0) {
+
+		std::cerr << "Deferred shading programs failed to build." << std::endl;
+
+		destroy();
+		return false;
+	}
+
+	SharedProjectionAndViewing::setUniformBlockForShader(geometryProgram);
+	SharedMaterialProperties::setUniformBlockForShader(geometryProgram);
+
+	// Meshes are rendered with the variant of the program for their material
+	ShaderVariants::registerShaders(geometryProgram, geometryShaders);
+
+	SharedProjectionAndViewing::setUniformBlockForShader(shadingProgram);
+	SharedGeneralLighting::setUniformBlockForShader(shadingProgram);
+
+	// Each G-buffer texture has its own unit
+	for (int i = 0; i <= gBufferColorCount; i++) {
+
+		glProgramUniform1i(shadingProgram, firstBufferSamplerLocation + i, gBufferTextureUnit + i);
+	}
+
+	// Sphere of stacks from pole to pole. Vertices are pushed out so the faces enclose the unit sphere.
+	float sphereScale = 1.0f / (std::cos(PI / VOLUME_SLICES) * std::cos(PI / (2 * VOLUME_STACKS)));
+
+	auto spherePoint = [sphereScale](int stack, int slice) {
+
+		float phi = PI * stack / VOLUME_STACKS;
+		float theta = 2.0f * PI * slice / VOLUME_SLICES;
+
+		return sphereScale * glm::vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+	};
+
+	std::vector<glm::vec3> triangles;
+
+	for (int stack = 0; stack < VOLUME_STACKS; stack++) {
+
+		for (int slice = 0; slice < VOLUME_SLICES; slice++) {
+
+			glm::vec3 a = spherePoint(stack, slice);
+			glm::vec3 b = spherePoint(stack + 1, slice);
+			glm::vec3 c = spherePoint(stack + 1, slice + 1);
+			glm::vec3 d = spherePoint(stack, slice + 1);
+
+			triangles.insert(triangles.end(), { a, c, b, a, d, c });
+		}
+	}
+
+	createVolume(sphereVolume, triangles);
+
+	// Cone with a base that encloses the unit circle at z = -1
+	float coneScale = 1.0f / std::cos(PI / VOLUME_SLICES);
+
+	auto conePoint = [coneScale](int slice) {
+
+		float theta = 2.0f * PI * slice / VOLUME_SLICES;
+
+		return glm::vec3(coneScale * std::cos(theta), coneScale * std::sin(theta), -1.0f);
+	};
+
+	triangles.clear();
+
+	for (int slice = 0; slice < VOLUME_SLICES; slice++) {
+
+		triangles.insert(triangles.end(), { ZERO_V3, conePoint(slice), conePoint(slice + 1) });
+		triangles.insert(triangles.end(), { glm::vec3(0.0f, 0.0f, -1.0f), conePoint(slice + 1), conePoint(slice) });
+	}
+
+	createVolume(coneVolume, triangles);
+
+	glGenVertexArrays(1, &emptyVao);
+
+	return true;
+
+} // end initialize
+
+
+void DeferredRenderer::destroy()
+{
+	// Nothing was created, possibly because there is no OpenGL context
+	if (geometryProgram == 0 && shadingProgram == 0) {
+		return;
+	}
+
+	deleteVolume(sphereVolume);
+	deleteVolume(coneVolume);
+
+	if (emptyVao != 0) {
+		GLStateCache::deleteVertexArrays(1, &emptyVao);
+	}
+
+	// Programs are deleted with the other shader programs
+	geometryProgram = 0;
+	shadingProgram = 0;
+	framebuffer = 0;
+	colorTextures.clear();
+	depthTexture = 0;
+	emptyVao = 0;
+
+} // end destroy
+
+
+void DeferredRenderer::setGBuffer(GLuint framebuffer, const std::vector<GLuint>& colorTextures, GLuint depthTexture)
+{
+	this->framebuffer = framebuffer;
+	this->colorTextures = colorTextures;
+	this->depthTexture = depthTexture;
+
+} // end setGBuffer
+
+
+int DeferredRenderer::getColorTextureCount()
+{
+	return gBufferColorCount;
+
+} // end getColorTextureCount
+
+
+GLenum DeferredRenderer::getColorFormat()
+{
+	// Colors are kept in floating point so they can be brighter than one like in the forward shader
+	return GL_RGBA16F;
+
+} // end getColorFormat
+
+
+GLenum DeferredRenderer::getDepthFormat()
+{
+	return GL_DEPTH_COMPONENT32F;
+
+} // end getDepthFormat
+
+
+void DeferredRenderer::beginGeometry(const GLint viewport[4])
+{
+	sceneFramebuffer = GLStateCache::getFramebuffer(GL_DRAW_FRAMEBUFFER);
+
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+	// Colors of pixels without depth are never read
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(viewport[0], viewport[1], viewport[2], viewport[3]);
+	glClear(GL_DEPTH_BUFFER_BIT);
+	glDisable(GL_SCISSOR_TEST);
+
+} // end beginGeometry
+
+
+int DeferredRenderer::shadeLights(const CameraView& view, const GLint viewport[4], const GeneralLight* lights)
+{
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer);
+
+	for (int i = 0; i < gBufferColorCount; i++) {
+
+		GLStateCache::activeTexture(GL_TEXTURE0 + gBufferTextureUnit + i);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, colorTextures[i]);
+	}
+
+	GLStateCache::activeTexture(GL_TEXTURE0 + gBufferTextureUnit + gBufferColorCount);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, depthTexture);
+
+	GLStateCache::useProgram(shadingProgram);
+	GLStateCache::bindVertexArray(emptyVao);
+
+	glm::mat4 inverseViewProjection = glm::inverse(view.projectionMatrix * view.viewMatrix);
+
+	glUniformMatrix4fv(inverseViewProjectionLocation, 1, GL_FALSE, glm::value_ptr(inverseViewProjection));
+	glUniform4i(viewportLocation, viewport[0], viewport[1], viewport[2], viewport[3]);
+	glUniform1i(fogEnabledLocation, ShaderVariants::getFogEnabled());
+
+	// Emissive color, fog and the depth of the scene replace what is in the viewport
+	glDepthFunc(GL_ALWAYS);
+	glUniform1i(fullScreenLocation, GL_TRUE);
+	glUniform1i(lightIndexLocation, -1);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	EngineCounters::addDraw(GL_TRIANGLES, 3);
+	glDepthFunc(GL_LESS);
+
+	// Lights are added. Surfaces are found in the G-buffer rather than by depth testing the volumes.
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE);
+
+	// Back faces of the volumes are rendered so the volumes still cover the pixels when the
+	// camera is inside them. Clamping keeps the parts beyond the far plane.
+	glEnable(GL_DEPTH_CLAMP);
+
+	int lightPasses = 0;
+
+	for (int i = 0; i < MAX_LIGHTS; i++) {
+
+		const GeneralLight& light = lights[i];
+
+		// Spotlights with a cutoff cosine above one light nothing
+		if (light.enabled == 0 || (light.isSpot != 0 && light.spotCutoffCos > 1.0f)) {
+			continue;
+		}
+
+		glm::vec3 position = glm::vec3(light.positionOrDirection);
+
+		float range = getLightRange(light);
+
+		// Too dim to be seen
+		if (range == 0.0f) {
+			continue;
+		}
+
+		glUniform1i(lightIndexLocation, i);
+		glUniform1f(lightRangeLocation, range);
+
+		if (light.positionOrDirection.w < 1.0f || range < 0.0f) {
+
+			glCullFace(GL_BACK);
+			glUniform1i(fullScreenLocation, GL_TRUE);
+			GLStateCache::bindVertexArray(emptyVao);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+			EngineCounters::addDraw(GL_TRIANGLES, 3);
+		}
+		else {
+
+			glm::mat4 volumeMatrix;
+			const LightVolume* volume = &sphereVolume;
+
+			if (light.isSpot != 0 && light.spotCutoffCos > MIN_CONE_COS) {
+
+				// Points within the range of the apex are within the height of the cone
+				float baseRadius = range * std::sqrt(1.0f - light.spotCutoffCos * light.spotCutoffCos) / light.spotCutoffCos;
+
+				glm::vec3 zAxis = -glm::normalize(light.spotDirection);
+				glm::vec3 helper = std::fabs(zAxis.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+				glm::vec3 xAxis = glm::normalize(glm::cross(helper, zAxis));
+				glm::vec3 yAxis = glm::cross(zAxis, xAxis);
+
+				volumeMatrix = glm::mat4(glm::vec4(xAxis * baseRadius, 0.0f), glm::vec4(yAxis * baseRadius, 0.0f),
+										 glm::vec4(zAxis * range, 0.0f), glm::vec4(position, 1.0f));
+
+				volume = &coneVolume;
+			}
+			else {
+
+				volumeMatrix = glm::translate(position) * glm::scale(glm::vec3(range));
+			}
+
+			glCullFace(GL_FRONT);
+			glUniform1i(fullScreenLocation, GL_FALSE);
+			glUniformMatrix4fv(volumeMatrixLocation, 1, GL_FALSE, glm::value_ptr(volumeMatrix));
+			GLStateCache::bindVertexArray(volume->vao);
+			glDrawArrays(GL_TRIANGLES, 0, volume->count);
+			EngineCounters::addDraw(GL_TRIANGLES, volume->count);
+		}
+
+		lightPasses++;
+	}
+
+	glDisable(GL_DEPTH_CLAMP);
+	glCullFace(GL_BACK);
+	glDisable(GL_BLEND);
+	glEnable(GL_DEPTH_TEST);
+	GLStateCache::bindVertexArray(0);
+	GLStateCache::activeTexture(GL_TEXTURE0);
+
+	return lightPasses;
+
+} // end shadeLights
+
+
+float DeferredRenderer::getLightRange(const GeneralLight& light)
+{
+	if (light.positionOrDirection.w < 1.0f || (light.linear <= 0.0f && light.quadratic <= 0.0f)) {
+		return -1.0f;
+	}
+
+	// Brightest color the light can add to a surface
+	glm::vec3 color = glm::vec3(light.ambientColor) + glm::vec3(light.diffuseColor) + glm::vec3(light.specularColor);
+	float brightness = std::max(color.r, std::max(color.g, color.b));
+
+	// Attenuation at which the light adds less than 1/256
+	float limit = brightness * 256.0f;
+
+	if (light.constant >= limit) {
+		return 0.0f;
+	}
+
+	if (light.quadratic > 0.0f) {
+
+		return (-light.linear + std::sqrt(light.linear * light.linear + 4.0f * light.quadratic * (limit - light.constant))) / (2.0f * light.quadratic);
+	}
+
+	return (limit - light.constant) / light.linear;
+
+} // end getLightRange
+
+
+void DeferredRenderer::createVolume(LightVolume& volume, const std::vector<glm::vec3>& triangles)
+{
+	glGenVertexArrays(1, &volume.vao);
+	GLStateCache::bindVertexArray(volume.vao);
+
+	glGenBuffers(1, &volume.vertexBuffer);
+	GLStateCache::bindBuffer(GL_ARRAY_BUFFER, volume.vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, triangles.size() * sizeof(glm::vec3), &triangles[0], GL_STATIC_DRAW);
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), 0);
+	glEnableVertexAttribArray(0);
+
+	GLStateCache::bindVertexArray(0);
+
+	volume.count = static_cast<GLsizei>(triangles.size());
+
+} // end createVolume
+
+
+void DeferredRenderer::deleteVolume(LightVolume& volume)
+{
+	if (volume.vao != 0) {
+
+		GLStateCache::deleteVertexArrays(1, &volume.vao);
+		GLStateCache::deleteBuffers(1, &volume.vertexBuffer);
+	}
+
+	volume = LightVolume();
+
+} // end deleteVolume
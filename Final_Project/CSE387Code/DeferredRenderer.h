@@ -0,0 +1,168 @@
+#pragma once
+
+#include <vector>
+
+#include "MathLibsConstsFuncs.h"
+#include "SharedGeneralLighting.h"
+
+struct CameraView;
+
+/**
+ * @class	DeferredRenderer
+ *
+ * @brief	Alternative to shading every fragment with every light. Meshes are rendered into
+ * 			a G-buffer that holds the emissive, ambient, diffuse and specular colors, the
+ * 			specular exponent, the normal and the depth of the nearest surface of each pixel.
+ * 			The lights are then added into the framebuffer the scene is rendered into, one
+ * 			pass per light. Directional lights and lights without a range cover the whole
+ * 			view. Positional lights with a range cover a sphere and spotlights with a narrow
+ * 			cone cover a cone, so only the pixels they can reach are shaded.
+ *
+ * 			The shading matches fragmentShader.fs.glsl. The range of a light is the distance
+ * 			at which its attenuation leaves less than one step of an 8-bit color.
+ */
+class DeferredRenderer
+{
+public:
+
+	/**
+	 * @fn	DeferredRenderer::~DeferredRenderer()
+	 *
+	 * @brief	Destructor. Deletes the light volumes.
+	 */
+	~DeferredRenderer() { destroy(); }
+
+	/**
+	 * @fn	bool DeferredRenderer::initialize();
+	 *
+	 * @brief	Builds the programs and the light volumes. The program that writes the G-buffer
+	 * 			is registered with ShaderVariants. Call after the shared uniform blocks are set
+	 * 			up.
+	 *
+	 * @returns	False if a program failed to build.
+	 */
+	bool initialize();
+
+	/**
+	 * @fn	void DeferredRenderer::destroy();
+	 *
+	 * @brief	Deletes everything that was created.
+	 */
+	void destroy();
+
+	/**
+	 * @fn	void DeferredRenderer::setGBuffer(GLuint framebuffer, const std::vector<GLuint>& colorTextures, GLuint depthTexture);
+	 *
+	 * @brief	Sets the G-buffer the meshes of the next views are rendered into. The textures
+	 * 			are owned by the caller and must have the formats given by getColorFormat and
+	 * 			getDepthFormat and the size of the framebuffer the scene is rendered into.
+	 *
+	 * @param	framebuffer  	Framebuffer with the color textures attached in order and the
+	 * 							depth texture.
+	 * @param	colorTextures	The getColorTextureCount color textures.
+	 * @param	depthTexture 	The depth texture.
+	 */
+	void setGBuffer(GLuint framebuffer, const std::vector<GLuint>& colorTextures, GLuint depthTexture);
+
+	/** @brief	Number, and format of the color textures of the G-buffer */
+	static int getColorTextureCount();
+	static GLenum getColorFormat();
+
+	/** @brief	Format of the depth texture of the G-buffer */
+	static GLenum getDepthFormat();
+
+	/**
+	 * @fn	void DeferredRenderer::beginGeometry(const GLint viewport[4]);
+	 *
+	 * @brief	Binds the G-buffer for the meshes of a view and clears the depth of the
+	 * 			viewport. The framebuffer that was bound is restored by shadeLights.
+	 */
+	void beginGeometry(const GLint viewport[4]);
+
+	/**
+	 * @fn	void DeferredRenderer::shadeLights(const CameraView& view, const GLint viewport[4], const GeneralLight* lights);
+	 *
+	 * @brief	Rebinds the framebuffer that was bound by beginGeometry and writes the emissive
+	 * 			color, fog and depth of the view into it. Then adds each light that is on.
+	 *
+	 * @param	view		The view of the camera being rendered.
+	 * @param	viewport	The viewport of the view in pixels.
+	 * @param	lights  	All lights.
+	 *
+	 * @returns	The number of light passes.
+	 */
+	int shadeLights(const CameraView& view, const GLint viewport[4], const GeneralLight* lights);
+
+	/**
+	 * @fn	static float DeferredRenderer::getLightRange(const GeneralLight& light);
+	 *
+	 * @brief	Gets the distance beyond which the attenuated light is too dim to change an
+	 * 			8-bit color.
+	 *
+	 * @returns	Negative if the light is not attenuated.
+	 */
+	static float getLightRange(const GeneralLight& light);
+
+	bool isInitialized() const { return shadingProgram != 0; }
+
+	/**
+	 * @fn	GLuint DeferredRenderer::getGeometryProgram() const
+	 *
+	 * @brief	Gets the base program that writes the G-buffer. Meshes are rendered with its
+	 * 			variants instead of their own shader programs.
+	 */
+	GLuint getGeometryProgram() const { return geometryProgram; }
+
+protected:
+
+	/**
+	 * @struct	LightVolume
+	 *
+	 * @brief	Closed mesh that encloses the unit sphere or the unit cone.
+	 */
+	struct LightVolume {
+
+		GLuint vao = 0;
+
+		GLuint vertexBuffer = 0;
+
+		GLsizei count = 0;
+
+	}; // end LightVolume
+
+	/**
+	 * @fn	static void DeferredRenderer::createVolume(LightVolume& volume, const std::vector<glm::vec3>& triangles);
+	 *
+	 * @brief	Loads the vertices of a triangle list into a light volume.
+	 */
+	static void createVolume(LightVolume& volume, const std::vector<glm::vec3>& triangles);
+
+	/**
+	 * @fn	static void DeferredRenderer::deleteVolume(LightVolume& volume);
+	 *
+	 * @brief	Deletes the buffers of a light volume.
+	 */
+	static void deleteVolume(LightVolume& volume);
+
+	/** @brief	Program that writes the G-buffer */
+	GLuint geometryProgram = 0;
+
+	/** @brief	Program that writes the emissive color and adds the lights */
+	GLuint shadingProgram = 0;
+
+	/** @brief	G-buffer and its attachments. Owned by the caller of setGBuffer. */
+	GLuint framebuffer = 0;
+	std::vector<GLuint> colorTextures;
+	GLuint depthTexture = 0;
+
+	/** @brief	Framebuffer the scene is rendered into */
+	GLuint sceneFramebuffer = 0;
+
+	/** @brief	Unit sphere, cone pointing down the negative z axis with its apex at the origin */
+	LightVolume sphereVolume;
+	LightVolume coneVolume;
+
+	/** @brief	Vertex array object without attributes for full screen passes */
+	GLuint emptyVao = 0;
+
+}; // end DeferredRenderer class
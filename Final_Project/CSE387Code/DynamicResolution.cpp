@@ -0,0 +1,135 @@
+#include "DynamicResolution.h"
+
+#include <cmath>
+
+#define VERBOSE false
+
+// Fraction of the target time the GPU time must stay under before the scale rises
+#define RAISE_THRESHOLD 0.8
+
+// Weight of the newest frame in the smoothed GPU time
+#define SMOOTHING 0.2
+
+
+void DynamicResolution::beginFrame()
+{
+	if (slots[0].query == 0) {
+
+		for (auto& slot : slots) {
+			glGenQueries(1, &slot.query);
+		}
+	}
+
+	// Read finished queries oldest first without waiting
+	for (size_t i = 0; i < slots.size(); i++) {
+
+		TimerSlot& slot = slots[(nextSlot + i) % slots.size()];
+
+		if (slot.pending == false) {
+			continue;
+		}
+
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(slot.query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (available == GL_FALSE) {
+			break;
+		}
+
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(slot.query, GL_QUERY_RESULT, &nanoseconds);
+
+		slot.pending = false;
+
+		updateScale(nanoseconds * 1.0e-9);
+	}
+
+	// The frame is not timed if every query is still waiting for its result
+	timing = slots[nextSlot].pending == false;
+
+	if (timing == true) {
+
+		glBeginQuery(GL_TIME_ELAPSED, slots[nextSlot].query);
+	}
+
+} // end beginFrame
+
+
+void DynamicResolution::endFrame()
+{
+	if (timing == false) {
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+
+	slots[nextSlot].pending = true;
+	nextSlot = (nextSlot + 1) % slots.size();
+	timing = false;
+
+} // end endFrame
+
+
+void DynamicResolution::clear()
+{
+	for (auto& slot : slots) {
+
+		if (slot.query != 0) {
+
+			glDeleteQueries(1, &slot.query);
+			slot.query = 0;
+		}
+
+		slot.pending = false;
+	}
+
+	nextSlot = 0;
+	timing = false;
+
+} // end clear
+
+
+void DynamicResolution::setScaleBounds(float minimum, float maximum)
+{
+	maxScale = glm::clamp(maximum, scaleStep, 1.0f);
+	minScale = glm::clamp(minimum, scaleStep, maxScale);
+	scale = glm::clamp(scale, minScale, maxScale);
+
+} // end setScaleBounds
+
+
+void DynamicResolution::updateScale(double frameGpuTime)
+{
+	gpuTime = gpuTime < 0.0 ? frameGpuTime : gpuTime + SMOOTHING * (frameGpuTime - gpuTime);
+
+	// Frames in flight were rendered before the last change
+	if (holdFrames > 0) {
+
+		holdFrames--;
+		return;
+	}
+
+	float newScale = scale;
+
+	if (gpuTime > targetGpuTime) {
+
+		// Drop straight to the scale expected to meet the target, rounded down to a step
+		float expected = scale * static_cast<float>(std::sqrt(targetGpuTime / gpuTime));
+		newScale = std::floor(expected / scaleStep) * scaleStep;
+	}
+	else if (gpuTime < targetGpuTime * RAISE_THRESHOLD) {
+
+		newScale = scale + scaleStep;
+	}
+
+	newScale = glm::clamp(newScale, minScale, maxScale);
+
+	if (newScale != scale) {
+
+		if (VERBOSE) cout << "Resolution scale " << scale << " -> " << newScale << " at " << gpuTime * 1000.0 << " ms" << endl;
+
+		scale = newScale;
+		holdFrames = static_cast<int>(slots.size());
+	}
+
+} // end updateScale
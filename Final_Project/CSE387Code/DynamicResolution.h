@@ -0,0 +1,139 @@
+#pragma once
+
+#include <vector>
+
+#include "MathLibsConstsFuncs.h"
+
+/**
+ * @class	DynamicResolution
+ *
+ * @brief	Chooses the fraction of the output resolution the scene is rendered at from the
+ * 			time the GPU takes to render it. The time is measured with timer queries whose
+ * 			results are read a few frames later so the CPU never waits for them. When the GPU
+ * 			is over budget the scale drops right away. When it is well under budget the scale
+ * 			rises one step at a time. After a change the scale is held until the frames
+ * 			rendered at the old scale have been measured.
+ *
+ * 			The scale applies to both the width and the height so the GPU time of pixel bound
+ * 			frames is roughly proportional to its square.
+ *
+ * 			beginFrame and endFrame must be called on the thread that owns the OpenGL context.
+ */
+class DynamicResolution
+{
+public:
+
+	/**
+	 * @fn	DynamicResolution::~DynamicResolution()
+	 *
+	 * @brief	Destructor. Deletes the queries.
+	 */
+	~DynamicResolution() { clear(); }
+
+	/**
+	 * @fn	void DynamicResolution::beginFrame();
+	 *
+	 * @brief	Reads the results of finished queries, updates the scale, and starts timing the
+	 * 			frame. Call after the scale for the frame has been read with getScale.
+	 */
+	void beginFrame();
+
+	/**
+	 * @fn	void DynamicResolution::endFrame();
+	 *
+	 * @brief	Stops timing the frame.
+	 */
+	void endFrame();
+
+	/**
+	 * @fn	void DynamicResolution::clear();
+	 *
+	 * @brief	Deletes the queries. Results that were not read are dropped.
+	 */
+	void clear();
+
+	void setEnabled(bool enabled) { this->enabled = enabled; }
+
+	bool isEnabled() const { return enabled; }
+
+	/**
+	 * @fn	float DynamicResolution::getScale() const
+	 *
+	 * @brief	Gets the fraction of the output width and height to render the scene at.
+	 */
+	float getScale() const { return scale; }
+
+	/**
+	 * @fn	void DynamicResolution::setScaleBounds(float minimum, float maximum);
+	 *
+	 * @brief	Sets the smallest and largest scales. The render target of the scene is sized
+	 * 			for the largest scale.
+	 */
+	void setScaleBounds(float minimum, float maximum);
+
+	float getMaxScale() const { return maxScale; }
+
+	/**
+	 * @fn	void DynamicResolution::setTargetGpuTime(double seconds)
+	 *
+	 * @brief	Sets the GPU time per frame the scale is adjusted to stay under.
+	 */
+	void setTargetGpuTime(double seconds) { targetGpuTime = seconds; }
+
+	/**
+	 * @fn	double DynamicResolution::getGpuTime() const
+	 *
+	 * @brief	Gets the smoothed GPU time in seconds of recently measured frames.
+	 */
+	double getGpuTime() const { return gpuTime; }
+
+protected:
+
+	/**
+	 * @fn	void DynamicResolution::updateScale(double frameGpuTime);
+	 *
+	 * @brief	Adds the GPU time of a frame to the smoothed time and adjusts the scale.
+	 */
+	void updateScale(double frameGpuTime);
+
+	/**
+	 * @struct	TimerSlot
+	 *
+	 * @brief	Query of the ring and whether a result is waiting to be read from it.
+	 */
+	struct TimerSlot {
+
+		GLuint query = 0;
+
+		bool pending = false;
+
+	}; // end TimerSlot
+
+	std::vector<TimerSlot> slots = std::vector<TimerSlot>(4);
+
+	/** @brief	Slot the next frame is timed with. Slots are used and read in order. */
+	size_t nextSlot = 0;
+
+	/** @brief	True while a query is running for the current frame */
+	bool timing = false;
+
+	bool enabled = true;
+
+	float scale = 1.0f;
+
+	float minScale = 0.5f;
+
+	float maxScale = 1.0f;
+
+	/** @brief	Amount the scale is changed by and rounded to */
+	float scaleStep = 0.05f;
+
+	double targetGpuTime = 1.0 / 60.0;
+
+	/** @brief	Smoothed GPU time. Negative until the first frame is measured. */
+	double gpuTime = -1.0;
+
+	/** @brief	Number of measured frames to wait before the scale may change again */
+	int holdFrames = 0;
+
+}; // end DynamicResolution class
@@ -0,0 +1,29 @@
+#include "EngineCounters.h"
+
+#define VERBOSE false
+
+// Zero initialized like all static storage
+std::atomic<unsigned long long> EngineCounters::counters[COUNTER_COUNT];
+
+std::atomic<unsigned long long> EngineCounters::gauges[GAUGE_COUNT];
+
+
+unsigned long long EngineCounters::getTriangleCount(GLenum primitiveMode, unsigned long long vertexCount)
+{
+	switch (primitiveMode) {
+
+	case GL_TRIANGLES:
+
+		return vertexCount / 3;
+
+	case GL_TRIANGLE_STRIP:
+	case GL_TRIANGLE_FAN:
+
+		return vertexCount > 2 ? vertexCount - 2 : 0;
+
+	default:
+
+		return 0;
+	}
+
+} // end getTriangleCount
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+#include "MathLibsConstsFuncs.h"
+
+/**
+ * @class	EngineCounters
+ *
+ * @brief	Counters of the work done by the engine that are always on. Counters are added to
+ * 			with relaxed atomic increments from any thread and taken, which resets them, by
+ * 			whoever reports them, normally the StatsOverlay once per rendered frame. Gauges
+ * 			hold the last value that was measured, such as the number of rigid bodies, and
+ * 			are not reset when read.
+ *
+ * 			Counting is cheap enough to leave in draw calls and uniform block uploads.
+ */
+class EngineCounters
+{
+public:
+
+	enum Counter {
+
+		DRAW_CALLS,			// Draw calls issued by the engine, including multi-draws
+		TRIANGLES,			// Triangles submitted by those draw calls
+		UNIFORM_BYTES,		// Bytes copied into uniform blocks
+		MATERIAL_UPLOADS,	// Materials set in the material uniform block
+		GAME_OBJECT_UPDATES,// Active game objects updated so far by the current update of the scene graph
+		PHYSICS_STEPS,		// Fixed steps taken by the physics simulation
+		UPDATE_TIME,		// Nanoseconds spent updating the game
+		PHYSICS_TIME,		// Nanoseconds of the update spent in the physics engine
+		RENDER_TIME,		// Nanoseconds spent rendering frames on the CPU
+		COUNTER_COUNT
+
+	}; // end Counter
+
+	enum Gauge {
+
+		ACTIVE_GAME_OBJECTS,	// Game objects updated by the last update of the scene graph
+		RIGID_BODIES,			// Collision objects in the dynamics world
+		PLAYING_CHANNELS,		// Sound channels FMOD is playing
+		GAUGE_COUNT
+
+	}; // end Gauge
+
+	/**
+	 * @class	Timer
+	 *
+	 * @brief	Adds the nanoseconds between its construction and destruction to a counter.
+	 */
+	class Timer
+	{
+	public:
+
+		Timer(Counter counter) : counter(counter), start(std::chrono::steady_clock::now()) {}
+
+		~Timer() {
+			add(counter, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+		}
+
+	protected:
+
+		Counter counter;
+
+		std::chrono::steady_clock::time_point start;
+
+	}; // end Timer
+
+	/**
+	 * @fn	static void EngineCounters::add(Counter counter, unsigned long long amount = 1)
+	 *
+	 * @brief	Adds to a counter.
+	 */
+	static void add(Counter counter, unsigned long long amount = 1) {
+		counters[counter].fetch_add(amount, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @fn	static void EngineCounters::addDraw(GLenum primitiveMode, unsigned long long vertexCount, unsigned long long instanceCount = 1)
+	 *
+	 * @brief	Counts a draw call and the triangles it submits. Points and lines are not
+	 * 			counted as triangles.
+	 */
+	static void addDraw(GLenum primitiveMode, unsigned long long vertexCount, unsigned long long instanceCount = 1) {
+
+		add(DRAW_CALLS);
+		add(TRIANGLES, getTriangleCount(primitiveMode, vertexCount) * instanceCount);
+	}
+
+	/**
+	 * @fn	static unsigned long long EngineCounters::take(Counter counter)
+	 *
+	 * @brief	Gets a counter and resets it to zero.
+	 */
+	static unsigned long long take(Counter counter) {
+		return counters[counter].exchange(0, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @fn	static void EngineCounters::set(Gauge gauge, unsigned long long value)
+	 *
+	 * @brief	Sets a gauge to the value that was measured.
+	 */
+	static void set(Gauge gauge, unsigned long long value) {
+		gauges[gauge].store(value, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @fn	static unsigned long long EngineCounters::get(Gauge gauge)
+	 *
+	 * @brief	Gets the last value of a gauge.
+	 */
+	static unsigned long long get(Gauge gauge) {
+		return gauges[gauge].load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @fn	static unsigned long long EngineCounters::getTriangleCount(GLenum primitiveMode, unsigned long long vertexCount);
+	 *
+	 * @brief	Gets the number of triangles formed by the vertices of a draw call.
+	 */
+	static unsigned long long getTriangleCount(GLenum primitiveMode, unsigned long long vertexCount);
+
+protected:
+
+	static std::atomic<unsigned long long> counters[COUNTER_COUNT];
+
+	static std::atomic<unsigned long long> gauges[GAUGE_COUNT];
+
+}; // end EngineCounters class
@@ -0,0 +1,199 @@
+#include "FrameCapture.h"
+#include "GLStateCache.h"
+#include "FreeImage.h"
+
+#define VERBOSE false
+
+
+FrameCapture::~FrameCapture()
+{
+	clear();
+
+} // end destructor
+
+
+void FrameCapture::capture(GLuint framebuffer, GLenum readBuffer, GLsizei width, GLsizei height)
+{
+	if (isEnabled() == false || width < 1 || height < 1) {
+		return;
+	}
+
+	// Hand back every frame that has finished without waiting, oldest first
+	for (size_t i = 0; i < slots.size(); i++) {
+
+		CaptureSlot& slot = slots[(nextSlot + i) % slots.size()];
+
+		if (slot.fence != 0 && collect(slot, false) == false) {
+			break;
+		}
+	}
+
+	CaptureSlot& slot = slots[nextSlot];
+
+	// Every buffer is in use. Only the oldest frame is waited for.
+	if (slot.fence != 0) {
+
+		if (VERBOSE) cout << "Frame capture is waiting for frame " << slot.frameNumber << endl;
+
+		collect(slot, true);
+	}
+
+	GLsizeiptr size = static_cast<GLsizeiptr>(width) * height * 4;
+
+	if (slot.pixelBuffer == 0) {
+
+		glGenBuffers(1, &slot.pixelBuffer);
+	}
+
+	GLStateCache::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.pixelBuffer);
+
+	// Buffers are only reallocated when the size of the frame changes
+	if (slot.width != width || slot.height != height) {
+
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+	}
+
+	GLuint previousFramebuffer = GLStateCache::getFramebuffer(GL_READ_FRAMEBUFFER);
+
+	GLStateCache::bindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	glReadBuffer(readBuffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+	// Returns immediately because the destination is a buffer object
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+
+	GLStateCache::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	GLStateCache::bindFramebuffer(GL_READ_FRAMEBUFFER, previousFramebuffer);
+
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot.width = width;
+	slot.height = height;
+	slot.frameNumber = frameCount++;
+
+	nextSlot = (nextSlot + 1) % slots.size();
+
+} // end capture
+
+
+void FrameCapture::flush()
+{
+	// Oldest first so frames reach the callback in order
+	for (size_t i = 0; i < slots.size(); i++) {
+
+		CaptureSlot& slot = slots[(nextSlot + i) % slots.size()];
+
+		if (slot.fence != 0) {
+
+			collect(slot, true);
+		}
+	}
+
+} // end flush
+
+
+void FrameCapture::clear()
+{
+	for (auto& slot : slots) {
+
+		if (slot.fence != 0) {
+
+			glDeleteSync(slot.fence);
+			slot.fence = 0;
+		}
+
+		if (slot.pixelBuffer != 0) {
+
+			GLStateCache::deleteBuffers(1, &slot.pixelBuffer);
+			slot.pixelBuffer = 0;
+		}
+
+		slot.width = 0;
+		slot.height = 0;
+	}
+
+	nextSlot = 0;
+
+} // end clear
+
+
+bool FrameCapture::collect(CaptureSlot& slot, bool wait)
+{
+	// Commands must be flushed or a fence that was not submitted would never signal
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	GLuint64 timeout = wait ? std::numeric_limits<GLuint64>::max() : 0;
+
+	GLenum result = glClientWaitSync(slot.fence, flags, timeout);
+
+	if (result == GL_TIMEOUT_EXPIRED) {
+		return false;
+	}
+
+	glDeleteSync(slot.fence);
+	slot.fence = 0;
+
+	if (result == GL_WAIT_FAILED) {
+
+		std::cerr << "Frame capture failed to wait for frame " << slot.frameNumber << std::endl;
+		return true;
+	}
+
+	GLStateCache::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.pixelBuffer);
+
+	const GLubyte* pixels = static_cast<const GLubyte*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+		static_cast<GLsizeiptr>(slot.width) * slot.height * 4, GL_MAP_READ_BIT));
+
+	if (pixels != nullptr) {
+
+		if (callback) {
+			callback(slot.frameNumber, slot.width, slot.height, pixels);
+		}
+
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+
+	GLStateCache::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	return true;
+
+} // end collect
+
+
+bool FrameCapture::saveImage(const std::string& fileName, GLsizei width, GLsizei height, const GLubyte* pixels)
+{
+	FIBITMAP* image = FreeImage_Allocate(width, height, 24);
+
+	if (image == nullptr) {
+		return false;
+	}
+
+	// FreeImage stores rows bottom up like OpenGL but in BGR order
+	for (GLsizei row = 0; row < height; row++) {
+
+		BYTE* destination = FreeImage_GetScanLine(image, row);
+		const GLubyte* source = pixels + static_cast<size_t>(row) * width * 4;
+
+		for (GLsizei column = 0; column < width; column++) {
+
+			destination[column * 3 + FI_RGBA_RED] = source[column * 4 + 0];
+			destination[column * 3 + FI_RGBA_GREEN] = source[column * 4 + 1];
+			destination[column * 3 + FI_RGBA_BLUE] = source[column * 4 + 2];
+		}
+	}
+
+	FREE_IMAGE_FORMAT format = FreeImage_GetFIFFromFilename(fileName.c_str());
+
+	if (format == FIF_UNKNOWN) {
+		format = FIF_PNG;
+	}
+
+	bool saved = FreeImage_Save(format, image, fileName.c_str(), 0) == TRUE;
+
+	FreeImage_Unload(image);
+
+	if (saved == false) {
+		std::cerr << "ERROR: Unable to save " << fileName << "!" << std::endl;
+	}
+
+	return saved;
+
+} // end saveImage
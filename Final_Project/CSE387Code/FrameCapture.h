@@ -0,0 +1,141 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "MathLibsConstsFuncs.h"
+
+/**
+ * @class	FrameCapture
+ *
+ * @brief	Reads rendered frames back to the CPU without stalling the pipeline. Each frame is
+ * 			copied into the next pixel buffer object of a ring and a fence is inserted after
+ * 			the copy. The pixels of a frame are mapped and handed to a callback only after
+ * 			its fence has signaled, usually a few frames later, so the CPU does not wait for
+ * 			the GPU to finish rendering. Only needs core OpenGL 3.2 so it works with software
+ * 			contexts such as OSMesa.
+ *
+ * 			All methods must be called on the thread that owns the OpenGL context.
+ */
+class FrameCapture
+{
+public:
+
+	/**
+	 * @brief	Receives a captured frame. Pixels are tightly packed RGBA8 rows starting with
+	 * 			the bottom row. The pointer is only valid during the call.
+	 */
+	typedef std::function<void(unsigned int frameNumber, GLsizei width, GLsizei height, const GLubyte* pixels)> CaptureCallback;
+
+	/**
+	 * @fn	FrameCapture::FrameCapture(int ringSize = 3)
+	 *
+	 * @brief	Constructor
+	 *
+	 * @param	ringSize	(Optional) Number of pixel buffers. More buffers let frames take
+	 * 						longer to finish before the CPU has to wait.
+	 */
+	FrameCapture(int ringSize = 3) : slots(std::max(ringSize, 1)) {}
+
+	/**
+	 * @fn	FrameCapture::~FrameCapture();
+	 *
+	 * @brief	Destructor. Deletes the pixel buffers and fences without reading them.
+	 */
+	~FrameCapture();
+
+	/**
+	 * @fn	void FrameCapture::setCallback(CaptureCallback callback)
+	 *
+	 * @brief	Sets the function that receives captured frames. Frames are only captured
+	 * 			while a callback is set.
+	 */
+	void setCallback(CaptureCallback callback) { this->callback = callback; }
+
+	bool isEnabled() const { return static_cast<bool>(callback); }
+
+	/**
+	 * @fn	void FrameCapture::capture(GLuint framebuffer, GLenum readBuffer, GLsizei width, GLsizei height);
+	 *
+	 * @brief	Starts an asynchronous read back of a framebuffer and hands frames that have
+	 * 			finished to the callback. Waits only if every buffer of the ring is still in
+	 * 			use.
+	 *
+	 * @param	framebuffer	The framebuffer to read. Zero for the default framebuffer.
+	 * @param	readBuffer 	The color buffer to read, such as GL_BACK or GL_COLOR_ATTACHMENT0.
+	 * @param	width	   	The width of the region to read.
+	 * @param	height	   	The height of the region to read.
+	 */
+	void capture(GLuint framebuffer, GLenum readBuffer, GLsizei width, GLsizei height);
+
+	/**
+	 * @fn	void FrameCapture::flush();
+	 *
+	 * @brief	Waits for all frames that are being read back and hands them to the callback.
+	 * 			Call before the OpenGL context is destroyed.
+	 */
+	void flush();
+
+	/**
+	 * @fn	void FrameCapture::clear();
+	 *
+	 * @brief	Deletes the pixel buffers and fences. Frames that were not read are dropped.
+	 */
+	void clear();
+
+	/**
+	 * @fn	static bool FrameCapture::saveImage(const std::string& fileName, GLsizei width, GLsizei height, const GLubyte* pixels);
+	 *
+	 * @brief	Writes a captured frame to an image file. The format is chosen from the
+	 * 			extension of the file name.
+	 *
+	 * @returns	True if the file was written.
+	 */
+	static bool saveImage(const std::string& fileName, GLsizei width, GLsizei height, const GLubyte* pixels);
+
+protected:
+
+	/**
+	 * @struct	CaptureSlot
+	 *
+	 * @brief	Pixel buffer of the ring and the frame being read into it.
+	 */
+	struct CaptureSlot {
+
+		GLuint pixelBuffer = 0;
+
+		GLsync fence = 0; // Signaled when the copy into the pixel buffer has finished. Zero if the slot is free.
+
+		GLsizei width = 0;
+
+		GLsizei height = 0;
+
+		unsigned int frameNumber = 0;
+
+	}; // end CaptureSlot
+
+	/**
+	 * @fn	bool FrameCapture::collect(CaptureSlot& slot, bool wait);
+	 *
+	 * @brief	Hands the frame in a slot to the callback if its copy has finished and frees
+	 * 			the slot.
+	 *
+	 * @param [in,out]	slot	The slot.
+	 * @param 		  	wait	True to wait for the copy to finish.
+	 *
+	 * @returns	True if the slot is free.
+	 */
+	bool collect(CaptureSlot& slot, bool wait);
+
+	std::vector<CaptureSlot> slots;
+
+	/** @brief	Slot the next frame is read into. Slots are filled and collected in order. */
+	size_t nextSlot = 0;
+
+	/** @brief	Number of frames that have been captured */
+	unsigned int frameCount = 0;
+
+	CaptureCallback callback;
+
+}; // end FrameCapture class
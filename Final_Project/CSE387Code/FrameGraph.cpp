@@ -0,0 +1,452 @@
+#include "FrameGraph.h"
+#include "GpuProfiler.h"
+#include "GLStateCache.h"
+
+#include <algorithm>
+
+#define VERBOSE false
+
+// Frames a pooled texture may go unused before it is deleted
+#define UNUSED_TEXTURE_FRAMES 60
+
+
+FrameGraph::Resource FrameGraph::PassBuilder::create(const std::string& name, const TextureDesc& desc)
+{
+	ResourceNode resource;
+	resource.name = name;
+	resource.desc = desc;
+
+	graph.resources.push_back(resource);
+
+	Resource handle = static_cast<Resource>(graph.resources.size()) - 1;
+
+	graph.passes[pass].creates.push_back(handle);
+
+	return handle;
+
+} // end create
+
+
+FrameGraph::Resource FrameGraph::PassBuilder::read(Resource resource)
+{
+	if (resource >= 0) {
+		graph.passes[pass].reads.push_back(resource);
+	}
+
+	return resource;
+
+} // end read
+
+
+FrameGraph::Resource FrameGraph::PassBuilder::write(Resource resource)
+{
+	if (resource >= 0) {
+		graph.passes[pass].writes.push_back(resource);
+	}
+
+	return resource;
+
+} // end write
+
+
+void FrameGraph::PassBuilder::setSideEffect()
+{
+	graph.passes[pass].sideEffect = true;
+
+} // end setSideEffect
+
+
+GLuint FrameGraph::PassResources::getTexture(Resource resource) const
+{
+	const ResourceNode& node = graph.resources[resource];
+
+	if (node.imported || node.pooledTexture < 0) {
+		return 0;
+	}
+
+	return graph.pool[node.pooledTexture].texture;
+
+} // end getTexture
+
+
+GLuint FrameGraph::PassResources::getFramebuffer(std::initializer_list<Resource> attachments) const
+{
+	return getFramebuffer(std::vector<Resource>(attachments));
+
+} // end getFramebuffer
+
+
+GLuint FrameGraph::PassResources::getFramebuffer(const std::vector<Resource>& attachments) const
+{
+	if (attachments.size() == 1 && graph.resources[attachments[0]].imported) {
+
+		return graph.resources[attachments[0]].importedFramebuffer;
+	}
+
+	std::vector<GLuint> key;
+
+	for (auto resource : attachments) {
+
+		key.push_back(getTexture(resource));
+	}
+
+	auto iter = graph.framebuffers.find(key);
+
+	if (iter != graph.framebuffers.end()) {
+		return iter->second;
+	}
+
+	GLuint previousFramebuffer = GLStateCache::getFramebuffer(GL_DRAW_FRAMEBUFFER);
+
+	GLuint framebuffer = 0;
+	glGenFramebuffers(1, &framebuffer);
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+	std::vector<GLenum> drawBuffers;
+
+	for (size_t i = 0; i < attachments.size(); i++) {
+
+		GLenum format = graph.resources[attachments[i]].desc.format;
+
+		if (isDepthFormat(format)) {
+
+			GLenum attachment = (format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+
+			glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, key[i], 0);
+		}
+		else {
+
+			GLenum attachment = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(drawBuffers.size());
+
+			glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, key[i], 0);
+			drawBuffers.push_back(attachment);
+		}
+	}
+
+	if (drawBuffers.empty()) {
+
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+	}
+	else {
+
+		glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), &drawBuffers[0]);
+		glReadBuffer(GL_COLOR_ATTACHMENT0);
+	}
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+
+		std::cerr << "Frame graph framebuffer is incomplete. Status 0x" << std::hex << status << std::dec << std::endl;
+
+		GLStateCache::deleteFramebuffers(1, &framebuffer);
+		return 0;
+	}
+
+	graph.framebuffers[key] = framebuffer;
+
+	return framebuffer;
+
+} // end getFramebuffer
+
+
+FrameGraph::TextureDesc FrameGraph::PassResources::getDesc(Resource resource) const
+{
+	return graph.resources[resource].desc;
+
+} // end getDesc
+
+
+void FrameGraph::reset()
+{
+	resources.clear();
+	passes.clear();
+	order.clear();
+
+} // end reset
+
+
+FrameGraph::Resource FrameGraph::importFramebuffer(const std::string& name, GLuint framebuffer, GLsizei width, GLsizei height)
+{
+	ResourceNode resource;
+	resource.name = name;
+	resource.desc.width = width;
+	resource.desc.height = height;
+	resource.imported = true;
+	resource.importedFramebuffer = framebuffer;
+
+	resources.push_back(resource);
+
+	return static_cast<Resource>(resources.size()) - 1;
+
+} // end importFramebuffer
+
+
+void FrameGraph::addPass(const std::string& name, const SetupFunction& setup, const ExecuteFunction& execute)
+{
+	PassNode pass;
+	pass.name = name;
+	pass.execute = execute;
+
+	passes.push_back(pass);
+
+	PassBuilder builder(*this, static_cast<int>(passes.size()) - 1);
+
+	setup(builder);
+
+} // end addPass
+
+
+bool FrameGraph::compile()
+{
+	order.clear();
+
+	// Passes with side effects and passes that write imported framebuffers are needed.
+	// Passes that write or create what a needed pass reads are needed too.
+	std::vector<int> needed;
+
+	for (size_t i = 0; i < passes.size(); i++) {
+
+		PassNode& pass = passes[i];
+
+		pass.culled = true;
+
+		bool writesImported = std::any_of(pass.writes.begin(), pass.writes.end(), [this](Resource resource) {
+			return resources[resource].imported;
+		});
+
+		if (pass.sideEffect || writesImported) {
+
+			pass.culled = false;
+			needed.push_back(static_cast<int>(i));
+		}
+	}
+
+	while (needed.empty() == false) {
+
+		int reader = needed.back();
+		needed.pop_back();
+
+		for (auto resource : passes[reader].reads) {
+
+			for (int writer = 0; writer < reader; writer++) {
+
+				PassNode& pass = passes[writer];
+
+				if (pass.culled == false) {
+					continue;
+				}
+
+				if (std::find(pass.writes.begin(), pass.writes.end(), resource) != pass.writes.end() ||
+					std::find(pass.creates.begin(), pass.creates.end(), resource) != pass.creates.end()) {
+
+					pass.culled = false;
+					needed.push_back(writer);
+				}
+			}
+		}
+	}
+
+	for (auto& resource : resources) {
+
+		resource.firstPass = -1;
+		resource.lastPass = -1;
+	}
+
+	for (size_t i = 0; i < passes.size(); i++) {
+
+		PassNode& pass = passes[i];
+
+		if (pass.culled) {
+
+			if (VERBOSE) cout << "Culled pass " << pass.name << endl;
+			continue;
+		}
+
+		int position = static_cast<int>(order.size());
+
+		// A transient texture must be created or written before it is read
+		for (auto resource : pass.reads) {
+
+			if (resources[resource].imported == false && resources[resource].firstPass < 0) {
+
+				std::cerr << "Pass " << pass.name << " reads " << resources[resource].name << " before it is written." << std::endl;
+
+				order.clear();
+				return false;
+			}
+		}
+
+		for (auto list : { &pass.creates, &pass.writes, &pass.reads }) {
+
+			for (auto resource : *list) {
+
+				ResourceNode& node = resources[resource];
+
+				if (node.firstPass < 0) {
+					node.firstPass = position;
+				}
+
+				node.lastPass = position;
+			}
+		}
+
+		order.push_back(static_cast<int>(i));
+	}
+
+	return true;
+
+} // end compile
+
+
+void FrameGraph::execute()
+{
+	frameNumber++;
+
+	PassResources passResources(*this);
+
+	for (size_t position = 0; position < order.size(); position++) {
+
+		PassNode& pass = passes[order[position]];
+
+		// Textures whose lifetime starts with this pass
+		for (auto list : { &pass.creates, &pass.writes, &pass.reads }) {
+
+			for (auto resource : *list) {
+
+				ResourceNode& node = resources[resource];
+
+				if (node.imported == false && node.pooledTexture < 0 && node.firstPass == static_cast<int>(position)) {
+
+					node.pooledTexture = acquireTexture(node.desc);
+				}
+			}
+		}
+
+		if (profiler != nullptr) {
+			profiler->beginScope(pass.name);
+		}
+
+		pass.execute(passResources);
+
+		if (profiler != nullptr) {
+			profiler->endScope();
+		}
+
+		// Textures whose lifetime ends with this pass can be used by later passes
+		for (auto list : { &pass.creates, &pass.writes, &pass.reads }) {
+
+			for (auto resource : *list) {
+
+				ResourceNode& node = resources[resource];
+
+				if (node.pooledTexture >= 0 && node.lastPass == static_cast<int>(position)) {
+
+					pool[node.pooledTexture].inUse = false;
+					pool[node.pooledTexture].lastUsedFrame = frameNumber;
+					node.pooledTexture = -1;
+				}
+			}
+		}
+	}
+
+	deleteUnusedTextures();
+
+} // end execute
+
+
+void FrameGraph::destroy()
+{
+	for (auto& framebuffer : framebuffers) {
+
+		GLStateCache::deleteFramebuffers(1, &framebuffer.second);
+	}
+
+	for (auto& pooled : pool) {
+
+		GLStateCache::deleteTextures(1, &pooled.texture);
+	}
+
+	framebuffers.clear();
+	pool.clear();
+	reset();
+
+} // end destroy
+
+
+int FrameGraph::acquireTexture(const TextureDesc& desc)
+{
+	for (size_t i = 0; i < pool.size(); i++) {
+
+		if (pool[i].inUse == false && pool[i].desc == desc) {
+
+			pool[i].inUse = true;
+			return static_cast<int>(i);
+		}
+	}
+
+	PooledTexture pooled;
+	pooled.desc = desc;
+	pooled.inUse = true;
+
+	glGenTextures(1, &pooled.texture);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, pooled.texture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, desc.format, desc.width, desc.height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+
+	if (VERBOSE) cout << "Frame graph texture created " << desc.width << " x " << desc.height << endl;
+
+	pool.push_back(pooled);
+
+	return static_cast<int>(pool.size()) - 1;
+
+} // end acquireTexture
+
+
+void FrameGraph::deleteUnusedTextures()
+{
+	for (size_t i = 0; i < pool.size(); ) {
+
+		PooledTexture& pooled = pool[i];
+
+		if (pooled.inUse || frameNumber - pooled.lastUsedFrame < UNUSED_TEXTURE_FRAMES) {
+
+			i++;
+			continue;
+		}
+
+		// Framebuffers the texture is attached to can not be used again
+		for (auto iter = framebuffers.begin(); iter != framebuffers.end(); ) {
+
+			if (std::find(iter->first.begin(), iter->first.end(), pooled.texture) != iter->first.end()) {
+
+				GLStateCache::deleteFramebuffers(1, &iter->second);
+				iter = framebuffers.erase(iter);
+			}
+			else {
+
+				++iter;
+			}
+		}
+
+		GLStateCache::deleteTextures(1, &pooled.texture);
+
+		pool.erase(pool.begin() + i);
+	}
+
+} // end deleteUnusedTextures
+
+
+bool FrameGraph::isDepthFormat(GLenum format)
+{
+	return format == GL_DEPTH_COMPONENT16 || format == GL_DEPTH_COMPONENT24 || format == GL_DEPTH_COMPONENT32 ||
+		   format == GL_DEPTH_COMPONENT32F || format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+
+} // end isDepthFormat
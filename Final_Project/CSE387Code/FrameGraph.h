@@ -0,0 +1,357 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "MathLibsConstsFuncs.h"
+
+class GpuProfiler;
+
+/**
+ * @class	FrameGraph
+ *
+ * @brief	Describes the rendering of a frame as passes that declare the textures they read
+ * 			and write. The graph is built again every frame. Compiling it:
+ * 			
+ * 			- culls passes whose results are never used. Passes with side effects, such as
+ * 			  presenting the frame, and passes that write imported framebuffers are kept.
+ * 			- schedules the remaining passes in the order they were added, which must be an
+ * 			  order in which every transient texture is written before it is read.
+ * 			- finds the first and last pass that uses each transient texture.
+ *
+ * 			When the graph is executed, transient textures are taken from a pool just before
+ * 			their first pass and returned just after their last one, so textures with the same
+ * 			size and format whose lifetimes do not overlap share the same memory. Pooled
+ * 			textures that go unused for a while are deleted.
+ *
+ * 			Must be used on the thread that owns the OpenGL context.
+ */
+class FrameGraph
+{
+public:
+
+	/** @brief	Identifies a resource of the graph. Negative for none. */
+	typedef int Resource;
+
+	/**
+	 * @struct	TextureDesc
+	 *
+	 * @brief	Size and internal format of a transient texture.
+	 */
+	struct TextureDesc {
+
+		GLsizei width = 0;
+
+		GLsizei height = 0;
+
+		GLenum format = GL_RGBA8;
+
+		bool operator==(const TextureDesc& other) const {
+			return width == other.width && height == other.height && format == other.format;
+		}
+
+	}; // end TextureDesc
+
+	/**
+	 * @class	PassBuilder
+	 *
+	 * @brief	Passed to the setup function of a pass to declare its resources.
+	 */
+	class PassBuilder
+	{
+	public:
+
+		/**
+		 * @fn	Resource FrameGraph::PassBuilder::create(const std::string& name, const TextureDesc& desc);
+		 *
+		 * @brief	Declares a transient texture that is first written by this pass.
+		 */
+		Resource create(const std::string& name, const TextureDesc& desc);
+
+		/**
+		 * @fn	Resource FrameGraph::PassBuilder::read(Resource resource);
+		 *
+		 * @brief	Declares that the pass reads a resource.
+		 */
+		Resource read(Resource resource);
+
+		/**
+		 * @fn	Resource FrameGraph::PassBuilder::write(Resource resource);
+		 *
+		 * @brief	Declares that the pass writes a resource.
+		 */
+		Resource write(Resource resource);
+
+		/**
+		 * @fn	void FrameGraph::PassBuilder::setSideEffect()
+		 *
+		 * @brief	Keeps the pass even if nothing reads what it writes.
+		 */
+		void setSideEffect();
+
+	protected:
+
+		friend class FrameGraph;
+
+		PassBuilder(FrameGraph& graph, int pass) : graph(graph), pass(pass) {}
+
+		FrameGraph& graph;
+
+		int pass;
+
+	}; // end PassBuilder
+
+	/**
+	 * @class	PassResources
+	 *
+	 * @brief	Passed to the execute function of a pass to get the OpenGL objects of its
+	 * 			resources.
+	 */
+	class PassResources
+	{
+	public:
+
+		/**
+		 * @fn	GLuint FrameGraph::PassResources::getTexture(Resource resource) const;
+		 *
+		 * @brief	Gets the texture of a transient resource. Zero for imported framebuffers.
+		 */
+		GLuint getTexture(Resource resource) const;
+
+		/**
+		 * @fn	GLuint FrameGraph::PassResources::getFramebuffer(std::initializer_list<Resource> attachments) const;
+		 *
+		 * @brief	Gets a framebuffer with the textures attached in order. Color textures are
+		 * 			attached to consecutive color attachments that are all drawn to, and a depth
+		 * 			texture to the depth attachment. An imported framebuffer must be the only
+		 * 			resource and is returned as it is. Framebuffers are cached. Pooled textures
+		 * 			hold whatever their last user left in them, so passes must clear what they
+		 * 			create.
+		 *
+		 * @returns	Zero if the framebuffer is incomplete or an imported framebuffer is the default one.
+		 */
+		GLuint getFramebuffer(std::initializer_list<Resource> attachments) const;
+
+		/**
+		 * @fn	GLuint FrameGraph::PassResources::getFramebuffer(const std::vector<Resource>& attachments) const;
+		 *
+		 * @brief	Gets a framebuffer with the textures attached in order.
+		 */
+		GLuint getFramebuffer(const std::vector<Resource>& attachments) const;
+
+		/**
+		 * @fn	TextureDesc FrameGraph::PassResources::getDesc(Resource resource) const;
+		 *
+		 * @brief	Gets the size and format of a resource.
+		 */
+		TextureDesc getDesc(Resource resource) const;
+
+	protected:
+
+		friend class FrameGraph;
+
+		PassResources(FrameGraph& graph) : graph(graph) {}
+
+		FrameGraph& graph;
+
+	}; // end PassResources
+
+	typedef std::function<void(PassBuilder&)> SetupFunction;
+
+	typedef std::function<void(const PassResources&)> ExecuteFunction;
+
+	/**
+	 * @fn	FrameGraph::~FrameGraph()
+	 *
+	 * @brief	Destructor. Deletes the pooled textures and cached framebuffers.
+	 */
+	~FrameGraph() { destroy(); }
+
+	/**
+	 * @fn	void FrameGraph::reset();
+	 *
+	 * @brief	Removes the passes and resources of the last frame. Pooled textures are kept.
+	 */
+	void reset();
+
+	/**
+	 * @fn	Resource FrameGraph::importFramebuffer(const std::string& name, GLuint framebuffer, GLsizei width, GLsizei height);
+	 *
+	 * @brief	Adds a framebuffer that is owned outside of the graph, such as the default
+	 * 			framebuffer of the window. Passes that write it are never culled.
+	 */
+	Resource importFramebuffer(const std::string& name, GLuint framebuffer, GLsizei width, GLsizei height);
+
+	/**
+	 * @fn	void FrameGraph::addPass(const std::string& name, const SetupFunction& setup, const ExecuteFunction& execute);
+	 *
+	 * @brief	Adds a pass. The setup function is called right away to declare the resources
+	 * 			of the pass. The execute function is called by execute if the pass is not culled.
+	 */
+	void addPass(const std::string& name, const SetupFunction& setup, const ExecuteFunction& execute);
+
+	/**
+	 * @fn	bool FrameGraph::compile();
+	 *
+	 * @brief	Culls and schedules the passes and finds the lifetimes of the transient textures.
+	 *
+	 * @returns	False if a transient texture is read before it is written. Nothing is
+	 * 			executed in that case.
+	 */
+	bool compile();
+
+	/**
+	 * @fn	void FrameGraph::execute();
+	 *
+	 * @brief	Runs the passes that were kept in order. Transient textures are taken from
+	 * 			the pool before their first pass and returned after their last.
+	 */
+	void execute();
+
+	/**
+	 * @fn	void FrameGraph::destroy();
+	 *
+	 * @brief	Deletes the pooled textures and cached framebuffers.
+	 */
+	void destroy();
+
+	/**
+	 * @fn	void FrameGraph::setProfiler(GpuProfiler* profiler)
+	 *
+	 * @brief	Sets the profiler each pass that is run is timed with as a scope named after
+	 * 			the pass. Null to not time them.
+	 */
+	void setProfiler(GpuProfiler* profiler) { this->profiler = profiler; }
+
+	/**
+	 * @fn	int FrameGraph::getExecutedPassCount() const
+	 *
+	 * @brief	Gets the number of passes run by the last execute.
+	 */
+	int getExecutedPassCount() const { return static_cast<int>(order.size()); }
+
+	/**
+	 * @fn	int FrameGraph::getCulledPassCount() const
+	 *
+	 * @brief	Gets the number of passes culled by the last compile.
+	 */
+	int getCulledPassCount() const { return static_cast<int>(passes.size() - order.size()); }
+
+	/**
+	 * @fn	int FrameGraph::getPooledTextureCount() const
+	 *
+	 * @brief	Gets the number of textures in the pool. Less than the number of transient
+	 * 			textures when some of them are aliased.
+	 */
+	int getPooledTextureCount() const { return static_cast<int>(pool.size()); }
+
+protected:
+
+	/**
+	 * @struct	ResourceNode
+	 *
+	 * @brief	A transient texture or an imported framebuffer.
+	 */
+	struct ResourceNode {
+
+		std::string name;
+
+		TextureDesc desc;
+
+		bool imported = false;
+
+		GLuint importedFramebuffer = 0;
+
+		int pooledTexture = -1; // Index in the pool while the texture is alive
+
+		int firstPass = -1; // Position in the order of the first and last passes that use it
+
+		int lastPass = -1;
+
+	}; // end ResourceNode
+
+	/**
+	 * @struct	PassNode
+	 *
+	 * @brief	A pass and the resources it declared.
+	 */
+	struct PassNode {
+
+		std::string name;
+
+		ExecuteFunction execute;
+
+		std::vector<Resource> reads;
+
+		std::vector<Resource> writes;
+
+		std::vector<Resource> creates;
+
+		bool sideEffect = false;
+
+		bool culled = false;
+
+	}; // end PassNode
+
+	/**
+	 * @struct	PooledTexture
+	 *
+	 * @brief	A texture that outlives the frame so it can be used again.
+	 */
+	struct PooledTexture {
+
+		GLuint texture = 0;
+
+		TextureDesc desc;
+
+		bool inUse = false;
+
+		unsigned int lastUsedFrame = 0;
+
+	}; // end PooledTexture
+
+	/**
+	 * @fn	int FrameGraph::acquireTexture(const TextureDesc& desc);
+	 *
+	 * @brief	Finds a free pooled texture with the same size and format, or creates one.
+	 *
+	 * @returns	The index of the texture in the pool.
+	 */
+	int acquireTexture(const TextureDesc& desc);
+
+	/**
+	 * @fn	void FrameGraph::deleteUnusedTextures();
+	 *
+	 * @brief	Deletes pooled textures that were not used in recent frames and the framebuffers
+	 * 			they are attached to.
+	 */
+	void deleteUnusedTextures();
+
+	/**
+	 * @fn	static bool FrameGraph::isDepthFormat(GLenum format);
+	 *
+	 * @brief	Returns true for formats that are attached to the depth attachment.
+	 */
+	static bool isDepthFormat(GLenum format);
+
+	std::vector<ResourceNode> resources;
+
+	std::vector<PassNode> passes;
+
+	/** @brief	Indices of the passes that were kept in the order they run */
+	std::vector<int> order;
+
+	std::vector<PooledTexture> pool;
+
+	/** @brief	Framebuffers by the textures attached to them */
+	std::map<std::vector<GLuint>, GLuint> framebuffers;
+
+	/** @brief	Number of frames executed */
+	unsigned int frameNumber = 0;
+
+	GpuProfiler* profiler = nullptr;
+
+}; // end FrameGraph class
@@ -0,0 +1,126 @@
+#include "FrameScheduler.h"
+
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#include <timeapi.h>
+#endif
+
+#define VERBOSE false
+
+// Time left before a deadline that is yielded instead of slept
+#define SLEEP_MARGIN 0.002
+
+
+FrameScheduler::FrameScheduler(double fixedTimeStep, double framesPerSecond)
+	: fixedTimeStep(fixedTimeStep)
+{
+	setFrameRate(framesPerSecond);
+
+#ifdef _WIN32
+	// The default timer resolution rounds sleeps up to about 15 milliseconds
+	timeBeginPeriod(1);
+#endif
+
+} // end constructor
+
+
+FrameScheduler::~FrameScheduler()
+{
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+
+} // end destructor
+
+
+void FrameScheduler::reset()
+{
+	lastFrameTime = getTime();
+	nextFrameTime = lastFrameTime;
+	accumulator = 0.0;
+
+} // end reset
+
+
+int FrameScheduler::beginFrame()
+{
+	if (realTime == false) {
+
+		accumulator = 0.0;
+		return 1;
+	}
+
+	if (frameInterval > 0.0) {
+
+		waitUntil(nextFrameTime);
+	}
+
+	double currentTime = getTime();
+
+	// Frames that were missed are skipped rather than rendered back to back
+	nextFrameTime += frameInterval;
+
+	if (nextFrameTime < currentTime) {
+
+		nextFrameTime = currentTime + frameInterval;
+	}
+
+	accumulator += currentTime - lastFrameTime;
+	lastFrameTime = currentTime;
+
+	int steps = 0;
+
+	while (accumulator >= fixedTimeStep && steps < maxStepsPerFrame) {
+
+		accumulator -= fixedTimeStep;
+		steps++;
+	}
+
+	// Drop time that could not be simulated
+	if (accumulator >= fixedTimeStep) {
+
+		if (VERBOSE) cout << "Dropped " << accumulator << " seconds of simulation" << endl;
+
+		accumulator = std::fmod(accumulator, fixedTimeStep);
+	}
+
+	return steps;
+
+} // end beginFrame
+
+
+void FrameScheduler::setFrameRate(double framesPerSecond)
+{
+	frameInterval = framesPerSecond > 0.0 ? 1.0 / framesPerSecond : 0.0;
+
+} // end setFrameRate
+
+
+void FrameScheduler::waitUntil(double time)
+{
+	double remaining = time - getTime();
+
+	if (remaining > SLEEP_MARGIN) {
+
+		std::this_thread::sleep_for(std::chrono::duration<double>(remaining - SLEEP_MARGIN));
+	}
+
+	while (getTime() < time) {
+
+		std::this_thread::yield();
+	}
+
+} // end waitUntil
+
+
+double FrameScheduler::getTime()
+{
+	static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+} // end getTime
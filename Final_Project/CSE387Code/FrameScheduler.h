@@ -0,0 +1,126 @@
+#pragma once
+
+#include "MathLibsConstsFuncs.h"
+
+/**
+ * @class	FrameScheduler
+ *
+ * @brief	Paces the game loop. The game is updated in fixed time steps that are taken from an
+ * 			accumulator of elapsed time, and frames are rendered no more often than the frame
+ * 			rate. The calling thread sleeps until the next frame is due instead of polling the
+ * 			clock. Frames are rendered with transformations interpolated between the last two
+ * 			fixed updates by the fraction of a step left in the accumulator.
+ */
+class FrameScheduler
+{
+public:
+
+	/**
+	 * @fn	FrameScheduler::FrameScheduler(double fixedTimeStep, double framesPerSecond);
+	 *
+	 * @brief	Constructor
+	 *
+	 * @param	fixedTimeStep  	The time in seconds that each update advances the game.
+	 * @param	framesPerSecond	The largest number of frames rendered per second. Zero to not
+	 * 							limit the frame rate.
+	 */
+	FrameScheduler(double fixedTimeStep, double framesPerSecond);
+
+	/**
+	 * @fn	FrameScheduler::~FrameScheduler();
+	 *
+	 * @brief	Destructor. Restores the resolution of the system timer.
+	 */
+	~FrameScheduler();
+
+	/**
+	 * @fn	void FrameScheduler::reset();
+	 *
+	 * @brief	Starts timing from the current time with an empty accumulator. Call right
+	 * 			before the game loop starts so loading time is not simulated.
+	 */
+	void reset();
+
+	/**
+	 * @fn	int FrameScheduler::beginFrame();
+	 *
+	 * @brief	Sleeps until the next frame is due and adds the elapsed time to the
+	 * 			accumulator.
+	 *
+	 * @returns	The number of fixed updates to run before the frame is rendered. At most
+	 * 			the maximum steps per frame. Time that does not fit is dropped so the game
+	 * 			slows down instead of falling further and further behind.
+	 */
+	int beginFrame();
+
+	/**
+	 * @fn	float FrameScheduler::getInterpolation() const
+	 *
+	 * @brief	Gets the fraction of a fixed step that is left in the accumulator after the
+	 * 			updates of the frame have run.
+	 */
+	float getInterpolation() const { return static_cast<float>(accumulator / fixedTimeStep); }
+
+	double getFixedTimeStep() const { return fixedTimeStep; }
+
+	/**
+	 * @fn	void FrameScheduler::setFrameRate(double framesPerSecond);
+	 *
+	 * @brief	Sets the largest number of frames rendered per second. Lower it on screens
+	 * 			that change little, such as menus, to save power. Zero to not limit the frame
+	 * 			rate, in which case the swap interval paces the frames.
+	 */
+	void setFrameRate(double framesPerSecond);
+
+	void setMaxStepsPerFrame(int steps) { maxStepsPerFrame = std::max(steps, 1); }
+
+	/**
+	 * @fn	void FrameScheduler::setRealTime(bool realTime)
+	 *
+	 * @brief	Selects whether the game is paced by the clock. If not, every frame takes
+	 * 			exactly one fixed step without waiting so the game runs as fast as it can be
+	 * 			updated. Used by headless games.
+	 */
+	void setRealTime(bool realTime) { this->realTime = realTime; }
+
+protected:
+
+	/**
+	 * @fn	void FrameScheduler::waitUntil(double time);
+	 *
+	 * @brief	Sleeps until shortly before a time and yields the rest of the way. Sleeping
+	 * 			can overshoot by about a millisecond so the last part is not slept.
+	 *
+	 * @param	time	The time to wait for as returned by getTime.
+	 */
+	void waitUntil(double time);
+
+	/**
+	 * @fn	static double FrameScheduler::getTime();
+	 *
+	 * @brief	Gets the time in seconds from a steady clock. Does not need GLFW to be
+	 * 			initialized.
+	 */
+	static double getTime();
+
+	/** @brief	Time in seconds advanced by each update */
+	double fixedTimeStep;
+
+	/** @brief	Time in seconds between frames. Zero if the frame rate is not limited. */
+	double frameInterval = 0.0;
+
+	/** @brief	Time that has passed and has not been simulated */
+	double accumulator = 0.0;
+
+	/** @brief	Time the last frame began */
+	double lastFrameTime = 0.0;
+
+	/** @brief	Time the next frame is due */
+	double nextFrameTime = 0.0;
+
+	int maxStepsPerFrame = 5;
+
+	/** @brief	False if every frame takes one step regardless of the time */
+	bool realTime = true;
+
+}; // end FrameScheduler class
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @struct	FrameStats
+ *
+ * @brief	Counts of the work done to render one frame. Filled in on the thread that
+ * 			renders and copied out by Game::getFrameStats once the frame is finished.
+ */
+struct FrameStats {
+
+	unsigned int frameNumber = 0; // Number of frames rendered before this one
+
+	int cameras = 0; // Views of cameras that were rendered
+
+	int depthPrepassCameras = 0; // Views rendered with a depth pre-pass
+
+	int frontToBackCameras = 0; // Views whose shading pass was sorted front to back
+
+	size_t depthPrepassDrawCalls = 0; // Sub-meshes rendered into the depth buffer alone
+
+	size_t drawCalls = 0; // Sub-meshes rendered by shading passes including static batches
+
+	size_t testedClusters = 0; // Meshlets tested by the cluster culler
+
+	size_t visibleClusters = 0; // Meshlets that passed and were drawn
+
+	size_t impostors = 0; // Meshes drawn as impostors, including those cross-fading with their mesh
+
+	int lightPasses = 0; // Light passes of the deferred pipeline
+
+	int renderPasses = 0; // Frame graph passes that were run
+
+	int culledPasses = 0; // Frame graph passes that were culled
+
+	int transientTextures = 0; // Textures in the pool of the frame graph, including aliased ones
+
+	unsigned int stateCallsIssued = 0; // Binds passed on to OpenGL by GLStateCache
+
+	unsigned int stateCallsSkipped = 0; // Binds skipped by GLStateCache because nothing changed
+
+	float resolutionScale = 1.0f; // Fraction of the output resolution the scene was rendered at
+
+	double gpuTime = 0.0; // Smoothed GPU time in seconds of the scene. Zero without dynamic resolution.
+
+}; // end FrameStats
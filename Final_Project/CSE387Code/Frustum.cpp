@@ -0,0 +1,61 @@
+#include "Frustum.h"
+
+void Frustum::setMatrix(const glm::mat4& viewProjection)
+{
+	// Rows of the matrix. glm matrices are stored by column.
+	glm::vec4 rows[4];
+
+	for (int i = 0; i < 4; i++) {
+
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+	}
+
+	planes[0] = rows[3] + rows[0]; // left
+	planes[1] = rows[3] - rows[0]; // right
+	planes[2] = rows[3] + rows[1]; // bottom
+	planes[3] = rows[3] - rows[1]; // top
+	planes[4] = rows[3] + rows[2]; // near
+	planes[5] = rows[3] - rows[2]; // far
+
+	// Normalize so distances to the planes are in world units
+	for (auto& plane : planes) {
+
+		plane /= glm::length(glm::vec3(plane));
+	}
+
+} // end setMatrix
+
+
+bool Frustum::intersectsSphere(const glm::vec3& center, float radius) const
+{
+	for (auto& plane : planes) {
+
+		if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+
+			return false;
+		}
+	}
+
+	return true;
+
+} // end intersectsSphere
+
+
+bool Frustum::intersectsBox(const glm::vec3& minimum, const glm::vec3& maximum) const
+{
+	for (auto& plane : planes) {
+
+		// Corner of the box that is farthest along the normal of the plane
+		glm::vec3 corner(plane.x > 0.0f ? maximum.x : minimum.x,
+						 plane.y > 0.0f ? maximum.y : minimum.y,
+						 plane.z > 0.0f ? maximum.z : minimum.z);
+
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) {
+
+			return false;
+		}
+	}
+
+	return true;
+
+} // end intersectsBox
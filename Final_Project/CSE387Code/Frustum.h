@@ -0,0 +1,72 @@
+#pragma once
+
+#include "MathLibsConstsFuncs.h"
+
+/**
+ * @class	Frustum
+ *
+ * @brief	The six planes of a viewing frustum in world coordinates. Used to skip
+ * 			geometry that cannot be seen by a camera.
+ */
+class Frustum
+{
+public:
+
+	Frustum() {}
+
+	/**
+	 * @fn	Frustum::Frustum(const glm::mat4& viewProjection)
+	 *
+	 * @brief	Constructor
+	 *
+	 * @param	viewProjection	The projection matrix multiplied by the viewing transformation.
+	 */
+	Frustum(const glm::mat4& viewProjection) { setMatrix(viewProjection); }
+
+	/**
+	 * @fn	void Frustum::setMatrix(const glm::mat4& viewProjection);
+	 *
+	 * @brief	Extracts the planes from a combined projection and viewing transformation.
+	 *
+	 * @param	viewProjection	The projection matrix multiplied by the viewing transformation.
+	 */
+	void setMatrix(const glm::mat4& viewProjection);
+
+	/**
+	 * @fn	bool Frustum::intersectsSphere(const glm::vec3& center, float radius) const;
+	 *
+	 * @brief	Determines if a sphere is at least partially inside the frustum.
+	 *
+	 * @param	center	The center of the sphere in world coordinates.
+	 * @param	radius	The radius of the sphere.
+	 *
+	 * @returns	False if the sphere is entirely outside of one of the planes.
+	 */
+	bool intersectsSphere(const glm::vec3& center, float radius) const;
+
+	/**
+	 * @fn	bool Frustum::intersectsBox(const glm::vec3& minimum, const glm::vec3& maximum) const;
+	 *
+	 * @brief	Determines if an axis aligned box is at least partially inside the frustum.
+	 * 			Boxes near the corners of the frustum may be reported as visible.
+	 *
+	 * @param	minimum	The minimum corner of the box in world coordinates.
+	 * @param	maximum	The maximum corner of the box in world coordinates.
+	 *
+	 * @returns	False if the box is entirely outside of one of the planes.
+	 */
+	bool intersectsBox(const glm::vec3& minimum, const glm::vec3& maximum) const;
+
+	/**
+	 * @fn	const glm::vec4& Frustum::getPlane(int index) const
+	 *
+	 * @brief	Gets a plane. The planes are in the order left, right, bottom, top, near, and far.
+	 */
+	const glm::vec4& getPlane(int index) const { return planes[index]; }
+
+protected:
+
+	/** @brief	Left, right, bottom, top, near, and far planes. The normals point inward. */
+	glm::vec4 planes[6];
+
+}; // end Frustum class
@@ -0,0 +1,363 @@
+#include "GLStateCache.h"
+
+#define VERBOSE false
+
+// The bindings of a new context are all zero
+GLuint GLStateCache::program = 0;
+
+GLuint GLStateCache::vertexArray = 0;
+
+GLuint GLStateCache::buffers[BUFFER_TARGETS];
+
+GLStateCache::BufferRange GLStateCache::uniformRanges[UNIFORM_BINDINGS];
+
+GLuint GLStateCache::activeUnit = GL_TEXTURE0;
+
+GLuint GLStateCache::textures2D[TEXTURE_UNITS];
+
+GLuint GLStateCache::textureArrays[TEXTURE_UNITS];
+
+GLuint GLStateCache::drawFramebuffer = 0;
+
+GLuint GLStateCache::readFramebuffer = 0;
+
+unsigned int GLStateCache::issuedCount = 0;
+
+unsigned int GLStateCache::skippedCount = 0;
+
+
+void GLStateCache::invalidate()
+{
+	program = UNKNOWN;
+	vertexArray = UNKNOWN;
+	activeUnit = UNKNOWN;
+	drawFramebuffer = UNKNOWN;
+	readFramebuffer = UNKNOWN;
+
+	for (auto& buffer : buffers) {
+		buffer = UNKNOWN;
+	}
+
+	for (auto& range : uniformRanges) {
+		range = BufferRange();
+	}
+
+	for (int i = 0; i < TEXTURE_UNITS; i++) {
+
+		textures2D[i] = UNKNOWN;
+		textureArrays[i] = UNKNOWN;
+	}
+
+} // end invalidate
+
+
+void GLStateCache::useProgram(GLuint program)
+{
+	if (update(GLStateCache::program, program)) {
+
+		glUseProgram(program);
+	}
+
+} // end useProgram
+
+
+void GLStateCache::bindVertexArray(GLuint vertexArray)
+{
+	if (update(GLStateCache::vertexArray, vertexArray)) {
+
+		glBindVertexArray(vertexArray);
+
+		// Each vertex array has its own element array buffer
+		buffers[getBufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+	}
+
+} // end bindVertexArray
+
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+	int index = getBufferTargetIndex(target);
+
+	if (index < 0) {
+
+		issuedCount++;
+		glBindBuffer(target, buffer);
+	}
+	else if (update(buffers[index], buffer)) {
+
+		glBindBuffer(target, buffer);
+	}
+
+} // end bindBuffer
+
+
+void GLStateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+	if (target == GL_UNIFORM_BUFFER && index < UNIFORM_BINDINGS) {
+
+		BufferRange& range = uniformRanges[index];
+
+		if (range.buffer == buffer && range.offset == offset && range.size == size) {
+
+			skippedCount++;
+			return;
+		}
+
+		range.buffer = buffer;
+		range.offset = offset;
+		range.size = size;
+	}
+
+	issuedCount++;
+	glBindBufferRange(target, index, buffer, offset, size);
+
+	// The buffer is also bound to the target itself
+	int targetIndex = getBufferTargetIndex(target);
+
+	if (targetIndex >= 0) {
+		buffers[targetIndex] = buffer;
+	}
+
+} // end bindBufferRange
+
+
+void GLStateCache::activeTexture(GLenum unit)
+{
+	if (update(activeUnit, unit)) {
+
+		glActiveTexture(unit);
+	}
+
+} // end activeTexture
+
+
+void GLStateCache::bindTexture(GLenum target, GLuint texture)
+{
+	GLuint* cached = nullptr;
+
+	if (activeUnit != UNKNOWN && activeUnit - GL_TEXTURE0 < TEXTURE_UNITS) {
+
+		if (target == GL_TEXTURE_2D) {
+			cached = &textures2D[activeUnit - GL_TEXTURE0];
+		}
+		else if (target == GL_TEXTURE_2D_ARRAY) {
+			cached = &textureArrays[activeUnit - GL_TEXTURE0];
+		}
+	}
+	else {
+
+		// The unit the texture is bound to is not known so any of them may have changed
+		for (int i = 0; i < TEXTURE_UNITS; i++) {
+
+			textures2D[i] = UNKNOWN;
+			textureArrays[i] = UNKNOWN;
+		}
+	}
+
+	if (cached == nullptr) {
+
+		issuedCount++;
+		glBindTexture(target, texture);
+	}
+	else if (update(*cached, texture)) {
+
+		glBindTexture(target, texture);
+	}
+
+} // end bindTexture
+
+
+void GLStateCache::bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+	bool issue = false;
+
+	if (target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER) {
+
+		issue = issue || drawFramebuffer != framebuffer;
+		drawFramebuffer = framebuffer;
+	}
+
+	if (target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER) {
+
+		issue = issue || readFramebuffer != framebuffer;
+		readFramebuffer = framebuffer;
+	}
+
+	if (issue == true) {
+
+		issuedCount++;
+		glBindFramebuffer(target, framebuffer);
+	}
+	else {
+
+		skippedCount++;
+	}
+
+} // end bindFramebuffer
+
+
+GLuint GLStateCache::getFramebuffer(GLenum target)
+{
+	GLuint& cached = target == GL_READ_FRAMEBUFFER ? readFramebuffer : drawFramebuffer;
+
+	if (cached == UNKNOWN) {
+
+		GLint framebuffer = 0;
+		glGetIntegerv(target == GL_READ_FRAMEBUFFER ? GL_READ_FRAMEBUFFER_BINDING : GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+
+		cached = static_cast<GLuint>(framebuffer);
+	}
+
+	return cached;
+
+} // end getFramebuffer
+
+
+GLuint GLStateCache::getProgram()
+{
+	if (program == UNKNOWN) {
+
+		GLint currentProgram = 0;
+		glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
+
+		program = static_cast<GLuint>(currentProgram);
+	}
+
+	return program;
+
+} // end getProgram
+
+
+void GLStateCache::deleteBuffers(GLsizei count, const GLuint* buffers)
+{
+	for (GLsizei i = 0; i < count; i++) {
+
+		if (buffers[i] == 0) {
+			continue;
+		}
+
+		// Deleted buffers are unbound from the targets
+		for (auto& buffer : GLStateCache::buffers) {
+
+			if (buffer == buffers[i]) {
+				buffer = 0;
+			}
+		}
+
+		for (auto& range : uniformRanges) {
+
+			if (range.buffer == buffers[i]) {
+				range = BufferRange();
+			}
+		}
+	}
+
+	glDeleteBuffers(count, buffers);
+
+} // end deleteBuffers
+
+
+void GLStateCache::deleteVertexArrays(GLsizei count, const GLuint* vertexArrays)
+{
+	for (GLsizei i = 0; i < count; i++) {
+
+		if (vertexArrays[i] != 0 && vertexArrays[i] == vertexArray) {
+
+			vertexArray = 0;
+			buffers[getBufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+		}
+	}
+
+	glDeleteVertexArrays(count, vertexArrays);
+
+} // end deleteVertexArrays
+
+
+void GLStateCache::deleteTextures(GLsizei count, const GLuint* textures)
+{
+	for (GLsizei i = 0; i < count; i++) {
+
+		if (textures[i] == 0) {
+			continue;
+		}
+
+		// Deleted textures are unbound from every unit
+		for (int unit = 0; unit < TEXTURE_UNITS; unit++) {
+
+			if (textures2D[unit] == textures[i]) {
+				textures2D[unit] = 0;
+			}
+
+			if (textureArrays[unit] == textures[i]) {
+				textureArrays[unit] = 0;
+			}
+		}
+	}
+
+	glDeleteTextures(count, textures);
+
+} // end deleteTextures
+
+
+void GLStateCache::deleteFramebuffers(GLsizei count, const GLuint* framebuffers)
+{
+	for (GLsizei i = 0; i < count; i++) {
+
+		if (framebuffers[i] == 0) {
+			continue;
+		}
+
+		// Deleting a bound framebuffer binds the default one
+		if (drawFramebuffer == framebuffers[i]) {
+			drawFramebuffer = 0;
+		}
+
+		if (readFramebuffer == framebuffers[i]) {
+			readFramebuffer = 0;
+		}
+	}
+
+	glDeleteFramebuffers(count, framebuffers);
+
+} // end deleteFramebuffers
+
+
+void GLStateCache::resetCounts()
+{
+	issuedCount = 0;
+	skippedCount = 0;
+
+} // end resetCounts
+
+
+int GLStateCache::getBufferTargetIndex(GLenum target)
+{
+	switch (target) {
+
+	case GL_ARRAY_BUFFER: return 0;
+	case GL_ELEMENT_ARRAY_BUFFER: return 1;
+	case GL_UNIFORM_BUFFER: return 2;
+	case GL_DRAW_INDIRECT_BUFFER: return 3;
+	case GL_PIXEL_PACK_BUFFER: return 4;
+	case GL_COPY_READ_BUFFER: return 5;
+	case GL_COPY_WRITE_BUFFER: return 6;
+	default: return -1;
+	}
+
+} // end getBufferTargetIndex
+
+
+bool GLStateCache::update(GLuint& cached, GLuint value)
+{
+	if (cached == value && value != UNKNOWN) {
+
+		skippedCount++;
+		return false;
+	}
+
+	cached = value;
+	issuedCount++;
+
+	return true;
+
+} // end update
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "MathLibsConstsFuncs.h"
+
+/**
+ * @class	GLStateCache
+ *
+ * @brief	Remembers the program, vertex array, buffers, textures and framebuffers that are
+ * 			bound in the OpenGL context so that binding them again is skipped instead of
+ * 			being passed to the driver. Engine code binds these through the cache rather
+ * 			than calling OpenGL directly, otherwise the cache no longer matches the context.
+ *
+ * 			Objects must also be deleted through the cache since OpenGL unbinds deleted
+ * 			objects. Bindings that the cache does not know, such as those after the context
+ * 			was created, are always passed on.
+ *
+ * 			Counts the calls that were passed on and skipped until the counts are reset.
+ * 			Must be used on the thread that owns the OpenGL context.
+ */
+class GLStateCache
+{
+public:
+
+	/**
+	 * @fn	static void GLStateCache::invalidate();
+	 *
+	 * @brief	Forgets every binding so the next bind of each is passed on. Call when the
+	 * 			context is created or after code outside of the engine changes its state.
+	 */
+	static void invalidate();
+
+	/**
+	 * @fn	static void GLStateCache::useProgram(GLuint program);
+	 *
+	 * @brief	Replaces glUseProgram.
+	 */
+	static void useProgram(GLuint program);
+
+	/**
+	 * @fn	static void GLStateCache::bindVertexArray(GLuint vertexArray);
+	 *
+	 * @brief	Replaces glBindVertexArray. The element array buffer is part of the vertex
+	 * 			array, so it is forgotten when the vertex array changes.
+	 */
+	static void bindVertexArray(GLuint vertexArray);
+
+	/**
+	 * @fn	static void GLStateCache::bindBuffer(GLenum target, GLuint buffer);
+	 *
+	 * @brief	Replaces glBindBuffer. Targets the cache does not track are always passed on.
+	 */
+	static void bindBuffer(GLenum target, GLuint buffer);
+
+	/**
+	 * @fn	static void GLStateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+	 *
+	 * @brief	Replaces glBindBufferRange. Only uniform buffer binding points are tracked.
+	 * 			Also binds the buffer to the target like OpenGL does.
+	 */
+	static void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+	/**
+	 * @fn	static void GLStateCache::activeTexture(GLenum unit);
+	 *
+	 * @brief	Replaces glActiveTexture.
+	 */
+	static void activeTexture(GLenum unit);
+
+	/**
+	 * @fn	static void GLStateCache::bindTexture(GLenum target, GLuint texture);
+	 *
+	 * @brief	Replaces glBindTexture. Binds to the active texture unit. Two dimensional
+	 * 			textures and texture arrays are tracked on the first units.
+	 */
+	static void bindTexture(GLenum target, GLuint texture);
+
+	/**
+	 * @fn	static void GLStateCache::bindFramebuffer(GLenum target, GLuint framebuffer);
+	 *
+	 * @brief	Replaces glBindFramebuffer.
+	 */
+	static void bindFramebuffer(GLenum target, GLuint framebuffer);
+
+	/**
+	 * @fn	static GLuint GLStateCache::getFramebuffer(GLenum target);
+	 *
+	 * @brief	Gets the framebuffer bound to GL_DRAW_FRAMEBUFFER or GL_READ_FRAMEBUFFER.
+	 * 			Only queries OpenGL if the binding is not known.
+	 */
+	static GLuint getFramebuffer(GLenum target);
+
+	/**
+	 * @fn	static GLuint GLStateCache::getProgram();
+	 *
+	 * @brief	Gets the program in use. Only queries OpenGL if it is not known.
+	 */
+	static GLuint getProgram();
+
+	/**
+	 * @fn	static void GLStateCache::deleteBuffers(GLsizei count, const GLuint* buffers);
+	 *
+	 * @brief	Replaces glDeleteBuffers.
+	 */
+	static void deleteBuffers(GLsizei count, const GLuint* buffers);
+
+	/**
+	 * @fn	static void GLStateCache::deleteVertexArrays(GLsizei count, const GLuint* vertexArrays);
+	 *
+	 * @brief	Replaces glDeleteVertexArrays.
+	 */
+	static void deleteVertexArrays(GLsizei count, const GLuint* vertexArrays);
+
+	/**
+	 * @fn	static void GLStateCache::deleteTextures(GLsizei count, const GLuint* textures);
+	 *
+	 * @brief	Replaces glDeleteTextures.
+	 */
+	static void deleteTextures(GLsizei count, const GLuint* textures);
+
+	/**
+	 * @fn	static void GLStateCache::deleteFramebuffers(GLsizei count, const GLuint* framebuffers);
+	 *
+	 * @brief	Replaces glDeleteFramebuffers.
+	 */
+	static void deleteFramebuffers(GLsizei count, const GLuint* framebuffers);
+
+	/**
+	 * @fn	static void GLStateCache::resetCounts();
+	 *
+	 * @brief	Sets the counts of issued and skipped calls to zero. Called once per frame.
+	 */
+	static void resetCounts();
+
+	/** @brief	Calls passed on to OpenGL since the counts were reset */
+	static unsigned int getIssuedCount() { return issuedCount; }
+
+	/** @brief	Calls skipped because the state was already set since the counts were reset */
+	static unsigned int getSkippedCount() { return skippedCount; }
+
+protected:
+
+	/**
+	 * @fn	static int GLStateCache::getBufferTargetIndex(GLenum target);
+	 *
+	 * @brief	Gets the slot of a buffer target in the cache.
+	 *
+	 * @returns	Negative for targets that are not tracked.
+	 */
+	static int getBufferTargetIndex(GLenum target);
+
+	/**
+	 * @fn	static bool GLStateCache::update(GLuint& cached, GLuint value);
+	 *
+	 * @brief	Counts the call and stores the value if it differs from the cached one.
+	 *
+	 * @returns	True if the call must be passed on.
+	 */
+	static bool update(GLuint& cached, GLuint value);
+
+	/** @brief	Marks bindings that are not known */
+	static const GLuint UNKNOWN = 0xFFFFFFFF;
+
+	static const int BUFFER_TARGETS = 7;
+
+	static const int TEXTURE_UNITS = 16;
+
+	static const int UNIFORM_BINDINGS = 32;
+
+	/**
+	 * @struct	BufferRange
+	 *
+	 * @brief	Range of a buffer bound to an indexed binding point.
+	 */
+	struct BufferRange {
+
+		GLuint buffer = UNKNOWN;
+
+		GLintptr offset = 0;
+
+		GLsizeiptr size = 0;
+
+	}; // end BufferRange
+
+	static GLuint program;
+
+	static GLuint vertexArray;
+
+	static GLuint buffers[BUFFER_TARGETS];
+
+	static BufferRange uniformRanges[UNIFORM_BINDINGS];
+
+	static GLuint activeUnit;
+
+	/** @brief	Two dimensional textures and texture arrays bound to each unit */
+	static GLuint textures2D[TEXTURE_UNITS];
+
+	static GLuint textureArrays[TEXTURE_UNITS];
+
+	static GLuint drawFramebuffer;
+
+	static GLuint readFramebuffer;
+
+	static unsigned int issuedCount;
+
+	static unsigned int skippedCount;
+
+}; // end GLStateCache class
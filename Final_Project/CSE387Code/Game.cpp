@@ -1,5 +1,6 @@
 #include "Game.h"
 #include <algorithm>
+#include <cmath>
 
 #include "SoundEngine.h"
 #include "PhysicsEngine.h"
@@ -12,7 +13,15 @@
 #include "SharedGeneralLighting.h"
 #include "SharedMaterialProperties.h"
 #include "SharedProjectionAndViewing.h"
+#include "GLStateCache.h"
+#include "CpuProfiler.h"
+#include "EngineCounters.h"
 #include "BuildShaderProgram.h"
+#include "ShaderVariants.h"
+#include "OcclusionCuller.h"
+#include "MeshletSet.h"
+#include "ImpostorAtlas.h"
+#include "TextureManager.h"
 #include "CameraComponent.h"
 
 #include "SimpleMoveComponent.h"
@@ -35,6 +44,8 @@ RigidBodyComponent* rg;
 
 #define VERBOSE false
 
+bool Game::headless = false;
+
 
 //********************* Static Function declarations *****************************************
 
@@ -72,6 +83,9 @@ Game::Game(std::string windowTitle)
 
 Game::~Game()
 {
+	// Batches are deleted first so they are not rebuilt as each static mesh is deleted
+	staticBatcher.clear();
+
 	// Delete gameObjects
 	while (!this->sceneNode.getChildren().empty()) {
 
@@ -89,11 +103,14 @@ Game::~Game()
 
 bool Game::initialize()
 {
-	bool windowInit = initializeRenderWindow();
+	CpuProfiler::setThreadName("Update");
+
+	bool windowInit = headless || initializeRenderWindow();
 
-	bool graphicsInit = initializeGraphics();
+	bool graphicsInit = headless || initializeGraphics();
 
-	bool soundInit = SoundEngine::Init();
+	// Sounds are mixed without output so headless games can run faster than real time
+	bool soundInit = SoundEngine::Init(headless);
 
 	bool physicsInit = PhysicsEngine::Init();
 
@@ -103,7 +120,55 @@ bool Game::initialize()
 
 		initializeGameObjects();
 
-		framebuffer_size_callback(this->renderWindow, initialScreenWidth, initialScreenHeight);
+		if (headless == true) {
+
+			// Nothing is rendered so updates are not paced
+			frameScheduler.setRealTime(false);
+
+			return true;
+		}
+
+		// Merge the meshes of objects that never move
+		staticBatcher.build(this->meshComps);
+
+		// Build the shader variants needed by the initial scene together
+		ShaderVariants::updateLighting(SharedGeneralLighting::getLights());
+
+		std::vector<std::pair<GLuint, const Material*>> programMaterials;
+
+		for (auto mesh : this->meshComps) {
+
+			mesh->getProgramMaterials(programMaterials);
+		}
+
+		// Meshes of the deferred pipeline use variants of the program that writes the G-buffer
+		if (deferredRenderer.isInitialized()) {
+
+			for (auto& programMaterial : programMaterials) {
+
+				programMaterial.first = deferredRenderer.getGeometryProgram();
+			}
+		}
+
+		ShaderVariants::buildVariants(programMaterials);
+
+		// The resolution drops when rendering the scene takes longer than a frame
+		dynamicResolution.setTargetGpuTime(FRAME_INTERVAL);
+
+		if (offscreen == true) {
+
+			// Cameras use the size of the render target
+			if (renderTarget.create(framebufferWidth, framebufferHeight) == false) {
+				return false;
+			}
+		}
+		else {
+
+			// The framebuffer may be larger than the window on high resolution displays
+			int width, height;
+			glfwGetFramebufferSize(this->renderWindow, &width, &height);
+			framebuffer_size_callback(this->renderWindow, width, height);
+		}
 
 		return true;
 	}
@@ -132,9 +197,15 @@ bool Game::initializeRenderWindow()
 	glfwWindowHint(GLFW_CONTEXT_RELEASE_BEHAVIOR, GLFW_RELEASE_BEHAVIOR_FLUSH);
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_API);
 	glfwWindowHint(GLFW_DOUBLEBUFFER, GLFW_TRUE);
+	glfwWindowHint(GLFW_CONTEXT_CREATION_API, contextCreationApi);
+
+	// Offscreen games only need the window for its context
+	if (offscreen == true) {
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	}
 
 	// Create rendering window and the OpenGL context.
-	this->renderWindow = glfwCreateWindow(initialScreenWidth, initialScreenHeight, this->windowTitle.c_str(), NULL, NULL);
+	this->renderWindow = glfwCreateWindow(framebufferWidth, framebufferHeight, this->windowTitle.c_str(), NULL, NULL);
 
 	if (!renderWindow) {
 		glfwTerminate();
@@ -143,6 +214,9 @@ bool Game::initializeRenderWindow()
 
 	glfwMakeContextCurrent(renderWindow);
 
+	// Nothing is known about the bindings of the new context
+	GLStateCache::invalidate();
+
 	// When sticky keys mode is enabled, the pollable state of a key will remain 
 	// GLFW_PRESS until the state of that key is polled with glfwGetKey. Once it 
 	// has been polled, if a key release event had been processed in the meantime,
@@ -150,8 +224,8 @@ bool Game::initializeRenderWindow()
 	glfwSetInputMode(renderWindow, GLFW_STICKY_KEYS, GLFW_TRUE);
 
 	// Set the swap interval for the OpenGL context i.e. the number of screen updates 
-	// to wait between before swapping the buffer and returning.
-	glfwSwapInterval(1);
+	// to wait between before swapping the buffer and returning. Offscreen games do not swap.
+	glfwSwapInterval(offscreen ? 0 : 1);
 
 	if (VERBOSE) cout << "Render Window Initialized" << endl;
 
@@ -181,6 +255,15 @@ bool Game::initializeGraphics()
 	glCullFace(GL_BACK);
 	glEnable(GL_CULL_FACE);
 
+	// Program that builds the depth pyramids used for occlusion culling
+	OcclusionCuller::loadShaders();
+
+	// Position only program used by depth pre-passes
+	RenderQueue::loadShaders();
+
+	// Program that renders the impostor atlases of models as they are loaded
+	ImpostorAtlas::loadShaders();
+
 	if (VERBOSE) cout << "Graphics Initialized" << endl;
 
 	// Display OpenGL context information (OpenGL and GLSL versions) on the
@@ -194,8 +277,7 @@ bool Game::initializeGraphics()
 
  void Game::loadData()
 {
-	 // Set the clear color
-	 glClearColor(static_cast<GLclampf>(0.2), static_cast<GLclampf>(0.5), static_cast<GLclampf>(0.8), static_cast<GLclampf>(1.0));
+	 CPU_PROFILE_SCOPE("Game::loadData");
 
 	 // Build shader program
 	 ShaderInfo shaders[] = {
@@ -204,13 +286,38 @@ bool Game::initializeGraphics()
 		 { GL_NONE, NULL } // signals that there are no more shaders 
 	 };
 
-	 GLuint shaderProgram = BuildShaderProgram(shaders);
+	 // Meshes of headless games are never rendered and have no shader program
+	 GLuint shaderProgram = 0;
+
+	 if (headless == false) {
+
+		 // Set the clear color
+		 glClearColor(static_cast<GLclampf>(0.2), static_cast<GLclampf>(0.5), static_cast<GLclampf>(0.8), static_cast<GLclampf>(1.0));
+
+		 shaderProgram = BuildShaderProgram(shaders);
+
+		 GLStateCache::useProgram(shaderProgram);
+
+		 SharedProjectionAndViewing::setUniformBlockForShader(shaderProgram);
+		 SharedMaterialProperties::setUniformBlockForShader(shaderProgram);
+		 SharedGeneralLighting::setUniformBlockForShader(shaderProgram);
+
+		 // Allow specialized versions of the program to be built for each material
+		 ShaderVariants::registerShaders(shaderProgram, shaders);
+
+		 if (deferredShading == true && deferredRenderer.initialize() == false) {
 
-	 glUseProgram(shaderProgram);
+			 std::cerr << "Falling back to forward shading." << std::endl;
+		 }
 
-	 SharedProjectionAndViewing::setUniformBlockForShader(shaderProgram);
-	 SharedMaterialProperties::setUniformBlockForShader(shaderProgram);
-	 SharedGeneralLighting::setUniformBlockForShader(shaderProgram);
+		 if (impostorRenderer.initialize() == false) {
+
+			 ImpostorRenderer::setEnabled(false);
+		 }
+
+		 // Without its program the overlay is not drawn but frames are still sampled
+		 statsOverlay.initialize();
+	 }
 /*
 	 SharedGeneralLighting::setAmbientColor(GL_LIGHT_ZERO, vec4(0.1f, 0.1f, 0.1f, 1.0f));
 	 SharedGeneralLighting::setDiffuseColor(GL_LIGHT_ZERO, vec4(1.0f, 1.0f, 1.0f, 1.0f));
@@ -346,74 +453,642 @@ void Game::bindCallBacks()
 
 } // end bindCallBacks
 
+void Game::setOffscreen(int width, int height, int contextCreationApi)
+{
+	this->offscreen = true;
+	this->contextCreationApi = contextCreationApi;
+
+	framebufferWidth = width;
+	framebufferHeight = height;
+
+} // end setOffscreen
+
+
+void Game::setCaptureDirectory(const std::string& directory)
+{
+	frameCapture.setCallback([directory](unsigned int frameNumber, GLsizei width, GLsizei height, const GLubyte* pixels) {
+
+		char fileName[32];
+		snprintf(fileName, sizeof(fileName), "frame_%05u.png", frameNumber);
+
+		FrameCapture::saveImage(directory + "/" + fileName, width, height, pixels);
+	});
+
+} // end setCaptureDirectory
+
 //********************* Run Methods *****************************************
 
 void Game::gameLoop()
 {
+	// The render thread takes over the OpenGL context
+	if (renderThreadEnabled == true && headless == false) {
+
+		renderThread.start(renderWindow, [this](const RenderSnapshot& snapshot) { renderScene(snapshot); });
+	}
+
+	// Time spent loading is not simulated
+	frameScheduler.reset();
+
 	while (isRunning) {
 
-		updateGame();
-		renderScene();
+		// Sleeps until the next frame is due
+		int steps = frameScheduler.beginFrame();
+
+		// Must be called in order for callback functions
+		// to be called for registered events.
+		if (headless == false) {
+			glfwPollEvents();
+		}
+
+		for (int step = 0; step < steps && isRunning; step++) {
+
+			updateGame(static_cast<float>(frameScheduler.getFixedTimeStep()));
+
+			if (stepLimit > 0 && --stepLimit == 0) {
+				isRunning = false;
+			}
+		}
+
+		// Nothing can be seen while the window is minimized
+		if (headless == true || framebufferWidth == 0 || framebufferHeight == 0) {
+			continue;
+		}
+
+		if (renderThread.isRunning()) {
+
+			// Waits if the render thread is two frames behind
+			buildSnapshot(renderThread.beginSnapshot(), frameScheduler.getInterpolation());
+			renderThread.submitSnapshot();
+		}
+		else {
+
+			buildSnapshot(singleThreadSnapshot, frameScheduler.getInterpolation());
+			renderScene(singleThreadSnapshot);
+		}
 	}
 
+	// Finish rendering and take the OpenGL context back
+	renderThread.stop();
+
 	shutdown();
 
 } // end gameLoop
 
 
 
-void Game::updateGame()
+void Game::updateGame(float deltaTime)
+{
+	CPU_PROFILE_SCOPE("Game::updateGame");
+	EngineCounters::Timer timer(EngineCounters::UPDATE_TIME);
+
+	// Frames are interpolated from where objects were before this update
+	this->sceneNode.savePreviousTransformations();
+
+	PhysicsEngine::Update(deltaTime);
+
+	// Update the scene graph. The sceneGraphNode held by the game is the root.
+	this->sceneNode.updateSceneGraph(deltaTime);
+
+	// Updates the FMOD system based on the current position and orientations
+	// of the SoundSources and SoundListeners
+	SoundEngine::Update( deltaTime );
+
+} // end updateGame()
+
+void Game::buildSnapshot(RenderSnapshot& snapshot, float interpolation)
 {
-	// Compute delta time
-	static double lastRenderTime = glfwGetTime();
-	double currentTime = glfwGetTime();
-	float deltaTime = static_cast<float>(currentTime - lastRenderTime);
+	CPU_PROFILE_SCOPE("Game::buildSnapshot");
+
+	snapshot.interpolation = interpolation;
+	snapshot.framebufferWidth = framebufferWidth;
+	snapshot.framebufferHeight = framebufferHeight;
 
-	if (deltaTime > 0.05f) {
-		deltaTime = 0.05f;
+	// Lights are rendered as they were at the end of the update
+	snapshot.lightsChanged = SharedGeneralLighting::copyLights(snapshot.lights);
+
+	snapshot.meshes.clear();
+	snapshot.subMeshes.clear();
+	snapshot.materials.clear();
+
+	for (auto mesh : this->meshComps) {
+
+		mesh->addToSnapshot(snapshot);
 	}
 
-	if (deltaTime >= FRAME_INTERVAL) {
+	// Views are reused so their lists of visible meshes keep their memory
+	snapshot.cameras.resize(CameraComponent::activeCameras.size());
 
-		// Must be called in order for callback functions
-		// to be called for registered events.
-		glfwPollEvents();
+	for (size_t i = 0; i < CameraComponent::activeCameras.size(); i++) {
 
-		PhysicsEngine::Update(deltaTime);
+		CameraView& view = snapshot.cameras[i];
 
-		// Update the scene graph. The sceneGraphNode held by the game is the root.
-		this->sceneNode.updateSceneGraph(deltaTime);
+		// Compute the transformations of cameras that moved or whose viewports changed
+		CameraComponent::activeCameras[i]->updateCameraData(view, interpolation);
 
-		// Updates the FMOD system based on the current position and orientations
-		// of the SoundSources and SoundListeners
-		SoundEngine::Update( deltaTime );
+		// Meshes outside of the view of the camera are skipped
+		view.visibleMeshes.clear();
 
-		// Save current time to determine when the scene should be rendered next
-		lastRenderTime = currentTime;
+		for (unsigned int meshIndex = 0; meshIndex < snapshot.meshes.size(); meshIndex++) {
+
+			const MeshDraw& meshDraw = snapshot.meshes[meshIndex];
+
+			if (meshDraw.boundingRadius < 0.0f || view.frustum.intersectsSphere(meshDraw.boundingCenter, meshDraw.boundingRadius)) {
+
+				view.visibleMeshes.push_back(meshIndex);
+			}
+		}
 	}
 
-} // end updateGame()
+} // end buildSnapshot
 
-void Game::renderScene()
+
+void Game::renderScene(const RenderSnapshot& snapshot)
 {
-	// clear the both the color and depth buffers
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	CPU_PROFILE_SCOPE("Game::renderScene");
 
-	for (auto camera : CameraComponent::activeCameras) {
+	// Counters are taken before the timer of this frame starts so they cover the whole last frame
+	statsOverlay.sample(frameStats);
+	EngineCounters::Timer timer(EngineCounters::RENDER_TIME);
 
-		camera->setViewingTransformation();
+	// Framebuffer that receives the finished frame
+	GLuint outputFramebuffer = offscreen ? renderTarget.getFramebuffer() : 0;
+	GLsizei outputWidth = offscreen ? renderTarget.getWidth() : snapshot.framebufferWidth;
+	GLsizei outputHeight = offscreen ? renderTarget.getHeight() : snapshot.framebufferHeight;
 
-		for (auto mesh : this->meshComps) {
+	// The scale does not change while a frame is rendered
+	float resolutionScale = dynamicResolution.isEnabled() ? dynamicResolution.getScale() : 1.0f;
 
-			mesh->draw();
-		}
+	unsigned int frameNumber = frameStats.frameNumber + 1;
+	frameStats = FrameStats();
+	frameStats.frameNumber = frameNumber;
+
+	gpuProfiler.beginFrame();
+
+	// The passes of the frame are declared again every frame
+	frameGraph.reset();
+	frameGraph.setProfiler(&gpuProfiler);
+
+	FrameGraph::Resource output = frameGraph.importFramebuffer("Output", outputFramebuffer, outputWidth, outputHeight);
+
+	// The scene is rendered into the output unless it is rendered at a lower resolution
+	FrameGraph::Resource sceneColor = output;
+	FrameGraph::Resource sceneDepth = -1;
+
+	std::vector<FrameGraph::Resource> gBuffer;
+
+	frameGraph.addPass("Scene",
+		[&](FrameGraph::PassBuilder& builder) {
+
+			FrameGraph::TextureDesc sceneDesc;
+			sceneDesc.width = outputWidth;
+			sceneDesc.height = outputHeight;
+
+			if (dynamicResolution.isEnabled()) {
+
+				// Sized for the largest scale so changing the scale never reallocates it
+				float maxScale = dynamicResolution.getMaxScale();
+				sceneDesc.width = std::max(1, static_cast<int>(std::ceil(outputWidth * maxScale)));
+				sceneDesc.height = std::max(1, static_cast<int>(std::ceil(outputHeight * maxScale)));
+
+				sceneDesc.format = GL_RGBA8;
+				sceneColor = builder.create("Scene Color", sceneDesc);
+
+				sceneDesc.format = GL_DEPTH_COMPONENT32F;
+				sceneDepth = builder.create("Scene Depth", sceneDesc);
+			}
+			else {
+
+				builder.write(output);
+			}
+
+			// The G-buffer matches the framebuffer the scene is rendered into
+			if (deferredRenderer.isInitialized()) {
+
+				sceneDesc.format = DeferredRenderer::getColorFormat();
+
+				for (int i = 0; i < DeferredRenderer::getColorTextureCount(); i++) {
+
+					gBuffer.push_back(builder.create("G-Buffer " + std::to_string(i), sceneDesc));
+				}
+
+				sceneDesc.format = DeferredRenderer::getDepthFormat();
+				gBuffer.push_back(builder.create("G-Buffer Depth", sceneDesc));
+			}
+		},
+		[&](const FrameGraph::PassResources& resources) {
+
+			if (sceneDepth >= 0) {
+
+				GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, resources.getFramebuffer({ sceneColor, sceneDepth }));
+
+				dynamicResolution.beginFrame();
+			}
+			else {
+
+				GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+			}
+
+			if (gBuffer.empty() == false) {
+
+				GLuint gBufferFramebuffer = resources.getFramebuffer(gBuffer);
+
+				if (gBufferFramebuffer != 0) {
+
+					std::vector<GLuint> colorTextures;
+
+					for (size_t i = 0; i + 1 < gBuffer.size(); i++) {
+
+						colorTextures.push_back(resources.getTexture(gBuffer[i]));
+					}
+
+					deferredRenderer.setGBuffer(gBufferFramebuffer, colorTextures, resources.getTexture(gBuffer.back()));
+				}
+				else {
+
+					std::cerr << "Falling back to forward shading." << std::endl;
+					deferredRenderer.destroy();
+				}
+			}
+
+			// clear the both the color and depth buffers
+			gpuProfiler.beginScope("Clear");
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			gpuProfiler.endScope();
+
+			// Copy lights that changed during the update into the uniform buffer
+			if (snapshot.lightsChanged) {
+
+				SharedGeneralLighting::setBufferData(snapshot.lights);
+			}
+
+			// Lights that were turned on or off select different shader variants
+			ShaderVariants::updateLighting(snapshot.lights);
+
+			// Copy the transformations of cameras that moved or whose viewports changed
+			for (auto& view : snapshot.cameras) {
+
+				if (view.cameraChanged) {
+
+					SharedProjectionAndViewing::setCamera(view.cameraSlot, view.viewMatrix, view.projectionMatrix);
+				}
+			}
+
+			for (size_t i = 0; i < snapshot.cameras.size(); i++) {
+
+				gpuProfiler.beginScope("Camera " + std::to_string(i));
+				renderCameraView(snapshot, snapshot.cameras[i], resolutionScale);
+				gpuProfiler.endScope();
+			}
+
+			if (sceneDepth >= 0) {
+
+				dynamicResolution.endFrame();
+
+				frameStats.gpuTime = std::max(dynamicResolution.getGpuTime(), 0.0);
+			}
+
+			// Stream texture mip levels based on what was rendered and enforce the memory budget
+			TextureManager::update();
+		});
+
+	// Upscale the part of the scene color that was rendered into
+	if (sceneColor != output) {
+
+		frameGraph.addPass("Upscale",
+			[&](FrameGraph::PassBuilder& builder) {
+
+				builder.read(sceneColor);
+				builder.write(output);
+			},
+			[&](const FrameGraph::PassResources& resources) {
+
+				GLStateCache::bindFramebuffer(GL_READ_FRAMEBUFFER, resources.getFramebuffer({ sceneColor }));
+				GLStateCache::bindFramebuffer(GL_DRAW_FRAMEBUFFER, outputFramebuffer);
+
+				glBlitFramebuffer(0, 0, static_cast<GLint>(std::lround(outputWidth * resolutionScale)), static_cast<GLint>(std::lround(outputHeight * resolutionScale)),
+								  0, 0, outputWidth, outputHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+				GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+			});
+	}
+
+	// Read the output before it is swapped
+	if (frameCapture.isEnabled()) {
+
+		frameGraph.addPass("Capture",
+			[&](FrameGraph::PassBuilder& builder) {
+
+				builder.read(output);
+				builder.setSideEffect();
+			},
+			[&](const FrameGraph::PassResources& resources) {
+
+				frameCapture.capture(outputFramebuffer, offscreen ? GL_COLOR_ATTACHMENT0 : GL_BACK, outputWidth, outputHeight);
+			});
+	}
+
+	// Drawn after the capture so captured frames do not include it
+	if (StatsOverlay::isVisible() && statsOverlay.isInitialized()) {
+
+		frameGraph.addPass("Stats Overlay",
+			[&](FrameGraph::PassBuilder& builder) {
+
+				builder.write(output);
+			},
+			[&](const FrameGraph::PassResources& resources) {
+
+				GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+
+				statsOverlay.draw(outputWidth, outputHeight);
+			});
+	}
+
+	if (offscreen == false) {
+
+		frameGraph.addPass("Present",
+			[&](FrameGraph::PassBuilder& builder) {
+
+				builder.write(output);
+				builder.setSideEffect();
+			},
+			[&](const FrameGraph::PassResources& resources) {
+
+				// flush all drawing commands and swap the front and back buffers
+				glfwSwapBuffers(renderWindow);
+			});
 	}
 
-	// flush all drawing commands and swap the front and back buffers
-	glfwSwapBuffers(renderWindow);
+	if (frameGraph.compile()) {
+
+		frameGraph.execute();
+	}
+
+	gpuProfiler.endFrame();
+
+	frameStats.resolutionScale = resolutionScale;
+	frameStats.renderPasses = frameGraph.getExecutedPassCount();
+	frameStats.culledPasses = frameGraph.getCulledPassCount();
+	frameStats.transientTextures = frameGraph.getPooledTextureCount();
+
+	// Counts every bind since the last frame finished, including those made before rendering
+	frameStats.stateCallsIssued = GLStateCache::getIssuedCount();
+	frameStats.stateCallsSkipped = GLStateCache::getSkippedCount();
+	GLStateCache::resetCounts();
+
+	{
+		std::lock_guard<std::mutex> lock(frameStatsMutex);
+		finishedFrameStats = frameStats;
+	}
 
 } // end renderScene
 
+
+void Game::renderCameraView(const RenderSnapshot& snapshot, const CameraView& view, float resolutionScale)
+{
+	// Scale the edges rather than the size so the viewports of cameras that share an edge still meet
+	GLint left = static_cast<GLint>(std::lround(view.viewport[0] * resolutionScale));
+	GLint bottom = static_cast<GLint>(std::lround(view.viewport[1] * resolutionScale));
+	GLint right = static_cast<GLint>(std::lround((view.viewport[0] + view.viewport[2]) * resolutionScale));
+	GLint top = static_cast<GLint>(std::lround((view.viewport[1] + view.viewport[3]) * resolutionScale));
+
+	GLint viewport[4] = { left, bottom, right - left, top - bottom };
+
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+	frameStats.cameras++;
+
+	if (view.depthPrepass && RenderQueue::hasDepthProgram()) {
+		frameStats.depthPrepassCameras++;
+	}
+
+	if (view.frontToBack) {
+		frameStats.frontToBackCameras++;
+	}
+
+	// Textures only need the detail of the scaled resolution
+	TextureManager::setViewportHeight(viewport[3]);
+
+	// Projection and viewing transformations were copied into the slot of the camera
+	SharedProjectionAndViewing::useCamera(view.cameraSlot);
+
+	// Meshes write their materials into the G-buffer instead of being shaded
+	if (deferredRenderer.isInitialized()) {
+
+		deferredRenderer.beginGeometry(viewport);
+	}
+
+	OcclusionCuller& occlusionCuller = *view.occlusionCuller;
+
+	bool occlusionEnabled = OcclusionCuller::isEnabled();
+
+	// The first pass renders the static geometry and the meshes that were visible in the last
+	// frame. Sub-meshes are sorted to minimize state changes.
+	renderQueue.clear();
+
+	for (auto meshIndex : view.visibleMeshes) {
+
+		const MeshDraw& meshDraw = snapshot.meshes[meshIndex];
+
+		if (occlusionEnabled == false || occlusionCuller.wasVisible(meshDraw.mesh)) {
+
+			queueMeshDraw(snapshot, meshDraw);
+		}
+	}
+
+	staticBatcher.addToRenderQueue(renderQueue, view.frustum, deferredRenderer.getGeometryProgram());
+
+	drawRenderQueue(view);
+
+	if (occlusionEnabled == true) {
+
+		// The depth of the first pass hides the meshes behind it
+		gpuProfiler.beginScope("Depth Pyramid");
+		occlusionCuller.buildDepthPyramid(viewport[0], viewport[1], viewport[2], viewport[3],
+										  view.projectionMatrix * view.viewMatrix);
+		gpuProfiler.endScope();
+
+		// The second pass renders meshes that were hidden in the last frame and are now visible
+		renderQueue.clear();
+
+		for (auto meshIndex : view.visibleMeshes) {
+
+			const MeshDraw& meshDraw = snapshot.meshes[meshIndex];
+
+			// Meshes without bounds are always visible
+			if (meshDraw.boundingRadius >= 0.0f &&
+				occlusionCuller.isOccluded(meshDraw.boundingCenter - glm::vec3(meshDraw.boundingRadius),
+										   meshDraw.boundingCenter + glm::vec3(meshDraw.boundingRadius)) == true) {
+				continue;
+			}
+
+			occlusionCuller.setVisible(meshDraw.mesh);
+
+			if (occlusionCuller.wasVisible(meshDraw.mesh) == false) {
+
+				queueMeshDraw(snapshot, meshDraw);
+			}
+		}
+
+		drawRenderQueue(view);
+
+		occlusionCuller.endFrame();
+	}
+
+	// Lights are added to the framebuffer of the scene from the G-buffer
+	if (deferredRenderer.isInitialized()) {
+
+		gpuProfiler.beginScope("Lights");
+		frameStats.lightPasses += deferredRenderer.shadeLights(view, viewport, snapshot.lights);
+		gpuProfiler.endScope();
+	}
+
+	// Distant meshes are drawn as impostors lit the same way in both pipelines
+	gpuProfiler.beginScope("Impostors");
+	frameStats.impostors += impostorRenderer.draw();
+	gpuProfiler.endScope();
+
+} // end renderCameraView
+
+
+void Game::queueMeshDraw(const RenderSnapshot& snapshot, const MeshDraw& meshDraw)
+{
+	// Approximate size of the mesh on the screen
+	float screenSize = std::numeric_limits<float>::max();
+
+	if (meshDraw.boundingRadius >= 0.0f) {
+
+		screenSize = MeshComponent::getProjectedSize(meshDraw.boundingCenter, meshDraw.boundingRadius);
+	}
+
+	// Distance to the nearest extent of the mesh orders the draws front to back
+	glm::vec3 center = glm::vec3(meshDraw.modelingTransformation[3]);
+	float radius = 0.0f;
+
+	if (meshDraw.boundingRadius >= 0.0f) {
+
+		center = meshDraw.boundingCenter;
+		radius = meshDraw.boundingRadius;
+	}
+
+	float viewDepth = -(SharedProjectionAndViewing::getViewMatrix() * glm::vec4(center, 1.0f)).z - radius;
+
+	// Small meshes are drawn as impostors. Both are drawn while they cross-fade.
+	float fade = 1.0f;
+	if (meshDraw.impostor != nullptr && ImpostorRenderer::isEnabled() && meshDraw.boundingRadius >= 0.0f) {
+
+		fade = ImpostorRenderer::getMeshFade(screenSize);
+
+		if (fade < 1.0f) {
+
+			glm::vec3 eyePosition = glm::vec3(glm::inverse(SharedProjectionAndViewing::getViewMatrix())[3]);
+
+			impostorRenderer.add(*meshDraw.impostor, meshDraw.modelingTransformation, eyePosition, fade);
+		}
+
+		if (fade <= 0.0f) {
+			return;
+		}
+	}
+
+	// The deferred pipeline renders every mesh with the program that writes the G-buffer
+	GLuint baseProgram = deferredRenderer.isInitialized() ? deferredRenderer.getGeometryProgram() : meshDraw.shaderProgram;
+
+	// Meshlets are culled in object coordinates. Computed for the first sub-mesh that has them.
+	bool clusterSpace = false;
+	glm::mat4 modelViewProjection;
+	glm::vec3 objectEyePosition;
+	bool backFaceCulling = true;
+
+	for (size_t i = 0; i < meshDraw.subMeshCount; i++) {
+
+		SubMesh* subMesh = snapshot.subMeshes[meshDraw.firstSubMesh + i];
+
+		// The copy of the material is rendered so the material can change during the frame
+		const Material* material = &snapshot.materials[meshDraw.firstSubMesh + i];
+
+		material->requestTextureDetail(screenSize);
+
+		int clusterJob = -1;
+
+		if (subMesh->meshlets != nullptr && ClusterCuller::isEnabled()) {
+
+			if (clusterSpace == false) {
+
+				glm::mat4 viewMatrix = SharedProjectionAndViewing::getViewMatrix();
+
+				modelViewProjection = SharedProjectionAndViewing::getProjectionMatrix() * viewMatrix * meshDraw.modelingTransformation;
+				objectEyePosition = glm::vec3(glm::inverse(viewMatrix * meshDraw.modelingTransformation)[3]);
+
+				// Mirrored meshes show the other side of their triangles
+				backFaceCulling = glm::determinant(glm::mat3(meshDraw.modelingTransformation)) > 0.0f;
+
+				clusterSpace = true;
+			}
+
+			clusterJob = clusterCuller.addJob(subMesh->meshlets, modelViewProjection, objectEyePosition, backFaceCulling);
+		}
+
+		// Each material is rendered with the variant of the shader program that matches it
+		renderQueue.addItem(subMesh, material, ShaderVariants::getProgram(baseProgram, material), meshDraw.modelingTransformation, viewDepth, clusterJob, fade);
+	}
+
+} // end queueMeshDraw
+
+
+void Game::drawRenderQueue(const CameraView& view)
+{
+	bool depthPrepass = view.depthPrepass && RenderQueue::hasDepthProgram();
+
+	// Only the meshlets of large sub-meshes that can be seen are drawn
+	if (clusterCuller.getJobCount() > 0) {
+
+		clusterCuller.cull();
+		renderQueue.resolveClusters(clusterCuller);
+		clusterCuller.clear();
+
+		frameStats.testedClusters += clusterCuller.getTestedCount();
+		frameStats.visibleClusters += clusterCuller.getVisibleCount();
+	}
+
+	renderQueue.sort(view.frontToBack);
+
+	if (depthPrepass) {
+
+		gpuProfiler.beginScope("Depth Pre-Pass");
+		renderQueue.drawDepth();
+		gpuProfiler.endScope();
+
+		frameStats.depthPrepassDrawCalls += renderQueue.getItemCount();
+
+		// Only the fragments that set the depth are shaded. Depth is already written.
+		glDepthFunc(GL_EQUAL);
+		glDepthMask(GL_FALSE);
+	}
+
+	// Writes the G-buffer in the deferred pipeline
+	gpuProfiler.beginScope("Meshes");
+	renderQueue.draw();
+	gpuProfiler.endScope();
+
+	frameStats.drawCalls += renderQueue.getItemCount();
+
+	if (depthPrepass) {
+
+		glDepthFunc(GL_LESS);
+		glDepthMask(GL_TRUE);
+	}
+
+} // end drawRenderQueue
+
+
+FrameStats Game::getFrameStats()
+{
+	std::lock_guard<std::mutex> lock(frameStatsMutex);
+
+	return finishedFrameStats;
+
+} // end getFrameStats
+
 GameObject* Game::findGameObjectByName(string name)
 {
 	// Traverse the scene graph to find a game object
@@ -435,6 +1110,9 @@ void Game::addMeshComp(MeshComponent* mesh)
 
 void Game::removeMeshComp(MeshComponent* mesh)
 {
+	// Batches the mesh was merged into are rebuilt without it
+	staticBatcher.remove(mesh);
+
 	auto iter = std::find(meshComps.begin(), meshComps.end(), mesh);
 
 	if (iter != meshComps.end()) {
@@ -459,11 +1137,30 @@ void Game::unloadData()
 
 void Game::shutdown()
 {
-	// Destroy the window
-	glfwDestroyWindow(renderWindow);
+	// Texture levels still being read are not uploaded
+	TextureManager::stopStreaming();
+
+	if (headless == false) {
+
+		// Frames still being read back are handed to the capture callback
+		frameCapture.flush();
+		frameCapture.clear();
 
-	// Frees all remaining resources allocated by GLFW
-	glfwTerminate();
+		renderTarget.destroy();
+		frameGraph.destroy();
+		clusterCuller.destroy();
+		impostorRenderer.destroy();
+		statsOverlay.destroy();
+		gpuProfiler.clear();
+		deferredRenderer.destroy();
+		dynamicResolution.clear();
+
+		// Destroy the window
+		glfwDestroyWindow(renderWindow);
+
+		// Frees all remaining resources allocated by GLFW
+		glfwTerminate();
+	}
 
 	// Release all game resources that were loaded.
 	unloadData();
@@ -473,23 +1170,6 @@ void Game::shutdown()
 
 } // end shutDown
 
-int Game::getWindowWidth()
-{
-	int width, height;
-	glfwGetFramebufferSize(this->renderWindow, &width, &height);
-
-	return width;
-}
-
-int Game::getWindowHeight()
-{
-	int width, height;
-	glfwGetFramebufferSize(this->renderWindow, &width, &height);
-
-	return height;
-
-}
-
 //********************* Event Handlers *****************************************
 
 void Game::window_close_callback(GLFWwindow* window) 
@@ -502,12 +1182,16 @@ void Game::window_close_callback(GLFWwindow* window)
 
 void Game::framebuffer_size_callback(GLFWwindow* window, int width, int height) {
 
-	glViewport(0, 0, width, height);
+	// The size of the render target does not follow the hidden window
+	if (offscreen == true) {
+		return;
+	}
 
-	// Set the modeling transformation
-	glm::mat4 projectionTransformation = glm::perspective(PI / 4.0f, ((float)width) / height, 0.5f, 1000.0f);
-	//glUniformMatrix4fv(0, 1, GL_FALSE, glm::value_ptr(projectionTransformation));
-	SharedProjectionAndViewing::setProjectionMatrix(projectionTransformation);
+	// Events are polled on the update thread, which does not hold the OpenGL
+	// context. Cameras compute their projection matrices from the saved size
+	// the next time they are updated.
+	framebufferWidth = width;
+	framebufferHeight = height;
 
 } // end framebuffer_size_callback
 
@@ -525,6 +1209,22 @@ void Game::key_callback(GLFWwindow* window, int key, int scancode, int action, i
 
 			break;
 
+		case GLFW_KEY_F3 :
+
+			StatsOverlay::setVisible(StatsOverlay::isVisible() == false);
+
+			break;
+
+		case GLFW_KEY_F12 :
+
+			// Write what every thread did recently for chrome://tracing
+			if (CpuProfiler::exportChromeTrace("cpuTrace.json")) {
+
+				std::cout << "CPU trace written to cpuTrace.json" << std::endl;
+			}
+
+			break;
+
 		default:
 
 			fprintf(stdout, "key pressed\n");
@@ -602,6 +1302,9 @@ void Game::addChild(GameObject* child)
 
 	if (gameInitializationComplete == true) {
 
+		// Components create OpenGL objects when they are initialized
+		RenderContextLock contextLock(renderThread);
+
 		child->initialize();
 	}
 }
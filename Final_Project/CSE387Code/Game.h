@@ -1,16 +1,32 @@
 #pragma once
 #include <string>
+#include <mutex>
 
 #include "MathLibsConstsFuncs.h"
 #include <GLFW/glfw3.h>
 
 #include "SceneNode.h"
+#include "RenderQueue.h"
+#include "StaticBatcher.h"
+#include "RenderThread.h"
+#include "FrameScheduler.h"
+#include "RenderTarget.h"
+#include "FrameCapture.h"
+#include "DynamicResolution.h"
+#include "FrameStats.h"
+#include "DeferredRenderer.h"
+#include "FrameGraph.h"
+#include "ClusterCuller.h"
+#include "ImpostorRenderer.h"
+#include "GpuProfiler.h"
+#include "StatsOverlay.h"
 
 static const int initialScreenWidth = 1024;
 static const int initialScreenHeight = 768;
 
 static const GLint FRAMES_PER_SECOND = 60; // Desired maximum number of frames per second
-static const GLdouble FRAME_INTERVAL = 1.0 / FRAMES_PER_SECOND; // Interval in milliseconds between frames
+static const GLdouble FRAME_INTERVAL = 1.0 / FRAMES_PER_SECOND; // Interval in seconds between frames
+static const GLdouble FIXED_TIME_STEP = 1.0 / 60.0; // Time in seconds that each update advances the game
 
 class Game
 {
@@ -39,7 +55,8 @@ public:
 	 *
 	 * @brief	Initializes graphics as well as sound and physics
 	 * 			engines. Loads the initial scene and initializes all 
-	 * 			game objects.
+	 * 			game objects. Headless games skip the window and graphics
+	 * 			and initialize sound without output.
 	 *
 	 * @returns	True if it succeeds, false if it fails.
 	 */
@@ -50,10 +67,109 @@ public:
 	 *
 	 * @brief	Game loop. Repeated processes user input, updates
 	 * 			all game objects, and renders the scene until isRunning
-	 * 			is false and the game ends.
+	 * 			is false and the game ends. Headless games only update
+	 * 			and take fixed steps as fast as they can.
 	 */
 	void gameLoop();
 
+	/**
+	 * @fn	static void Game::setHeadless(bool headless)
+	 *
+	 * @brief	Selects whether the game runs without a window or an OpenGL context. Headless
+	 * 			games update the scene graph, physics, and sound but make no OpenGL calls.
+	 * 			Mesh components keep their bounds and collision shapes but create no buffers or
+	 * 			textures. Must be set before initialize is called.
+	 */
+	static void setHeadless(bool headless) { Game::headless = headless; }
+
+	static bool isHeadless() { return headless; }
+
+	/**
+	 * @fn	void Game::setStepLimit(int steps)
+	 *
+	 * @brief	Ends the game loop after a number of fixed updates. Zero to run until the game
+	 * 			is stopped.
+	 */
+	void setStepLimit(int steps) { stepLimit = steps; }
+
+	/**
+	 * @fn	void Game::setOffscreen(int width, int height, int contextCreationApi = GLFW_NATIVE_CONTEXT_API);
+	 *
+	 * @brief	Renders into a render target of a fixed size instead of the default framebuffer
+	 * 			of a visible window. The window is hidden and the buffers are never swapped.
+	 * 			Must be called before initialize.
+	 *
+	 * 			GLFW_OSMESA_CONTEXT_API or GLFW_EGL_CONTEXT_API select a software or EGL context.
+	 * 			To run on a Linux machine without a display, GLFW must be built with the OSMesa
+	 * 			platform.
+	 *
+	 * @param	width			  	The width of the render target in pixels.
+	 * @param	height			  	The height of the render target in pixels.
+	 * @param	contextCreationApi	(Optional) The GLFW context creation API.
+	 */
+	void setOffscreen(int width, int height, int contextCreationApi = GLFW_NATIVE_CONTEXT_API);
+
+	/**
+	 * @fn	FrameCapture& Game::getFrameCapture()
+	 *
+	 * @brief	Gets the read back of rendered frames. Frames are captured while a callback is
+	 * 			set. The callback is called on the thread that renders.
+	 */
+	FrameCapture& getFrameCapture() { return frameCapture; }
+
+	/**
+	 * @fn	DynamicResolution& Game::getDynamicResolution()
+	 *
+	 * @brief	Gets the scaling of the resolution the scene is rendered at. While it is enabled
+	 * 			the scene is rendered into a render target at a fraction of the size of the
+	 * 			window, or of the offscreen render target, that follows the GPU time of recent
+	 * 			frames. The viewports of the cameras are scaled by the same fraction and the
+	 * 			result is upscaled to fill the window.
+	 */
+	DynamicResolution& getDynamicResolution() { return dynamicResolution; }
+
+	/**
+	 * @fn	GpuProfiler& Game::getGpuProfiler()
+	 *
+	 * @brief	Gets the profiler that times the passes, cameras and draw groups of each frame
+	 * 			on the GPU. Only use it on the thread that renders.
+	 */
+	GpuProfiler& getGpuProfiler() { return gpuProfiler; }
+
+	/**
+	 * @fn	StatsOverlay& Game::getStatsOverlay()
+	 *
+	 * @brief	Gets the statistics of recent frames that are drawn over the window while
+	 * 			StatsOverlay::setVisible is on. F3 shows and hides them. Only use it on the
+	 * 			thread that renders.
+	 */
+	StatsOverlay& getStatsOverlay() { return statsOverlay; }
+
+	/**
+	 * @fn	FrameStats Game::getFrameStats();
+	 *
+	 * @brief	Gets the counts of the last frame that finished rendering. Safe to call while
+	 * 			the render thread is rendering.
+	 */
+	FrameStats getFrameStats();
+
+	/**
+	 * @fn	void Game::setCaptureDirectory(const std::string& directory);
+	 *
+	 * @brief	Captures every rendered frame to numbered PNG files in a directory.
+	 */
+	void setCaptureDirectory(const std::string& directory);
+
+	/**
+	 * @fn	void Game::setDeferredShading(bool deferredShading)
+	 *
+	 * @brief	Selects the deferred pipeline, which writes the materials of the meshes into a
+	 * 			G-buffer and adds each light in a separate pass over the pixels it can reach,
+	 * 			instead of shading every fragment with every light. Must be called before
+	 * 			initialize. Falls back to forward shading if the pipeline cannot be set up.
+	 */
+	void setDeferredShading(bool deferredShading) { this->deferredShading = deferredShading; }
+
 	/**
 	 * @fn	void Game::addMeshComp(class MeshComponent* mesh);
 	 *
@@ -143,9 +259,27 @@ public:
 
 	void removeAndDeleteChild(GameObject* child);
 
-	int getWindowWidth();
+	/**
+	 * @fn	int Game::getWindowWidth()
+	 *
+	 * @brief	Gets the width in pixels of the framebuffer. The size is saved when the
+	 * 			framebuffer is resized rather than queried each time.
+	 */
+	int getWindowWidth() { return framebufferWidth; }
 
-	int getWindowHeight();
+	/**
+	 * @fn	int Game::getWindowHeight()
+	 *
+	 * @brief	Gets the height in pixels of the framebuffer.
+	 */
+	int getWindowHeight() { return framebufferHeight; }
+
+	/**
+	 * @fn	GLFWwindow* Game::getRenderWindow()
+	 *
+	 * @brief	Gets the rendering window. Null if the game is headless.
+	 */
+	GLFWwindow* getRenderWindow() { return renderWindow; }
 
 	/**
 	 * @fn	bool Game::getGameInitializationComplete()
@@ -156,6 +290,30 @@ public:
 	 */
 	bool getGameInitializationComplete() { return gameInitializationComplete; }
 
+	/**
+	 * @fn	RenderThread& Game::getRenderThread()
+	 *
+	 * @brief	Gets the render thread. Code that makes OpenGL calls on the update thread
+	 * 			after the game loop has started must hold a RenderContextLock on it.
+	 */
+	RenderThread& getRenderThread() { return renderThread; }
+
+	/**
+	 * @fn	void Game::setRenderThreadEnabled(bool enabled)
+	 *
+	 * @brief	Selects whether the scene is rendered on a separate thread. Must be set before
+	 * 			the game loop starts. Enabled by default.
+	 */
+	void setRenderThreadEnabled(bool enabled) { renderThreadEnabled = enabled; }
+
+	/**
+	 * @fn	FrameScheduler& Game::getFrameScheduler()
+	 *
+	 * @brief	Gets the scheduler that paces updates and frames. Use it to lower the frame
+	 * 			rate on screens that change little.
+	 */
+	FrameScheduler& getFrameScheduler() { return frameScheduler; }
+
 protected:
 
 	class SceneGraphNode sceneNode;
@@ -204,18 +362,70 @@ protected:
 	void initializeGameObjects();
 
 	/**
-	 * @fn	virtual void Game::updateGame();
+	 * @fn	virtual void Game::updateGame(float deltaTime);
+	 *
+	 * @brief	Updates all game objects and the attached components by one fixed time step.
+	 *
+	 * @param	deltaTime	The fixed time step in seconds.
+	 */
+	virtual void updateGame(float deltaTime);
+
+	/**
+	 * @fn	void Game::buildSnapshot(RenderSnapshot& snapshot);
+	 *
+	 * @brief	Copies the lights, cameras, and meshes that are needed to render the scene into a
+	 * 			snapshot. Meshes outside of the frustum of a camera are left out of the visible
+	 * 			list of the camera. Called on the update thread and makes no OpenGL calls.
+	 *
+	 * @param [out]	snapshot	 	The snapshot.
+	 * @param 	   	interpolation	Fraction of a fixed update that has passed since the last
+	 * 								one. Transformations are interpolated by it.
+	 */
+	void buildSnapshot(RenderSnapshot& snapshot, float interpolation);
+
+	/**
+	 * @fn	void Game::renderScene(const RenderSnapshot& snapshot);
+	 *
+	 * @brief	Renders a snapshot of the game scene and swaps the buffers. The scene, the
+	 * 			upscale of a reduced resolution, the frame capture and the swap are passes of a
+	 * 			frame graph that is built for every frame. Called on the thread that owns the
+	 * 			OpenGL context.
+	 *
+	 * @param	snapshot	The snapshot.
+	 */
+	void renderScene(const RenderSnapshot& snapshot);
+
+	/**
+	 * @fn	void Game::renderCameraView(const RenderSnapshot& snapshot, const CameraView& view, float resolutionScale);
+	 *
+	 * @brief	Renders a snapshot from the viewpoint of one camera. If occlusion culling is
+	 * 			enabled, meshes that were visible in the last frame are rendered first and the
+	 * 			remaining meshes are only rendered if they are not hidden by the depth of the
+	 * 			first pass.
+	 *
+	 * @param	snapshot	   	The snapshot.
+	 * @param	view		   	The view of the camera in the snapshot.
+	 * @param	resolutionScale	Fraction of the framebuffer size the scene is rendered at. The
+	 * 							viewport of the camera is scaled by it.
+	 */
+	void renderCameraView(const RenderSnapshot& snapshot, const CameraView& view, float resolutionScale);
+
+	/**
+	 * @fn	void Game::queueMeshDraw(const RenderSnapshot& snapshot, const MeshDraw& meshDraw);
 	 *
-	 * @brief	Updates all game objects and the attached components.
+	 * @brief	Adds the sub-meshes of a mesh in a snapshot to the render queue and requests
+	 * 			the texture detail needed for its size on the screen.
 	 */
-	virtual void updateGame();
+	void queueMeshDraw(const RenderSnapshot& snapshot, const MeshDraw& meshDraw);
 
 	/**
-	 * @fn	void Game::renderScene();
+	 * @fn	void Game::drawRenderQueue(const CameraView& view);
 	 *
-	 * @brief	Renders the game scene.
+	 * @brief	Sorts and renders the render queue for a view. If the view has a depth pre-pass
+	 * 			the queue is rendered into the depth buffer first and then shaded with a depth
+	 * 			test of GL_EQUAL so each pixel is shaded once.
 	 */
-	void renderScene();
+	void drawRenderQueue(const CameraView& view);
 
 	/**
 	 * @fn	virtual void Game::unloadData();
@@ -231,12 +441,85 @@ protected:
 	/** @brief	All mesh components that need to be rendered */
 	std::vector<class MeshComponent*> meshComps;
 
+	/** @brief	Sorted sub-meshes of all mesh components for the camera being rendered */
+	RenderQueue renderQueue;
+
+	/** @brief	Combined buffers for the meshes of objects that do not move */
+	StaticBatcher staticBatcher;
+
+	/** @brief	Thread that owns the OpenGL context while the game loop runs */
+	RenderThread renderThread;
+
+	/** @brief	True to render on the render thread. False to render after each update. */
+	bool renderThreadEnabled = true;
+
+	/** @brief	Paces fixed updates and rendered frames */
+	FrameScheduler frameScheduler{ FIXED_TIME_STEP, FRAMES_PER_SECOND };
+
+	/** @brief	Number of fixed updates after which the game loop ends. Zero for no limit. */
+	int stepLimit = 0;
+
+	/** @brief	True to render into the render target of a hidden window */
+	bool offscreen = false;
+
+	/** @brief	GLFW context creation API used for the window */
+	int contextCreationApi = GLFW_NATIVE_CONTEXT_API;
+
+	/** @brief	Framebuffer rendered into when the game is offscreen */
+	RenderTarget renderTarget;
+
+	/** @brief	Asynchronous read back of rendered frames */
+	FrameCapture frameCapture;
+
+	/** @brief	Fraction of the output resolution the scene is rendered at */
+	DynamicResolution dynamicResolution;
+
+	/** @brief	Passes of the frame being rendered and the textures they share */
+	FrameGraph frameGraph;
+
+	/** @brief	GPU time of the passes, cameras and draw groups of recent frames */
+	GpuProfiler gpuProfiler;
+
+	/** @brief	Statistics of recent frames drawn over the finished frame */
+	StatsOverlay statsOverlay;
+
+	/** @brief	Culls the meshlets of large sub-meshes in the render queue */
+	ClusterCuller clusterCuller;
+
+	/** @brief	Draws distant copies of models as quads textured with their impostor atlases */
+	ImpostorRenderer impostorRenderer;
+
+	/** @brief	True to use the deferred pipeline */
+	bool deferredShading = false;
+
+	/** @brief	G-buffer and light passes of the deferred pipeline. Only initialized if it is used. */
+	DeferredRenderer deferredRenderer;
+
+	/** @brief	Counts of the frame being rendered. Only used by the thread that renders. */
+	FrameStats frameStats;
+
+	/** @brief	Counts of the last finished frame */
+	FrameStats finishedFrameStats;
+
+	/** @brief	Guards finishedFrameStats */
+	std::mutex frameStatsMutex;
+
+	/** @brief	True if the game runs without a window or an OpenGL context */
+	static bool headless;
+
+	/** @brief	Snapshot used when the scene is rendered on the update thread */
+	RenderSnapshot singleThreadSnapshot;
+
 	/** @brief	Title for the window */
 	std::string windowTitle;
 
 	/** @brief	The rendering window */
 	GLFWwindow* renderWindow = NULL;
 
+	/** @brief	Size of the framebuffer. Updated by framebuffer_size_callback. */
+	int framebufferWidth = initialScreenWidth;
+	int framebufferHeight = initialScreenHeight;
+
 	/** @brief	False until after the game has been initialized. When true
 	 newly instnatiated game objects and components must be initialized. */
 	bool gameInitializationComplete = false;
@@ -2,6 +2,7 @@
 
 #include "Component.h"
 #include "MeshComponent.h"
+#include "EngineCounters.h"
 
 #include <algorithm>
 #include <glm/gtx/matrix_decompose.hpp>
@@ -60,6 +61,8 @@ void GameObject::update(float deltaTime)
 	// Check to see if this game object is active
 	if (gameObjectState == ACTIVE) {
 
+		EngineCounters::add(EngineCounters::GAME_OBJECT_UPDATES);
+
 		// Update the components that are attached to to this game object
 		for (auto component : this->components) {
 
@@ -144,6 +147,8 @@ void GameObject::addComponent(Component* component)
 
 		// Adding a new component to a game object that is already in 
 		// the scene graph and initialized.
+		RenderContextLock contextLock(owningGame->getRenderThread());
+
 		component->initialize();
 	}
 
@@ -187,6 +192,8 @@ void GameObject::addChild(GameObject* child)
 
 	if (getOwningGame()->getGameInitializationComplete() == true) {
 
+		RenderContextLock contextLock(getOwningGame()->getRenderThread());
+
 		child->initialize();
 
 	}
@@ -0,0 +1,333 @@
+#include "GpuProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+#define VERBOSE false
+
+// Number of recent frames the times of each scope are averaged over
+#define HISTORY_LENGTH 60
+
+
+void GpuProfiler::beginFrame()
+{
+	if (enabled == false) {
+		return;
+	}
+
+	readResults();
+
+	frameNumber++;
+
+	// The frame is not profiled if every slot is still waiting for its results
+	FrameSlot& slot = slots[nextSlot];
+
+	recording = slot.pending == false;
+
+	if (recording == true) {
+
+		slot.usedQueries = 0;
+		slot.records.clear();
+		slot.frameNumber = frameNumber;
+
+		openScopes.clear();
+	}
+
+} // end beginFrame
+
+
+void GpuProfiler::endFrame()
+{
+	if (recording == true) {
+
+		// Scopes that were left open end with the frame
+		while (openScopes.empty() == false) {
+			endScope();
+		}
+
+		FrameSlot& slot = slots[nextSlot];
+
+		if (slot.records.empty() == false) {
+
+			slot.pending = true;
+			nextSlot = (nextSlot + 1) % slots.size();
+		}
+
+		recording = false;
+	}
+
+	if (enabled == true && dumpInterval > 0.0) {
+
+		double time = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+		if (lastDumpTime < 0.0) {
+
+			lastDumpTime = time;
+		}
+		else if (time - lastDumpTime >= dumpInterval) {
+
+			dump();
+			lastDumpTime = time;
+		}
+	}
+
+} // end endFrame
+
+
+void GpuProfiler::beginScope(const std::string& name)
+{
+	if (recording == false) {
+		return;
+	}
+
+	ScopeRecord record;
+
+	record.scope = findScope(name, static_cast<int>(openScopes.size()));
+	record.beginQuery = issueTimestamp();
+
+	FrameSlot& slot = slots[nextSlot];
+
+	openScopes.push_back(slot.records.size());
+	slot.records.push_back(record);
+
+} // end beginScope
+
+
+void GpuProfiler::endScope()
+{
+	if (recording == false || openScopes.empty()) {
+		return;
+	}
+
+	slots[nextSlot].records[openScopes.back()].endQuery = issueTimestamp();
+
+	openScopes.pop_back();
+
+} // end endScope
+
+
+void GpuProfiler::clear()
+{
+	for (auto& slot : slots) {
+
+		if (slot.queries.empty() == false) {
+
+			glDeleteQueries(static_cast<GLsizei>(slot.queries.size()), &slot.queries[0]);
+		}
+
+		slot = FrameSlot();
+	}
+
+	nextSlot = 0;
+	recording = false;
+	openScopes.clear();
+
+	scopes.clear();
+	scopeIndices.clear();
+
+} // end clear
+
+
+double GpuProfiler::getAverage(const std::string& name) const
+{
+	auto iter = scopeIndices.find(name);
+
+	if (iter == scopeIndices.end() || scopes[iter->second].samples.empty()) {
+
+		return -1.0;
+	}
+
+	const std::vector<double>& samples = scopes[iter->second].samples;
+
+	double total = 0.0;
+
+	for (auto sample : samples) {
+		total += sample;
+	}
+
+	return total / samples.size();
+
+} // end getAverage
+
+
+std::vector<GpuProfiler::ScopeTiming> GpuProfiler::getTimings() const
+{
+	std::vector<ScopeTiming> timings;
+
+	for (auto& scope : scopes) {
+
+		if (scope.samples.empty()) {
+			continue;
+		}
+
+		ScopeTiming timing;
+
+		timing.name = scope.name;
+		timing.depth = scope.depth;
+		timing.average = getAverage(scope.name);
+		timing.maximum = *std::max_element(scope.samples.begin(), scope.samples.end());
+
+		timings.push_back(timing);
+	}
+
+	return timings;
+
+} // end getTimings
+
+
+void GpuProfiler::dump()
+{
+	std::vector<ScopeTiming> timings = getTimings();
+
+	if (timings.empty()) {
+		return;
+	}
+
+	std::cout << "GPU time in milliseconds, average (maximum) of the last " << HISTORY_LENGTH
+		<< " frames up to frame " << measuredFrame << std::endl;
+
+	for (auto& timing : timings) {
+
+		std::cout << std::string(2 * (timing.depth + 1), ' ') << std::left << std::setw(24) << timing.name << std::right
+			<< std::fixed << std::setprecision(3) << std::setw(9) << timing.average
+			<< " (" << timing.maximum << ")" << std::endl;
+	}
+
+	std::cout.unsetf(std::ios::floatfield);
+
+	if (csvFileName.empty()) {
+		return;
+	}
+
+	// The file is replaced the first time it is written to
+	std::ofstream file(csvFileName, csvHeaderWritten ? std::ios::app : std::ios::trunc);
+
+	if (file.is_open() == false) {
+
+		std::cerr << "Unable to write GPU timings to " << csvFileName << std::endl;
+		return;
+	}
+
+	if (csvHeaderWritten == false) {
+
+		file << "frame,scope,depth,average_ms,maximum_ms" << std::endl;
+		csvHeaderWritten = true;
+	}
+
+	for (auto& timing : timings) {
+
+		file << measuredFrame << "," << timing.name << "," << timing.depth << ","
+			<< std::fixed << std::setprecision(4) << timing.average << "," << timing.maximum << std::endl;
+	}
+
+} // end dump
+
+
+void GpuProfiler::readResults()
+{
+	std::vector<GLuint64> timestamps;
+
+	// Read finished frames oldest first without waiting
+	for (size_t i = 0; i < slots.size(); i++) {
+
+		FrameSlot& slot = slots[(nextSlot + i) % slots.size()];
+
+		if (slot.pending == false) {
+			continue;
+		}
+
+		// Timestamps finish in order so the frame is done when its last one is
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(slot.queries[slot.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (available == GL_FALSE) {
+			break;
+		}
+
+		timestamps.resize(slot.usedQueries);
+
+		for (GLuint query = 0; query < slot.usedQueries; query++) {
+
+			glGetQueryObjectui64v(slot.queries[query], GL_QUERY_RESULT, &timestamps[query]);
+		}
+
+		// Scopes with the same name are added up. Scopes that were not timed stay negative.
+		frameTimes.assign(scopes.size(), -1.0);
+
+		for (auto& record : slot.records) {
+
+			double milliseconds = (timestamps[record.endQuery] - timestamps[record.beginQuery]) * 1.0e-6;
+
+			frameTimes[record.scope] = std::max(frameTimes[record.scope], 0.0) + milliseconds;
+		}
+
+		for (size_t scope = 0; scope < frameTimes.size(); scope++) {
+
+			if (frameTimes[scope] < 0.0) {
+				continue;
+			}
+
+			ScopeHistory& history = scopes[scope];
+
+			if (history.samples.size() < HISTORY_LENGTH) {
+
+				history.samples.push_back(frameTimes[scope]);
+			}
+			else {
+
+				history.samples[history.nextSample] = frameTimes[scope];
+				history.nextSample = (history.nextSample + 1) % HISTORY_LENGTH;
+			}
+		}
+
+		slot.pending = false;
+		measuredFrame = slot.frameNumber;
+	}
+
+} // end readResults
+
+
+int GpuProfiler::findScope(const std::string& name, int depth)
+{
+	auto iter = scopeIndices.find(name);
+
+	if (iter != scopeIndices.end()) {
+
+		return iter->second;
+	}
+
+	ScopeHistory scope;
+
+	scope.name = name;
+	scope.depth = depth;
+
+	scopes.push_back(scope);
+
+	int index = static_cast<int>(scopes.size()) - 1;
+
+	scopeIndices.emplace(name, index);
+
+	return index;
+
+} // end findScope
+
+
+GLuint GpuProfiler::issueTimestamp()
+{
+	FrameSlot& slot = slots[nextSlot];
+
+	if (slot.usedQueries == slot.queries.size()) {
+
+		GLuint query = 0;
+		glGenQueries(1, &query);
+
+		slot.queries.push_back(query);
+	}
+
+	glQueryCounter(slot.queries[slot.usedQueries], GL_TIMESTAMP);
+
+	return slot.usedQueries++;
+
+} // end issueTimestamp
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "MathLibsConstsFuncs.h"
+
+/**
+ * @class	GpuProfiler
+ *
+ * @brief	Measures the GPU time of named scopes of a frame with timestamp queries. Scopes
+ * 			may be nested. The queries of a frame are read a few frames later once all of them
+ * 			are available so the CPU never waits for the GPU. Frames are not profiled while
+ * 			every slot of the ring is still waiting for its results.
+ *
+ * 			Each scope keeps the times of the most recent frames it was measured in and reports
+ * 			their average and maximum. The times of scopes with the same name in one frame are
+ * 			added together. The averages can be written to the console and a CSV file at a
+ * 			fixed interval.
+ *
+ * 			Timestamps are used instead of GL_TIME_ELAPSED queries since those cannot be nested
+ * 			and DynamicResolution already uses one for the scene.
+ *
+ * 			Must be used on the thread that owns the OpenGL context.
+ */
+class GpuProfiler
+{
+public:
+
+	/**
+	 * @struct	ScopeTiming
+	 *
+	 * @brief	Rolling timing of one scope.
+	 */
+	struct ScopeTiming {
+
+		std::string name;
+
+		int depth = 0; // Number of scopes the scope is nested in
+
+		double average = 0.0; // Milliseconds averaged over the recent frames
+
+		double maximum = 0.0; // Longest of the recent frames in milliseconds
+
+	}; // end ScopeTiming
+
+	/**
+	 * @fn	GpuProfiler::~GpuProfiler()
+	 *
+	 * @brief	Destructor. Deletes the queries.
+	 */
+	~GpuProfiler() { clear(); }
+
+	/**
+	 * @fn	void GpuProfiler::beginFrame();
+	 *
+	 * @brief	Reads the results of finished frames and starts recording the scopes of a new one.
+	 */
+	void beginFrame();
+
+	/**
+	 * @fn	void GpuProfiler::endFrame();
+	 *
+	 * @brief	Stops recording the frame. Writes the averages if the dump interval has passed.
+	 */
+	void endFrame();
+
+	/**
+	 * @fn	void GpuProfiler::beginScope(const std::string& name);
+	 *
+	 * @brief	Starts timing a scope. Every scope must be ended before the frame ends.
+	 */
+	void beginScope(const std::string& name);
+
+	/**
+	 * @fn	void GpuProfiler::endScope();
+	 *
+	 * @brief	Stops timing the scope that was begun last.
+	 */
+	void endScope();
+
+	/**
+	 * @fn	void GpuProfiler::clear();
+	 *
+	 * @brief	Deletes the queries and forgets the timings.
+	 */
+	void clear();
+
+	void setEnabled(bool enabled) { this->enabled = enabled; }
+
+	bool isEnabled() const { return enabled; }
+
+	/**
+	 * @fn	double GpuProfiler::getAverage(const std::string& name) const;
+	 *
+	 * @brief	Gets the average time of a scope in milliseconds.
+	 *
+	 * @returns	Negative if the scope has not been measured.
+	 */
+	double getAverage(const std::string& name) const;
+
+	/**
+	 * @fn	std::vector<ScopeTiming> GpuProfiler::getTimings() const;
+	 *
+	 * @brief	Gets the timings of every scope that was measured in the order they were first
+	 * 			begun.
+	 */
+	std::vector<ScopeTiming> getTimings() const;
+
+	/**
+	 * @fn	void GpuProfiler::setDumpInterval(double seconds)
+	 *
+	 * @brief	Sets how often the averages are written to the console and the CSV file. Zero
+	 * 			to never write them.
+	 */
+	void setDumpInterval(double seconds) { dumpInterval = seconds; }
+
+	/**
+	 * @fn	void GpuProfiler::setCsvFile(const std::string& fileName)
+	 *
+	 * @brief	Sets the file the averages are appended to as rows of frame, scope, depth,
+	 * 			average and maximum. Empty to only write them to the console.
+	 */
+	void setCsvFile(const std::string& fileName) { csvFileName = fileName; csvHeaderWritten = false; }
+
+	/**
+	 * @fn	void GpuProfiler::dump();
+	 *
+	 * @brief	Writes the averages to the console and the CSV file.
+	 */
+	void dump();
+
+protected:
+
+	/**
+	 * @fn	void GpuProfiler::readResults();
+	 *
+	 * @brief	Reads the queries of the frames whose results are available, oldest first.
+	 */
+	void readResults();
+
+	/**
+	 * @fn	int GpuProfiler::findScope(const std::string& name, int depth);
+	 *
+	 * @brief	Finds a scope by name or adds it.
+	 *
+	 * @returns	The index of the scope.
+	 */
+	int findScope(const std::string& name, int depth);
+
+	/**
+	 * @fn	GLuint GpuProfiler::issueTimestamp();
+	 *
+	 * @brief	Records a timestamp with the next query of the frame being recorded.
+	 *
+	 * @returns	The index of the query in the frame.
+	 */
+	GLuint issueTimestamp();
+
+	/**
+	 * @struct	ScopeRecord
+	 *
+	 * @brief	A scope that was timed in a frame.
+	 */
+	struct ScopeRecord {
+
+		int scope = -1;
+
+		GLuint beginQuery = 0; // Indices of the queries in the frame
+
+		GLuint endQuery = 0;
+
+	}; // end ScopeRecord
+
+	/**
+	 * @struct	FrameSlot
+	 *
+	 * @brief	Queries and scopes of one frame of the ring.
+	 */
+	struct FrameSlot {
+
+		std::vector<GLuint> queries; // Grows to the most timestamps recorded in a frame
+
+		GLuint usedQueries = 0;
+
+		std::vector<ScopeRecord> records;
+
+		unsigned int frameNumber = 0;
+
+		bool pending = false;
+
+	}; // end FrameSlot
+
+	/**
+	 * @struct	ScopeHistory
+	 *
+	 * @brief	Times of a scope in recent frames.
+	 */
+	struct ScopeHistory {
+
+		std::string name;
+
+		int depth = 0;
+
+		std::vector<double> samples; // Milliseconds. Used as a ring once it is full.
+
+		size_t nextSample = 0;
+
+	}; // end ScopeHistory
+
+	std::vector<FrameSlot> slots = std::vector<FrameSlot>(4);
+
+	/** @brief	Slot the next frame is recorded in. Slots are used and read in order. */
+	size_t nextSlot = 0;
+
+	/** @brief	True while a frame is being recorded */
+	bool recording = false;
+
+	/** @brief	Records of the scopes that have begun and not ended */
+	std::vector<size_t> openScopes;
+
+	std::vector<ScopeHistory> scopes;
+
+	std::map<std::string, int> scopeIndices;
+
+	/** @brief	Time the scope times of a read frame are added up in */
+	std::vector<double> frameTimes;
+
+	bool enabled = true;
+
+	/** @brief	Frames recorded since the profiler was created */
+	unsigned int frameNumber = 0;
+
+	/** @brief	Frame the most recent results are from */
+	unsigned int measuredFrame = 0;
+
+	double dumpInterval = 0.0;
+
+	double lastDumpTime = -1.0;
+
+	std::string csvFileName;
+
+	bool csvHeaderWritten = false;
+
+}; // end GpuProfiler class
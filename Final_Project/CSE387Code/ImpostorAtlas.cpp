@@ -0,0 +1,219 @@
+#include "ImpostorAtlas.h"
+#include "CpuProfiler.h"
+#include "EngineCounters.h"
+#include "GLStateCache.h"
+#include "BuildShaderProgram.h"
+#include "SharedMaterialProperties.h"
+
+#include <algorithm>
+#include <cmath>
+
+#define VERBOSE false
+
+// Uniform location in impostorBake.vs.glsl
+#define bakeViewProjectionLocation 0
+
+// Elevation of the highest row of frames
+#define MAX_ELEVATION (PI / 3.0f)
+
+// Frames are slightly larger than the bounding sphere so mip levels do not bleed into it
+#define FRAME_MARGIN 1.05f
+
+// Mip levels down to a frame of 4 x 4 pixels
+#define ATLAS_MIP_LEVELS 6
+
+GLuint ImpostorAtlas::bakeProgram = 0;
+
+bool ImpostorAtlas::impostorsEnabled = true;
+
+
+ImpostorAtlas::~ImpostorAtlas()
+{
+	if (colorTexture != 0) {
+
+		GLStateCache::deleteTextures(1, &colorTexture);
+		GLStateCache::deleteTextures(1, &normalTexture);
+	}
+
+} // end destructor
+
+
+void ImpostorAtlas::loadShaders()
+{
+	ShaderInfo shaders[] = {
+		{ GL_VERTEX_SHADER, "Shaders/impostorBake.vs.glsl" },
+		{ GL_FRAGMENT_SHADER, "Shaders/impostorBake.fs.glsl" },
+		{ GL_NONE, NULL } // signals that there are no more shaders
+	};
+
+	bakeProgram = BuildShaderProgram(shaders);
+
+	if (bakeProgram != 0) {
+
+		SharedMaterialProperties::setUniformBlockForShader(bakeProgram);
+	}
+	else {
+
+		std::cerr << "Impostor bake program failed to build. Models will be rendered without impostors." << std::endl;
+	}
+
+} // end loadShaders
+
+
+ImpostorAtlas* ImpostorAtlas::bake(const std::vector<SubMesh>& subMeshes, const glm::vec3& center, float radius)
+{
+	CPU_PROFILE_SCOPE("ImpostorAtlas::bake");
+
+	if (bakeProgram == 0 || radius <= 0.0f) {
+		return nullptr;
+	}
+
+	GLsizei width = AZIMUTHS * FRAME_SIZE;
+	GLsizei height = ELEVATIONS * FRAME_SIZE;
+
+	ImpostorAtlas* atlas = new ImpostorAtlas();
+	atlas->center = center;
+	atlas->radius = radius;
+
+	for (auto texture : { &atlas->colorTexture, &atlas->normalTexture }) {
+
+		glGenTextures(1, texture);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, *texture);
+		glTexStorage2D(GL_TEXTURE_2D, ATLAS_MIP_LEVELS, GL_RGBA8, width, height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+
+	// State that is restored when the atlas is done
+	GLuint previousFramebuffer = GLStateCache::getFramebuffer(GL_DRAW_FRAMEBUFFER);
+	GLuint previousProgram = GLStateCache::getProgram();
+	GLint previousViewport[4];
+	GLfloat previousClearColor[4];
+
+	glGetIntegerv(GL_VIEWPORT, previousViewport);
+	glGetFloatv(GL_COLOR_CLEAR_VALUE, previousClearColor);
+
+	GLuint depthBuffer = 0;
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+	GLuint framebuffer = 0;
+	glGenFramebuffers(1, &framebuffer);
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlas->colorTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, atlas->normalTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+	GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(2, drawBuffers);
+
+	bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+	if (complete) {
+
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		GLStateCache::useProgram(bakeProgram);
+
+		float halfSize = radius * FRAME_MARGIN;
+
+		// The model is between one and three radii from the viewpoint
+		glm::mat4 projection = glm::ortho(-halfSize, halfSize, -halfSize, halfSize, radius * 0.5f, radius * 3.5f);
+
+		for (int frame = 0; frame < AZIMUTHS * ELEVATIONS; frame++) {
+
+			glm::vec3 eye = center + getFrameDirection(frame) * (2.0f * radius);
+
+			glm::mat4 viewProjection = projection * glm::lookAt(eye, center, glm::vec3(0.0f, 1.0f, 0.0f));
+
+			glUniformMatrix4fv(bakeViewProjectionLocation, 1, GL_FALSE, glm::value_ptr(viewProjection));
+
+			glViewport((frame % AZIMUTHS) * FRAME_SIZE, (frame / AZIMUTHS) * FRAME_SIZE, FRAME_SIZE, FRAME_SIZE);
+
+			for (auto& subMesh : subMeshes) {
+
+				GLStateCache::bindVertexArray(subMesh.vao);
+
+				SharedMaterialProperties::setShaderMaterialProperties(subMesh.material);
+				subMesh.material->requestTextureDetail(static_cast<float>(FRAME_SIZE));
+
+				if (subMesh.renderMode == ORDERED) {
+
+					glDrawArrays(subMesh.primitiveMode, 0, subMesh.count);
+				}
+				else { // renderMode == INDEXED
+
+					glDrawElements(subMesh.primitiveMode, subMesh.count, GL_UNSIGNED_INT, 0);
+				}
+
+				EngineCounters::addDraw(subMesh.primitiveMode, subMesh.count);
+			}
+		}
+
+		SharedMaterialProperties::unbindTextures();
+
+		for (auto texture : { atlas->colorTexture, atlas->normalTexture }) {
+
+			GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
+			glGenerateMipmap(GL_TEXTURE_2D);
+		}
+
+		GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+	}
+	else {
+
+		std::cerr << "Impostor atlas framebuffer is incomplete." << std::endl;
+	}
+
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+	glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+	GLStateCache::useProgram(previousProgram);
+	glClearColor(previousClearColor[0], previousClearColor[1], previousClearColor[2], previousClearColor[3]);
+
+	GLStateCache::deleteFramebuffers(1, &framebuffer);
+	glDeleteRenderbuffers(1, &depthBuffer);
+
+	if (complete == false) {
+
+		delete atlas;
+		return nullptr;
+	}
+
+	if (VERBOSE) cout << "Impostor atlas baked " << width << " x " << height << endl;
+
+	return atlas;
+
+} // end bake
+
+
+int ImpostorAtlas::selectFrame(const glm::vec3& objectDirection)
+{
+	float azimuthStep = TWO_PI / AZIMUTHS;
+	float elevationStep = MAX_ELEVATION / (ELEVATIONS - 1);
+
+	int azimuth = static_cast<int>(std::lround(std::atan2(objectDirection.x, objectDirection.z) / azimuthStep));
+	azimuth = ((azimuth % AZIMUTHS) + AZIMUTHS) % AZIMUTHS;
+
+	// Views from below use the lowest row
+	int elevation = static_cast<int>(std::lround(std::asin(glm::clamp(objectDirection.y, -1.0f, 1.0f)) / elevationStep));
+	elevation = glm::clamp(elevation, 0, ELEVATIONS - 1);
+
+	return elevation * AZIMUTHS + azimuth;
+
+} // end selectFrame
+
+
+glm::vec3 ImpostorAtlas::getFrameDirection(int frame)
+{
+	float azimuth = (frame % AZIMUTHS) * TWO_PI / AZIMUTHS;
+	float elevation = (frame / AZIMUTHS) * MAX_ELEVATION / (ELEVATIONS - 1);
+
+	return glm::vec3(std::sin(azimuth) * std::cos(elevation), std::sin(elevation), std::cos(azimuth) * std::cos(elevation));
+
+} // end getFrameDirection
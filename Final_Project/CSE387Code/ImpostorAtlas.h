@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+
+#include "MathLibsConstsFuncs.h"
+#include "SubMesh.h"
+
+/**
+ * @class	ImpostorAtlas
+ *
+ * @brief	Pictures of a model from a ring of directions around its up axis at a few
+ * 			elevations. They are used to draw distant copies of the model as quads that face
+ * 			the camera. Each frame of the atlas is an orthographic view of the bounding sphere
+ * 			of the model with the vertical axis of the model pointing up.
+ *
+ * 			The color atlas holds the diffuse color, with alpha where the model covers the
+ * 			frame. The normal atlas holds the normal in object coordinates packed into 0 to 1,
+ * 			with alpha 1 where the material is lit. Impostors are lit when they are drawn so
+ * 			they follow the lights of the scene.
+ */
+class ImpostorAtlas
+{
+public:
+
+	/** @brief	Frames around the up axis, elevations, and size of a frame in pixels */
+	static const int AZIMUTHS = 8;
+	static const int ELEVATIONS = 3;
+	static const int FRAME_SIZE = 128;
+
+	/**
+	 * @fn	ImpostorAtlas::~ImpostorAtlas()
+	 *
+	 * @brief	Destructor. Deletes the textures.
+	 */
+	~ImpostorAtlas();
+
+	/**
+	 * @fn	static void ImpostorAtlas::loadShaders();
+	 *
+	 * @brief	Builds the program that renders models into atlases. Call once after the OpenGL
+	 * 			context has been created.
+	 */
+	static void loadShaders();
+
+	/**
+	 * @fn	static ImpostorAtlas* ImpostorAtlas::bake(const std::vector<SubMesh>& subMeshes, const glm::vec3& center, float radius);
+	 *
+	 * @brief	Renders the sub-meshes of a model into a new atlas. The OpenGL state that is
+	 * 			changed is restored.
+	 *
+	 * @param	subMeshes	The sub-meshes of the model.
+	 * @param	center   	The center of the bounding sphere of the model in object coordinates.
+	 * @param	radius   	The radius of the bounding sphere.
+	 *
+	 * @returns	Null if the program is not built or the framebuffer is incomplete. Otherwise an
+	 * 			atlas that is owned by the caller.
+	 */
+	static ImpostorAtlas* bake(const std::vector<SubMesh>& subMeshes, const glm::vec3& center, float radius);
+
+	/**
+	 * @fn	static int ImpostorAtlas::selectFrame(const glm::vec3& objectDirection);
+	 *
+	 * @brief	Finds the frame that was rendered from the direction closest to a direction.
+	 *
+	 * @param	objectDirection	Unit direction from the center of the model toward the
+	 * 							viewpoint in object coordinates.
+	 *
+	 * @returns	The index of the frame. Frames are numbered across the rows of the atlas.
+	 */
+	static int selectFrame(const glm::vec3& objectDirection);
+
+	/**
+	 * @fn	static glm::vec3 ImpostorAtlas::getFrameDirection(int frame);
+	 *
+	 * @brief	Gets the unit direction from the center of the model toward the viewpoint of
+	 * 			a frame in object coordinates.
+	 */
+	static glm::vec3 getFrameDirection(int frame);
+
+	/** @brief	Enables baking. Models loaded while it is off have no impostor. */
+	static void setEnabled(bool enabled) { impostorsEnabled = enabled; }
+
+	static bool isEnabled() { return impostorsEnabled; }
+
+	GLuint getColorTexture() const { return colorTexture; }
+
+	GLuint getNormalTexture() const { return normalTexture; }
+
+	/** @brief	Bounding sphere of the model in object coordinates */
+	const glm::vec3& getCenter() const { return center; }
+
+	float getRadius() const { return radius; }
+
+protected:
+
+	GLuint colorTexture = 0;
+
+	GLuint normalTexture = 0;
+
+	glm::vec3 center;
+
+	float radius = 0.0f;
+
+	/** @brief	Program that writes the color and normal atlases */
+	static GLuint bakeProgram;
+
+	static bool impostorsEnabled;
+
+}; // end ImpostorAtlas class
@@ -0,0 +1,234 @@
+#include "ImpostorRenderer.h"
+#include "EngineCounters.h"
+#include "GLStateCache.h"
+#include "ImpostorAtlas.h"
+#include "BuildShaderProgram.h"
+#include "ShaderVariants.h"
+#include "SharedProjectionAndViewing.h"
+#include "SharedGeneralLighting.h"
+
+#include <algorithm>
+
+#define VERBOSE false
+
+// Texture units of the atlases. Units below them are used by materials, occlusion culling and the G-buffer.
+#define colorAtlasTextureUnit 11
+#define normalAtlasTextureUnit 12
+
+// Uniform locations in impostor.vs.glsl and impostor.fs.glsl
+#define atlasFramesLocation 0
+#define frameMarginLocation 1
+#define fogEnabledLocation 2
+#define colorAtlasLocation 10
+#define normalAtlasLocation 11
+
+// Matches the margin the atlases are rendered with
+#define FRAME_MARGIN 1.05f
+
+float ImpostorRenderer::impostorSize = 64.0f;
+
+float ImpostorRenderer::meshSize = 96.0f;
+
+bool ImpostorRenderer::impostorsEnabled = true;
+
+
+bool ImpostorRenderer::initialize()
+{
+	ShaderInfo shaders[] = {
+		{ GL_VERTEX_SHADER, "Shaders/impostor.vs.glsl" },
+		{ GL_FRAGMENT_SHADER, "Shaders/impostor.fs.glsl" },
+		{ GL_NONE, NULL } // signals that there are no more shaders
+	};
+
+	program = BuildShaderProgram(shaders);
+
+	if (program == 0) {
+
+		std::cerr << "Impostor program failed to build." << std::endl;
+		return false;
+	}
+
+	SharedProjectionAndViewing::setUniformBlockForShader(program);
+	SharedGeneralLighting::setUniformBlockForShader(program);
+
+	glProgramUniform2i(program, atlasFramesLocation, ImpostorAtlas::AZIMUTHS, ImpostorAtlas::ELEVATIONS);
+	glProgramUniform1f(program, frameMarginLocation, FRAME_MARGIN);
+	glProgramUniform1i(program, colorAtlasLocation, colorAtlasTextureUnit);
+	glProgramUniform1i(program, normalAtlasLocation, normalAtlasTextureUnit);
+
+	glm::vec2 corners[] = { glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, -1.0f), glm::vec2(-1.0f, 1.0f), glm::vec2(1.0f, 1.0f) };
+
+	glGenVertexArrays(1, &vao);
+	GLStateCache::bindVertexArray(vao);
+
+	glGenBuffers(1, &quadBuffer);
+	GLStateCache::bindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), 0);
+	glEnableVertexAttribArray(0);
+
+	// One set of the remaining attributes per instance
+	glGenBuffers(1, &instanceBuffer);
+	GLStateCache::bindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+	for (GLuint i = 0; i < 4; i++) {
+
+		glVertexAttribPointer(1 + i, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(i * sizeof(glm::vec4)));
+		glVertexAttribDivisor(1 + i, 1);
+		glEnableVertexAttribArray(1 + i);
+	}
+
+	GLStateCache::bindVertexArray(0);
+
+	return true;
+
+} // end initialize
+
+
+void ImpostorRenderer::destroy()
+{
+	if (vao != 0) {
+
+		GLStateCache::deleteVertexArrays(1, &vao);
+		GLStateCache::deleteBuffers(1, &quadBuffer);
+		GLStateCache::deleteBuffers(1, &instanceBuffer);
+	}
+
+	// The program is deleted with the other shader programs
+	program = 0;
+	vao = 0;
+	quadBuffer = 0;
+	instanceBuffer = 0;
+	bufferCapacity = 0;
+
+	instances.clear();
+	instanceAtlases.clear();
+
+} // end destroy
+
+
+void ImpostorRenderer::add(const ImpostorAtlas& atlas, const glm::mat4& modelingTransformation, const glm::vec3& eyePosition, float meshFade)
+{
+	glm::vec3 axisX = glm::vec3(modelingTransformation[0]);
+	glm::vec3 axisY = glm::vec3(modelingTransformation[1]);
+	glm::vec3 axisZ = glm::vec3(modelingTransformation[2]);
+
+	// Largest scale factor of the modeling transformation
+	float scale = std::max(glm::length(axisX), std::max(glm::length(axisY), glm::length(axisZ)));
+
+	axisX = glm::normalize(axisX);
+	axisY = glm::normalize(axisY);
+	axisZ = glm::normalize(axisZ);
+
+	glm::vec3 center = glm::vec3(modelingTransformation * glm::vec4(atlas.getCenter(), 1.0f));
+
+	// Direction toward the viewpoint in object coordinates
+	glm::vec3 toEye = glm::normalize(eyePosition - center);
+	glm::vec3 objectDirection(glm::dot(toEye, axisX), glm::dot(toEye, axisY), glm::dot(toEye, axisZ));
+
+	Instance instance;
+
+	instance.centerRadius = glm::vec4(center, atlas.getRadius() * scale);
+	instance.axisXFrame = glm::vec4(axisX, static_cast<float>(ImpostorAtlas::selectFrame(objectDirection)));
+	instance.axisYFade = glm::vec4(axisY, meshFade);
+	instance.axisZ = glm::vec4(axisZ, 0.0f);
+
+	instances.push_back(instance);
+	instanceAtlases.push_back(&atlas);
+
+} // end add
+
+
+int ImpostorRenderer::draw()
+{
+	if (instances.empty()) {
+		return 0;
+	}
+
+	// Copies of the same model are drawn together
+	drawOrder.resize(instances.size());
+
+	for (size_t i = 0; i < drawOrder.size(); i++) {
+		drawOrder[i] = i;
+	}
+
+	std::stable_sort(drawOrder.begin(), drawOrder.end(), [this](size_t a, size_t b) {
+		return instanceAtlases[a] < instanceAtlases[b];
+	});
+
+	sortedInstances.clear();
+
+	for (auto index : drawOrder) {
+
+		sortedInstances.push_back(instances[index]);
+	}
+
+	GLStateCache::bindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+	// Orphan the storage so instances still being read by earlier draws are not overwritten
+	bufferCapacity = std::max(bufferCapacity, sortedInstances.size());
+	glBufferData(GL_ARRAY_BUFFER, bufferCapacity * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, sortedInstances.size() * sizeof(Instance), &sortedInstances[0]);
+
+	GLStateCache::useProgram(program);
+	glUniform1i(fogEnabledLocation, ShaderVariants::getFogEnabled());
+
+	GLStateCache::bindVertexArray(vao);
+
+	size_t first = 0;
+
+	while (first < drawOrder.size()) {
+
+		const ImpostorAtlas* atlas = instanceAtlases[drawOrder[first]];
+
+		size_t last = first + 1;
+
+		while (last < drawOrder.size() && instanceAtlases[drawOrder[last]] == atlas) {
+			last++;
+		}
+
+		GLStateCache::activeTexture(GL_TEXTURE0 + colorAtlasTextureUnit);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, atlas->getColorTexture());
+		GLStateCache::activeTexture(GL_TEXTURE0 + normalAtlasTextureUnit);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, atlas->getNormalTexture());
+
+		glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(last - first), static_cast<GLuint>(first));
+		EngineCounters::addDraw(GL_TRIANGLE_STRIP, 4, last - first);
+
+		first = last;
+	}
+
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE0 + colorAtlasTextureUnit);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE0);
+
+	int drawn = static_cast<int>(instances.size());
+
+	instances.clear();
+	instanceAtlases.clear();
+
+	return drawn;
+
+} // end draw
+
+
+float ImpostorRenderer::getMeshFade(float screenSize)
+{
+	if (meshSize <= impostorSize) {
+
+		return screenSize > impostorSize ? 1.0f : 0.0f;
+	}
+
+	return glm::clamp((screenSize - impostorSize) / (meshSize - impostorSize), 0.0f, 1.0f);
+
+} // end getMeshFade
+
+
+void ImpostorRenderer::setTransition(float impostorSize, float meshSize)
+{
+	ImpostorRenderer::impostorSize = impostorSize;
+	ImpostorRenderer::meshSize = meshSize;
+
+} // end setTransition
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <vector>
+
+#include "MathLibsConstsFuncs.h"
+
+class ImpostorAtlas;
+
+/**
+ * @class	ImpostorRenderer
+ *
+ * @brief	Draws distant copies of models as quads that face the camera, textured with a
+ * 			frame of the impostor atlas of the model. All copies of a model are drawn by one
+ * 			instanced draw call.
+ *
+ * 			Whether a copy is drawn as a mesh or an impostor depends on its size on the
+ * 			screen. Between the impostor size and the mesh size both are drawn, each leaving
+ * 			out the pixels the other draws in a dither pattern, so the copy cross-fades from
+ * 			one to the other.
+ */
+class ImpostorRenderer
+{
+public:
+
+	/**
+	 * @fn	ImpostorRenderer::~ImpostorRenderer()
+	 *
+	 * @brief	Destructor. Deletes the buffers.
+	 */
+	~ImpostorRenderer() { destroy(); }
+
+	/**
+	 * @fn	bool ImpostorRenderer::initialize();
+	 *
+	 * @brief	Builds the program and the buffers. Call after the shared uniform blocks are
+	 * 			set up.
+	 *
+	 * @returns	False if the program failed to build.
+	 */
+	bool initialize();
+
+	/**
+	 * @fn	void ImpostorRenderer::destroy();
+	 *
+	 * @brief	Deletes everything that was created.
+	 */
+	void destroy();
+
+	bool isInitialized() const { return program != 0; }
+
+	/**
+	 * @fn	void ImpostorRenderer::add(const ImpostorAtlas& atlas, const glm::mat4& modelingTransformation, const glm::vec3& eyePosition, float meshFade);
+	 *
+	 * @brief	Adds a copy of a model to be drawn by the next draw.
+	 *
+	 * @param	atlas				  	The impostor atlas of the model.
+	 * @param	modelingTransformation	The modeling transformation of the copy.
+	 * @param	eyePosition			  	The viewpoint in world coordinates. Selects the frame.
+	 * @param	meshFade			  	The fade of the mesh of the copy. The impostor draws
+	 * 									the pixels the mesh leaves out.
+	 */
+	void add(const ImpostorAtlas& atlas, const glm::mat4& modelingTransformation, const glm::vec3& eyePosition, float meshFade);
+
+	/**
+	 * @fn	int ImpostorRenderer::draw();
+	 *
+	 * @brief	Draws the copies that were added into the framebuffer that is bound, lit by
+	 * 			the lights of the scene, and removes them.
+	 *
+	 * @returns	The number of copies that were drawn.
+	 */
+	int draw();
+
+	/**
+	 * @fn	static float ImpostorRenderer::getMeshFade(float screenSize);
+	 *
+	 * @brief	Gets the share of the pixels of a mesh that are drawn by the mesh rather than
+	 * 			its impostor.
+	 *
+	 * @param	screenSize	The diameter of the bounding sphere of the mesh in pixels.
+	 *
+	 * @returns	One at or above the mesh size. Zero at or below the impostor size.
+	 */
+	static float getMeshFade(float screenSize);
+
+	/**
+	 * @fn	static void ImpostorRenderer::setTransition(float impostorSize, float meshSize);
+	 *
+	 * @brief	Sets the sizes on the screen in pixels between which copies cross-fade.
+	 */
+	static void setTransition(float impostorSize, float meshSize);
+
+	/**
+	 * @fn	static void ImpostorRenderer::setEnabled(bool enabled)
+	 *
+	 * @brief	Turns impostors on or off. Copies are always drawn as meshes when it is off.
+	 */
+	static void setEnabled(bool enabled) { impostorsEnabled = enabled; }
+
+	static bool isEnabled() { return impostorsEnabled; }
+
+protected:
+
+	/**
+	 * @struct	Instance
+	 *
+	 * @brief	Per instance attributes of impostor.vs.glsl.
+	 */
+	struct Instance {
+
+		glm::vec4 centerRadius;
+
+		glm::vec4 axisXFrame;
+
+		glm::vec4 axisYFade;
+
+		glm::vec4 axisZ;
+
+	}; // end Instance
+
+	/** @brief	Copies that were added, and the atlas of each */
+	std::vector<Instance> instances;
+	std::vector<const ImpostorAtlas*> instanceAtlases;
+
+	/** @brief	Instances ordered by atlas for drawing */
+	std::vector<size_t> drawOrder;
+	std::vector<Instance> sortedInstances;
+
+	GLuint program = 0;
+
+	GLuint vao = 0;
+
+	GLuint quadBuffer = 0;
+
+	GLuint instanceBuffer = 0;
+
+	/** @brief	Capacity of the instance buffer in instances */
+	size_t bufferCapacity = 0;
+
+	static float impostorSize;
+
+	static float meshSize;
+
+	static bool impostorsEnabled;
+
+}; // end ImpostorRenderer class
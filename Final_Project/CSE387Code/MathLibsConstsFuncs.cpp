@@ -46,6 +46,30 @@ void setScaleForTransform(glm::mat4& transform, const glm::vec3& scale)
 	transform[2][2] = scale.z;
 }
 
+glm::mat4 interpolateTransforms(const glm::mat4& from, const glm::mat4& to, float t)
+{
+	if (from == to) {
+		return to;
+	}
+
+	// Lengths of the basis vectors are the scale factors
+	glm::vec3 fromScale(glm::length(glm::vec3(from[0])), glm::length(glm::vec3(from[1])), glm::length(glm::vec3(from[2])));
+	glm::vec3 toScale(glm::length(glm::vec3(to[0])), glm::length(glm::vec3(to[1])), glm::length(glm::vec3(to[2])));
+
+	if (fromScale.x == 0.0f || fromScale.y == 0.0f || fromScale.z == 0.0f ||
+		toScale.x == 0.0f || toScale.y == 0.0f || toScale.z == 0.0f) {
+		return to;
+	}
+
+	glm::quat fromRotation = glm::quat_cast(glm::mat3(glm::vec3(from[0]) / fromScale.x, glm::vec3(from[1]) / fromScale.y, glm::vec3(from[2]) / fromScale.z));
+	glm::quat toRotation = glm::quat_cast(glm::mat3(glm::vec3(to[0]) / toScale.x, glm::vec3(to[1]) / toScale.y, glm::vec3(to[2]) / toScale.z));
+
+	glm::mat4 transform = glm::mat4_cast(glm::slerp(fromRotation, toRotation, t)) * glm::scale(glm::mix(fromScale, toScale, t));
+	transform[3] = glm::mix(from[3], to[3], t);
+
+	return transform;
+}
+
 /**
  * @fn	ostream &operator<< (ostream &os, const vec2 &V) { os << "[ " << V.x << " " << V.y << " ]"; return os;
  *
@@ -160,4 +160,18 @@ glm::vec3 getPositionVec3FromTransform(const glm::mat4& transform);
 glm::vec3 getScaleFromTransform(const glm::mat4& transform);
 void setPositionVec3ForTransform(glm::mat4& transform, const glm::vec3& position);
 void setRotationMat3ForTransform(glm::mat4& transform, const glm::mat4& rotation);
-void setScaleForTransform(glm::mat4& transform, const glm::vec3& scale);
\ No newline at end of file
+void setScaleForTransform(glm::mat4& transform, const glm::vec3& scale);
+
+/**
+ * @fn	glm::mat4 interpolateTransforms(const glm::mat4& from, const glm::mat4& to, float t);
+ *
+ * @brief	Blends two affine transformations. Positions and scales are interpolated linearly
+ * 			and rotations are spherically interpolated.
+ *
+ * @param	from	The transformation at t equal to zero.
+ * @param	to  	The transformation at t equal to one.
+ * @param	t   	The interpolation parameter.
+ *
+ * @returns	The blended transformation.
+ */
+glm::mat4 interpolateTransforms(const glm::mat4& from, const glm::mat4& to, float t);
\ No newline at end of file
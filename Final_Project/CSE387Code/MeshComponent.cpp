@@ -1,4 +1,7 @@
 #include "MeshComponent.h"
+#include "GLStateCache.h"
+#include "TextureManager.h"
+#include "RenderSnapshot.h"
 
 #define VERBOSE true
 
@@ -6,16 +9,21 @@ MeshComponent::~MeshComponent()
 {
 	for (auto& subMesh : subMeshes) {
 
-		glDeleteVertexArrays(1, &subMesh.vao);
+		// Sub-meshes of headless games have no buffers
+		if (subMesh.vao != 0) {
 
-		glDeleteBuffers(1, &subMesh.vertexBuffer);
+			GLStateCache::deleteVertexArrays(1, &subMesh.vao);
 
-		if (subMesh.renderMode == INDEXED) {
-			glDeleteBuffers(1, &subMesh.indexBuffer);
+			GLStateCache::deleteBuffers(1, &subMesh.vertexBuffer);
+
+			if (subMesh.renderMode == INDEXED) {
+				GLStateCache::deleteBuffers(1, &subMesh.indexBuffer);
+			}
 		}
 
 		if (subMesh.material != nullptr) {
 
+			subMesh.material->releaseTextures();
 			delete subMesh.material;
 		}
 	}
@@ -26,43 +34,105 @@ MeshComponent::~MeshComponent()
 } // end destructor
 
 
-// Preform drawing operations. Draw this object and all of its children.
-void MeshComponent::draw()
+void MeshComponent::addToSnapshot(RenderSnapshot& snapshot)
 {
-	// Only active game objects are rendered
-	if (this->owningGameObject->getState() == ACTIVE) {
+	// Only active game objects are rendered. Batched meshes are rendered by the StaticBatcher.
+	if (this->owningGameObject->getState() == ACTIVE && batched == false) {
 
-		// Use the shader program for this object
-		glUseProgram(this->shaderProgram);
+		MeshDraw meshDraw;
 
-		// Set Modeling transformation
-		SharedProjectionAndViewing::setModelingMatrix(this->owningGameObject->sceneNode.getModelingTransformation());
+		meshDraw.mesh = this;
+		meshDraw.shaderProgram = this->shaderProgram;
+		meshDraw.modelingTransformation = this->owningGameObject->sceneNode.getInterpolatedModelingTransformation(snapshot.interpolation);
 
-		for (auto& subMesh : subMeshes) {
+		if (getWorldBoundingSphere(meshDraw.modelingTransformation, meshDraw.boundingCenter, meshDraw.boundingRadius) == false) {
 
-			// Bind vertex array object
-			glBindVertexArray(subMesh.vao);
+			meshDraw.boundingRadius = -1.0f;
+		}
 
-			// Set the material properties in the shader program
-			SharedMaterialProperties::setShaderMaterialProperties(subMesh.material);
+		meshDraw.impostor = getImpostor();
 
-			if (subMesh.renderMode == ORDERED) {
+		meshDraw.firstSubMesh = snapshot.subMeshes.size();
 
-				// Fetch input data for pipeline	
-				glDrawArrays(subMesh.primitiveMode, 0, subMesh.count);
+		for (auto& subMesh : getSubMeshes()) {
 
-			}
-			else { // renderMode == INDEXED
+			snapshot.subMeshes.push_back(&subMesh);
 
-				// Fetch input data for pipeline	
-				glDrawElements(subMesh.primitiveMode, subMesh.count, GL_UNSIGNED_INT, 0);
-			}
-
-			SharedMaterialProperties::cleanUpMaterial(subMesh.material);
+			// Materials are copied because they can be changed while the snapshot is rendered
+			snapshot.materials.push_back(subMesh.material != nullptr ? *subMesh.material : Material());
 		}
+
+		meshDraw.subMeshCount = snapshot.subMeshes.size() - meshDraw.firstSubMesh;
+
+		snapshot.meshes.push_back(meshDraw);
+	}
+
+} // end addToSnapshot
+
+
+void MeshComponent::getProgramMaterials(std::vector<std::pair<GLuint, const Material*>>& programMaterials)
+{
+	for (auto& subMesh : getSubMeshes()) {
+
+		programMaterials.push_back({ this->shaderProgram, subMesh.material });
+	}
+
+} // end getProgramMaterials
+
+
+float MeshComponent::getProjectedSize(const glm::vec3& worldCenter, float radius)
+{
+	glm::vec4 eyeCenter = SharedProjectionAndViewing::getViewMatrix() * glm::vec4(worldCenter, 1.0f);
+
+	float distance = -eyeCenter.z;
+
+	// Viewpoint is inside the bounding sphere
+	if (distance <= radius) {
+
+		return std::numeric_limits<float>::max();
+	}
+
+	// Projected diameter of the bounding sphere in pixels
+	return radius * SharedProjectionAndViewing::getProjectionMatrix()[1][1] * TextureManager::getViewportHeight() / distance;
+
+} // end getProjectedSize
+
+
+bool MeshComponent::getWorldBoundingSphere(glm::vec3& center, float& radius)
+{
+	return getWorldBoundingSphere(this->owningGameObject->sceneNode.getModelingTransformation(), center, radius);
+
+} // end getWorldBoundingSphere
+
+
+bool MeshComponent::getWorldBoundingSphere(const glm::mat4& modelMatrix, glm::vec3& center, float& radius)
+{
+	if (this->collisionShape == nullptr) {
+
+		return false;
+	}
+
+	// The bounding sphere of the collision shape does not change
+	if (boundingRadius < 0.0f) {
+
+		btVector3 shapeCenter;
+		btScalar shapeRadius;
+		this->collisionShape->getBoundingSphere(shapeCenter, shapeRadius);
+
+		boundingCenter = glm::vec3(shapeCenter.x(), shapeCenter.y(), shapeCenter.z());
+		boundingRadius = shapeRadius;
 	}
 
-} // end draw
+	// Account for the largest scale factor of the modeling transformation
+	float scale = std::max(glm::length(glm::vec3(modelMatrix[0])),
+					std::max(glm::length(glm::vec3(modelMatrix[1])), glm::length(glm::vec3(modelMatrix[2]))));
+
+	center = glm::vec3(modelMatrix * glm::vec4(boundingCenter, 1.0f));
+	radius = boundingRadius * scale;
+
+	return true;
+
+} // end getWorldBoundingSphere
 
 
 SubMesh MeshComponent::buildSubMesh(const std::vector<pntVertexData>& vertexData, const std::vector<unsigned int>& indices, Material* material)
@@ -72,13 +142,21 @@ SubMesh MeshComponent::buildSubMesh(const std::vector<pntVertexData>& vertexData
 	// Store the address of the material struct for the submesh
 	subMesh.material = material;
 
+	subMesh.count = static_cast<unsigned int>(indices.size());
+	subMesh.renderMode = INDEXED;
+
+	// Headless games keep the material and count but create no buffers
+	if (Game::isHeadless()) {
+		return subMesh;
+	}
+
 	// Generate and bind the vertex array object
 	glGenVertexArrays(1, &subMesh.vao);
-	glBindVertexArray(subMesh.vao);
+	GLStateCache::bindVertexArray(subMesh.vao);
 
 	// Generate, bind, and load the vertex array object
 	glGenBuffers(1, &subMesh.vertexBuffer);
-	glBindBuffer(GL_ARRAY_BUFFER, subMesh.vertexBuffer);
+	GLStateCache::bindBuffer(GL_ARRAY_BUFFER, subMesh.vertexBuffer);
 	glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(pntVertexData), &vertexData[0], GL_STATIC_DRAW);
 
 	// Specify the location and data format of the positions, normals, and texture coordinates
@@ -90,13 +168,10 @@ SubMesh MeshComponent::buildSubMesh(const std::vector<pntVertexData>& vertexData
 	glEnableVertexAttribArray(2);
 
 	// Generate, bind, and buffer the indices in the Index Array Buffer
-	subMesh.count = static_cast<unsigned int>(indices.size());
 	glGenBuffers(1, &subMesh.indexBuffer);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, subMesh.indexBuffer);
+	GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, subMesh.indexBuffer);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
 
-	subMesh.renderMode = INDEXED;
-
 	return subMesh;
 
 } // end buildSubMesh
@@ -109,13 +184,21 @@ SubMesh MeshComponent::buildSubMesh(const std::vector<pntVertexData>& vertexData
 	// Store the address of the material struct for the submesh
 	subMesh.material = material;
 
+	subMesh.count = static_cast<unsigned int>(vertexData.size());
+	subMesh.renderMode = ORDERED;
+
+	// Headless games keep the material and count but create no buffers
+	if (Game::isHeadless()) {
+		return subMesh;
+	}
+
 	// Generate and bind the vertex array object
 	glGenVertexArrays(1, &subMesh.vao);
-	glBindVertexArray(subMesh.vao);
+	GLStateCache::bindVertexArray(subMesh.vao);
 
 	// Generate, bind, and load the vertex array object
 	glGenBuffers(1, &subMesh.vertexBuffer);
-	glBindBuffer(GL_ARRAY_BUFFER, subMesh.vertexBuffer);
+	GLStateCache::bindBuffer(GL_ARRAY_BUFFER, subMesh.vertexBuffer);
 	glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(pntVertexData), &vertexData[0], GL_STATIC_DRAW);
 
 	// Specify the location and data format of the positions, normals, and texture coordinates
@@ -126,8 +209,6 @@ SubMesh MeshComponent::buildSubMesh(const std::vector<pntVertexData>& vertexData
 	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(pntVertexData), (void*)(2 * sizeof(glm::vec3)));
 	glEnableVertexAttribArray(2);
 
-	subMesh.renderMode = ORDERED;
-
 	return subMesh;
 
 } // end buildSubMesh
@@ -3,63 +3,12 @@
 #include "MathLibsConstsFuncs.h"
 #include "Component.h"
 #include "SharedMaterialProperties.h"
+#include "SubMesh.h"
 #include "SharedProjectionAndViewing.h"
 #include "btBulletDynamicsCommon.h"
 #include "Texture.h"
 
-/**
- * @enum	RENDER_MODE
- *
- * @brief	Values that represent render modes to be used when a sub-mesh if rendered.
- */
-enum RENDER_MODE { ORDERED, INDEXED };
-
-/**
- * @struct	SubMesh
- *
- * @brief	Stuct containing values needed to render a sub-mesh. All visible objects
- * 			(Meshes) are rendered using one or more sub-meshes.
- */
-struct SubMesh {
-
-	GLuint vao = GL_INVALID_VALUE; // ID for Vertex Array Object for the sub-mesh
-
-	GLuint vertexBuffer = GL_INVALID_VALUE; // ID for vertex data buffer for the sub-mesh
-
-	GLuint indexBuffer = GL_INVALID_VALUE; // ID for index buffer for the sub-mesh (if indexed rendering is used)
-
-	Material* material = nullptr; // Pointer to material properties including textures for the sub-mesh
-
-	GLuint count = 0; // Either the number of vertices in the mesh or the number of indices
-
-	RENDER_MODE renderMode = INDEXED; // Render mode for the mesh. Either ORDERED or INDEXED
-
-	GLuint primitiveMode = GL_TRIANGLES; // Primite mode for the mesh GL_POINTS, GL_LINES, etc.
-
-}; // end SubMesh
-
-
-/**
- * @struct	pntVertexData
- *
- * @brief	Structure for holding vertex data for a single vertex.
- */
-struct pntVertexData
-{
-	glm::vec3 m_pos = ZERO_V3; // Position of the vertex in Object coordinates
-	glm::vec3 m_normal = ZERO_V3; // Normal vector for the vertex in Object coordinates
-	glm::vec2 m_textCoord = ZERO_V2; // 2D vertex texture coordinates
-
-	pntVertexData() {}
-
-	pntVertexData(glm::vec3 pos, glm::vec3 normal, glm::vec2 textCoord)
-	{
-		m_pos = pos;
-		m_normal = normal;
-		m_textCoord = textCoord;
-	}
-};
-
+class ImpostorAtlas;
 
 /**
  * @class	Mesh
@@ -101,14 +50,27 @@ public:
 	virtual void initialize() override = 0;
 
 	/**
-	 * @fn	virtual void Mesh::draw();
+	 * @fn	virtual void MeshComponent::addToSnapshot(struct RenderSnapshot& snapshot);
+	 *
+	 * @brief	Copies the modeling transformation and bounds of the mesh and adds its
+	 * 			sub-meshes to a render snapshot so they can be culled, sorted, and rendered
+	 * 			with the sub-meshes of other objects on the render thread. Only active
+	 * 			game objects that are not batched are added. The modeling transformation is
+	 * 			interpolated between the last two fixed updates.
+	 *
+	 * @param [in,out]	snapshot	The render snapshot being built.
+	 */
+	virtual void addToSnapshot(struct RenderSnapshot& snapshot);
+
+	/**
+	 * @fn	void MeshComponent::getProgramMaterials(std::vector<std::pair<GLuint, const Material*>>& programMaterials);
+	 *
+	 * @brief	Adds the shader program and the material of each sub-mesh to a list so
+	 * 			the shader variants can be built before rendering.
 	 *
-	 * @brief	Renders all sub-meshes that are part of the object. Binds
-	 * 			the vertex array object, sets the material properties, and sets
-	 * 			the modeling transformation based on the world transformation
-	 * 			of the owning game object.
+	 * @param [in,out]	programMaterials	The list of program and material pairs.
 	 */
-	virtual void draw();
+	void getProgramMaterials(std::vector<std::pair<GLuint, const Material*>>& programMaterials);
 
 	/**
 	 * @fn	virtual bool MeshComponent::isMesh() override
@@ -131,10 +93,8 @@ public:
 	 */
 	btCollisionShape* getCollisionShape() { return this->collisionShape; }
 
-protected:
-
 	/**
-	 * @fn	SubMesh MeshComponent::buildSubMesh(const std::vector<pntVertexData>& vertexData, const std::vector<unsigned int>& indices, Material* material);
+	 * @fn	static SubMesh MeshComponent::buildSubMesh(const std::vector<pntVertexData>& vertexData, const std::vector<unsigned int>& indices, Material* material);
 	 *
 	 * @brief	Builds one sub mesh  that will be rendered using indexed rendering based 
 	 * 			the vertex data, indices, and material properties that are passed to it. 
@@ -147,10 +107,10 @@ protected:
 	 *
 	 * @returns	A SubMesh.
 	 */
-	SubMesh buildSubMesh(const std::vector<pntVertexData>& vertexData, const std::vector<unsigned int>& indices, Material* material);
+	static SubMesh buildSubMesh(const std::vector<pntVertexData>& vertexData, const std::vector<unsigned int>& indices, Material* material);
 
 	/**
-	 * @fn	SubMesh Mesh::buildSubMesh(const std::vector<pntVertexData>& vertexData, Material* material);
+	 * @fn	static SubMesh MeshComponent::buildSubMesh(const std::vector<pntVertexData>& vertexData, Material* material);
 	 * 		
 	 * @brief	Builds one sub mesh  that will be rendered using sequential rendering based
 	 * 			the vertex data, indices, and material properties that are passed to it.
@@ -161,7 +121,102 @@ protected:
 	 *
 	 * @returns	A SubMesh.
 	 */
-	SubMesh buildSubMesh(const std::vector<pntVertexData>& vertexData, Material* material);
+	static SubMesh buildSubMesh(const std::vector<pntVertexData>& vertexData, Material* material);
+
+	/**
+	 * @fn	void MeshComponent::setStaticGeometry(bool staticGeometry)
+	 *
+	 * @brief	Marks the mesh as never moving so it can be merged with other static meshes
+	 * 			by the StaticBatcher.
+	 */
+	void setStaticGeometry(bool staticGeometry) { this->staticGeometry = staticGeometry; }
+
+	bool isStaticGeometry() const { return staticGeometry; }
+
+	/**
+	 * @fn	void MeshComponent::setBatched(bool batched)
+	 *
+	 * @brief	Set by the StaticBatcher when the sub-meshes have been merged into combined
+	 * 			buffers. Batched meshes are not added to render queues.
+	 */
+	void setBatched(bool batched) { this->batched = batched; }
+
+	bool isBatched() const { return batched; }
+
+	/**
+	 * @fn	static float MeshComponent::getProjectedSize(const glm::vec3& worldCenter, float radius);
+	 *
+	 * @brief	Approximates the size on the screen of a sphere using the current viewing and
+	 * 			projection transformations.
+	 *
+	 * @param	worldCenter	The center of the sphere in world coordinates.
+	 * @param	radius	   	The radius of the sphere.
+	 *
+	 * @returns	The projected diameter in pixels. The largest float value if the viewpoint is
+	 * 			inside of the sphere.
+	 */
+	static float getProjectedSize(const glm::vec3& worldCenter, float radius);
+
+	/**
+	 * @fn	bool MeshComponent::getWorldBoundingSphere(glm::vec3& center, float& radius);
+	 *
+	 * @brief	Gets the bounding sphere of the collision shape in world coordinates.
+	 *
+	 * @param [out]	center	The center of the sphere.
+	 * @param [out]	radius	The radius of the sphere.
+	 *
+	 * @returns	False if the mesh does not have a collision shape.
+	 */
+	bool getWorldBoundingSphere(glm::vec3& center, float& radius);
+
+	/**
+	 * @fn	bool MeshComponent::getWorldBoundingSphere(const glm::mat4& modelMatrix, glm::vec3& center, float& radius);
+	 *
+	 * @brief	Gets the bounding sphere of the collision shape transformed by a modeling
+	 * 			transformation.
+	 *
+	 * @param 	   	modelMatrix	The modeling transformation.
+	 * @param [out]	center	   	The center of the sphere.
+	 * @param [out]	radius	   	The radius of the sphere.
+	 *
+	 * @returns	False if the mesh does not have a collision shape.
+	 */
+	bool getWorldBoundingSphere(const glm::mat4& modelMatrix, glm::vec3& center, float& radius);
+
+protected:
+
+	/** @brief	Reads the sub-meshes and shader program of static meshes */
+	friend class StaticBatcher;
+
+	/**
+	 * @fn	virtual std::vector<SubMesh>& MeshComponent::getSubMeshes()
+	 *
+	 * @brief	Gets the sub meshes that are rendered for this component.
+	 *
+	 * @returns	The sub meshes.
+	 */
+	virtual std::vector<SubMesh>& getSubMeshes() { return subMeshes; }
+
+	/**
+	 * @fn	virtual const ImpostorAtlas* MeshComponent::getImpostor() const
+	 *
+	 * @brief	Gets the impostor atlas that distant copies of the mesh are drawn with.
+	 *
+	 * @returns	Null if the mesh is always drawn as a mesh.
+	 */
+	virtual const ImpostorAtlas* getImpostor() const { return nullptr; }
+
+	/** @brief	Center of the bounding sphere of the collision shape in object coordinates */
+	glm::vec3 boundingCenter = ZERO_V3;
+
+	/** @brief	Radius of the bounding sphere of the collision shape. Negative until it is computed. */
+	float boundingRadius = -1.0f;
+
+	/** @brief	True if the mesh never moves */
+	bool staticGeometry = false;
+
+	/** @brief	True if the sub-meshes are rendered as part of static batches */
+	bool batched = false;
 
 	/** @brief	Indentifier for the shader program used to render all sub-meshes */
 	GLuint shaderProgram = 0; 
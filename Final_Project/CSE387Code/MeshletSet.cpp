@@ -0,0 +1,159 @@
+#include "MeshletSet.h"
+
+#include <algorithm>
+
+#define VERBOSE false
+
+// Sub-meshes with fewer triangles are culled as a whole
+#define MIN_CLUSTERED_TRIANGLES 512
+
+
+MeshletSet* MeshletSet::build(const std::vector<pntVertexData>& vertexData, const std::vector<unsigned int>& indices)
+{
+	size_t triangleCount = indices.size() / 3;
+
+	if (triangleCount < MIN_CLUSTERED_TRIANGLES) {
+		return nullptr;
+	}
+
+	MeshletSet* meshlets = new MeshletSet();
+
+	// Meshlet that last used each vertex. Counts the distinct vertices of the current meshlet.
+	std::vector<int> vertexMeshlet(vertexData.size(), -1);
+
+	size_t first = 0;
+	int vertexCount = 0;
+
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+
+		int newVertices = 0;
+
+		for (size_t corner = 0; corner < 3; corner++) {
+
+			if (vertexMeshlet[indices[triangle * 3 + corner]] != meshlets->count) {
+				newVertices++;
+			}
+		}
+
+		size_t meshletTriangles = triangle - first / 3;
+
+		// Start a new meshlet when the triangle does not fit
+		if (vertexCount + newVertices > MAX_VERTICES || meshletTriangles >= MAX_TRIANGLES) {
+
+			meshlets->addMeshlet(vertexData, indices, first, triangle * 3);
+
+			first = triangle * 3;
+			vertexCount = 0;
+		}
+
+		for (size_t corner = 0; corner < 3; corner++) {
+
+			int& lastMeshlet = vertexMeshlet[indices[triangle * 3 + corner]];
+
+			if (lastMeshlet != meshlets->count) {
+
+				lastMeshlet = meshlets->count;
+				vertexCount++;
+			}
+		}
+	}
+
+	meshlets->addMeshlet(vertexData, indices, first, triangleCount * 3);
+
+	// Padding is never reported as visible
+	size_t padded = (meshlets->count + 3) & ~static_cast<size_t>(3);
+
+	for (auto bounds : { &meshlets->centerX, &meshlets->centerY, &meshlets->centerZ, &meshlets->radius,
+						 &meshlets->coneX, &meshlets->coneY, &meshlets->coneZ, &meshlets->coneCutoff }) {
+
+		bounds->resize(padded, 0.0f);
+	}
+
+	if (VERBOSE) cout << triangleCount << " triangles partitioned into " << meshlets->count << " meshlets" << endl;
+
+	return meshlets;
+
+} // end build
+
+
+void MeshletSet::addMeshlet(const std::vector<pntVertexData>& vertexData, const std::vector<unsigned int>& indices, size_t first, size_t last)
+{
+	// Sphere around the bounding box of the vertices
+	glm::vec3 minimum(std::numeric_limits<float>::max());
+	glm::vec3 maximum(-std::numeric_limits<float>::max());
+
+	for (size_t i = first; i < last; i++) {
+
+		minimum = glm::min(minimum, vertexData[indices[i]].m_pos);
+		maximum = glm::max(maximum, vertexData[indices[i]].m_pos);
+	}
+
+	glm::vec3 center = (minimum + maximum) * 0.5f;
+	float sphereRadius = 0.0f;
+
+	for (size_t i = first; i < last; i++) {
+
+		sphereRadius = std::max(sphereRadius, glm::length(vertexData[indices[i]].m_pos - center));
+	}
+
+	// Normals of the front faces. Triangles are counterclockwise from the front.
+	std::vector<glm::vec3> normals;
+	glm::vec3 axis = ZERO_V3;
+
+	for (size_t i = first; i + 2 < last; i += 3) {
+
+		const glm::vec3& a = vertexData[indices[i]].m_pos;
+		const glm::vec3& b = vertexData[indices[i + 1]].m_pos;
+		const glm::vec3& c = vertexData[indices[i + 2]].m_pos;
+
+		glm::vec3 normal = glm::cross(b - a, c - a);
+		float length = glm::length(normal);
+
+		// Degenerate triangles are never rendered
+		if (length > 0.0f) {
+
+			normals.push_back(normal / length);
+			axis += normals.back();
+		}
+	}
+
+	float cutoff = 1.0f;
+
+	if (glm::length(axis) > 0.0f) {
+
+		axis = glm::normalize(axis);
+
+		float minimumDot = 1.0f;
+
+		for (auto& normal : normals) {
+
+			minimumDot = std::min(minimumDot, glm::dot(axis, normal));
+		}
+
+		// Cones wider than a hemisphere always have a triangle facing the viewpoint
+		if (minimumDot > 0.0f) {
+
+			cutoff = std::sqrt(1.0f - minimumDot * minimumDot);
+		}
+		else {
+
+			axis = ZERO_V3;
+		}
+	}
+
+	centerX.push_back(center.x);
+	centerY.push_back(center.y);
+	centerZ.push_back(center.z);
+	radius.push_back(sphereRadius);
+
+	coneX.push_back(axis.x);
+	coneY.push_back(axis.y);
+	coneZ.push_back(axis.z);
+	coneCutoff.push_back(cutoff);
+
+	firstIndex.push_back(static_cast<GLuint>(first));
+	indexCount.push_back(static_cast<GLuint>(last - first));
+
+	count++;
+
+} // end addMeshlet
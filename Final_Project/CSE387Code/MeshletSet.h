@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+
+#include "MathLibsConstsFuncs.h"
+#include "SubMesh.h"
+
+/**
+ * @struct	MeshletSet
+ *
+ * @brief	Clusters of consecutive triangles of an indexed sub-mesh. Each meshlet has at most
+ * 			MAX_VERTICES distinct vertices and MAX_TRIANGLES triangles, a bounding sphere and
+ * 			a cone that holds the normals of its triangles. The cone is used to skip meshlets
+ * 			whose triangles all face away from the viewpoint.
+ *
+ * 			Meshlets are consecutive ranges of the index buffer, so the index buffer is not
+ * 			changed. Assimp already orders the triangles for the vertex cache, which keeps the
+ * 			triangles of a range close together.
+ *
+ * 			The bounds are stored as separate arrays of floats, padded to a multiple of four,
+ * 			so four meshlets can be tested at once. All values are in object coordinates.
+ */
+struct MeshletSet {
+
+	static const int MAX_VERTICES = 64;
+
+	static const int MAX_TRIANGLES = 124;
+
+	int count = 0; // Number of meshlets
+
+	std::vector<float> centerX, centerY, centerZ, radius; // Bounding spheres
+
+	std::vector<float> coneX, coneY, coneZ; // Average normals. Zero if the triangles face too many ways.
+
+	std::vector<float> coneCutoff; // Sine of the angle between the average normal and the farthest normal
+
+	std::vector<GLuint> firstIndex; // First index of the meshlet in the index buffer
+
+	std::vector<GLuint> indexCount; // Number of indices of the meshlet
+
+	/**
+	 * @fn	static MeshletSet* MeshletSet::build(const std::vector<pntVertexData>& vertexData, const std::vector<unsigned int>& indices);
+	 *
+	 * @brief	Partitions a triangle list into meshlets.
+	 *
+	 * @param	vertexData	The vertices of the sub-mesh.
+	 * @param	indices   	The indices of the triangles of the sub-mesh.
+	 *
+	 * @returns	Null if the sub-mesh is too small to be worth culling in pieces. Otherwise a new
+	 * 			meshlet set that is owned by the caller.
+	 */
+	static MeshletSet* build(const std::vector<pntVertexData>& vertexData, const std::vector<unsigned int>& indices);
+
+protected:
+
+	/**
+	 * @fn	void MeshletSet::addMeshlet(const std::vector<pntVertexData>& vertexData, const std::vector<unsigned int>& indices, size_t first, size_t last);
+	 *
+	 * @brief	Computes the bounds of the triangles in a range of indices and appends them.
+	 */
+	void addMeshlet(const std::vector<pntVertexData>& vertexData, const std::vector<unsigned int>& indices, size_t first, size_t last);
+
+}; // end MeshletSet
@@ -1,4 +1,8 @@
 #include "ModelMeshComponent.h"
+#include "CpuProfiler.h"
+#include "GLStateCache.h"
+#include "MeshletSet.h"
+#include "ImpostorAtlas.h"
 
 #define VERBOSE false
 
@@ -14,6 +18,11 @@ ModelMeshComponent::~ModelMeshComponent()
 	// Search for the texture among those that were previously loaded
 	auto iter = loadedModels.find(filePathAndName);
 
+	// Models that failed to load were never added
+	if (iter == loadedModels.end()) {
+		return;
+	}
+
 	iter->second->copyCount--;
 
 	if (VERBOSE) cout << "objects left of this type " << iter->second->copyCount << endl;
@@ -24,24 +33,38 @@ ModelMeshComponent::~ModelMeshComponent()
 
 		for (auto& subMesh : modelSubMeshes) {
 
-			glDeleteVertexArrays(1, &subMesh.vao);
+			// Sub-meshes of headless games have no buffers
+			if (subMesh.vao != 0) {
+
+				GLStateCache::deleteVertexArrays(1, &subMesh.vao);
 
-			glDeleteBuffers(1, &subMesh.vertexBuffer);
+				GLStateCache::deleteBuffers(1, &subMesh.vertexBuffer);
 
-			if (subMesh.renderMode == INDEXED) {
-				glDeleteBuffers(1, &subMesh.indexBuffer);
+				if (subMesh.renderMode == INDEXED) {
+					GLStateCache::deleteBuffers(1, &subMesh.indexBuffer);
+				}
 			}
 
 			if (subMesh.material != nullptr) {
 
+				subMesh.material->releaseTextures();
 				delete subMesh.material;
 			}
+
+			delete subMesh.meshlets;
 		}
+
+		delete impostor;
+
+		// The model is loaded again the next time it is used
+		loadedModels.erase(iter);
 	}
 }
 
 void ModelMeshComponent::initialize()
 {
+	CPU_PROFILE_SCOPE("ModelMeshComponent::initialize");
+
 	// Search for the texture among those that were previously loaded
 	auto iter = loadedModels.find(filePathAndName);
 
@@ -54,6 +77,8 @@ void ModelMeshComponent::initialize()
 
 		modelSubMeshes = iter->second->modelSubMeshes;
 
+		impostor = iter->second->impostor;
+
 		iter->second->copyCount++;
 	}
 	else {
@@ -117,7 +142,12 @@ void ModelMeshComponent::initialize()
 				material = new Material(); // Use the default material settings
 			}
 
-			this->modelSubMeshes.push_back(buildSubMesh(vData, indices, material));
+			SubMesh subMesh = buildSubMesh(vData, indices, material);
+
+			// Large sub-meshes are split into meshlets that are culled separately
+			subMesh.meshlets = MeshletSet::build(vData, indices);
+
+			this->modelSubMeshes.push_back(subMesh);
 
 			// Add the mesh collision shape for collision detection
 			// Do NOT use the default btTransform constructor for this! It  
@@ -134,6 +164,16 @@ void ModelMeshComponent::initialize()
 
 			loadedModels.emplace(filePathAndName, this);
 		}
+
+		// Render the views that distant copies of the model are drawn with
+		glm::vec3 center;
+		float radius;
+
+		if (Game::isHeadless() == false && ImpostorAtlas::isEnabled() == true &&
+			getWorldBoundingSphere(glm::mat4(1.0f), center, radius) == true) {
+
+			impostor = ImpostorAtlas::bake(modelSubMeshes, center, radius);
+		}
 	}
 
 } // end initialize
@@ -240,6 +280,11 @@ Material* ModelMeshComponent::readInMaterialProperties( const aiMaterial* assimp
 	// Temporary to hold the path to a texture
 	aiString path;
 
+	// Headless games never sample textures
+	if (Game::isHeadless()) {
+		return meshMaterial;
+	}
+
 	// Load diffuse, specular, and normal maps
 	if (assimpMaterial->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
 
@@ -247,7 +292,12 @@ Material* ModelMeshComponent::readInMaterialProperties( const aiMaterial* assimp
 
 			std::string relativeFilePath = getDirectoryPath(filename) + path.C_Str();
 
-			meshMaterial->setDiffuseTexture(Texture::GetTexture(relativeFilePath)->getTextureObject());
+			if (TextureArray::isEnabled()) {
+				meshMaterial->setDiffuseTexture(TextureArray::GetTextureLayer(relativeFilePath));
+			}
+			else {
+				meshMaterial->setDiffuseTexture(Texture::GetTexture(relativeFilePath));
+			}
 		}
 	}
 	if (assimpMaterial->GetTextureCount(aiTextureType_SPECULAR) > 0) {
@@ -256,7 +306,12 @@ Material* ModelMeshComponent::readInMaterialProperties( const aiMaterial* assimp
 
 			std::string relativeFilePath = getDirectoryPath(filename) + path.C_Str();
 
-			meshMaterial->setSpecularTexture(Texture::GetTexture(relativeFilePath)->getTextureObject());
+			if (TextureArray::isEnabled()) {
+				meshMaterial->setSpecularTexture(TextureArray::GetTextureLayer(relativeFilePath));
+			}
+			else {
+				meshMaterial->setSpecularTexture(Texture::GetTexture(relativeFilePath));
+			}
 		}
 	}
 	//if (assimpMaterial->GetTextureCount(aiTextureType_NORMALS) > 0) {
@@ -273,34 +328,4 @@ Material* ModelMeshComponent::readInMaterialProperties( const aiMaterial* assimp
 
 	return meshMaterial;
 
-} // end readInMaterialProperties
-
-
-// Preform drawing operations. Draw this object and all of its children.
-void ModelMeshComponent::draw()
-{
-	// Only active game objects are rendered
-	if (this->owningGameObject->getState() == ACTIVE) {
-
-		// Use the shader program for this object
-		glUseProgram(this->shaderProgram);
-
-		// Set Modeling transformation
-		SharedProjectionAndViewing::setModelingMatrix(this->owningGameObject->sceneNode.getModelingTransformation());
-
-		for (auto& subMesh : modelSubMeshes) {
-
-			// Bind vertex array object
-			glBindVertexArray(subMesh.vao);
-
-			// Set the material properties in the shader program
-			SharedMaterialProperties::setShaderMaterialProperties(subMesh.material);
-
-			// Fetch input data for pipeline	
-			glDrawElements(subMesh.primitiveMode, subMesh.count, GL_UNSIGNED_INT, 0);
-
-			SharedMaterialProperties::cleanUpMaterial(subMesh.material);
-		}
-	}
-
-} // end draw
\ No newline at end of file
+} // end readInMaterialProperties
\ No newline at end of file
@@ -38,7 +38,27 @@ public:
 	 */
 	virtual void initialize() override;
 
-	virtual void draw() override;
+	/**
+	 * @fn	virtual std::vector<SubMesh>& ModelMeshComponent::getSubMeshes() override
+	 *
+	 * @brief	Gets the sub meshes that are shared by all copies of the model.
+	 */
+	virtual std::vector<SubMesh>& getSubMeshes() override { return modelSubMeshes; }
+
+	/**
+	 * @fn	virtual const ImpostorAtlas* ModelMeshComponent::getImpostor() const override
+	 *
+	 * @brief	Gets the impostor atlas that is rendered when the model is loaded.
+	 */
+	virtual const ImpostorAtlas* getImpostor() const override { return impostor; }
+
+	/**
+	 * @fn	static bool ModelMeshComponent::isModelLoaded(const std::string& filePathAndName)
+	 *
+	 * @brief	Returns true if copies of the model are in use, so the next copy that is
+	 * 			initialized shares them instead of importing the file.
+	 */
+	static bool isModelLoaded(const std::string& filePathAndName) { return loadedModels.count(filePathAndName) > 0; }
 
 protected:
 
@@ -92,5 +112,8 @@ protected:
 	 avoid having to load multiple copies of a mesh.
 	 */
 	std::vector<SubMesh> modelSubMeshes;
+
+	/** @brief	Views of the model shared by all copies of it. Null if none were rendered. */
+	ImpostorAtlas* impostor = nullptr;
 };
 
@@ -0,0 +1,282 @@
+#include "OcclusionCuller.h"
+#include "EngineCounters.h"
+#include "GLStateCache.h"
+#include "BuildShaderProgram.h"
+
+#define VERBOSE false
+
+// Texture unit used to read the depth pyramid. Units 0 through 3 are used by materials.
+#define hiZTextureUnit 4
+
+#define sourceSizeLocation 0
+#define sourceDepthLocation 1
+
+GLuint OcclusionCuller::reductionProgram = 0;
+
+GLuint OcclusionCuller::emptyVao = 0;
+
+bool OcclusionCuller::occlusionEnabled = true;
+
+bool OcclusionCuller::gpuReduction = true;
+
+int OcclusionCuller::readbackSize = 128;
+
+
+OcclusionCuller::~OcclusionCuller()
+{
+	GLStateCache::deleteTextures(1, &depthTexture);
+	GLStateCache::deleteTextures(1, &pyramidTexture);
+	GLStateCache::deleteFramebuffers(1, &framebuffer);
+
+} // end destructor
+
+
+void OcclusionCuller::loadShaders()
+{
+	ShaderInfo shaders[] = {
+		{ GL_VERTEX_SHADER, "Shaders/hiZReduction.vs.glsl" },
+		{ GL_FRAGMENT_SHADER, "Shaders/hiZReduction.fs.glsl" },
+		{ GL_NONE, NULL } // signals that there are no more shaders
+	};
+
+	reductionProgram = BuildShaderProgram(shaders);
+
+	if (reductionProgram != 0) {
+
+		glProgramUniform1i(reductionProgram, sourceDepthLocation, hiZTextureUnit);
+
+		glGenVertexArrays(1, &emptyVao);
+	}
+	else {
+
+		std::cerr << "Hi-Z reduction program failed to build. Occlusion culling will reduce depth on the CPU." << std::endl;
+	}
+
+} // end loadShaders
+
+
+void OcclusionCuller::buildDepthPyramid(GLint x, GLint y, GLsizei width, GLsizei height, const glm::mat4& viewProjection)
+{
+	this->viewProjection = viewProjection;
+	this->viewportWidth = width;
+	this->viewportHeight = height;
+
+	if (width < 1 || height < 1) {
+
+		readbackDepth.clear();
+		return;
+	}
+
+	// Halve the viewport until it fits the read back size
+	int levels = 1;
+
+	while (getLevelSize(width, levels) > readbackSize || getLevelSize(height, levels) > readbackSize) {
+		levels++;
+	}
+
+	readbackLevel = levels;
+	readbackWidth = getLevelSize(width, levels);
+	readbackHeight = getLevelSize(height, levels);
+	readbackDepth.resize(readbackWidth * readbackHeight);
+
+	if (gpuReduction == true && reductionProgram != 0) {
+
+		reduceOnGpu(x, y, width, height, levels);
+	}
+	else {
+
+		reduceOnCpu(x, y, width, height, levels);
+	}
+
+} // end buildDepthPyramid
+
+
+void OcclusionCuller::reduceOnGpu(GLint x, GLint y, GLsizei width, GLsizei height, int levels)
+{
+	// Textures are only created again when the size of the viewport changes
+	if (width != textureWidth || height != textureHeight || levels != textureLevels) {
+
+		GLStateCache::deleteTextures(1, &depthTexture);
+		GLStateCache::deleteTextures(1, &pyramidTexture);
+
+		GLStateCache::activeTexture(GL_TEXTURE0 + hiZTextureUnit);
+
+		glGenTextures(1, &depthTexture);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, depthTexture);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, width, height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+
+		// Level zero of the pyramid is half the size of the viewport
+		glGenTextures(1, &pyramidTexture);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, pyramidTexture);
+		glTexStorage2D(GL_TEXTURE_2D, levels, GL_R32F, getLevelSize(width, 1), getLevelSize(height, 1));
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		if (framebuffer == 0) {
+			glGenFramebuffers(1, &framebuffer);
+		}
+
+		textureWidth = width;
+		textureHeight = height;
+		textureLevels = levels;
+	}
+
+	GLuint previousFramebuffer = GLStateCache::getFramebuffer(GL_DRAW_FRAMEBUFFER);
+
+	// Copy the depth of the viewport from the read framebuffer
+	GLStateCache::activeTexture(GL_TEXTURE0 + hiZTextureUnit);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, depthTexture);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, x, y, width, height);
+
+	GLStateCache::useProgram(reductionProgram);
+	GLStateCache::bindVertexArray(emptyVao);
+	GLStateCache::bindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+	glDisable(GL_DEPTH_TEST);
+
+	GLsizei sourceWidth = width;
+	GLsizei sourceHeight = height;
+
+	for (int level = 0; level < levels; level++) {
+
+		GLsizei levelWidth = getLevelSize(width, level + 1);
+		GLsizei levelHeight = getLevelSize(height, level + 1);
+
+		// Read the previous level. Limiting the levels that can be read to the one
+		// below the level being written prevents a feedback loop.
+		if (level > 0) {
+
+			GLStateCache::bindTexture(GL_TEXTURE_2D, pyramidTexture);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level - 1);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level - 1);
+		}
+
+		glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pyramidTexture, level);
+
+		glViewport(0, 0, levelWidth, levelHeight);
+		glUniform2i(sourceSizeLocation, sourceWidth, sourceHeight);
+
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		EngineCounters::addDraw(GL_TRIANGLES, 3);
+
+		sourceWidth = levelWidth;
+		sourceHeight = levelHeight;
+	}
+
+	// Read back the last level
+	GLStateCache::bindTexture(GL_TEXTURE_2D, pyramidTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+	glGetTexImage(GL_TEXTURE_2D, levels - 1, GL_RED, GL_FLOAT, &readbackDepth[0]);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+
+	GLStateCache::bindFramebuffer(GL_DRAW_FRAMEBUFFER, previousFramebuffer);
+	GLStateCache::bindVertexArray(0);
+	glEnable(GL_DEPTH_TEST);
+	glViewport(x, y, width, height);
+
+} // end reduceOnGpu
+
+
+void OcclusionCuller::reduceOnCpu(GLint x, GLint y, GLsizei width, GLsizei height, int levels)
+{
+	std::vector<float> source(width * height);
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(x, y, width, height, GL_DEPTH_COMPONENT, GL_FLOAT, &source[0]);
+
+	int sourceWidth = width;
+	int sourceHeight = height;
+
+	std::vector<float> destination;
+
+	for (int level = 1; level <= levels; level++) {
+
+		int levelWidth = getLevelSize(width, level);
+		int levelHeight = getLevelSize(height, level);
+
+		destination.assign(levelWidth * levelHeight, 0.0f);
+
+		// Each texel holds the farthest depth of the two by two texels it covers
+		for (int row = 0; row < sourceHeight; row++) {
+			for (int column = 0; column < sourceWidth; column++) {
+
+				float& depth = destination[(row / 2) * levelWidth + column / 2];
+				depth = std::max(depth, source[row * sourceWidth + column]);
+			}
+		}
+
+		source.swap(destination);
+		sourceWidth = levelWidth;
+		sourceHeight = levelHeight;
+	}
+
+	readbackDepth.swap(source);
+
+} // end reduceOnCpu
+
+
+bool OcclusionCuller::isOccluded(const glm::vec3& minimum, const glm::vec3& maximum) const
+{
+	if (readbackDepth.empty()) {
+		return false;
+	}
+
+	// Screen rectangle and nearest depth of the box
+	float left = std::numeric_limits<float>::max(), bottom = std::numeric_limits<float>::max();
+	float right = -std::numeric_limits<float>::max(), top = -std::numeric_limits<float>::max();
+	float nearestDepth = 1.0f;
+
+	for (int i = 0; i < 8; i++) {
+
+		glm::vec4 corner((i & 1) ? maximum.x : minimum.x,
+						 (i & 2) ? maximum.y : minimum.y,
+						 (i & 4) ? maximum.z : minimum.z, 1.0f);
+
+		glm::vec4 clip = viewProjection * corner;
+
+		// Boxes that cross the near plane are treated as visible
+		if (clip.w <= 0.0f) {
+			return false;
+		}
+
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+		left = std::min(left, ndc.x);
+		right = std::max(right, ndc.x);
+		bottom = std::min(bottom, ndc.y);
+		top = std::max(top, ndc.y);
+		nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+	}
+
+	// Texels of the read back level covered by the rectangle
+	float scale = 1.0f / (1 << readbackLevel);
+
+	int firstColumn = glm::clamp(static_cast<int>((left * 0.5f + 0.5f) * viewportWidth * scale), 0, readbackWidth - 1);
+	int lastColumn = glm::clamp(static_cast<int>((right * 0.5f + 0.5f) * viewportWidth * scale), 0, readbackWidth - 1);
+	int firstRow = glm::clamp(static_cast<int>((bottom * 0.5f + 0.5f) * viewportHeight * scale), 0, readbackHeight - 1);
+	int lastRow = glm::clamp(static_cast<int>((top * 0.5f + 0.5f) * viewportHeight * scale), 0, readbackHeight - 1);
+
+	// Visible if any covered texel is farther away than the nearest point of the box
+	for (int row = firstRow; row <= lastRow; row++) {
+		for (int column = firstColumn; column <= lastColumn; column++) {
+
+			if (readbackDepth[row * readbackWidth + column] >= nearestDepth) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+
+} // end isOccluded
+
+
+void OcclusionCuller::endFrame()
+{
+	visibleLastFrame.swap(visibleThisFrame);
+	visibleThisFrame.clear();
+
+} // end endFrame
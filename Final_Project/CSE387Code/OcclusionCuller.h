@@ -0,0 +1,184 @@
+#pragma once
+
+#include <unordered_set>
+#include <vector>
+
+#include "MathLibsConstsFuncs.h"
+
+/**
+ * @class	OcclusionCuller
+ *
+ * @brief	Hierarchical depth (Hi-Z) occlusion culling for one camera. Meshes that were
+ * 			visible in the last frame are rendered first. The depth they leave behind is
+ * 			reduced to a pyramid in which each texel holds the farthest depth of the pixels
+ * 			it covers. A small level of the pyramid is read back and the bounding boxes of the
+ * 			remaining meshes are tested against it on the CPU. Meshes that are hidden are not
+ * 			rendered and are tested again in the next frame.
+ *
+ * 			The pyramid is built with a fragment shader. If the shader cannot be built, the
+ * 			depth buffer is read back and reduced on the CPU instead. Both paths only need
+ * 			core OpenGL so they run under software implementations.
+ *
+ * 			Reading back the pyramid waits for the first pass to finish. Keep the read back
+ * 			level small.
+ */
+class OcclusionCuller
+{
+public:
+
+	/**
+	 * @fn	OcclusionCuller::~OcclusionCuller();
+	 *
+	 * @brief	Destructor. Deletes the textures and the framebuffer.
+	 */
+	~OcclusionCuller();
+
+	/**
+	 * @fn	static void OcclusionCuller::loadShaders();
+	 *
+	 * @brief	Builds the shader program that reduces the depth pyramid. Call once after
+	 * 			the OpenGL context has been created.
+	 */
+	static void loadShaders();
+
+	/**
+	 * @fn	bool OcclusionCuller::wasVisible(const void* object) const
+	 *
+	 * @brief	Determines if an object passed the occlusion test in the last frame.
+	 *
+	 * @param	object	The object. Usually a mesh component.
+	 */
+	bool wasVisible(const void* object) const { return visibleLastFrame.count(object) > 0; }
+
+	/**
+	 * @fn	void OcclusionCuller::setVisible(const void* object)
+	 *
+	 * @brief	Records that an object passed the occlusion test in this frame. Objects
+	 * 			that are not recorded are treated as hidden in the next frame.
+	 *
+	 * @param	object	The object. Usually a mesh component.
+	 */
+	void setVisible(const void* object) { visibleThisFrame.insert(object); }
+
+	/**
+	 * @fn	void OcclusionCuller::buildDepthPyramid(GLint x, GLint y, GLsizei width, GLsizei height, const glm::mat4& viewProjection);
+	 *
+	 * @brief	Builds the depth pyramid from the depth buffer of the read framebuffer and
+	 * 			reads back the level that is used for testing. Restores the viewport, the
+	 * 			draw framebuffer and depth testing.
+	 *
+	 * @param	x			  	The x coordinate of the lower left corner of the viewport.
+	 * @param	y			  	The y coordinate of the lower left corner of the viewport.
+	 * @param	width		  	The width of the viewport.
+	 * @param	height		  	The height of the viewport.
+	 * @param	viewProjection	The projection matrix multiplied by the viewing transformation
+	 * 							that the depth was rendered with.
+	 */
+	void buildDepthPyramid(GLint x, GLint y, GLsizei width, GLsizei height, const glm::mat4& viewProjection);
+
+	/**
+	 * @fn	bool OcclusionCuller::isOccluded(const glm::vec3& minimum, const glm::vec3& maximum) const;
+	 *
+	 * @brief	Tests a bounding box against the depth pyramid.
+	 *
+	 * @param	minimum	The minimum corner of the box in world coordinates.
+	 * @param	maximum	The maximum corner of the box in world coordinates.
+	 *
+	 * @returns	True if the box is entirely behind the depth of the first pass. False if it
+	 * 			might be visible, crosses the near plane, or no pyramid has been built.
+	 */
+	bool isOccluded(const glm::vec3& minimum, const glm::vec3& maximum) const;
+
+	/**
+	 * @fn	void OcclusionCuller::endFrame();
+	 *
+	 * @brief	Makes the objects recorded in this frame the visible set of the next frame.
+	 */
+	void endFrame();
+
+	static void setEnabled(bool enabled) { occlusionEnabled = enabled; }
+
+	static bool isEnabled() { return occlusionEnabled; }
+
+	/**
+	 * @fn	static void OcclusionCuller::setGpuReduction(bool useGpu)
+	 *
+	 * @brief	Selects whether the pyramid is reduced on the GPU or on the CPU. The CPU
+	 * 			is always used if the reduction shader program could not be built.
+	 */
+	static void setGpuReduction(bool useGpu) { gpuReduction = useGpu; }
+
+	/**
+	 * @fn	static void OcclusionCuller::setReadbackSize(int size)
+	 *
+	 * @brief	Sets the largest width or height of the level that is read back.
+	 */
+	static void setReadbackSize(int size) { readbackSize = std::max(size, 1); }
+
+protected:
+
+	/**
+	 * @fn	void OcclusionCuller::reduceOnGpu(GLint x, GLint y, GLsizei width, GLsizei height, int levels);
+	 *
+	 * @brief	Copies the depth of the viewport into a texture, reduces it with the
+	 * 			reduction shader program, and reads back the last level.
+	 */
+	void reduceOnGpu(GLint x, GLint y, GLsizei width, GLsizei height, int levels);
+
+	/**
+	 * @fn	void OcclusionCuller::reduceOnCpu(GLint x, GLint y, GLsizei width, GLsizei height, int levels);
+	 *
+	 * @brief	Reads back the depth of the viewport and reduces it on the CPU.
+	 */
+	void reduceOnCpu(GLint x, GLint y, GLsizei width, GLsizei height, int levels);
+
+	/**
+	 * @fn	static int OcclusionCuller::getLevelSize(int size, int level)
+	 *
+	 * @brief	Gets the width or height of a level that has been halved a number of times.
+	 * 			Odd sizes are rounded up so every pixel is covered.
+	 */
+	static int getLevelSize(int size, int level) { return std::max(1, (size + (1 << level) - 1) >> level); }
+
+	/** @brief	Depth of the viewport and the pyramid levels built from it */
+	GLuint depthTexture = 0;
+	GLuint pyramidTexture = 0;
+	GLuint framebuffer = 0;
+
+	/** @brief	Size of the viewport and number of levels the textures were created for */
+	GLsizei textureWidth = 0;
+	GLsizei textureHeight = 0;
+	int textureLevels = 0;
+
+	/** @brief	Level of the pyramid that was read back */
+	std::vector<float> readbackDepth;
+	int readbackWidth = 0;
+	int readbackHeight = 0;
+
+	/** @brief	Number of times the viewport was halved to get the level that was read back */
+	int readbackLevel = 0;
+
+	/** @brief	Size of the viewport the pyramid was built for */
+	GLsizei viewportWidth = 0;
+	GLsizei viewportHeight = 0;
+
+	/** @brief	Transformation the depth was rendered with */
+	glm::mat4 viewProjection;
+
+	/** @brief	Objects that passed the occlusion test in the last frame and in this frame */
+	std::unordered_set<const void*> visibleLastFrame;
+	std::unordered_set<const void*> visibleThisFrame;
+
+	/** @brief	Shader program that reduces one level of the pyramid. Zero if it failed to build. */
+	static GLuint reductionProgram;
+
+	/** @brief	Vertex array object without vertex data used to draw the full screen triangle */
+	static GLuint emptyVao;
+
+	static bool occlusionEnabled;
+
+	static bool gpuReduction;
+
+	static int readbackSize;
+
+}; // end OcclusionCuller class
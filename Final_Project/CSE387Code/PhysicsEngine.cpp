@@ -1,4 +1,6 @@
 #include "PhysicsEngine.h"
+#include "CpuProfiler.h"
+#include "EngineCounters.h"
 
 #include "RigidBodyComponent.h"
 
@@ -81,11 +83,17 @@ bool PhysicsEngine::Init()
 
 void PhysicsEngine::Update(const float & deltaTime)
 {
+	CPU_PROFILE_SCOPE("PhysicsEngine::Update");
+	EngineCounters::Timer timer(EngineCounters::PHYSICS_TIME);
+
 	// Update the simulation by deltaTime on each update. Automatically takes into account 
 	// variability in deltaTime performing interpolation up to 10 interpolation steps.
 	// Each internal interpolation step will be a 60th of a second. deltaTime should
 	// always be less than 10 * (1/60).
-	dynamicsWorld->stepSimulation(deltaTime, 10, btScalar(1 / 60.0f));
+	int steps = dynamicsWorld->stepSimulation(deltaTime, 10, btScalar(1 / 60.0f));
+
+	EngineCounters::add(EngineCounters::PHYSICS_STEPS, steps);
+	EngineCounters::set(EngineCounters::RIGID_BODIES, dynamicsWorld->getNumCollisionObjects());
 
 } // end Update
 
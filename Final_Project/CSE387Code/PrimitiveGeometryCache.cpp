@@ -0,0 +1,91 @@
+#include "PrimitiveGeometryCache.h"
+#include "GLStateCache.h"
+
+#define VERBOSE false
+
+// Static variable must be defined outside the declaration
+std::unordered_map<std::string, PrimitiveGeometry> PrimitiveGeometryCache::loadedGeometry;
+
+PrimitiveGeometry* PrimitiveGeometryCache::acquire(const std::string& key)
+{
+	auto iter = loadedGeometry.find(key);
+
+	if (iter == loadedGeometry.end()) {
+
+		return nullptr;
+	}
+
+	if (VERBOSE) std::cout << "Retrieving primitive: " << key << std::endl;
+
+	iter->second.referenceCount++;
+
+	return &iter->second;
+
+} // end acquire
+
+
+PrimitiveGeometry* PrimitiveGeometryCache::add(const std::string& key, const SubMesh& subMesh, btCollisionShape* collisionShape)
+{
+	if (VERBOSE) std::cout << "Adding primitive: " << key << std::endl;
+
+	PrimitiveGeometry& geometry = loadedGeometry[key];
+
+	geometry.subMesh = subMesh;
+	geometry.subMesh.material = nullptr;
+	geometry.collisionShape = collisionShape;
+	geometry.referenceCount = 1;
+
+	return &geometry;
+
+} // end add
+
+
+void PrimitiveGeometryCache::release(const std::string& key)
+{
+	auto iter = loadedGeometry.find(key);
+
+	if (iter == loadedGeometry.end()) {
+
+		return;
+	}
+
+	PrimitiveGeometry& geometry = iter->second;
+
+	geometry.referenceCount--;
+
+	if (geometry.referenceCount <= 0) {
+
+		if (VERBOSE) std::cout << "Free all resources for primitive: " << key << std::endl;
+
+		// Geometry of headless games has no buffers
+		if (geometry.subMesh.vao != 0) {
+
+			GLStateCache::deleteVertexArrays(1, &geometry.subMesh.vao);
+
+			GLStateCache::deleteBuffers(1, &geometry.subMesh.vertexBuffer);
+
+			if (geometry.subMesh.renderMode == INDEXED) {
+				GLStateCache::deleteBuffers(1, &geometry.subMesh.indexBuffer);
+			}
+		}
+
+		delete geometry.collisionShape;
+
+		loadedGeometry.erase(iter);
+	}
+
+} // end release
+
+
+std::string PrimitiveGeometryCache::getSphereKey(GLfloat radius, GLint stacks, GLint slices)
+{
+	return "sphere " + std::to_string(radius) + " " + std::to_string(stacks) + " " + std::to_string(slices);
+
+} // end getSphereKey
+
+
+std::string PrimitiveGeometryCache::getBoxKey(float width, float height, float depth)
+{
+	return "box " + std::to_string(width) + " " + std::to_string(height) + " " + std::to_string(depth);
+
+} // end getBoxKey
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include "MeshComponent.h"
+
+/**
+ * @struct	PrimitiveGeometry
+ *
+ * @brief	Vertex array object, buffers, and collision shape for one set of primitive
+ * 			parameters. Shared by all mesh components built from the same parameters.
+ */
+struct PrimitiveGeometry {
+
+	SubMesh subMesh; // Buffers and counts. The material is not shared and is always null.
+
+	btCollisionShape* collisionShape = nullptr; // Collision shape shared by all instances
+
+	int referenceCount = 0; // Number of mesh components using the geometry
+
+}; // end PrimitiveGeometry
+
+
+/**
+ * @class	PrimitiveGeometryCache
+ *
+ * @brief	Static class that shares the geometry of procedurally generated primitives. The
+ * 			vertex data for a set of parameters is generated and buffered once. Every mesh
+ * 			component with the same parameters renders from the same buffers with its own
+ * 			material and uses the same collision shape. Because the collision shape is shared,
+ * 			instances should be sized with the primitive parameters rather than by scaling
+ * 			the game objects.
+ */
+class PrimitiveGeometryCache
+{
+public:
+
+	/**
+	 * @fn	static PrimitiveGeometry* PrimitiveGeometryCache::acquire(const std::string& key);
+	 *
+	 * @brief	Retrieves the geometry for a set of parameters if it was built previously and
+	 * 			increments the reference count.
+	 *
+	 * @param	key	The key for the primitive parameters.
+	 *
+	 * @returns	Null if the geometry has not been built, else the geometry.
+	 */
+	static PrimitiveGeometry* acquire(const std::string& key);
+
+	/**
+	 * @fn	static PrimitiveGeometry* PrimitiveGeometryCache::add(const std::string& key, const SubMesh& subMesh, btCollisionShape* collisionShape);
+	 *
+	 * @brief	Adds newly built geometry to the cache with a reference count of one. The cache
+	 * 			takes ownership of the buffers and the collision shape.
+	 *
+	 * @param	key			  	The key for the primitive parameters.
+	 * @param	subMesh		  	Sub-mesh holding the buffers.
+	 * @param	collisionShape	The collision shape.
+	 *
+	 * @returns	The geometry.
+	 */
+	static PrimitiveGeometry* add(const std::string& key, const SubMesh& subMesh, btCollisionShape* collisionShape);
+
+	/**
+	 * @fn	static void PrimitiveGeometryCache::release(const std::string& key);
+	 *
+	 * @brief	Decrements the reference count of the geometry. Deletes the buffers and collision
+	 * 			shape when it is no longer used.
+	 *
+	 * @param	key	The key for the primitive parameters.
+	 */
+	static void release(const std::string& key);
+
+	/**
+	 * @fn	static std::string PrimitiveGeometryCache::getSphereKey(GLfloat radius, GLint stacks, GLint slices);
+	 *
+	 * @brief	Gets the key for a sphere.
+	 */
+	static std::string getSphereKey(GLfloat radius, GLint stacks, GLint slices);
+
+	/**
+	 * @fn	static std::string PrimitiveGeometryCache::getBoxKey(float width, float height, float depth);
+	 *
+	 * @brief	Gets the key for a box.
+	 */
+	static std::string getBoxKey(float width, float height, float depth);
+
+protected:
+
+	/** @brief	Map of ALL primitive geometry that is in use */
+	static std::unordered_map<std::string, PrimitiveGeometry> loadedGeometry;
+
+}; // end PrimitiveGeometryCache class
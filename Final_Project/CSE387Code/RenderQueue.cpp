@@ -0,0 +1,230 @@
+#include "RenderQueue.h"
+#include "EngineCounters.h"
+#include "GLStateCache.h"
+#include "MeshComponent.h"
+#include "BuildShaderProgram.h"
+#include "ClusterCuller.h"
+
+#include <algorithm>
+#include <iostream>
+
+GLuint RenderQueue::depthProgram = 0;
+
+
+void RenderQueue::loadShaders()
+{
+	ShaderInfo shaders[] = {
+		{ GL_VERTEX_SHADER, "Shaders/depthOnly.vs.glsl" },
+		{ GL_FRAGMENT_SHADER, "Shaders/depthOnly.fs.glsl" },
+		{ GL_NONE, NULL } // signals that there are no more shaders
+	};
+
+	depthProgram = BuildShaderProgram(shaders);
+
+	if (depthProgram != 0) {
+
+		SharedProjectionAndViewing::setUniformBlockForShader(depthProgram);
+	}
+	else {
+
+		std::cerr << "Depth pre-pass program failed to build. Cameras will render without a depth pre-pass." << std::endl;
+	}
+
+} // end loadShaders
+
+
+void RenderQueue::clear()
+{
+	items.clear();
+	indirectBuffer = 0;
+
+} // end clear
+
+
+void RenderQueue::addItem(const SubMesh* subMesh, const Material* material, GLuint shaderProgram, const glm::mat4& modelingTransformation, float viewDepth, int clusterJob, float fade)
+{
+	DrawItem item;
+
+	item.subMesh = subMesh;
+	item.material = material;
+	item.shaderProgram = shaderProgram;
+	item.modelingTransformation = modelingTransformation;
+	item.viewDepth = viewDepth;
+	item.clusterJob = clusterJob;
+	item.fade = fade;
+
+	// Most expensive state change in the highest bits. 16 bits of program,
+	// 24 bits of texture, and 24 bits of vertex array object.
+	unsigned long long textureKey = SharedMaterialProperties::getTextureSortKey(material);
+
+	item.sortKey = (static_cast<unsigned long long>(shaderProgram & 0xFFFF) << 48) |
+				   ((textureKey & 0xFFFFFF) << 24) |
+				   (static_cast<unsigned long long>(subMesh->vao) & 0xFFFFFF);
+
+	items.push_back(item);
+
+} // end addItem
+
+
+void RenderQueue::resolveClusters(const ClusterCuller& culler)
+{
+	for (auto& item : items) {
+
+		if (item.clusterJob >= 0) {
+
+			culler.getCommands(item.clusterJob, item.indirectOffset, item.indirectCount, item.indirectIndexCount);
+		}
+	}
+
+	// Sub-meshes without visible meshlets are not drawn at all
+	items.erase(std::remove_if(items.begin(), items.end(), [](const DrawItem& item) {
+		return item.clusterJob >= 0 && item.indirectCount == 0;
+	}), items.end());
+
+	indirectBuffer = culler.getIndirectBuffer();
+
+} // end resolveClusters
+
+
+void RenderQueue::sort(bool frontToBack)
+{
+	if (frontToBack) {
+
+		std::stable_sort(items.begin(), items.end(), [](const DrawItem& a, const DrawItem& b) {
+			return a.viewDepth < b.viewDepth || (a.viewDepth == b.viewDepth && a.sortKey < b.sortKey);
+		});
+	}
+	else {
+
+		std::stable_sort(items.begin(), items.end(), [](const DrawItem& a, const DrawItem& b) {
+			return a.sortKey < b.sortKey || (a.sortKey == b.sortKey && a.viewDepth < b.viewDepth);
+		});
+	}
+
+} // end sort
+
+
+void RenderQueue::drawDepth()
+{
+	if (depthProgram == 0) {
+		return;
+	}
+
+	depthOrder.resize(items.size());
+
+	for (size_t i = 0; i < items.size(); i++) {
+		depthOrder[i] = i;
+	}
+
+	std::stable_sort(depthOrder.begin(), depthOrder.end(), [this](size_t a, size_t b) {
+		return items[a].viewDepth < items[b].viewDepth;
+	});
+
+	GLStateCache::useProgram(depthProgram);
+
+	// Nothing but depth is written
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+	if (indirectBuffer != 0) {
+		GLStateCache::bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+	}
+
+	GLuint currentVao = 0;
+	const glm::mat4* currentModelingTransformation = nullptr;
+	float currentFade = 1.0f;
+
+	for (auto index : depthOrder) {
+
+		const DrawItem& item = items[index];
+
+		if (currentModelingTransformation == nullptr || *currentModelingTransformation != item.modelingTransformation || currentFade != item.fade) {
+
+			SharedProjectionAndViewing::setModelingMatrix(item.modelingTransformation, item.fade);
+			currentModelingTransformation = &item.modelingTransformation;
+			currentFade = item.fade;
+		}
+
+		const SubMesh* subMesh = item.subMesh;
+
+		if (subMesh->vao != currentVao) {
+
+			GLStateCache::bindVertexArray(subMesh->vao);
+			currentVao = subMesh->vao;
+		}
+
+		drawItem(item);
+	}
+
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+} // end drawDepth
+
+
+void RenderQueue::draw()
+{
+	GLuint currentProgram = 0;
+	GLuint currentVao = 0;
+	const glm::mat4* currentModelingTransformation = nullptr;
+	float currentFade = 1.0f;
+
+	if (indirectBuffer != 0) {
+		GLStateCache::bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+	}
+
+	for (auto& item : items) {
+
+		if (item.shaderProgram != currentProgram) {
+
+			GLStateCache::useProgram(item.shaderProgram);
+			currentProgram = item.shaderProgram;
+		}
+
+		// Items from the same game object share a modeling transformation
+		if (currentModelingTransformation == nullptr || *currentModelingTransformation != item.modelingTransformation || currentFade != item.fade) {
+
+			SharedProjectionAndViewing::setModelingMatrix(item.modelingTransformation, item.fade);
+			currentModelingTransformation = &item.modelingTransformation;
+			currentFade = item.fade;
+		}
+
+		const SubMesh* subMesh = item.subMesh;
+
+		if (subMesh->vao != currentVao) {
+
+			GLStateCache::bindVertexArray(subMesh->vao);
+			currentVao = subMesh->vao;
+		}
+
+		// Set the material properties. Textures that are already bound are not bound again.
+		SharedMaterialProperties::setShaderMaterialProperties(item.material);
+
+		drawItem(item);
+	}
+
+	SharedMaterialProperties::unbindTextures();
+
+} // end draw
+
+
+void RenderQueue::drawItem(const DrawItem& item)
+{
+	const SubMesh* subMesh = item.subMesh;
+
+	if (item.indirectCount > 0) {
+
+		// Only the visible meshlets
+		glMultiDrawElementsIndirect(subMesh->primitiveMode, GL_UNSIGNED_INT, reinterpret_cast<const void*>(item.indirectOffset), item.indirectCount, 0);
+		EngineCounters::addDraw(subMesh->primitiveMode, item.indirectIndexCount);
+	}
+	else if (subMesh->renderMode == ORDERED) {
+
+		glDrawArrays(subMesh->primitiveMode, 0, subMesh->count);
+		EngineCounters::addDraw(subMesh->primitiveMode, subMesh->count);
+	}
+	else { // renderMode == INDEXED
+
+		glDrawElements(subMesh->primitiveMode, subMesh->count, GL_UNSIGNED_INT, 0);
+		EngineCounters::addDraw(subMesh->primitiveMode, subMesh->count);
+	}
+
+} // end drawItem
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "MathLibsConstsFuncs.h"
+
+struct SubMesh;
+struct Material;
+class ClusterCuller;
+
+/**
+ * @struct	DrawItem
+ *
+ * @brief	Everything needed to render a single sub-mesh.
+ */
+struct DrawItem {
+
+	const SubMesh* subMesh = nullptr; // Sub-mesh to render
+
+	const Material* material = nullptr; // Material properties the sub-mesh is rendered with
+
+	GLuint shaderProgram = 0; // Shader program used to render the sub-mesh
+
+	glm::mat4 modelingTransformation; // Modeling transformation of the owning game object
+
+	unsigned long long sortKey = 0; // Orders items to minimize state changes
+
+	float viewDepth = 0.0f; // Distance in front of the camera used to order items front to back
+
+	float fade = 1.0f; // Share of the pixels drawn while the mesh cross-fades with its impostor
+
+	int clusterJob = -1; // Job of the ClusterCuller that culls the meshlets of the sub-mesh. Negative if not culled.
+
+	GLintptr indirectOffset = 0; // Offset of the draw commands of the visible meshlets
+
+	GLsizei indirectCount = 0; // Number of draw commands. Zero to draw the whole sub-mesh.
+
+	GLuint indirectIndexCount = 0; // Indices drawn by all of the draw commands
+
+}; // end DrawItem
+
+
+/**
+ * @class	RenderQueue
+ *
+ * @brief	Collects the sub-meshes of all visible mesh components, sorts them by shader
+ * 			program, texture and vertex array object, and renders them. State that does not
+ * 			change between consecutive items is not set again. Items with the same state are
+ * 			rendered front to back.
+ *
+ * 			The items can also be rendered into the depth buffer alone with a position only
+ * 			program so a following shading pass only shades the visible fragments.
+ */
+class RenderQueue
+{
+public:
+
+	/**
+	 * @fn	static void RenderQueue::loadShaders();
+	 *
+	 * @brief	Builds the position only program used by drawDepth. Must be called after the
+	 * 			OpenGL context is created.
+	 */
+	static void loadShaders();
+
+	/**
+	 * @fn	static bool RenderQueue::hasDepthProgram()
+	 *
+	 * @brief	Returns false if the depth program failed to build and drawDepth renders nothing.
+	 */
+	static bool hasDepthProgram() { return depthProgram != 0; }
+
+	/**
+	 * @fn	void RenderQueue::clear();
+	 *
+	 * @brief	Removes all items. Call before items are added for a new rendering pass.
+	 */
+	void clear();
+
+	/**
+	 * @fn	void RenderQueue::addItem(const SubMesh* subMesh, const Material* material, GLuint shaderProgram, const glm::mat4& modelingTransformation, float viewDepth = 0.0f, int clusterJob = -1, float fade = 1.0f);
+	 *
+	 * @brief	Adds a sub-mesh to the queue.
+	 *
+	 * @param	subMesh				  	The sub-mesh.
+	 * @param	material			  	The material properties of the sub-mesh. Must remain
+	 * 									unchanged until the queue is cleared.
+	 * @param	shaderProgram		  	The shader program used to render the sub-mesh.
+	 * @param	modelingTransformation	The modeling transformation for the sub-mesh.
+	 * @param	viewDepth			  	(Optional) Distance of the sub-mesh in front of the camera.
+	 * @param	clusterJob			  	(Optional) Job of the ClusterCuller that culls the
+	 * 									meshlets of the sub-mesh.
+	 * @param	fade				  	(Optional) Share of the pixels of the sub-mesh that are drawn.
+	 */
+	void addItem(const SubMesh* subMesh, const Material* material, GLuint shaderProgram, const glm::mat4& modelingTransformation, float viewDepth = 0.0f, int clusterJob = -1, float fade = 1.0f);
+
+	/**
+	 * @fn	void RenderQueue::resolveClusters(const ClusterCuller& culler);
+	 *
+	 * @brief	Gets the draw commands of items whose meshlets were culled. Items without visible
+	 * 			meshlets are removed. Call after the culler has culled and before sorting.
+	 *
+	 * @param	culler	The culler the jobs of the items were added to.
+	 */
+	void resolveClusters(const ClusterCuller& culler);
+
+	/**
+	 * @fn	void RenderQueue::sort(bool frontToBack = false);
+	 *
+	 * @brief	Sorts the items by their sort keys and then by their distance from the camera.
+	 *
+	 * @param	frontToBack	(Optional) True to sort by distance first. Hides more fragments
+	 * 						behind nearer items at the cost of more state changes.
+	 */
+	void sort(bool frontToBack = false);
+
+	/**
+	 * @fn	void RenderQueue::drawDepth();
+	 *
+	 * @brief	Renders all items front to back into the depth buffer only. Materials are not
+	 * 			set and the order of the items is not changed.
+	 */
+	void drawDepth();
+
+	/**
+	 * @fn	void RenderQueue::draw();
+	 *
+	 * @brief	Renders all items in order. Unbinds textures when done.
+	 */
+	void draw();
+
+	/**
+	 * @fn	size_t RenderQueue::getItemCount() const
+	 *
+	 * @brief	Gets the number of items in the queue.
+	 */
+	size_t getItemCount() const { return items.size(); }
+
+protected:
+
+	/** @brief	Items to be rendered */
+	std::vector<DrawItem> items;
+
+	/**
+	 * @fn	static void RenderQueue::drawItem(const DrawItem& item);
+	 *
+	 * @brief	Draws the sub-mesh of an item, or its visible meshlets.
+	 */
+	static void drawItem(const DrawItem& item);
+
+	/** @brief	Buffer that holds the draw commands of the visible meshlets */
+	GLuint indirectBuffer = 0;
+
+	/** @brief	Indices of the items from front to back for drawDepth */
+	std::vector<size_t> depthOrder;
+
+	/** @brief	Position only program used by drawDepth */
+	static GLuint depthProgram;
+
+}; // end RenderQueue class
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+
+#include "SubMesh.h"
+#include "Frustum.h"
+#include "SharedGeneralLighting.h"
+
+/**
+ * @struct	MeshDraw
+ *
+ * @brief	Everything needed to render the sub-meshes of one mesh component in a frame.
+ */
+struct MeshDraw {
+
+	const void* mesh = nullptr; // Mesh component the data was taken from. Only used to identify the mesh.
+
+	GLuint shaderProgram = 0; // Base shader program of the mesh
+
+	glm::mat4 modelingTransformation; // Modeling transformation when the snapshot was taken
+
+	glm::vec3 boundingCenter; // Center of the bounding sphere in world coordinates
+
+	float boundingRadius = -1.0f; // Radius of the bounding sphere. Negative if the mesh does not have bounds.
+
+	size_t firstSubMesh = 0; // Index of the first sub-mesh of the mesh in the snapshot
+
+	size_t subMeshCount = 0; // Number of sub-meshes of the mesh
+
+	const class ImpostorAtlas* impostor = nullptr; // Views distant copies are drawn with. Null if none.
+
+}; // end MeshDraw
+
+
+/**
+ * @struct	CameraView
+ *
+ * @brief	Matrices, viewport, and visible meshes of one camera in a frame.
+ */
+struct CameraView {
+
+	int cameraSlot = -1; // Slot of the camera in the camera uniform buffer
+
+	bool cameraChanged = false; // True if the matrices must be copied into the slot
+
+	glm::mat4 viewMatrix; // Viewing transformation
+
+	glm::mat4 projectionMatrix; // Projection transformation
+
+	GLint viewport[4] = { 0, 0, 0, 0 }; // Viewport in pixels
+
+	Frustum frustum; // Viewing frustum in world coordinates
+
+	class OcclusionCuller* occlusionCuller = nullptr; // Occlusion culling state of the camera
+
+	bool depthPrepass = false; // True to render depth alone before shading
+
+	bool frontToBack = false; // True to sort the shading pass by distance instead of state
+
+	std::vector<unsigned int> visibleMeshes; // Indices of the meshes that intersect the frustum
+
+}; // end CameraView
+
+
+/**
+ * @struct	RenderSnapshot
+ *
+ * @brief	Copy of the scene state needed to render one frame. Built by the update thread
+ * 			and read by the render thread so that the game objects can be updated while
+ * 			the previous frame is rendered. Sub-meshes are referenced and not copied.
+ * 			Their buffers are only changed while the RenderContextLock is held. Materials
+ * 			are copied since games change them while updating.
+ */
+struct RenderSnapshot {
+
+	std::vector<MeshDraw> meshes; // Meshes of active game objects that are not batched
+
+	std::vector<SubMesh*> subMeshes; // Sub-meshes of all of the meshes
+
+	std::vector<Material> materials; // Copies of the materials of the sub-meshes, in the same order
+
+	std::vector<CameraView> cameras; // Active cameras in rendering order
+
+	GeneralLight lights[MAX_LIGHTS]; // All lights
+
+	bool lightsChanged = false; // True if the lights must be copied into the light buffer
+
+	float interpolation = 1.0f; // Fraction of a fixed update between the last update and the time the snapshot was taken
+
+	int framebufferWidth = 0; // Size of the framebuffer the views were computed for
+
+	int framebufferHeight = 0;
+
+}; // end RenderSnapshot
@@ -0,0 +1,100 @@
+#include "RenderTarget.h"
+#include "GLStateCache.h"
+
+#define VERBOSE false
+
+
+bool RenderTarget::create(GLsizei width, GLsizei height)
+{
+	if (framebuffer != 0 && width == this->width && height == this->height) {
+		return true;
+	}
+
+	destroy();
+
+	this->width = width;
+	this->height = height;
+
+	glGenTextures(1, &colorTexture);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, colorTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &framebuffer);
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+
+		std::cerr << "Render target " << width << " x " << height << " is incomplete. Status 0x" << std::hex << status << std::dec << std::endl;
+
+		destroy();
+		return false;
+	}
+
+	if (VERBOSE) cout << "Render target created " << width << " x " << height << endl;
+
+	return true;
+
+} // end create
+
+
+void RenderTarget::destroy()
+{
+	// Nothing was created, possibly because there is no OpenGL context
+	if (framebuffer == 0 && colorTexture == 0) {
+		return;
+	}
+
+	GLStateCache::deleteFramebuffers(1, &framebuffer);
+	glDeleteRenderbuffers(1, &depthBuffer);
+	GLStateCache::deleteTextures(1, &colorTexture);
+
+	framebuffer = 0;
+	depthBuffer = 0;
+	colorTexture = 0;
+	width = 0;
+	height = 0;
+
+} // end destroy
+
+
+void RenderTarget::bind() const
+{
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+} // end bind
+
+
+void RenderTarget::bindDefault()
+{
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+} // end bindDefault
+
+
+void RenderTarget::blitTo(GLuint destinationFramebuffer, GLsizei sourceWidth, GLsizei sourceHeight, GLsizei destinationWidth, GLsizei destinationHeight) const
+{
+	GLStateCache::bindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	GLStateCache::bindFramebuffer(GL_DRAW_FRAMEBUFFER, destinationFramebuffer);
+
+	// Linear filtering is only allowed for color
+	glBlitFramebuffer(0, 0, sourceWidth, sourceHeight, 0, 0, destinationWidth, destinationHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, destinationFramebuffer);
+
+} // end blitTo
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "MathLibsConstsFuncs.h"
+
+/**
+ * @class	RenderTarget
+ *
+ * @brief	Framebuffer object that the scene can be rendered into instead of the default
+ * 			framebuffer. Color is stored in an RGBA8 texture so it can be read back or
+ * 			sampled, and depth in a 32-bit floating point renderbuffer. Only needs core
+ * 			OpenGL 3.0 so it works with software contexts such as OSMesa.
+ */
+class RenderTarget
+{
+public:
+
+	/**
+	 * @fn	RenderTarget::~RenderTarget()
+	 *
+	 * @brief	Destructor. Deletes the framebuffer and its attachments.
+	 */
+	~RenderTarget() { destroy(); }
+
+	/**
+	 * @fn	bool RenderTarget::create(GLsizei width, GLsizei height);
+	 *
+	 * @brief	Creates the framebuffer and attachments. Calling it again with a different
+	 * 			size replaces the attachments.
+	 *
+	 * @param	width 	The width in pixels.
+	 * @param	height	The height in pixels.
+	 *
+	 * @returns	True if the framebuffer is complete.
+	 */
+	bool create(GLsizei width, GLsizei height);
+
+	/**
+	 * @fn	void RenderTarget::destroy();
+	 *
+	 * @brief	Deletes the framebuffer and its attachments.
+	 */
+	void destroy();
+
+	/**
+	 * @fn	void RenderTarget::bind() const;
+	 *
+	 * @brief	Binds the framebuffer for drawing and reading.
+	 */
+	void bind() const;
+
+	/**
+	 * @fn	static void RenderTarget::bindDefault();
+	 *
+	 * @brief	Binds the default framebuffer of the window for drawing and reading.
+	 */
+	static void bindDefault();
+
+	/**
+	 * @fn	void RenderTarget::blitTo(GLuint destinationFramebuffer, GLsizei sourceWidth, GLsizei sourceHeight, GLsizei destinationWidth, GLsizei destinationHeight) const;
+	 *
+	 * @brief	Copies the lower left corner of the color of the render target into another
+	 * 			framebuffer, scaling it to fill the destination. Leaves the destination
+	 * 			framebuffer bound for drawing and reading.
+	 *
+	 * @param	destinationFramebuffer	The framebuffer copied into. Zero for the window.
+	 * @param	sourceWidth			  	The width of the copied region in pixels.
+	 * @param	sourceHeight		  	The height of the copied region in pixels.
+	 * @param	destinationWidth	  	The width of the destination in pixels.
+	 * @param	destinationHeight	  	The height of the destination in pixels.
+	 */
+	void blitTo(GLuint destinationFramebuffer, GLsizei sourceWidth, GLsizei sourceHeight, GLsizei destinationWidth, GLsizei destinationHeight) const;
+
+	bool isCreated() const { return framebuffer != 0; }
+
+	GLuint getFramebuffer() const { return framebuffer; }
+
+	GLuint getColorTexture() const { return colorTexture; }
+
+	GLsizei getWidth() const { return width; }
+
+	GLsizei getHeight() const { return height; }
+
+protected:
+
+	GLuint framebuffer = 0;
+
+	GLuint colorTexture = 0;
+
+	GLuint depthBuffer = 0;
+
+	GLsizei width = 0;
+
+	GLsizei height = 0;
+
+}; // end RenderTarget class
@@ -0,0 +1,160 @@
+#include "RenderThread.h"
+#include "CpuProfiler.h"
+
+#define VERBOSE false
+
+void RenderThread::start(GLFWwindow* window, std::function<void(const RenderSnapshot&)> renderFunction)
+{
+	if (running == true) {
+		return;
+	}
+
+	this->window = window;
+	this->renderFunction = renderFunction;
+
+	writeIndex = 0;
+	readIndex = 0;
+	queuedSnapshots = 0;
+	contextRequested = false;
+	contextReleased = false;
+	contextDepth = 0;
+	running = true;
+
+	// A context can only be current on one thread at a time
+	glfwMakeContextCurrent(nullptr);
+
+	thread = std::thread(&RenderThread::run, this);
+
+	if (VERBOSE) cout << "Render thread started" << endl;
+
+} // end start
+
+
+void RenderThread::stop()
+{
+	if (running == false) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		running = false;
+	}
+	condition.notify_all();
+
+	thread.join();
+
+	glfwMakeContextCurrent(window);
+
+	if (VERBOSE) cout << "Render thread stopped" << endl;
+
+} // end stop
+
+
+RenderSnapshot& RenderThread::beginSnapshot()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	// The render thread is reading the other snapshot or both are waiting to be rendered
+	condition.wait(lock, [this] { return queuedSnapshots < 2; });
+
+	return snapshots[writeIndex];
+
+} // end beginSnapshot
+
+
+void RenderThread::submitSnapshot()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		writeIndex = 1 - writeIndex;
+		queuedSnapshots++;
+	}
+	condition.notify_all();
+
+} // end submitSnapshot
+
+
+void RenderThread::acquireContext()
+{
+	if (running == false || contextDepth++ > 0) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	contextRequested = true;
+	condition.notify_all();
+
+	// Submitted snapshots are rendered before the context is released
+	condition.wait(lock, [this] { return contextReleased; });
+
+	lock.unlock();
+
+	glfwMakeContextCurrent(window);
+
+} // end acquireContext
+
+
+void RenderThread::releaseContext()
+{
+	if (running == false || --contextDepth > 0) {
+		return;
+	}
+
+	glfwMakeContextCurrent(nullptr);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		contextRequested = false;
+	}
+	condition.notify_all();
+
+} // end releaseContext
+
+
+void RenderThread::run()
+{
+	CpuProfiler::setThreadName("Render");
+
+	glfwMakeContextCurrent(window);
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (true) {
+
+		condition.wait(lock, [this] { return queuedSnapshots > 0 || contextRequested || running == false; });
+
+		if (queuedSnapshots > 0) {
+
+			// The update thread does not touch a snapshot while it is queued
+			const RenderSnapshot& snapshot = snapshots[readIndex];
+
+			lock.unlock();
+			renderFunction(snapshot);
+			lock.lock();
+
+			readIndex = 1 - readIndex;
+			queuedSnapshots--;
+			condition.notify_all();
+		}
+		else if (running == false) {
+
+			break;
+		}
+		else if (contextRequested) {
+
+			glfwMakeContextCurrent(nullptr);
+			contextReleased = true;
+			condition.notify_all();
+
+			condition.wait(lock, [this] { return contextRequested == false || running == false; });
+
+			contextReleased = false;
+			glfwMakeContextCurrent(window);
+		}
+	}
+
+	glfwMakeContextCurrent(nullptr);
+
+} // end run
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "MathLibsConstsFuncs.h"
+#include <GLFW/glfw3.h>
+
+#include "RenderSnapshot.h"
+
+/**
+ * @class	RenderThread
+ *
+ * @brief	Thread that owns the OpenGL context and renders snapshots of the scene. The
+ * 			update thread fills one snapshot while the render thread renders the other. The
+ * 			update thread waits if both snapshots are waiting to be rendered, so rendering is
+ * 			never more than two frames behind the update.
+ *
+ * 			Code on the update thread that needs to make OpenGL calls, such as initializing
+ * 			or deleting game objects after the game has started, must hold a
+ * 			RenderContextLock. Snapshots that were already submitted are rendered first so
+ * 			they cannot reference deleted meshes.
+ */
+class RenderThread
+{
+public:
+
+	/**
+	 * @fn	RenderThread::~RenderThread()
+	 *
+	 * @brief	Destructor. Stops the thread if it is running.
+	 */
+	~RenderThread() { stop(); }
+
+	/**
+	 * @fn	void RenderThread::start(GLFWwindow* window, std::function<void(const RenderSnapshot&)> renderFunction);
+	 *
+	 * @brief	Releases the OpenGL context of a window on the calling thread and starts a
+	 * 			thread that makes it current and renders submitted snapshots.
+	 *
+	 * @param [in]	window		  	The window whose context is used for rendering.
+	 * @param 	  	renderFunction	Renders a snapshot and swaps the buffers.
+	 */
+	void start(GLFWwindow* window, std::function<void(const RenderSnapshot&)> renderFunction);
+
+	/**
+	 * @fn	void RenderThread::stop();
+	 *
+	 * @brief	Renders the snapshots that were submitted, stops the thread, and makes the
+	 * 			OpenGL context current on the calling thread again.
+	 */
+	void stop();
+
+	/**
+	 * @fn	bool RenderThread::isRunning() const
+	 *
+	 * @brief	Determines if the thread is running. Only call from the update thread.
+	 */
+	bool isRunning() const { return running; }
+
+	/**
+	 * @fn	RenderSnapshot& RenderThread::beginSnapshot();
+	 *
+	 * @brief	Gets the snapshot to fill for the next frame. Waits until the render thread
+	 * 			is done with it.
+	 *
+	 * @returns	The snapshot. It still holds the data of the frame two frames ago.
+	 */
+	RenderSnapshot& beginSnapshot();
+
+	/**
+	 * @fn	void RenderThread::submitSnapshot();
+	 *
+	 * @brief	Passes the snapshot returned by beginSnapshot to the render thread.
+	 */
+	void submitSnapshot();
+
+	/**
+	 * @fn	void RenderThread::acquireContext();
+	 *
+	 * @brief	Waits until all submitted snapshots have been rendered, pauses the render
+	 * 			thread, and makes the OpenGL context current on the calling thread. Calls may
+	 * 			be nested. Does nothing if the thread is not running.
+	 */
+	void acquireContext();
+
+	/**
+	 * @fn	void RenderThread::releaseContext();
+	 *
+	 * @brief	Gives the OpenGL context back to the render thread after the outermost call
+	 * 			to acquireContext.
+	 */
+	void releaseContext();
+
+protected:
+
+	/**
+	 * @fn	void RenderThread::run();
+	 *
+	 * @brief	Body of the render thread.
+	 */
+	void run();
+
+	/** @brief	Window whose OpenGL context is used */
+	GLFWwindow* window = nullptr;
+
+	/** @brief	Renders a snapshot */
+	std::function<void(const RenderSnapshot&)> renderFunction;
+
+	std::thread thread;
+
+	/** @brief	Guards the members below that both threads use */
+	std::mutex mutex;
+
+	/** @brief	Signaled whenever a snapshot is submitted or rendered or the context changes threads */
+	std::condition_variable condition;
+
+	/** @brief	Snapshot being filled and snapshot being rendered */
+	RenderSnapshot snapshots[2];
+
+	int writeIndex = 0;
+
+	int readIndex = 0;
+
+	/** @brief	Number of snapshots that were submitted and not yet rendered */
+	int queuedSnapshots = 0;
+
+	bool running = false;
+
+	/** @brief	True while the update thread needs the context */
+	bool contextRequested = false;
+
+	/** @brief	True while the render thread has released the context */
+	bool contextReleased = false;
+
+	/** @brief	Nesting depth of acquireContext calls. Only used by the update thread. */
+	int contextDepth = 0;
+
+}; // end RenderThread class
+
+
+/**
+ * @class	RenderContextLock
+ *
+ * @brief	Holds the OpenGL context on the update thread for the lifetime of the lock.
+ */
+class RenderContextLock
+{
+public:
+
+	RenderContextLock(RenderThread& renderThread) : renderThread(renderThread) { renderThread.acquireContext(); }
+
+	~RenderContextLock() { renderThread.releaseContext(); }
+
+protected:
+
+	RenderThread& renderThread;
+
+}; // end RenderContextLock class
@@ -8,6 +8,12 @@ RigidBodyComponent::RigidBodyComponent(MeshComponent* meshComponent, DynamicsSta
 	: Component( updateOrder), meshComponent(meshComponent), rigidbodyDynamics(state)
 {
 	this->mass = mass;
+
+	// Meshes that never move can be merged into static batches
+	if (state == KINEMATIC_STATIONARY && meshComponent != nullptr) {
+
+		meshComponent->setStaticGeometry(true);
+	}
 }
 
 void RigidBodyComponent::initialize()
@@ -1,6 +1,8 @@
 #include "SceneNode.h"
 #include "GameObject.h"
 #include "MeshComponent.h"
+#include "CpuProfiler.h"
+#include "EngineCounters.h"
 
 
 // ***** Definitions of static data members that are shared by all SceneNode objects ****
@@ -196,6 +198,38 @@ glm::mat4 SceneGraphNode::getModelingTransformation()
 
 } // end getModelingTransformation
 
+
+glm::mat4 SceneGraphNode::getInterpolatedTransformation(float interpolation)
+{
+	// Objects added since the last fixed update have nothing to interpolate from
+	if (previousTransformSaved == false) {
+		return getTransformation(WORLD);
+	}
+
+	return interpolateTransforms(previousWorldTransform, getTransformation(WORLD), interpolation);
+
+} // end getInterpolatedTransformation
+
+
+glm::mat4 SceneGraphNode::getInterpolatedModelingTransformation(float interpolation)
+{
+	return getInterpolatedTransformation(interpolation) * scale;
+
+} // end getInterpolatedModelingTransformation
+
+
+void SceneGraphNode::savePreviousTransformations()
+{
+	for (auto gameObject : this->children) {
+
+		gameObject->sceneNode.previousWorldTransform = gameObject->sceneNode.getTransformation(WORLD);
+		gameObject->sceneNode.previousTransformSaved = true;
+
+		gameObject->sceneNode.savePreviousTransformations();
+	}
+
+} // end savePreviousTransformations
+
 void SceneGraphNode::rotateTo(const glm::vec3& direction, Frame frame)
 {
 	// Normalize the new direction
@@ -332,6 +366,8 @@ void SceneGraphNode::removeGameObjectFromSceneGraph(GameObject* gameObject)
 
 void SceneGraphNode::updateSceneGraph(float deltaTime)
 {
+	CPU_PROFILE_SCOPE("SceneGraphNode::updateSceneGraph");
+
 	// Update all gameObjects
 	SceneGraphNode::updatingGameObjects = true;
 
@@ -348,6 +384,8 @@ void SceneGraphNode::updateSceneGraph(float deltaTime)
 
 	SceneGraphNode::updatingGameObjects = false;
 
+	EngineCounters::set(EngineCounters::ACTIVE_GAME_OBJECTS, EngineCounters::take(EngineCounters::GAME_OBJECT_UPDATES));
+
 	// Attach any pending game objects to their parent
 	for (auto pending : SceneGraphNode::pendingChildren) {
 
@@ -357,12 +395,19 @@ void SceneGraphNode::updateSceneGraph(float deltaTime)
 	SceneGraphNode::pendingChildren.clear();
 
 	// Delete dead game objects
-	for (auto gameObject : SceneGraphNode::deadGameObjects) {
+	if (SceneGraphNode::deadGameObjects.empty() == false) {
+
+		// Meshes of dead game objects may be referenced by snapshots that have not been
+		// rendered and delete OpenGL objects when they are destroyed.
+		RenderContextLock contextLock(SceneGraphNode::deadGameObjects[0]->getOwningGame()->getRenderThread());
 
-		// Delete the dead game object from the parent's child list
-		gameObject->sceneNode.parent->removeGameObjectFromSceneGraph(gameObject);
+		for (auto gameObject : SceneGraphNode::deadGameObjects) {
 
-		delete gameObject;
+			// Delete the dead game object from the parent's child list
+			gameObject->sceneNode.parent->removeGameObjectFromSceneGraph(gameObject);
+
+			delete gameObject;
+		}
 	}
 
 	// Clear the list for the next update cycle
@@ -154,6 +154,39 @@ public:
 	 */
 	glm::mat4 getModelingTransformation();
 
+	/**
+	 * @fn	glm::mat4 SceneGraphNode::getInterpolatedTransformation(float interpolation);
+	 *
+	 * @brief	Gets the world transformation between the one saved before the last fixed
+	 * 			update and the current one. Used to render smoothly between fixed updates.
+	 *
+	 * @param	interpolation	Fraction of a fixed update that has passed since the last one.
+	 *
+	 * @returns	The interpolated world transformation.
+	 */
+	glm::mat4 getInterpolatedTransformation(float interpolation);
+
+	/**
+	 * @fn	glm::mat4 SceneGraphNode::getInterpolatedModelingTransformation(float interpolation);
+	 *
+	 * @brief	Gets the interpolated world transformation including any scale applied to
+	 * 			this node.
+	 *
+	 * @param	interpolation	Fraction of a fixed update that has passed since the last one.
+	 *
+	 * @returns	The interpolated modeling transformation.
+	 */
+	glm::mat4 getInterpolatedModelingTransformation(float interpolation);
+
+	/**
+	 * @fn	void SceneGraphNode::savePreviousTransformations();
+	 *
+	 * @brief	Saves the world transformations of all of the game objects below this node.
+	 * 			Called before each fixed update so rendering can interpolate between the
+	 * 			last two updates.
+	 */
+	void savePreviousTransformations();
+
 	/**
 	 * @fn	void SceneGraphNode::rotateTo(const glm::vec3& direction, Frame frame) void setApplyScaleToChildren(bool applyScale)
 	 *
@@ -303,6 +336,12 @@ public:
 	/** @brief	4 x 4 matrix holding the scale for the game object */
 	mat4 scale = mat4(1.0f);
 
+	/** @brief	World transformation before the last fixed update */
+	mat4 previousWorldTransform = mat4(1.0f);
+
+	/** @brief	False until the world transformation has been saved before a fixed update */
+	bool previousTransformSaved = false;
+
 	/**
 	 * @brief	Reference to parent in the scene graph Is equal to null for the root of the scene
 	 * 			graph (the game)
@@ -0,0 +1,250 @@
+#include "ShaderVariants.h"
+
+#include <deque>
+#include <sstream>
+
+#include "SharedGeneralLighting.h"
+#include "SharedProjectionAndViewing.h"
+
+#define VERBOSE false
+
+// Bits of a variant key
+#define TEXTURE_MODE_MASK 0x3u
+#define DIFFUSE_TEXTURE_BIT (1u << 2)
+#define DIFFUSE_ARRAY_BIT (1u << 3)
+#define SPECULAR_TEXTURE_BIT (1u << 4)
+#define SPECULAR_ARRAY_BIT (1u << 5)
+#define FOG_BIT (1u << 6)
+#define LIGHT_ENABLED_SHIFT 8
+#define LIGHT_IS_SPOT_SHIFT 16
+
+// Static variables must be defined outside the declaration
+std::unordered_map<GLuint, ShaderVariants::ProgramVariants> ShaderVariants::registeredPrograms;
+
+unsigned int ShaderVariants::lightingKey = 0;
+
+bool ShaderVariants::fogEnabled = true;
+
+bool ShaderVariants::variantsEnabled = true;
+
+
+void ShaderVariants::registerShaders(GLuint baseProgram, ShaderInfo* shaders)
+{
+	if (baseProgram == 0 || shaders == nullptr) {
+		return;
+	}
+
+	ProgramVariants& programVariants = registeredPrograms[baseProgram];
+
+	programVariants.shaders.clear();
+
+	for (ShaderInfo* entry = shaders; entry->type != GL_NONE; ++entry) {
+
+		programVariants.shaders.push_back({ entry->type, entry->filename, 0 });
+	}
+
+	programVariants.shaders.push_back({ GL_NONE, nullptr, 0 });
+
+} // end registerShaders
+
+
+GLuint ShaderVariants::getProgram(GLuint baseProgram, const Material* material)
+{
+	if (variantsEnabled == false) {
+		return baseProgram;
+	}
+
+	auto iter = registeredPrograms.find(baseProgram);
+
+	if (iter == registeredPrograms.end()) {
+		return baseProgram;
+	}
+
+	unsigned int key = getVariantKey(material);
+
+	auto variant = iter->second.variants.find(key);
+
+	if (variant != iter->second.variants.end()) {
+		return variant->second;
+	}
+
+	if (VERBOSE) std::cout << "Building shader variant " << std::hex << key << std::dec << std::endl;
+
+	GLuint variantProgram = BuildShaderProgram(&iter->second.shaders[0], getDefines(key));
+
+	if (variantProgram != 0) {
+
+		setUpVariant(variantProgram);
+	}
+	else {
+
+		// Do not try to build it again
+		variantProgram = baseProgram;
+	}
+
+	iter->second.variants[key] = variantProgram;
+
+	return variantProgram;
+
+} // end getProgram
+
+
+void ShaderVariants::buildVariants(const std::vector<std::pair<GLuint, const Material*>>& programMaterials)
+{
+	if (variantsEnabled == false) {
+		return;
+	}
+
+	// Each variant builds from its own copy of the shaders. A deque keeps the copies
+	// in place as more are added.
+	std::deque<std::vector<ShaderInfo>> variantShaders;
+
+	std::vector<ShaderInfo*> shaderSets;
+	std::vector<std::string> defines;
+	std::vector<std::pair<ProgramVariants*, unsigned int>> newVariants;
+
+	for (auto& programMaterial : programMaterials) {
+
+		auto iter = registeredPrograms.find(programMaterial.first);
+
+		if (iter == registeredPrograms.end()) {
+			continue;
+		}
+
+		unsigned int key = getVariantKey(programMaterial.second);
+
+		if (iter->second.variants.count(key) > 0) {
+			continue;
+		}
+
+		// Reserve the key so the variant is only built once
+		iter->second.variants[key] = programMaterial.first;
+
+		variantShaders.push_back(iter->second.shaders);
+
+		shaderSets.push_back(&variantShaders.back()[0]);
+		defines.push_back(getDefines(key));
+		newVariants.push_back({ &iter->second, key });
+	}
+
+	if (shaderSets.empty()) {
+		return;
+	}
+
+	if (VERBOSE) std::cout << "Building " << shaderSets.size() << " shader variants" << std::endl;
+
+	std::vector<GLuint> programs = BuildShaderPrograms(shaderSets, defines);
+
+	for (size_t i = 0; i < programs.size(); i++) {
+
+		if (programs[i] != 0) {
+
+			setUpVariant(programs[i]);
+
+			newVariants[i].first->variants[newVariants[i].second] = programs[i];
+		}
+	}
+
+} // end buildVariants
+
+
+void ShaderVariants::updateLighting(const GeneralLight* lights)
+{
+	unsigned int enabledLights = 0;
+	unsigned int spotLights = 0;
+
+	for (int i = 0; i < MAX_LIGHTS; i++) {
+
+		if (lights[i].enabled != 0) {
+
+			enabledLights |= 1u << i;
+
+			if (lights[i].isSpot != 0) {
+
+				spotLights |= 1u << i;
+			}
+		}
+	}
+
+	lightingKey = (enabledLights << LIGHT_ENABLED_SHIFT) | (spotLights << LIGHT_IS_SPOT_SHIFT);
+
+} // end updateLighting
+
+
+unsigned int ShaderVariants::getVariantKey(const Material* material)
+{
+	unsigned int key = static_cast<unsigned int>(material->textureMode) & TEXTURE_MODE_MASK;
+
+	// Textures are ignored when there is no texture mode
+	if (material->textureMode != 0) {
+
+		if (material->diffuseTextureEnabled) {
+			key |= DIFFUSE_TEXTURE_BIT;
+		}
+		if (material->diffuseLayer >= 0) {
+			key |= DIFFUSE_ARRAY_BIT;
+		}
+		if (material->specularTextureEnabled) {
+			key |= SPECULAR_TEXTURE_BIT;
+		}
+		if (material->specularLayer >= 0) {
+			key |= SPECULAR_ARRAY_BIT;
+		}
+	}
+
+	// Decals are not lit
+	if (material->textureMode != 1) {
+
+		key |= lightingKey;
+	}
+
+	if (fogEnabled) {
+		key |= FOG_BIT;
+	}
+
+	return key;
+
+} // end getVariantKey
+
+
+std::string ShaderVariants::getDefines(unsigned int key)
+{
+	unsigned int enabledLights = (key >> LIGHT_ENABLED_SHIFT) & 0xFF;
+	unsigned int spotLights = (key >> LIGHT_IS_SPOT_SHIFT) & 0xFF;
+
+	// Only loop up to the last light that is on
+	int lightCount = 0;
+	for (int i = 0; i < MAX_LIGHTS; i++) {
+
+		if (enabledLights & (1u << i)) {
+			lightCount = i + 1;
+		}
+	}
+
+	auto boolString = [](bool value) { return value ? "true" : "false"; };
+
+	std::stringstream defines;
+
+	defines << "#define SHADER_VARIANT" << std::endl;
+	defines << "#define TEXTURE_MODE " << (key & TEXTURE_MODE_MASK) << std::endl;
+	defines << "#define DIFFUSE_TEXTURE_ENABLED " << boolString((key & DIFFUSE_TEXTURE_BIT) != 0) << std::endl;
+	defines << "#define DIFFUSE_TEXTURE_ARRAY " << boolString((key & DIFFUSE_ARRAY_BIT) != 0) << std::endl;
+	defines << "#define SPECULAR_TEXTURE_ENABLED " << boolString((key & SPECULAR_TEXTURE_BIT) != 0) << std::endl;
+	defines << "#define SPECULAR_TEXTURE_ARRAY " << boolString((key & SPECULAR_ARRAY_BIT) != 0) << std::endl;
+	defines << "#define NUM_LIGHTS " << lightCount << std::endl;
+	defines << "#define LIGHT_ENABLED(i) (((" << enabledLights << " >> (i)) & 1) != 0)" << std::endl;
+	defines << "#define LIGHT_IS_SPOT(i) (((" << spotLights << " >> (i)) & 1) != 0)" << std::endl;
+	defines << "#define FOG_ENABLED " << boolString((key & FOG_BIT) != 0) << std::endl;
+
+	return defines.str();
+
+} // end getDefines
+
+
+void ShaderVariants::setUpVariant(GLuint variantProgram)
+{
+	SharedProjectionAndViewing::setUniformBlockForShader(variantProgram);
+	SharedMaterialProperties::setUniformBlockForShader(variantProgram);
+	SharedGeneralLighting::setUniformBlockForShader(variantProgram);
+
+} // end setUpVariant
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BuildShaderProgram.h"
+#include "SharedMaterialProperties.h"
+#include "SharedGeneralLighting.h"
+
+/**
+ * @class	ShaderVariants
+ *
+ * @brief	Static class that builds specialized versions of a shader program. The
+ * 			texture mode, the texture types of the material, the lights that are on,
+ * 			and whether fog is used are passed to the shaders as preprocessor
+ * 			definitions so the compiler can remove the branches on them. Each material
+ * 			is rendered with the variant that matches it. Variants are built when first
+ * 			needed and are saved by the shader program binary cache.
+ */
+class ShaderVariants
+{
+public:
+
+	/**
+	 * @fn	static void ShaderVariants::registerShaders(GLuint baseProgram, ShaderInfo* shaders);
+	 *
+	 * @brief	Records the shader source files of a program so variants of it can be
+	 * 			built. Programs that are not registered are always used as they are.
+	 *
+	 * @param	baseProgram	The program built without variant definitions.
+	 * @param	shaders	   	The shaders the program was built from.
+	 */
+	static void registerShaders(GLuint baseProgram, ShaderInfo* shaders);
+
+	/**
+	 * @fn	static GLuint ShaderVariants::getProgram(GLuint baseProgram, const Material* material);
+	 *
+	 * @brief	Gets the variant of a program for a material. The variant is built if it
+	 * 			does not exist yet.
+	 *
+	 * @param	baseProgram	The program built without variant definitions.
+	 * @param	material   	The material being rendered.
+	 *
+	 * @returns	The variant. The base program if variants are disabled, the base
+	 * 			program was not registered, or the variant failed to build.
+	 */
+	static GLuint getProgram(GLuint baseProgram, const Material* material);
+
+	/**
+	 * @fn	static void ShaderVariants::buildVariants(const std::vector<std::pair<GLuint, const Material*>>& programMaterials);
+	 *
+	 * @brief	Builds all of the variants needed for a set of programs and materials at
+	 * 			once. Compiling them together lets the driver compile them in parallel.
+	 *
+	 * @param	programMaterials	Base program and material pairs.
+	 */
+	static void buildVariants(const std::vector<std::pair<GLuint, const Material*>>& programMaterials);
+
+	/**
+	 * @fn	static void ShaderVariants::updateLighting(const GeneralLight* lights);
+	 *
+	 * @brief	Determines which lights are on and which are spotlights. Call once per
+	 * 			frame before getting programs.
+	 *
+	 * @param	lights	All lights. Usually the copy of the lights in a render snapshot.
+	 */
+	static void updateLighting(const GeneralLight* lights);
+
+	static void setFogEnabled(bool enabled) { fogEnabled = enabled; }
+
+	static bool getFogEnabled() { return fogEnabled; }
+
+	static void setEnabled(bool enabled) { variantsEnabled = enabled; }
+
+	static bool isEnabled() { return variantsEnabled; }
+
+protected:
+
+	/** @brief	Source files and variants of a registered program */
+	struct ProgramVariants {
+
+		std::vector<ShaderInfo> shaders; // Shaders including the GL_NONE terminator
+
+		std::unordered_map<unsigned int, GLuint> variants; // Variants by key
+	};
+
+	/**
+	 * @fn	static unsigned int ShaderVariants::getVariantKey(const Material* material);
+	 *
+	 * @brief	Packs the material properties and the present lighting and fog settings
+	 * 			that select a variant.
+	 */
+	static unsigned int getVariantKey(const Material* material);
+
+	/**
+	 * @fn	static std::string ShaderVariants::getDefines(unsigned int key);
+	 *
+	 * @brief	Gets the preprocessor definitions for a variant key.
+	 */
+	static std::string getDefines(unsigned int key);
+
+	/**
+	 * @fn	static void ShaderVariants::setUpVariant(GLuint variantProgram);
+	 *
+	 * @brief	Sets up the shared uniform blocks and the samplers of a new variant.
+	 */
+	static void setUpVariant(GLuint variantProgram);
+
+	/** @brief	Registered programs by base program */
+	static std::unordered_map<GLuint, ProgramVariants> registeredPrograms;
+
+	/** @brief	Bits for the lights that are on and the lights that are spotlights */
+	static unsigned int lightingKey;
+
+	static bool fogEnabled;
+
+	static bool variantsEnabled;
+
+}; // end ShaderVariants class
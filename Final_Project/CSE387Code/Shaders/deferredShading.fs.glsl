@@ -0,0 +1,161 @@
+#version 430 core
+
+#pragma optimize(on)
+#pragma debug(off)
+
+const int MaxLights = 8;
+
+// Structure for holding general light properties. Matches fragmentShader.fs.glsl.
+struct GeneralLight
+{
+	vec4 ambientColor;
+	vec4 diffuseColor;
+	vec4 specularColor;
+	vec4 positionOrDirection;
+	vec3 spotDirection;
+	bool isSpot;
+	float spotCutoffCos;
+	float spotExponent;
+	float constant;
+	float linear;
+	float quadratic;
+	bool enabled;
+};
+
+layout(std140, binding = 22) uniform LightBlock
+{
+	GeneralLight lights[MaxLights];
+};
+
+layout(std140, binding = 3) uniform cameraBlock
+{
+	mat4 viewingMatrix;
+	mat4 projectionMatrix;
+	vec3 worldEyePosition;
+};
+
+// Transforms normalized device coordinates of the view back to world coordinates
+layout(location = 2) uniform mat4 inverseViewProjection;
+
+// Viewport of the view in pixels
+layout(location = 3) uniform ivec4 viewport;
+
+// Light that is added. Negative for the pass that writes the emissive color, fog, and depth.
+layout(location = 4) uniform int lightIndex;
+
+// Distance beyond which the light is not added. Negative if the light has no range.
+layout(location = 5) uniform float lightRange;
+
+layout(location = 6) uniform bool fogEnabled;
+
+layout(location = 10) uniform sampler2D emissiveBuffer;
+layout(location = 11) uniform sampler2D ambientBuffer;
+layout(location = 12) uniform sampler2D diffuseBuffer;
+layout(location = 13) uniform sampler2D specularBuffer;
+layout(location = 14) uniform sampler2D normalBuffer;
+layout(location = 15) uniform sampler2D depthBuffer;
+
+out vec4 fragmentColor;
+
+const vec3 fogColor = vec3(0.2, 0.5, 0.8);
+const float fogDensity = 0.03;
+
+vec3 shadingCaculation(GeneralLight light, vec3 worldPosition, vec3 worldNormal, ivec2 texel);
+
+void main()
+{
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+
+	float depth = texelFetch(depthBuffer, texel, 0).r;
+
+	// Nothing was rendered. The clear color is kept.
+	if (depth == 1.0) {
+		discard;
+	}
+
+	vec4 ndcPosition = vec4((gl_FragCoord.xy - viewport.xy) / viewport.zw * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+	vec4 worldPosition = inverseViewProjection * ndcPosition;
+	worldPosition /= worldPosition.w;
+
+	// Fog is linear in the color so each light is faded by the same factor
+	float distFactor = 1.0;
+
+	if (fogEnabled) {
+
+		float dist = length(viewingMatrix * worldPosition);
+		distFactor = clamp(1.0 / exp((dist * fogDensity) * (dist * fogDensity)), 0.0, 1.0);
+	}
+
+	vec4 emissive = texelFetch(emissiveBuffer, texel, 0);
+
+	if (lightIndex < 0) {
+
+		fragmentColor = vec4(mix(fogColor, emissive.rgb, distFactor), 1.0);
+
+		// Later passes and occlusion culling read the depth of the scene
+		gl_FragDepth = depth;
+		return;
+	}
+
+	GeneralLight light = lights[lightIndex];
+
+	// Unlit materials and surfaces out of range of the light
+	if (emissive.a == 0.0 ||
+		(lightRange >= 0.0 && distance(light.positionOrDirection.xyz, worldPosition.xyz) > lightRange)) {
+		discard;
+	}
+
+	vec3 worldNormal = texelFetch(normalBuffer, texel, 0).xyz;
+
+	fragmentColor = vec4(distFactor * shadingCaculation(light, worldPosition.xyz, worldNormal, texel), 0.0);
+
+} // end main
+
+
+// Same as the shading calculation of fragmentShader.fs.glsl with the material read from the G-buffer
+vec3 shadingCaculation(GeneralLight light, vec3 worldPosition, vec3 worldNormal, ivec2 texel)
+{
+	vec3 totalFromThisLight = vec3(0.0, 0.0, 0.0);
+
+	vec3 lightVector;
+	if (light.positionOrDirection.w < 1) {
+		// Directional
+		lightVector = normalize(light.positionOrDirection.xyz);
+	}
+	else {
+		// Positional
+		lightVector = normalize(light.positionOrDirection.xyz - worldPosition);
+	}
+
+	vec3 reflection = normalize(reflect(-lightVector, worldNormal));
+	vec3 eyeVector = normalize(worldEyePosition - worldPosition);
+
+	float spotCos = 0;
+	if (light.isSpot == true) {
+
+		spotCos = dot(-lightVector, normalize(light.spotDirection));
+	}
+
+	// Is it a spot light and are we in the cone?
+	if (light.isSpot == false || spotCos >= light.spotCutoffCos) {
+
+		vec4 specular = texelFetch(specularBuffer, texel, 0);
+
+		totalFromThisLight += texelFetch(ambientBuffer, texel, 0).rgb * light.ambientColor.xyz;
+
+		totalFromThisLight += max(dot(worldNormal, lightVector), 0.0f) * texelFetch(diffuseBuffer, texel, 0).rgb * light.diffuseColor.xyz;
+
+		totalFromThisLight += pow(max(dot(reflection, eyeVector), 0.0f), specular.a) * specular.rgb * light.specularColor.xyz;
+	}
+
+	// Attenuation of positional lights
+	if (light.positionOrDirection.w >= 1) {
+
+		float lightDistance = length(light.positionOrDirection.xyz - worldPosition);
+
+		totalFromThisLight /= light.constant + light.linear * lightDistance + light.quadratic * lightDistance * lightDistance;
+	}
+
+	return totalFromThisLight;
+
+} // end shadingCaculation
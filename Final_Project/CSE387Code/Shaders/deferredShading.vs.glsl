@@ -0,0 +1,35 @@
+#version 430 core
+
+#pragma optimize(on)
+#pragma debug(off)
+
+layout(std140, binding = 3) uniform cameraBlock
+{
+	mat4 viewingMatrix;
+	mat4 projectionMatrix;
+	vec3 worldEyePosition;
+};
+
+// Transformation of the light volume into world coordinates
+layout(location = 0) uniform mat4 volumeMatrix;
+
+// True to cover the viewport instead of rendering a light volume
+layout(location = 1) uniform bool fullScreen;
+
+layout (location = 0) in vec3 vertexPosition;
+
+void main()
+{
+	if (fullScreen) {
+
+		// Covers the viewport with a single triangle. No vertex data is needed.
+		vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+
+		gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+	}
+	else {
+
+		gl_Position = projectionMatrix * viewingMatrix * volumeMatrix * vec4(vertexPosition, 1.0);
+	}
+
+} // end main
@@ -0,0 +1,37 @@
+#version 430 core
+
+#pragma optimize(on)
+#pragma debug(off)
+
+layout(std140, binding = 2) uniform transformBlock
+{
+	mat4 modelMatrix;
+	mat3 normalModelMatrix;
+	float fade;
+};
+
+float ditherThreshold();
+
+// Only depth is written by the depth pre-pass. Pixels left out by the shading
+// pass of a fading mesh are left out here too.
+void main()
+{
+	// Meshes that cross-fade with their impostors leave out a dithered share of their pixels
+	if (fade < 1.0 && fade <= ditherThreshold()) {
+		discard;
+	}
+
+} // end main
+
+
+// Threshold in (0, 1) of the pixel from a 4 x 4 ordered dither matrix. Objects that
+// cross-fade with their impostors draw the pixels whose threshold is below their fade.
+float ditherThreshold()
+{
+	const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+
+	ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+
+	return (bayer[pixel.y * 4 + pixel.x] + 0.5) / 16.0;
+
+} // end ditherThreshold
@@ -0,0 +1,32 @@
+#version 430 core
+
+#pragma optimize(on)
+#pragma debug(off)
+
+layout(std140, binding = 2) uniform transformBlock
+{
+	mat4 modelMatrix;
+	mat3 normalModelMatrix;
+	float fade;
+};
+
+layout(std140, binding = 3) uniform cameraBlock
+{
+	mat4 viewingMatrix;
+	mat4 projectionMatrix;
+	vec3 worldEyePosition;
+};
+
+// Must match the position computed by vertexShader.vs.glsl for the shading
+// pass to pass the GL_EQUAL depth test
+invariant gl_Position;
+
+layout (location = 0) in vec3 vertexPosition; 
+
+void main()
+{
+	vec4 viewSpace = viewingMatrix * modelMatrix * vec4(vertexPosition, 1.0f);
+
+	gl_Position = projectionMatrix * viewSpace;
+
+} // end main
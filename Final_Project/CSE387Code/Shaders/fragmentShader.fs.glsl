@@ -5,6 +5,21 @@
 
 const int MaxLights = 8;
 
+// Variants of this shader are built with these macros defined as constants by
+// ShaderVariants so that branches on them are removed by the compiler. Without
+// them the shader decides at run time using the material and lights.
+#ifndef SHADER_VARIANT
+#define TEXTURE_MODE material.textureMode
+#define DIFFUSE_TEXTURE_ENABLED material.diffuseTextureEnabled
+#define SPECULAR_TEXTURE_ENABLED material.specularTextureEnabled
+#define DIFFUSE_TEXTURE_ARRAY (object.diffuseLayer >= 0)
+#define SPECULAR_TEXTURE_ARRAY (object.specularLayer >= 0)
+#define NUM_LIGHTS MaxLights
+#define LIGHT_ENABLED(i) lights[i].enabled
+#define LIGHT_IS_SPOT(i) lights[i].isSpot
+#define FOG_ENABLED true
+#endif
+
 // Structure for holding general light properties
 struct GeneralLight
 {
@@ -34,7 +49,7 @@ struct GeneralLight
 
 };
 
-layout(shared) uniform LightBlock
+layout(std140, binding = 22) uniform LightBlock
 {
 	GeneralLight lights[MaxLights];
 };
@@ -50,23 +65,36 @@ struct Material
 	int textureMode;
 	bool diffuseTextureEnabled;
 	bool specularTextureEnabled;
+	int diffuseLayer;		// Layer of the diffuse texture array. Negative if not used.
+	int specularLayer;		// Layer of the specular texture array. Negative if not used.
 //	bool normalMapEnabled;
 //	bool bumpMapEnabled;
 };
 
-layout(shared) uniform MaterialBlock
+layout(std140, binding = 2) uniform transformBlock
+{
+	mat4 modelMatrix;
+	mat3 normalModelMatrix;
+	float fade;
+};
+
+layout(std140, binding = 12) uniform MaterialBlock
 {
 	Material object;
 };
 
-layout(shared) uniform worldEyeBlock
+layout(std140, binding = 3) uniform cameraBlock
 {
+	mat4 viewingMatrix;
+	mat4 projectionMatrix;
 	vec3 worldEyePosition;
 };
 
 layout(location = 100) uniform sampler2D diffuseSampler;
 layout(location = 101) uniform sampler2D specularSampler;
 //layout(location = 102) uniform sampler2D normalMapSampler;
+layout(location = 104) uniform sampler2DArray diffuseArraySampler;
+layout(location = 105) uniform sampler2DArray specularArraySampler;
 
 in vec3 vertexWorldPosition;
 in vec3 vertexWorldNormal;
@@ -75,7 +103,10 @@ in vec4 viewSpace;
 
 out vec4 fragmentColor;
 
-vec3 shadingCaculation(GeneralLight light, Material object);
+vec3 shadingCaculation(GeneralLight light, bool isSpot, Material object);
+vec4 diffuseTextureColor(Material object);
+vec4 specularTextureColor(Material object);
+float ditherThreshold();
 vec3 fragmentWorldNormal;
 
 const vec3 fogColor = vec3(0.2, 0.5, 0.8);
@@ -83,6 +114,10 @@ const float fogDensity = 0.03;
 
 void main()
 {
+	// Meshes that cross-fade with their impostors leave out a dithered share of their pixels
+	if (fade < 1.0 && fade <= ditherThreshold()) {
+		discard;
+	}
 
 	// Make copy of material properties that can be written to
 	Material material = object;
@@ -90,87 +125,137 @@ void main()
 	fragmentWorldNormal = vertexWorldNormal;
 
 	// Substitute diffuse texture for ambient and diffuse material properties
-	if (material.diffuseTextureEnabled == true && material.textureMode != 0) {
+	if (DIFFUSE_TEXTURE_ENABLED == true && TEXTURE_MODE != 0) {
 
-		material.diffuseMat = texture(diffuseSampler, TexCoord.st);
+		material.diffuseMat = diffuseTextureColor(material);
 		material.ambientMat = material.diffuseMat;
 	}
 
 	// Substitute specular texture for specular material properties
-	if (material.specularTextureEnabled == true && material.textureMode != 0) {
+	if (SPECULAR_TEXTURE_ENABLED == true && TEXTURE_MODE != 0) {
 
-		material.specularMat = texture(specularSampler, TexCoord.st);
+		material.specularMat = specularTextureColor(material);
 	}
 
 	// Should shading calculations be performed
-	if (material.textureMode == 2 || material.textureMode == 0) {
+	if (TEXTURE_MODE == 2 || TEXTURE_MODE == 0) {
 
 		fragmentColor = material.emmissiveMat;
 
-		for (int i = 0; i < MaxLights; i++) {
+		for (int i = 0; i < NUM_LIGHTS; i++) {
 
-			fragmentColor += vec4(shadingCaculation(lights[i], material), 1.0);
+			if (LIGHT_ENABLED(i) == true) {
+
+				fragmentColor += vec4(shadingCaculation(lights[i], LIGHT_IS_SPOT(i), material), 1.0);
+			}
 		}
 
 	}
-	else if (material.textureMode == 1) { // No shading calculations
+	else if (TEXTURE_MODE == 1) { // No shading calculations
 
-		fragmentColor = texture(diffuseSampler, TexCoord.st);
+		fragmentColor = diffuseTextureColor(material);
 	}
 
 
 	// fog calculations
-	float dist = length(viewSpace);
-	float distFactor = 1.0 / exp((dist * fogDensity) * (dist * fogDensity));
-	distFactor = clamp(distFactor, 0.0, 1.0);
+	if (FOG_ENABLED == true) {
+
+		float dist = length(viewSpace);
+		float distFactor = 1.0 / exp((dist * fogDensity) * (dist * fogDensity));
+		distFactor = clamp(distFactor, 0.0, 1.0);
 
-	fragmentColor = mix(vec4(fogColor, 1.0), fragmentColor, distFactor);
+		fragmentColor = mix(vec4(fogColor, 1.0), fragmentColor, distFactor);
+	}
 
 
 } // main
 
 
-vec3 shadingCaculation(GeneralLight light, Material object)
+// Samples either the diffuse texture or a layer of the diffuse texture array
+vec4 diffuseTextureColor(Material object)
+{
+	if (DIFFUSE_TEXTURE_ARRAY) {
+
+		return texture(diffuseArraySampler, vec3(TexCoord.st, object.diffuseLayer));
+	}
+
+	return texture(diffuseSampler, TexCoord.st);
+
+} // end diffuseTextureColor
+
+
+// Samples either the specular texture or a layer of the specular texture array
+vec4 specularTextureColor(Material object)
+{
+	if (SPECULAR_TEXTURE_ARRAY) {
+
+		return texture(specularArraySampler, vec3(TexCoord.st, object.specularLayer));
+	}
+
+	return texture(specularSampler, TexCoord.st);
+
+} // end specularTextureColor
+
+
+vec3 shadingCaculation(GeneralLight light, bool isSpot, Material object)
 {
 	vec3 totalFromThisLight = vec3(0.0, 0.0, 0.0);
 
-	if (light.enabled == true) {
+	// Calculate a bunch of vectors
+	vec3 lightVector;
+	if (light.positionOrDirection.w < 1) {
+		// Directional
+		lightVector = normalize(light.positionOrDirection.xyz);
+	}
+	else {
+		// Positional
+		lightVector = normalize(light.positionOrDirection.xyz -
+			vertexWorldPosition.xyz);
+	}
 
-		// Calculate a bunch of vectors
-		vec3 lightVector;
-		if (light.positionOrDirection.w < 1) {
-			// Directional
-			lightVector = normalize(light.positionOrDirection.xyz);
-		}
-		else {
-			// Positional
-			lightVector = normalize(light.positionOrDirection.xyz -
-				vertexWorldPosition.xyz);
-		}
+	vec3 reflection = normalize(reflect(-lightVector, fragmentWorldNormal.xyz));
+	vec3 eyeVector = normalize(worldEyePosition - vertexWorldPosition.xyz);
 
-		vec3 reflection = normalize(reflect(-lightVector, fragmentWorldNormal.xyz));
-		vec3 eyeVector = normalize(worldEyePosition - vertexWorldPosition.xyz);
+	float spotCosFGameObject = 0;
+	if (isSpot == true) {
 
-		float spotCosFGameObject = 0;
-		if (light.isSpot == true) {
+		spotCosFGameObject = dot(-lightVector, normalize(light.spotDirection));
+	}
 
-			spotCosFGameObject = dot(-lightVector, normalize(light.spotDirection));
-		}
+	// Is it a spot light and are we in the cone?
+	if (isSpot == false || (isSpot == true && spotCosFGameObject >= light.spotCutoffCos)) {
 
-		// Is it a spot light and are we in the cone?
-		if (light.isSpot == false || (light.isSpot == true && spotCosFGameObject >= light.spotCutoffCos)) {
+		// Ambient Reflection
+		totalFromThisLight += object.ambientMat.xyz * light.ambientColor.xyz;
 
-			// Ambient Reflection
-			totalFromThisLight += object.ambientMat.xyz * light.ambientColor.xyz;
+		// Difuse Reflection
+		totalFromThisLight += max(dot(fragmentWorldNormal.xyz, lightVector), 0.0f) * object.diffuseMat.xyz * light.diffuseColor.xyz;
 
-			// Difuse Reflection
-			totalFromThisLight += max(dot(fragmentWorldNormal.xyz, lightVector), 0.0f) * object.diffuseMat.xyz * light.diffuseColor.xyz;
+		// Specular Reflection
+		totalFromThisLight += pow(max(dot(reflection, eyeVector), 0.0f), object.specularExp) * object.specularMat.xyz * light.specularColor.xyz;
+	}
 
-			// Specular Reflection
-			totalFromThisLight += pow(max(dot(reflection, eyeVector), 0.0f), object.specularExp) * object.specularMat.xyz * light.specularColor.xyz;
-		}
+	// Attenuation of positional lights. The default coefficients leave the light unattenuated.
+	if (light.positionOrDirection.w >= 1) {
+
+		float lightDistance = length(light.positionOrDirection.xyz - vertexWorldPosition.xyz);
+
+		totalFromThisLight /= light.constant + light.linear * lightDistance + light.quadratic * lightDistance * lightDistance;
 	}
 
 	return totalFromThisLight;
 
 } // end shadingCaculation
+
+
+// Threshold in (0, 1) of the pixel from a 4 x 4 ordered dither matrix. Objects that
+// cross-fade with their impostors draw the pixels whose threshold is below their fade.
+float ditherThreshold()
+{
+	const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+
+	ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+
+	return (bayer[pixel.y * 4 + pixel.x] + 0.5) / 16.0;
+
+} // end ditherThreshold
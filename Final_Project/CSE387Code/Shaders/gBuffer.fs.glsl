@@ -0,0 +1,146 @@
+#version 430 core
+
+#pragma optimize(on)
+#pragma debug(off)
+
+// Writes the material properties of the nearest surface of each pixel for the
+// deferred pipeline. Lighting and fog are applied by deferredShading.fs.glsl.
+// Variants are built by ShaderVariants the same way as for fragmentShader.fs.glsl.
+#ifndef SHADER_VARIANT
+#define TEXTURE_MODE material.textureMode
+#define DIFFUSE_TEXTURE_ENABLED material.diffuseTextureEnabled
+#define SPECULAR_TEXTURE_ENABLED material.specularTextureEnabled
+#define DIFFUSE_TEXTURE_ARRAY (object.diffuseLayer >= 0)
+#define SPECULAR_TEXTURE_ARRAY (object.specularLayer >= 0)
+#endif
+
+struct Material
+{
+	vec4 ambientMat;
+	vec4 diffuseMat;
+	vec4 specularMat;
+	vec4 emmissiveMat;
+	float specularExp;
+	int textureMode;
+	bool diffuseTextureEnabled;
+	bool specularTextureEnabled;
+	int diffuseLayer;		// Layer of the diffuse texture array. Negative if not used.
+	int specularLayer;		// Layer of the specular texture array. Negative if not used.
+};
+
+layout(std140, binding = 2) uniform transformBlock
+{
+	mat4 modelMatrix;
+	mat3 normalModelMatrix;
+	float fade;
+};
+
+layout(std140, binding = 12) uniform MaterialBlock
+{
+	Material object;
+};
+
+layout(location = 100) uniform sampler2D diffuseSampler;
+layout(location = 101) uniform sampler2D specularSampler;
+layout(location = 104) uniform sampler2DArray diffuseArraySampler;
+layout(location = 105) uniform sampler2DArray specularArraySampler;
+
+in vec3 vertexWorldPosition;
+in vec3 vertexWorldNormal;
+in vec2 TexCoord;
+in vec4 viewSpace;
+
+layout(location = 0) out vec4 emissiveOut;	// Emissive color or the color of unlit materials. Alpha is 1 if lit.
+layout(location = 1) out vec4 ambientOut;
+layout(location = 2) out vec4 diffuseOut;
+layout(location = 3) out vec4 specularOut;	// Specular exponent in alpha
+layout(location = 4) out vec4 normalOut;
+
+vec4 diffuseTextureColor(Material object);
+vec4 specularTextureColor(Material object);
+float ditherThreshold();
+
+void main()
+{
+	// Meshes that cross-fade with their impostors leave out a dithered share of their pixels
+	if (fade < 1.0 && fade <= ditherThreshold()) {
+		discard;
+	}
+
+	// Make copy of material properties that can be written to
+	Material material = object;
+
+	// Substitute diffuse texture for ambient and diffuse material properties
+	if (DIFFUSE_TEXTURE_ENABLED == true && TEXTURE_MODE != 0) {
+
+		material.diffuseMat = diffuseTextureColor(material);
+		material.ambientMat = material.diffuseMat;
+	}
+
+	// Substitute specular texture for specular material properties
+	if (SPECULAR_TEXTURE_ENABLED == true && TEXTURE_MODE != 0) {
+
+		material.specularMat = specularTextureColor(material);
+	}
+
+	// Should shading calculations be performed
+	if (TEXTURE_MODE == 2 || TEXTURE_MODE == 0) {
+
+		emissiveOut = vec4(material.emmissiveMat.rgb, 1.0);
+	}
+	else if (TEXTURE_MODE == 1) { // No shading calculations
+
+		emissiveOut = vec4(diffuseTextureColor(material).rgb, 0.0);
+	}
+	else {
+
+		emissiveOut = vec4(0.0);
+	}
+
+	ambientOut = vec4(material.ambientMat.rgb, 0.0);
+	diffuseOut = vec4(material.diffuseMat.rgb, 0.0);
+	specularOut = vec4(material.specularMat.rgb, material.specularExp);
+
+	// Not normalized, matching the forward shader
+	normalOut = vec4(vertexWorldNormal, 0.0);
+
+} // main
+
+
+// Samples either the diffuse texture or a layer of the diffuse texture array
+vec4 diffuseTextureColor(Material object)
+{
+	if (DIFFUSE_TEXTURE_ARRAY) {
+
+		return texture(diffuseArraySampler, vec3(TexCoord.st, object.diffuseLayer));
+	}
+
+	return texture(diffuseSampler, TexCoord.st);
+
+} // end diffuseTextureColor
+
+
+// Samples either the specular texture or a layer of the specular texture array
+vec4 specularTextureColor(Material object)
+{
+	if (SPECULAR_TEXTURE_ARRAY) {
+
+		return texture(specularArraySampler, vec3(TexCoord.st, object.specularLayer));
+	}
+
+	return texture(specularSampler, TexCoord.st);
+
+} // end specularTextureColor
+
+
+// Threshold in (0, 1) of the pixel from a 4 x 4 ordered dither matrix. Objects that
+// cross-fade with their impostors draw the pixels whose threshold is below their fade.
+float ditherThreshold()
+{
+	const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+
+	ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+
+	return (bayer[pixel.y * 4 + pixel.x] + 0.5) / 16.0;
+
+} // end ditherThreshold
@@ -0,0 +1,33 @@
+#version 430 core
+
+#pragma optimize(on)
+#pragma debug(off)
+
+// Level of the depth pyramid that is read. The base level of the texture is
+// set to this level so texelFetch always reads level 0.
+layout(location = 1) uniform sampler2D sourceDepth;
+
+// Size of the level that is read in texels
+layout(location = 0) uniform ivec2 sourceSize;
+
+out float maxDepth;
+
+void main()
+{
+	// Each texel covers two by two texels of the level that is read. The
+	// last texel of a level with an odd size covers a single row or column.
+	ivec2 sourceCoord = ivec2(gl_FragCoord.xy) * 2;
+	ivec2 lastCoord = min(sourceCoord + 1, sourceSize - 1);
+
+	// Farthest depth of the texels that are covered
+	float depth = 0.0;
+
+	for (int y = sourceCoord.y; y <= lastCoord.y; y++) {
+		for (int x = sourceCoord.x; x <= lastCoord.x; x++) {
+
+			depth = max(depth, texelFetch(sourceDepth, ivec2(x, y), 0).r);
+		}
+	}
+
+	maxDepth = depth;
+}
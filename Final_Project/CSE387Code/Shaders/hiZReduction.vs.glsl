@@ -0,0 +1,12 @@
+#version 430 core
+
+#pragma optimize(on)
+#pragma debug(off)
+
+// Covers the viewport with a single triangle. No vertex data is needed.
+void main()
+{
+	vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+
+	gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
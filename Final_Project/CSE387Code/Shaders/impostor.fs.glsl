@@ -0,0 +1,144 @@
+#version 430 core
+
+#pragma optimize(on)
+#pragma debug(off)
+
+// Lights impostors with the ambient and diffuse terms of fragmentShader.fs.glsl
+// and applies the same fog. Specular highlights are left out.
+
+const int MaxLights = 8;
+
+// Structure for holding general light properties
+struct GeneralLight
+{
+	vec4 ambientColor;		// ambient color of the light
+	vec4 diffuseColor;		// diffuse color of the light
+	vec4 specularColor;		// specular color of the light
+
+	vec4 positionOrDirection;	// Direction if w = 0. Position if w = 1.
+
+	vec3 spotDirection;		// the direction the cone of light is shinning
+	bool isSpot;			// 1 if the light is a spotlight
+	float spotCutoffCos;	// Cosine of the spot cutoff angle
+	float spotExponent;		// For gradual falloff near cone edge
+
+	float constant;			// Attenuation coefficients
+	float linear;
+	float quadratic;
+
+	bool enabled;			// true if light is "on"
+};
+
+layout(std140, binding = 22) uniform LightBlock
+{
+	GeneralLight lights[MaxLights];
+};
+
+layout(location = 2) uniform bool fogEnabled;
+layout(location = 10) uniform sampler2D colorAtlas;
+layout(location = 11) uniform sampler2D normalAtlas;
+
+in vec2 atlasCoord;
+in vec3 vertexWorldPosition;
+in vec4 viewSpace;
+flat in mat3 objectToWorld;
+flat in float meshFade;
+
+out vec4 fragmentColor;
+
+float ditherThreshold();
+
+const vec3 fogColor = vec3(0.2, 0.5, 0.8);
+const float fogDensity = 0.03;
+
+void main()
+{
+	vec4 color = texture(colorAtlas, atlasCoord);
+
+	if (color.a < 0.5) {
+		discard;
+	}
+
+	// Draws the pixels left out by the mesh while they cross-fade
+	if (meshFade > 0.0 && ditherThreshold() < meshFade) {
+		discard;
+	}
+
+	// Mip levels are averaged with the empty texels around the model. Dividing
+	// by the coverage restores the color and normal.
+	vec4 packedNormal = texture(normalAtlas, atlasCoord) / color.a;
+
+	vec3 diffuse = color.rgb / color.a;
+
+	if (packedNormal.a < 0.5) {
+
+		fragmentColor = vec4(diffuse, 1.0);
+	}
+	else {
+
+		vec3 normal = normalize(objectToWorld * (packedNormal.xyz * 2.0 - 1.0));
+
+		vec3 total = vec3(0.0);
+
+		for (int i = 0; i < MaxLights; i++) {
+
+			if (lights[i].enabled == false) {
+				continue;
+			}
+
+			vec3 lightVector;
+
+			if (lights[i].positionOrDirection.w < 1) {
+
+				lightVector = normalize(lights[i].positionOrDirection.xyz);
+			}
+			else {
+
+				lightVector = normalize(lights[i].positionOrDirection.xyz - vertexWorldPosition);
+			}
+
+			vec3 fromLight = vec3(0.0);
+
+			if (lights[i].isSpot == false || dot(-lightVector, normalize(lights[i].spotDirection)) >= lights[i].spotCutoffCos) {
+
+				fromLight += diffuse * lights[i].ambientColor.rgb;
+				fromLight += max(dot(normal, lightVector), 0.0) * diffuse * lights[i].diffuseColor.rgb;
+			}
+
+			if (lights[i].positionOrDirection.w >= 1) {
+
+				float lightDistance = length(lights[i].positionOrDirection.xyz - vertexWorldPosition);
+
+				fromLight /= lights[i].constant + lights[i].linear * lightDistance + lights[i].quadratic * lightDistance * lightDistance;
+			}
+
+			total += fromLight;
+		}
+
+		fragmentColor = vec4(total, 1.0);
+	}
+
+	// fog calculations
+	if (fogEnabled == true) {
+
+		float dist = length(viewSpace);
+		float distFactor = 1.0 / exp((dist * fogDensity) * (dist * fogDensity));
+		distFactor = clamp(distFactor, 0.0, 1.0);
+
+		fragmentColor = mix(vec4(fogColor, 1.0), fragmentColor, distFactor);
+	}
+
+} // main
+
+
+// Threshold in (0, 1) of the pixel from a 4 x 4 ordered dither matrix. Objects that
+// cross-fade with their impostors draw the pixels whose threshold is below their fade.
+float ditherThreshold()
+{
+	const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+
+	ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+
+	return (bayer[pixel.y * 4 + pixel.x] + 0.5) / 16.0;
+
+} // end ditherThreshold
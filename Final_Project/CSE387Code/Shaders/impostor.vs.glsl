@@ -0,0 +1,64 @@
+#version 430 core
+
+#pragma optimize(on)
+#pragma debug(off)
+
+// Draws distant copies of a model as quads that face the camera. Each instance
+// selects the frame of the impostor atlas that was rendered from the direction
+// closest to the viewpoint. The quad turns about the vertical axis of the model
+// the same way the frames were rendered.
+
+layout(std140, binding = 3) uniform cameraBlock
+{
+	mat4 viewingMatrix;
+	mat4 projectionMatrix;
+	vec3 worldEyePosition;
+};
+
+layout(location = 0) uniform ivec2 atlasFrames;	// Frames across and down the atlas
+layout(location = 1) uniform float frameMargin;	// Size of a frame relative to the bounding sphere
+
+layout (location = 0) in vec2 corner;		// Corner of the quad from -1 to 1
+layout (location = 1) in vec4 centerRadius;	// Bounding sphere in world coordinates
+layout (location = 2) in vec4 axisXFrame;	// Unit x axis of the model in world coordinates. Frame in w.
+layout (location = 3) in vec4 axisYFade;	// Unit y axis of the model. Fade of the mesh in w.
+layout (location = 4) in vec4 axisZ;		// Unit z axis of the model
+
+out vec2 atlasCoord;
+out vec3 vertexWorldPosition;
+out vec4 viewSpace;
+flat out mat3 objectToWorld;
+flat out float meshFade;
+
+void main()
+{
+	vec3 center = centerRadius.xyz;
+
+	vec3 forward = normalize(worldEyePosition - center);
+	vec3 right = cross(axisYFade.xyz, forward);
+
+	// Looking straight along the vertical axis of the model
+	if (length(right) < 0.001) {
+
+		right = vec3(viewingMatrix[0][0], viewingMatrix[1][0], viewingMatrix[2][0]);
+	}
+
+	right = normalize(right);
+	vec3 up = cross(forward, right);
+
+	vertexWorldPosition = center + (corner.x * right + corner.y * up) * (centerRadius.w * frameMargin);
+
+	viewSpace = viewingMatrix * vec4(vertexWorldPosition, 1.0);
+
+	gl_Position = projectionMatrix * viewSpace;
+
+	int frame = int(axisXFrame.w);
+	vec2 cell = vec2(frame % atlasFrames.x, frame / atlasFrames.x);
+
+	atlasCoord = (cell + corner * 0.5 + 0.5) / vec2(atlasFrames);
+
+	objectToWorld = mat3(axisXFrame.xyz, axisYFade.xyz, axisZ.xyz);
+
+	meshFade = axisYFade.w;
+
+} // end main
@@ -0,0 +1,69 @@
+#version 430 core
+
+#pragma optimize(on)
+#pragma debug(off)
+
+// Writes the diffuse color and the object space normal of a model into the
+// frames of an impostor atlas. Impostors are lit by impostor.fs.glsl.
+
+struct Material
+{
+	vec4 ambientMat;
+	vec4 diffuseMat;
+	vec4 specularMat;
+	vec4 emmissiveMat;
+	float specularExp;
+	int textureMode;
+	bool diffuseTextureEnabled;
+	bool specularTextureEnabled;
+	int diffuseLayer;		// Layer of the diffuse texture array. Negative if not used.
+	int specularLayer;		// Layer of the specular texture array. Negative if not used.
+};
+
+layout(std140, binding = 12) uniform MaterialBlock
+{
+	Material object;
+};
+
+layout(location = 100) uniform sampler2D diffuseSampler;
+layout(location = 101) uniform sampler2D specularSampler;
+layout(location = 104) uniform sampler2DArray diffuseArraySampler;
+layout(location = 105) uniform sampler2DArray specularArraySampler;
+
+in vec3 objectNormal;
+in vec2 TexCoord;
+
+layout(location = 0) out vec4 colorOut;		// Diffuse color. Alpha is 1 where the model is.
+layout(location = 1) out vec4 normalOut;	// Normal packed into 0 to 1. Alpha is 1 if lit.
+
+vec4 diffuseTextureColor();
+
+void main()
+{
+	vec4 diffuse = object.diffuseMat;
+
+	// Substitute diffuse texture for ambient and diffuse material properties
+	if (object.diffuseTextureEnabled == true && object.textureMode != 0) {
+
+		diffuse = diffuseTextureColor();
+	}
+
+	colorOut = vec4(diffuse.rgb, 1.0);
+
+	// Texture mode 1 is not shaded
+	normalOut = vec4(normalize(objectNormal) * 0.5 + 0.5, object.textureMode == 1 ? 0.0 : 1.0);
+
+} // main
+
+
+// Samples either the diffuse texture or a layer of the diffuse texture array
+vec4 diffuseTextureColor()
+{
+	if (object.diffuseLayer >= 0) {
+
+		return texture(diffuseArraySampler, vec3(TexCoord.st, object.diffuseLayer));
+	}
+
+	return texture(diffuseSampler, TexCoord.st);
+
+} // end diffuseTextureColor
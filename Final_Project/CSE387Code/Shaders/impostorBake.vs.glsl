@@ -0,0 +1,25 @@
+#version 430 core
+
+#pragma optimize(on)
+#pragma debug(off)
+
+// Renders a model into a frame of an impostor atlas. The model is rendered in
+// object coordinates by an orthographic projection set up by ImpostorAtlas.
+layout(location = 0) uniform mat4 bakeViewProjection;
+
+layout (location = 0) in vec3 vertexPosition;
+layout (location = 1) in vec3 vertexNormal;
+layout (location = 2) in vec2 vertexTexCoord;
+
+out vec3 objectNormal;
+out vec2 TexCoord;
+
+void main()
+{
+	gl_Position = bakeViewProjection * vec4(vertexPosition, 1.0);
+
+	objectNormal = vertexNormal;
+
+	TexCoord = vertexTexCoord;
+
+} // end main
@@ -0,0 +1,31 @@
+#version 430 core
+
+#pragma optimize(on)
+#pragma debug(off)
+
+// Glyphs are cells of one row of the font texture. Cells are a pixel wider and
+// taller than the glyphs they hold so glyphs drawn side by side are spaced apart.
+const ivec2 cellSize = ivec2(6, 8);
+
+layout(location = 1) uniform sampler2D fontSampler;
+
+in vec2 cellCoord;
+flat in vec4 quadColor;
+flat in int quadGlyph;
+
+out vec4 fragmentColor;
+
+void main()
+{
+	if (quadGlyph >= 0) {
+
+		ivec2 texel = min(ivec2(cellCoord * vec2(cellSize)), cellSize - 1);
+
+		if (texelFetch(fontSampler, ivec2(quadGlyph * cellSize.x + texel.x, texel.y), 0).r < 0.5) {
+			discard;
+		}
+	}
+
+	fragmentColor = quadColor;
+
+} // end main
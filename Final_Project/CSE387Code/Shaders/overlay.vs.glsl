@@ -0,0 +1,31 @@
+#version 430 core
+
+#pragma optimize(on)
+#pragma debug(off)
+
+// Draws the quads of the stats overlay. The corners of each quad come from the
+// vertex index and its rectangle is given in pixels from the top left corner.
+
+layout(location = 0) uniform vec2 viewportSize;	// Size of the framebuffer in pixels
+
+layout (location = 0) in vec4 rect;		// Left, top, width and height in pixels
+layout (location = 1) in vec4 color;
+layout (location = 2) in int glyph;		// Glyph of the font. Negative for a solid rectangle.
+
+out vec2 cellCoord;
+flat out vec4 quadColor;
+flat out int quadGlyph;
+
+void main()
+{
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+
+	vec2 pixel = rect.xy + corner * rect.zw;
+
+	gl_Position = vec4(2.0 * pixel.x / viewportSize.x - 1.0, 1.0 - 2.0 * pixel.y / viewportSize.y, 0.0, 1.0);
+
+	cellCoord = corner;
+	quadColor = color;
+	quadGlyph = glyph;
+
+} // end main
@@ -3,12 +3,18 @@
 #pragma optimize(on)
 #pragma debug(off)
 
-layout(shared) uniform transformBlock
+layout(std140, binding = 2) uniform transformBlock
 {
 	mat4 modelMatrix;
 	mat3 normalModelMatrix;
+	float fade;
+};
+
+layout(std140, binding = 3) uniform cameraBlock
+{
 	mat4 viewingMatrix;
 	mat4 projectionMatrix;
+	vec3 worldEyePosition;
 };
 
 
@@ -17,6 +23,9 @@ out vec3 vertexWorldNormal;
 out vec2 TexCoord;
 out vec4 viewSpace;
 
+// The depth pre-pass computes the same positions so the depths match exactly
+invariant gl_Position;
+
 layout (location = 0) in vec3 vertexPosition; 
 layout (location = 1) in vec3 vertexNormal;
 layout (location = 2) in vec2 vertexTexCoord;
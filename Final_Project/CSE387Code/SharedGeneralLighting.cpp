@@ -1,85 +1,67 @@
 #include "SharedGeneralLighting.h"
 
 #include <sstream> 
+#include <algorithm>
 
 GeneralLight SharedGeneralLighting::lights[MAX_LIGHTS];
 
 const std::string SharedGeneralLighting::generalLightBlockName = "LightBlock";
 
-SharedUniformBlock SharedGeneralLighting::lightBlock(generalLightBlockBindingPoint);
+bool SharedGeneralLighting::lightsChanged = false;
+
+SharedUniformBlock SharedGeneralLighting::lightBlock(generalLightBlockBindingPoint, sizeof(lights));
 
 
 void SharedGeneralLighting::setUniformBlockForShader(GLuint shaderProgram)
 {
-	std::vector <std::string > lightBlockMemberNames = buildUniformBlockNameList();
-
-	std::vector<GLint> uniformOffsets = lightBlock.setUniformBlockForShader( shaderProgram, 
-																		generalLightBlockName, 
-																		lightBlockMemberNames);
-	int offsetIndex = 0;
-
-	for (int i = 0; i < MAX_LIGHTS; i++) {
+	// Lights are only initialized for the first shader. Later shaders
+	// share the buffer and must not reset lights that have been set.
+	bool firstShader = lightBlock.isSetUp() == false;
 
-		// Light color locations
-		lights[i].ambientColorLoc = uniformOffsets[offsetIndex++];
-		lights[i].diffuseColorLoc = uniformOffsets[offsetIndex++];
-		lights[i].specularColorLoc = uniformOffsets[offsetIndex++];
+	lightBlock.setUniformBlockForShader(shaderProgram, generalLightBlockName);
 
-		// Position and direction location
-		lights[i].positionOrDirectionLoc = uniformOffsets[offsetIndex++];
+	if (firstShader) {
 
-		// Spotlight locations
-		lights[i].spotDirectionLoc = uniformOffsets[offsetIndex++];
-		lights[i].isSpotLoc = uniformOffsets[offsetIndex++];
-		lights[i].spotCutoffCosLoc = uniformOffsets[offsetIndex++];
-		lights[i].spotExponentLoc = uniformOffsets[offsetIndex++];
+		for (int i = 0; i < MAX_LIGHTS; i++) {
 
-		//Attenuation factor locations
-		lights[i].constantLoc = uniformOffsets[offsetIndex++];
-		lights[i].linearLoc = uniformOffsets[offsetIndex++];
-		lights[i].quadraticLoc = uniformOffsets[offsetIndex++];
-
-		// Enabled location
-		lights[i].enabledLoc = uniformOffsets[offsetIndex++];
+			initilizeAttributes(i);
+		}
 
-		initilizeAttributes(i);
+		updateBuffer();
 	}
 
 } // end setUniformBlockForShader
 
 
-std::vector<std::string> SharedGeneralLighting::buildUniformBlockNameList()
+void SharedGeneralLighting::updateBuffer()
 {
-	static const int NUM_LIGHT_ATTRIBUTES = 12;
+	if (lightsChanged) {
 
-	// Get the indices of the uniform block variables in the shader
-	static const std::string names[NUM_LIGHT_ATTRIBUTES]
-		= { "ambientColor", "diffuseColor", "specularColor",
-		"positionOrDirection", "spotDirection",
-		"isSpot", "spotCutoffCos", "spotExponent",
-		"constant", "linear", "quadratic", "enabled" };
+		lightBlock.setData(lights);
 
-	std::vector<std::string> uniformBlockNames;
+		lightsChanged = false;
+	}
 
-	for (int lightNumber = 0; lightNumber < MAX_LIGHTS; lightNumber++) {
+} // end updateBuffer
 
-		// Get string representation of the int
-		std::string numberStrg = std::to_string(lightNumber);
 
-		std::string uniformNames[NUM_LIGHT_ATTRIBUTES];
+bool SharedGeneralLighting::copyLights(GeneralLight* destination)
+{
+	std::copy(lights, lights + MAX_LIGHTS, destination);
 
-		for (int i = 0; i < NUM_LIGHT_ATTRIBUTES; i++) {
+	bool changed = lightsChanged;
+	lightsChanged = false;
 
-			uniformBlockNames.push_back("lights[" + numberStrg + "]." + names[i]);
-		}
-
-	}
+	return changed;
 
-	return uniformBlockNames;
+} // end copyLights
 
-}
 
+void SharedGeneralLighting::setBufferData(const GeneralLight* sourceLights)
+{
+	lightBlock.setData(sourceLights);
 
+} // end setBufferData
 
 
 void SharedGeneralLighting::initilizeAttributes(GLint lightNumber)
@@ -106,63 +88,32 @@ void SharedGeneralLighting::initilizeAttributes(GLint lightNumber)
 
 void SharedGeneralLighting::setEnabled(lightSource light, bool on)
 {
-	// Bind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, lightBlock.getBuffer());
-
 	lights[light].enabled = on;
-
-	glBufferSubData(GL_UNIFORM_BUFFER, lights[light].enabledLoc, sizeof(bool), &lights[light].enabled);
-
-	// Unbind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	lightsChanged = true;
 }
 
 void SharedGeneralLighting::setAmbientColor(lightSource light, glm::vec4 color4)
 {
-	// Bind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, lightBlock.getBuffer());
-
 	lights[light].ambientColor = color4;
-	glBufferSubData(GL_UNIFORM_BUFFER, lights[light].ambientColorLoc, sizeof(glm::vec4), value_ptr(lights[light].ambientColor));
-
-	// Unbind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	lightsChanged = true;
 }
 
 void SharedGeneralLighting::setDiffuseColor(lightSource light, glm::vec4 color4)
 {
-	// Bind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, lightBlock.getBuffer());
-
 	lights[light].diffuseColor = color4;
-	glBufferSubData(GL_UNIFORM_BUFFER, lights[light].diffuseColorLoc, sizeof(glm::vec4), value_ptr(lights[light].diffuseColor));
-
-	// Unbind the buffer.
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	lightsChanged = true;
 }
 
 void SharedGeneralLighting::setSpecularColor(lightSource light, glm::vec4 color4)
 {
-	// Bind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, lightBlock.getBuffer());
-
 	lights[light].specularColor = color4;
-	glBufferSubData(GL_UNIFORM_BUFFER, lights[light].specularColorLoc, sizeof(glm::vec4), value_ptr(lights[light].specularColor));
-
-	// Unbind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	lightsChanged = true;
 }
 
 void SharedGeneralLighting::setPositionOrDirection(lightSource light, glm::vec4 positOrDirect)
 {
-	// Bind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, lightBlock.getBuffer());
-
 	lights[light].positionOrDirection = positOrDirect;
-	glBufferSubData(GL_UNIFORM_BUFFER, lights[light].positionOrDirectionLoc, sizeof(glm::vec4), value_ptr(lights[light].positionOrDirection));
-
-	// Unbind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	lightsChanged = true;
 }
 
 void SharedGeneralLighting::setAttenuationFactors(lightSource light, glm::vec3 factors)
@@ -175,81 +126,42 @@ void SharedGeneralLighting::setAttenuationFactors(lightSource light, glm::vec3 f
 
 void SharedGeneralLighting::setConstantAttenuation(lightSource light, float factor)
 {
-	// Bind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, lightBlock.getBuffer());
-
 	lights[light].constant = factor;
-	glBufferSubData(GL_UNIFORM_BUFFER, lights[light].constantLoc, sizeof(float), &lights[light].constant);
-
-	// Unbind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	lightsChanged = true;
 }
 
 void SharedGeneralLighting::setLinearAttenuation(lightSource light, float factor)
 {
-	// Bind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, lightBlock.getBuffer());
-
 	lights[light].linear = factor;
-	glBufferSubData(GL_UNIFORM_BUFFER, lights[light].linearLoc, sizeof(float), &lights[light].linear);
-
-	// Unbind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	lightsChanged = true;
 }
 
 void SharedGeneralLighting::setQuadraticAttenuation(lightSource light, float factor)
 {
-	// Bind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, lightBlock.getBuffer());
-
 	lights[light].quadratic = factor;
-	glBufferSubData(GL_UNIFORM_BUFFER, lights[light].quadraticLoc, sizeof(float), &lights[light].quadratic);
-
-	// Unbind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	lightsChanged = true;
 }
 
 void SharedGeneralLighting::setIsSpot(lightSource light, bool spotOn)
 {
-	glBindBuffer(GL_UNIFORM_BUFFER, lightBlock.getBuffer());
-
 	lights[light].isSpot = spotOn;
-
-	glBufferSubData(GL_UNIFORM_BUFFER, lights[light].isSpotLoc, sizeof(bool), &lights[light].isSpot);
-
-	// Unbind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	lightsChanged = true;
 }
 
 void SharedGeneralLighting::setSpotDirection(lightSource light, glm::vec3 spotDirect)
 {
-	glBindBuffer(GL_UNIFORM_BUFFER, lightBlock.getBuffer());
-
 	lights[light].spotDirection = glm::normalize(spotDirect);
-	glBufferSubData(GL_UNIFORM_BUFFER, lights[light].spotDirectionLoc, sizeof(glm::vec3), value_ptr(lights[light].spotDirection));
-
-	// Unbind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	lightsChanged = true;
 }
 
 void SharedGeneralLighting::setSpotCutoffCos(lightSource light, float cutoffCos)
 {
-	glBindBuffer(GL_UNIFORM_BUFFER, lightBlock.getBuffer());
-
 	lights[light].spotCutoffCos = cutoffCos;
-	glBufferSubData(GL_UNIFORM_BUFFER, lights[light].spotCutoffCosLoc, sizeof(float), &lights[light].spotCutoffCos);
-
-	// Unbind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	lightsChanged = true;
 }
 
 void SharedGeneralLighting::setSpotExponent(lightSource light, float spotEx)
 {
-	glBindBuffer(GL_UNIFORM_BUFFER, lightBlock.getBuffer());
-
 	lights[light].spotExponent = spotEx;
-	glBufferSubData(GL_UNIFORM_BUFFER, lights[light].spotExponentLoc, sizeof(float), &lights[light].spotExponent);
-
-	// Unbind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
-}
\ No newline at end of file
+	lightsChanged = true;
+}
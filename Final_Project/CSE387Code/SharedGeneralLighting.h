@@ -1,6 +1,8 @@
 #pragma once
 #include "SharedUniformBlock.h"
 
+#include <cstddef>
+
 #define generalLightBlockBindingPoint 22
 
 // Maximum number of lights
@@ -15,52 +17,65 @@ enum lightSource {
 };
 
 
-// Structure for holding the attributes of an individual light source
+// Structure for holding the attributes of an individual light source. Matches
+// an element of the lights array in the std140 LightBlock of the shader.
 struct GeneralLight {
 
-	GLint ambientColorLoc; 
 	vec4 ambientColor = vec4(0.0f, 0.0f, 0.0f, 1.0f);		// ambient color of the light
-	GLint diffuseColorLoc; 
 	vec4 diffuseColor = vec4(0.0f, 0.0f, 0.0f, 1.0f);		// diffuse color of the light
-	GLint specularColorLoc;
 	vec4 specularColor = vec4(0.0f, 0.0f, 0.0f, 1.0f);		// specular color of the light
 
 	// Either the position or direction
 	// if w = 0 then the light is directional
 	// if w = 1 then the light is positional
 	// direction is the negative of the direction the light is shinning
-	GLint positionOrDirectionLoc; 
 	glm::vec4 positionOrDirection = vec4(0.0f, 0.0f, 0.0f, 1.0f);
 
 	// spotlight attributes
-	GLint spotDirectionLoc; 
 	glm::vec3 spotDirection = vec3(0.0f, 0.0f, -1.0f);		// the direction the cone of light is shinning      
-	GLint isSpotLoc; 
-	bool isSpot = false;					// true if the light is a spotlight
-	GLint spotCutoffCosLoc; 
+	GLint isSpot = false;					// true if the light is a spotlight. GLSL bools are four bytes.
 	float spotCutoffCos = glm::radians(180.0f);	// Cosine of the spot cutoff angle
-	GLint spotExponentLoc; 
 	float spotExponent = 1.0f;				// spot exponent for falloff calculation
 
 	// attenuation coefficients
-	GLint constantLoc; 
 	float constant = 1.0f;
-	GLint linearLoc; 
 	float linear = 0.0f;
-	GLint quadraticLoc; 
 	float quadratic = 0.0f;
 
-	GLint enabledLoc; 
-	bool enabled = false;			// true if light is "on"
+	GLint enabled = false;			// true if light is "on"
+
+	float padding[2];				// Array elements are padded to a multiple of 16 bytes
 };
 
+static_assert(offsetof(GeneralLight, positionOrDirection) == 48, "std140 offset of positionOrDirection");
+static_assert(offsetof(GeneralLight, spotDirection) == 64, "std140 offset of spotDirection");
+static_assert(offsetof(GeneralLight, isSpot) == 76, "std140 offset of isSpot");
+static_assert(offsetof(GeneralLight, spotCutoffCos) == 80, "std140 offset of spotCutoffCos");
+static_assert(offsetof(GeneralLight, constant) == 88, "std140 offset of constant");
+static_assert(offsetof(GeneralLight, enabled) == 100, "std140 offset of enabled");
+static_assert(sizeof(GeneralLight) == 112, "std140 array stride of lights");
+
 class SharedGeneralLighting
 {
 public:
 	
 	static void setUniformBlockForShader(GLuint shaderProgram);
 
-	static bool getEnabled(lightSource light) { return lights[light].enabled; }
+	// Copies all of the lights into the buffer if any of them changed since
+	// the last update. Call once per frame before rendering.
+	static void updateBuffer();
+
+	// Copies all of the lights so they can be rendered on another thread.
+	// Returns true if any of them changed since the last copy or update.
+	static bool copyLights(GeneralLight* destination);
+
+	// Copies lights that were copied with copyLights into the buffer. Call
+	// on the thread that owns the OpenGL context.
+	static void setBufferData(const GeneralLight* sourceLights);
+
+	static const GeneralLight* getLights() { return lights; }
+
+	static bool getEnabled(lightSource light) { return lights[light].enabled != 0; }
 	static void setEnabled(lightSource light, bool on);
 
 	static glm::vec4 getAmbientColor(lightSource light) { return lights[light].ambientColor; }
@@ -86,7 +101,7 @@ public:
 	static float getQuadraticAttenuation(lightSource light) { return lights[light].quadratic; }
 	static void setQuadraticAttenuation(lightSource light, float factor);
 
-	static bool getIsSpot(lightSource light) { return lights[light].isSpot; }
+	static bool getIsSpot(lightSource light) { return lights[light].isSpot != 0; }
 	static void setIsSpot(lightSource light, bool spotOn);
 
 	static glm::vec3 getSpotDirection(lightSource light) { return lights[light].spotDirection; }
@@ -100,12 +115,13 @@ public:
 
 protected:
 
-	static std::vector<std::string> buildUniformBlockNameList();
-
 	static void initilizeAttributes(GLint lightNumber);
 
 	static GeneralLight lights[MAX_LIGHTS];
 
+	// True if the lights changed since the buffer was last updated
+	static bool lightsChanged;
+
 	static SharedUniformBlock lightBlock;
 
 	const static std::string generalLightBlockName;
@@ -1,87 +1,67 @@
 #include "SharedMaterialProperties.h"
+#include "EngineCounters.h"
+#include "GLStateCache.h"
 
-GLuint SharedMaterialProperties::ambientMatLocation; // Byte offset of the projection matrix
+GLuint SharedMaterialProperties::boundTextures[4] = { 0, 0, 0, 0 };
 
-GLuint SharedMaterialProperties::diffuseMatLocation; // Byte offset of the viewing matrix
-
-GLuint SharedMaterialProperties::specularMatLocation; // Byte offset of the modeling matrix
-
-GLuint SharedMaterialProperties::emmissiveMatLocation; // Byte offset of the modeling matrix to transform normal vectors
-
-GLuint SharedMaterialProperties::specularExpLocation;  // Byte offset of the eye position
-
-GLuint SharedMaterialProperties::diffuseTextureEnabledLocation;
-
-GLuint SharedMaterialProperties::specularTextureEnabledLocation;
-
-GLuint SharedMaterialProperties::textureModeLoction;
-
-//GLuint SharedMaterialProperties::normalMapEnabledLocation;
-
-//GLuint SharedMaterialProperties::bumpMapEnabledLocation;
-// 
-SharedUniformBlock SharedMaterialProperties::materialBlock(materialBlockBindingPoint);
+SharedUniformBlock SharedMaterialProperties::materialBlock(materialBlockBindingPoint, sizeof(MaterialBlock));
 
 const std::string SharedMaterialProperties::materialBlockName = "MaterialBlock";
 
 
 void SharedMaterialProperties::setUniformBlockForShader(GLuint shaderProgram)
 {
-	std::vector<std::string> materialMemberNames = { "object.ambientMat", "object.diffuseMat", "object.specularMat",
-										   "object.emmissiveMat", "object.specularExp", 
-										   "object.diffuseTextureEnabled" , "object.specularTextureEnabled" ,"object.textureMode"
-											/*,"object.normalMapEnabled", "object.bumpMapEnabled"*/ };
-
-	std::vector<GLint> uniformOffsets = materialBlock.setUniformBlockForShader(shaderProgram, materialBlockName, materialMemberNames);
-
-	// Save locations
-	ambientMatLocation = uniformOffsets[0];
-	diffuseMatLocation = uniformOffsets[1];
-	specularMatLocation = uniformOffsets[2];
-	emmissiveMatLocation = uniformOffsets[3];
-	specularExpLocation = uniformOffsets[4];
-	diffuseTextureEnabledLocation = uniformOffsets[5];
-	specularTextureEnabledLocation = uniformOffsets[6];
-	textureModeLoction = uniformOffsets[7];
-	//normalMapEnabledLocation = uniformOffsets[8];
-	//bumpMapEnabledLocation = uniformOffsets[9];
+	materialBlock.setUniformBlockForShader(shaderProgram, materialBlockName);
+
+	// Texture units used by each sampler do not change
+	glProgramUniform1i(shaderProgram, diffuseSamplerLocation, 0);
+	glProgramUniform1i(shaderProgram, specularSamplerLocation, 1);
+	glProgramUniform1i(shaderProgram, diffuseArraySamplerLocation, 2);
+	glProgramUniform1i(shaderProgram, specularArraySamplerLocation, 3);
 	
 } // end setUniformBlockForShader
 
 
-void SharedMaterialProperties::setShaderMaterialProperties(Material* material)
+void SharedMaterialProperties::setShaderMaterialProperties(const Material* material)
 {
 	if (materialBlock.getSize() > 0) {
 
-		// Bind the buffer. 
-		glBindBuffer(GL_UNIFORM_BUFFER, materialBlock.getBuffer());
+		MaterialBlock materialData;
+
+		materialData.ambientMat = material->ambientMat;
+		materialData.diffuseMat = material->diffuseMat;
+		materialData.specularMat = material->specularMat;
+		materialData.emmissiveMat = material->emissiveMat;
+		materialData.specularExp = material->specularExpMat;
+		materialData.textureMode = material->textureMode;
+		materialData.diffuseTextureEnabled = material->diffuseTextureEnabled;
+		materialData.specularTextureEnabled = material->specularTextureEnabled;
+		materialData.diffuseLayer = material->diffuseLayer;
+		materialData.specularLayer = material->specularLayer;
 
 		// Set the Material*properties in the shader.
-		glBufferSubData(GL_UNIFORM_BUFFER, ambientMatLocation, sizeof(glm::vec4), glm::value_ptr(material->ambientMat));
-		glBufferSubData(GL_UNIFORM_BUFFER, diffuseMatLocation, sizeof(glm::vec4), glm::value_ptr(material->diffuseMat));
-		glBufferSubData(GL_UNIFORM_BUFFER, specularMatLocation, sizeof(glm::vec4), glm::value_ptr(material->specularMat));
-		glBufferSubData(GL_UNIFORM_BUFFER, emmissiveMatLocation, sizeof(glm::vec4), glm::value_ptr(material->emissiveMat));
-		glBufferSubData(GL_UNIFORM_BUFFER, specularExpLocation, sizeof(float), &material->specularExpMat);
-		glBufferSubData(GL_UNIFORM_BUFFER, diffuseTextureEnabledLocation, sizeof(bool), &material->diffuseTextureEnabled);
-		glBufferSubData(GL_UNIFORM_BUFFER, specularTextureEnabledLocation, sizeof(bool), &material->specularTextureEnabled);
-		glBufferSubData(GL_UNIFORM_BUFFER, textureModeLoction, sizeof(int), &material->textureMode);
-		//glBufferSubData(GL_UNIFORM_BUFFER, normalMapEnabledLocation, sizeof(bool), &material->normalMapEnabled);
-		//glBufferSubData(GL_UNIFORM_BUFFER, bumpMapEnabledLocation, sizeof(bool), &material->bumpMapEnabled);
-		
-
-		// Unbind the buffer. 
-		glBindBuffer(GL_UNIFORM_BUFFER, 0);
-
-		// Activate and set texture units.
+		materialBlock.setData(&materialData);
+		EngineCounters::add(EngineCounters::MATERIAL_UPLOADS);
+
+		// Activate and set texture units. Textures that are already
+		// bound are not bound again.
 		if (material->diffuseTextureEnabled == true) {
-			glUniform1i(diffuseSamplerLocation, 0);
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, material->diffuseTextureObject);
+
+			if (material->diffuseTextureArray != nullptr) {
+				bindTexture(2, GL_TEXTURE_2D_ARRAY, material->diffuseTextureArray->getTextureObject());
+			}
+			else {
+				bindTexture(0, GL_TEXTURE_2D, material->diffuseTextureObject);
+			}
 		}
 		if (material->specularTextureEnabled == true) {
-			glUniform1i(specularSamplerLocation, 1);
-			glActiveTexture(GL_TEXTURE1);
-			glBindTexture(GL_TEXTURE_2D, material->specularTextureObject);
+
+			if (material->specularTextureArray != nullptr) {
+				bindTexture(3, GL_TEXTURE_2D_ARRAY, material->specularTextureArray->getTextureObject());
+			}
+			else {
+				bindTexture(1, GL_TEXTURE_2D, material->specularTextureObject);
+			}
 		}
 		//if (material->normalMapEnabled == true) {
 		//	glUniform1i(normalMapSamplerLocation, 2);
@@ -100,15 +80,11 @@ void SharedMaterialProperties::setShaderMaterialProperties(Material* material)
 
 void SharedMaterialProperties::cleanUpMaterial(Material*material)
 {
-	if (material->diffuseTextureEnabled == true) {
-		glUniform1i(diffuseSamplerLocation, 0);
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, 0);
+	if (material->diffuseTextureEnabled == true && material->diffuseTextureArray == nullptr) {
+		bindTexture(0, GL_TEXTURE_2D, 0);
 	}
-	if (material->specularTextureEnabled == true) {
-		glUniform1i(specularSamplerLocation, 1);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, 0);
+	if (material->specularTextureEnabled == true && material->specularTextureArray == nullptr) {
+		bindTexture(1, GL_TEXTURE_2D, 0);
 	}
 	//if (material->normalMapEnabled == true) {
 	//	glUniform1i(normalMapSamplerLocation, 2);
@@ -120,4 +96,49 @@ void SharedMaterialProperties::cleanUpMaterial(Material*material)
 	//	glActiveTexture(GL_TEXTURE3);
 	//	glBindTexture(GL_TEXTURE_2D, 0);
 	//}
-}
+} // end cleanUpMaterial
+
+
+void SharedMaterialProperties::unbindTextures()
+{
+	// Unbind unconditionally. Texture loading and streaming bind textures
+	// without going through bindTexture. GLStateCache skips units that are
+	// already unbound.
+	const GLenum targets[4] = { GL_TEXTURE_2D, GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_2D_ARRAY };
+
+	for (GLuint unit = 0; unit < 4; unit++) {
+
+		GLStateCache::activeTexture(GL_TEXTURE0 + unit);
+		GLStateCache::bindTexture(targets[unit], 0);
+		boundTextures[unit] = 0;
+	}
+
+} // end unbindTextures
+
+
+GLuint SharedMaterialProperties::getTextureSortKey(const Material* material)
+{
+	if (material->diffuseTextureEnabled == false) {
+		return 0;
+	}
+
+	if (material->diffuseTextureArray != nullptr) {
+		return material->diffuseTextureArray->getTextureObject();
+	}
+
+	return material->diffuseTextureObject;
+
+} // end getTextureSortKey
+
+
+void SharedMaterialProperties::bindTexture(GLuint unit, GLenum target, GLuint textureObject)
+{
+	if (boundTextures[unit] != textureObject) {
+
+		GLStateCache::activeTexture(GL_TEXTURE0 + unit);
+		GLStateCache::bindTexture(target, textureObject);
+
+		boundTextures[unit] = textureObject;
+	}
+
+} // end bindTexture
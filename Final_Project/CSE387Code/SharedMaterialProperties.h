@@ -1,16 +1,21 @@
 #pragma once
 
 #include "MathLibsConstsFuncs.h"
+#include <cstddef>
 #include <vector>
 
 // Static helper classes to support uniform blocks
 #include "SharedUniformBlock.h"
+#include "Texture.h"
+#include "TextureArray.h"
 
 #define materialBlockBindingPoint 12
 #define diffuseSamplerLocation 100
 #define specularSamplerLocation 101
 //#define normalMapSamplerLocation 102
 //#define bumpMapSamplerLocation 103
+#define diffuseArraySamplerLocation 104
+#define specularArraySamplerLocation 105
 
 struct Material
 {
@@ -101,6 +106,91 @@ struct Material
 
 	} // end setSpecularTexture
 
+	void setDiffuseTexture(Texture* texture)
+	{
+		if (texture != nullptr) {
+
+			this->diffuseTexture = texture;
+			setDiffuseTexture(texture->getTextureObject());
+		}
+
+	} // end setDiffuseTexture
+
+	void setSpecularTexture(Texture* texture)
+	{
+		if (texture != nullptr) {
+
+			this->specularTexture = texture;
+			setSpecularTexture(texture->getTextureObject());
+		}
+
+	} // end setSpecularTexture
+
+	void setDiffuseTexture(const TextureArrayLayer& textureLayer)
+	{
+		if (textureLayer.textureArray != nullptr) {
+
+			this->diffuseTextureArray = textureLayer.textureArray;
+			this->diffuseLayer = textureLayer.layer;
+			diffuseTextureEnabled = true;
+			setTextureMode(REPLACE_AMBIENT_DIFFUSE);
+		}
+
+	} // end setDiffuseTexture
+
+	void setSpecularTexture(const TextureArrayLayer& textureLayer)
+	{
+		if (textureLayer.textureArray != nullptr) {
+
+			this->specularTextureArray = textureLayer.textureArray;
+			this->specularLayer = textureLayer.layer;
+			specularTextureEnabled = true;
+			setTextureMode(REPLACE_AMBIENT_DIFFUSE);
+		}
+
+	} // end setSpecularTexture
+
+	// Called when the material is used for rendering so the textures
+	// can stream in the mip levels needed for the on-screen size.
+	void requestTextureDetail(float screenSize) const
+	{
+		if (diffuseTexture != nullptr) {
+			diffuseTexture->requestDetail(screenSize);
+		}
+		if (specularTexture != nullptr) {
+			specularTexture->requestDetail(screenSize);
+		}
+
+	} // end requestTextureDetail
+
+	// Takes another reference to the textures, for a copy of a
+	// material that releases its textures separately.
+	void retainTextures()
+	{
+		if (diffuseTexture != nullptr) {
+			diffuseTexture->retain();
+		}
+		if (specularTexture != nullptr) {
+			specularTexture->retain();
+		}
+
+	} // end retainTextures
+
+	// Gives up the references to the textures that were obtained
+	// with Texture::GetTexture. Call before deleting the material.
+	void releaseTextures()
+	{
+		if (diffuseTexture != nullptr) {
+			diffuseTexture->release();
+			diffuseTexture = nullptr;
+		}
+		if (specularTexture != nullptr) {
+			specularTexture->release();
+			specularTexture = nullptr;
+		}
+
+	} // end releaseTextures
+
 	//void setNormalMap(GLint textureObject)
 	//{
 	//	this->normalMapObject = textureObject;
@@ -136,6 +226,19 @@ struct Material
 	GLuint specularTextureObject;
 	bool specularTextureEnabled;
 
+	// Textures that were obtained with Texture::GetTexture. Null if the
+	// texture object was set directly.
+	Texture* diffuseTexture = nullptr;
+	Texture* specularTexture = nullptr;
+
+	// Texture arrays and layers used instead of individual texture
+	// objects. Layers are negative if arrays are not used.
+	TextureArray* diffuseTextureArray = nullptr;
+	int diffuseLayer = -1;
+
+	TextureArray* specularTextureArray = nullptr;
+	int specularLayer = -1;
+
 	//GLuint normalMapObject;
 	//bool normalMapEnabled;
 
@@ -144,6 +247,28 @@ struct Material
 };
 
 
+// Contents of MaterialBlock with the std140 layout. GLSL bools are four bytes.
+struct MaterialBlock
+{
+	glm::vec4 ambientMat;
+	glm::vec4 diffuseMat;
+	glm::vec4 specularMat;
+	glm::vec4 emmissiveMat;
+	float specularExp;
+	GLint textureMode;
+	GLint diffuseTextureEnabled;
+	GLint specularTextureEnabled;
+	GLint diffuseLayer;
+	GLint specularLayer;
+	float padding[2]; // Structs are padded to a multiple of 16 bytes
+};
+
+static_assert(offsetof(MaterialBlock, specularExp) == 64, "std140 offset of specularExp");
+static_assert(offsetof(MaterialBlock, textureMode) == 68, "std140 offset of textureMode");
+static_assert(offsetof(MaterialBlock, diffuseLayer) == 80, "std140 offset of diffuseLayer");
+static_assert(sizeof(MaterialBlock) == 96, "std140 size of MaterialBlock");
+
+
 class SharedMaterialProperties
 {
 public:
@@ -154,32 +279,28 @@ public:
 
 	// Call the set the Material*properties in the shader before 
 	// rendering the object.
-	static void setShaderMaterialProperties(Material*material);
+	static void setShaderMaterialProperties(const Material* material);
 
-	// Cleans Material*properties after rendering an object.
+	// Cleans Material*properties after rendering an object. Texture
+	// arrays are left bound since they are shared by many materials.
 	static void cleanUpMaterial(Material*material);
 
-protected:
-
-	static GLuint ambientMatLocation; // Byte offset of the projection matrix
-
-	static GLuint diffuseMatLocation; // Byte offset of the viewing matrix
-
-	static GLuint specularMatLocation; // Byte offset of the modeling matrix
-
-	static GLuint emmissiveMatLocation; // Byte offset of the modeling matrix to transform normal vectors
+	// Unbinds all textures including texture arrays. Call after rendering
+	// a sequence of objects without cleaning up each material. Textures
+	// must be unbound before textures are loaded or streamed.
+	static void unbindTextures();
 
-	static GLuint specularExpLocation;  // Byte offset of the eye position
+	// Gets a value that is the same for materials that can be rendered
+	// one after another without binding a different texture.
+	static GLuint getTextureSortKey(const Material* material);
 
-	static GLuint diffuseTextureEnabledLocation;
-
-	static GLuint specularTextureEnabledLocation;
-
-	//static GLuint normalMapEnabledLocation;
+protected:
 
-	//static GLuint bumpMapEnabledLocation;
+	// Binds a texture to a texture unit if it is not already bound.
+	static void bindTexture(GLuint unit, GLenum target, GLuint textureObject);
 
-	static GLuint textureModeLoction;
+	// Texture objects presently bound to texture units 0 through 3.
+	static GLuint boundTextures[4];
 
 	static SharedUniformBlock materialBlock;
 
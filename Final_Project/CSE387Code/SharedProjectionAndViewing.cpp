@@ -1,73 +1,111 @@
 #include "SharedProjectionAndViewing.h"
 
-GLuint SharedProjectionAndViewing::projectionLocation; // Byte offset of the projection matrix
-glm::mat4 SharedProjectionAndViewing::projectionMatrix; // Current projection matrix that is held in the buffer
+TransformBlock SharedProjectionAndViewing::transformData; // Current matrices that are held in the buffer
 
-GLuint SharedProjectionAndViewing::viewLocation; // Byte offset of the viewing matrix
-glm::mat4 SharedProjectionAndViewing::viewMatrix; // Current viewing matrix that is held in the buffer
+std::vector<CameraBlock> SharedProjectionAndViewing::cameraData(1); // Matrices of each camera slot
 
-GLuint SharedProjectionAndViewing::modelLocation; // Byte offset of the modeling matrix
-glm::mat4 SharedProjectionAndViewing::modelMatrix; // Current modeling matrix that is held in the buffer
+std::vector<bool> SharedProjectionAndViewing::cameraSlotUsed(1, false); // True for slots that belong to a camera
 
-GLuint SharedProjectionAndViewing::normalModelLocation; // Byte offset of the modeling matrix to transform normal vectors
+int SharedProjectionAndViewing::currentCameraSlot = 0; // Slot that is bound for rendering
 
-GLuint SharedProjectionAndViewing::eyePositionLocation;  // Byte offset of the eye position
-
-SharedUniformBlock SharedProjectionAndViewing::projViewBlock(projectionViewBlockBindingPoint);
-SharedUniformBlock SharedProjectionAndViewing::worldEyeBlock(worldEyeBlockBindingPoint);
+SharedUniformBlock SharedProjectionAndViewing::projViewBlock(projectionViewBlockBindingPoint, sizeof(TransformBlock));
+SharedUniformBlock SharedProjectionAndViewing::cameraBlock(cameraBlockBindingPoint, sizeof(CameraBlock));
 
 const std::string SharedProjectionAndViewing::transformBlockName = "transformBlock";
 
-const std::string SharedProjectionAndViewing::eyeBlockName = "worldEyeBlock";
+const std::string SharedProjectionAndViewing::cameraBlockName = "cameraBlock";
 
 
 void SharedProjectionAndViewing::setUniformBlockForShader(GLuint shaderProgram)
 {
-	std::vector<std::string> projViewMemberNames = { "modelMatrix", "normalModelMatrix", "viewingMatrix", "projectionMatrix"};
-
-	std::vector<GLint> uniformOffsets = projViewBlock.setUniformBlockForShader(shaderProgram, transformBlockName, projViewMemberNames);
+	projViewBlock.setUniformBlockForShader(shaderProgram, transformBlockName);
 
-	// Save locations
-	modelLocation = uniformOffsets[0];
-	normalModelLocation = uniformOffsets[1];
-	viewLocation = uniformOffsets[2];
-	projectionLocation = uniformOffsets[3];
+	bool firstShader = cameraBlock.isSetUp() == false;
 
-	uniformOffsets.clear();
-	std::vector<std::string> worldEyeMemberNames = { "worldEyePosition" };
+	cameraBlock.setUniformBlockForShader(shaderProgram, cameraBlockName);
 
-	uniformOffsets = worldEyeBlock.setUniformBlockForShader(shaderProgram, eyeBlockName, worldEyeMemberNames);
+	// Cameras may have been added before the buffer was created
+	if (firstShader) {
 
-	// Save location
-	eyePositionLocation = uniformOffsets[0];
+		setAllCameras();
+		useCamera(currentCameraSlot);
+	}
 
 } // end setUniformBlockForShader
 
 
-void SharedProjectionAndViewing::setViewMatrix( glm::mat4 viewMatrix)
+int SharedProjectionAndViewing::addCamera()
 {
-	if (projViewBlock.getSize() > 0  ) {
+	// Reuse the slot of a camera that was removed
+	for (size_t i = 0; i < cameraSlotUsed.size(); i++) {
+
+		if (cameraSlotUsed[i] == false) {
 
-		// Bind the buffer. 
-		glBindBuffer(GL_UNIFORM_BUFFER, projViewBlock.getBuffer());
+			cameraSlotUsed[i] = true;
+			return static_cast<int>(i);
+		}
+	}
+
+	cameraSlotUsed.push_back(true);
+	cameraData.push_back(CameraBlock());
 
-		SharedProjectionAndViewing::viewMatrix = viewMatrix;
+	// Data in a reallocated buffer must be set again
+	if (cameraBlock.setSlotCount(static_cast<int>(cameraData.size()))) {
 
-		glBufferSubData(GL_UNIFORM_BUFFER, viewLocation, sizeof(glm::mat4), glm::value_ptr(viewMatrix));
+		setAllCameras();
+		useCamera(currentCameraSlot);
 	}
 
-	if (worldEyeBlock.getSize() > 0 ) {
+	return static_cast<int>(cameraData.size()) - 1;
 
-		// Bind the buffer.
-		glBindBuffer(GL_UNIFORM_BUFFER, worldEyeBlock.getBuffer());
+} // end addCamera
 
-		glm::vec3 viewPoint = vec3(glm::inverse(viewMatrix)[3]);
 
-		glBufferSubData(GL_UNIFORM_BUFFER, eyePositionLocation, sizeof(glm::vec3), glm::value_ptr(viewPoint));
+void SharedProjectionAndViewing::removeCamera(int cameraSlot)
+{
+	if (cameraSlot >= 0 && cameraSlot < static_cast<int>(cameraSlotUsed.size())) {
+
+		cameraSlotUsed[cameraSlot] = false;
 	}
 
-	// Unbind the buffer. 
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+} // end removeCamera
+
+
+void SharedProjectionAndViewing::setCamera(int cameraSlot, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix)
+{
+	CameraBlock& camera = cameraData[cameraSlot];
+
+	camera.viewingMatrix = viewMatrix;
+	camera.projectionMatrix = projectionMatrix;
+	camera.worldEyePosition = vec3(glm::inverse(viewMatrix)[3]);
+
+	cameraBlock.setSlotData(cameraSlot, &camera);
+
+} // end setCamera
+
+
+void SharedProjectionAndViewing::useCamera(int cameraSlot)
+{
+	currentCameraSlot = cameraSlot;
+
+	cameraBlock.bindSlot(cameraSlot);
+
+} // end useCamera
+
+
+void SharedProjectionAndViewing::setAllCameras()
+{
+	for (size_t i = 0; i < cameraData.size(); i++) {
+
+		cameraBlock.setSlotData(static_cast<int>(i), &cameraData[i]);
+	}
+
+} // end setAllCameras
+
+
+void SharedProjectionAndViewing::setViewMatrix( glm::mat4 viewMatrix)
+{
+	setCamera(currentCameraSlot, viewMatrix, cameraData[currentCameraSlot].projectionMatrix);
 
 } // end setViewMatrix
 
@@ -75,26 +113,14 @@ void SharedProjectionAndViewing::setViewMatrix( glm::mat4 viewMatrix)
 // Accessor for the current viewing matrix
 glm::mat4 SharedProjectionAndViewing::getViewMatrix()
 {
-	return viewMatrix;
+	return cameraData[currentCameraSlot].viewingMatrix;
 
 } // end getViewMatrix
 
 
 void SharedProjectionAndViewing::setProjectionMatrix( glm::mat4 projectionMatrix)
 {
-
-	if (projViewBlock.getSize()  > 0  ) {
-	
-		// Bind the buffer. 
-		glBindBuffer(GL_UNIFORM_BUFFER, projViewBlock.getBuffer());
-
-		SharedProjectionAndViewing::projectionMatrix = projectionMatrix;
-
-		glBufferSubData(GL_UNIFORM_BUFFER, projectionLocation, sizeof(glm::mat4), glm::value_ptr(projectionMatrix));
-
-		// Unbind the buffer. 
-		glBindBuffer(GL_UNIFORM_BUFFER, 0);
-	}
+	setCamera(currentCameraSlot, cameraData[currentCameraSlot].viewingMatrix, projectionMatrix);
 
 } // end setProjectionMatrix
 
@@ -102,36 +128,32 @@ void SharedProjectionAndViewing::setProjectionMatrix( glm::mat4 projectionMatrix
 // Accessor for the current projection matrix
 glm::mat4 SharedProjectionAndViewing::getProjectionMatrix()
 {
-	return projectionMatrix;
+	return cameraData[currentCameraSlot].projectionMatrix;
 
 } // end getProjectionMatrix
 
 
-void SharedProjectionAndViewing::setModelingMatrix(glm::mat4 modelingMatrix)
+void SharedProjectionAndViewing::setModelingMatrix(glm::mat4 modelingMatrix, float fade)
 {
-	if (projViewBlock.getSize() > 0) {
+	transformData.modelMatrix = modelingMatrix;
+	transformData.fade = fade;
 
-		// Bind the buffer. 
-		glBindBuffer(GL_UNIFORM_BUFFER, projViewBlock.getBuffer() );
+	glm::mat3 normalModelMatrix = glm::mat3(glm::transpose(glm::inverse(modelingMatrix)));
 
-		SharedProjectionAndViewing::modelMatrix = modelingMatrix;
+	for (int i = 0; i < 3; i++) {
 
-		glBufferSubData(GL_UNIFORM_BUFFER, modelLocation, sizeof(glm::mat4), glm::value_ptr(modelMatrix));
-
-		glBufferSubData(GL_UNIFORM_BUFFER, normalModelLocation, sizeof(glm::mat3), 
-			glm::value_ptr(mat3(glm::transpose(glm::inverse(modelMatrix)))));
-
-		// Unbind the buffer. 
-		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		transformData.normalModelMatrix[i] = glm::vec4(normalModelMatrix[i], 0.0f);
 	}
 
+	// The whole block is the modeling and normal matrices and the fade
+	projViewBlock.setData(&transformData);
+
 } // end setModelingMatrix
 
 
 // Accessor for the current modeling matrix
 glm::mat4 SharedProjectionAndViewing::getModelingMatrix()
 {
-	return modelMatrix;
+	return transformData.modelMatrix;
 
 } // end getModelingMatrix
-
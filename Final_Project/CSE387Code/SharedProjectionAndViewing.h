@@ -3,8 +3,10 @@
 
 #include "SharedUniformBlock.h"
 
+#include <cstddef>
+
 #define projectionViewBlockBindingPoint 2
-#define worldEyeBlockBindingPoint 3
+#define cameraBlockBindingPoint 3
 
 /**
 
@@ -12,80 +14,130 @@ static class that supports working with the two uniform blocks shown below.
 
 setUniformBlockForShader should be called for every shader program that includes
 the uniform block below. This will create a buffers for each uniform block
-and bind the buffers and uniform blocks together through the binding points.
-Binding points for the two blocks and the associated buffers are defined above.
+and bind the buffers to the binding points. The blocks use the std140 layout
+and are bound to the binding points defined above in the shaders. The
+TransformBlock and CameraBlock structs below must match them.
 
-Adding a #include for this header file makes the functionality avaible through
-the class name.
+The transformBlock holds the modeling transformation of the object being rendered.
+The cameraBlock holds the viewing and projection transformations of a camera. Each
+camera has its own slot in the camera buffer that is only written when the camera
+or its viewport changes. The slot of the camera being rendered is bound with
+useCamera.
 
-layout(shared) uniform transformBlock
+layout(std140, binding = 2) uniform transformBlock
 {
 	mat4 modelMatrix;
 	mat3 normalModelMatrix;
-	mat4 viewingMatrix;
-	mat4 projectionMatrix;
+	float fade;
 };
 
-layout (shared) uniform worldEyeBlock
+layout(std140, binding = 3) uniform cameraBlock
 {
+	mat4 viewingMatrix;
+	mat4 projectionMatrix;
 	vec3 worldEyePosition;
 };
 
 */
 
+// Contents of transformBlock with the std140 layout
+struct TransformBlock {
+
+	glm::mat4 modelMatrix;
+
+	glm::vec4 normalModelMatrix[3]; // Columns of a mat3 are padded to a vec4 in std140
+
+	float fade = 1.0f; // Share of the pixels of the object that are drawn. Less than one while it cross-fades with its impostor.
+
+	float padding[3]; // Blocks are padded to a multiple of 16 bytes
+};
+
+static_assert(offsetof(TransformBlock, modelMatrix) == 0, "std140 offset of modelMatrix");
+static_assert(offsetof(TransformBlock, normalModelMatrix) == 64, "std140 offset of normalModelMatrix");
+static_assert(offsetof(TransformBlock, fade) == 112, "std140 offset of fade");
+static_assert(sizeof(TransformBlock) == 128, "std140 size of transformBlock");
+
+// Contents of cameraBlock with the std140 layout
+struct CameraBlock {
+
+	glm::mat4 viewingMatrix;
+
+	glm::mat4 projectionMatrix;
+
+	glm::vec3 worldEyePosition;
+
+	float padding; // Blocks are padded to a multiple of 16 bytes
+};
+
+static_assert(offsetof(CameraBlock, projectionMatrix) == 64, "std140 offset of projectionMatrix");
+static_assert(offsetof(CameraBlock, worldEyePosition) == 128, "std140 offset of worldEyePosition");
+static_assert(sizeof(CameraBlock) == 144, "std140 size of cameraBlock");
+
 class SharedProjectionAndViewing
 {
 	public:
 
 	// Should be called for each shader program that includes the
-	// projectionViewBlock and worldEyeBlock uniform blocks.
+	// transformBlock and cameraBlock uniform blocks.
 	static void setUniformBlockForShader(GLuint shaderProgram);
 
-	// Accessor for the current projection matrix
+	// Reserves a slot in the camera buffer for a camera. Returns
+	// the slot.
+	static int addCamera();
+
+	// Frees the slot of a camera that is no longer used.
+	static void removeCamera(int cameraSlot);
+
+	// Sets the viewing and projection matrices of a camera in its 
+	// slot of the buffer. Also sets the world eye position.
+	static void setCamera(int cameraSlot, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+
+	// Binds the slot of a camera so that it is used for rendering.
+	static void useCamera(int cameraSlot);
+
+	// Accessor for the projection matrix of the camera in use
 	static glm::mat4 getProjectionMatrix();
 
-	// Mutator for the projection matrix. Sets the projection
-	// matrix in the buffer.
+	// Mutator for the projection matrix of the camera in use. Sets
+	// the projection matrix in the buffer.
 	static void setProjectionMatrix(glm::mat4 projectionMatrix);
 
-	// Accessor for the current viewing matrix
+	// Accessor for the viewing matrix of the camera in use
 	static glm::mat4 getViewMatrix();
 
-	// Mutator for the viewing matrix. Sets the viewing
-	// matrix in the buffer. Also sets the world eye position
+	// Mutator for the viewing matrix of the camera in use. Sets the 
+	// viewing matrix in the buffer. Also sets the world eye position
 	static void setViewMatrix(glm::mat4 viewMatrix);
 
 	// Accessor for the current modeling matrix
 	static glm::mat4 getModelingMatrix();
 
 	// Mutator for the modeling matrix. Sets the modeling transformation
-	// for both the vertex positions and normals in the buffer. 
-	static void setModelingMatrix(glm::mat4 modelingMatrix);
+	// for both the vertex positions and normals in the buffer. Objects
+	// with a fade less than one leave out a dithered share of their pixels.
+	static void setModelingMatrix(glm::mat4 modelingMatrix, float fade = 1.0f);
 
 	protected:
 
-	static GLuint projectionLocation; // Byte offset of the projection matrix
-	static glm::mat4 projectionMatrix; // Current projection matrix that is held in the buffer
+	// Copies the data of every camera into the buffer
+	static void setAllCameras();
 
-	static GLuint viewLocation; // Byte offset of the viewing matrix
-	static glm::mat4 viewMatrix; // Current viewing matrix that is held in the buffer
+	static TransformBlock transformData; // Current matrices that are held in the buffer
 
-	static GLuint modelLocation; // Byte offset of the modeling matrix
-	static glm::mat4 modelMatrix; // Current modeling matrix that is held in the buffer
+	static std::vector<CameraBlock> cameraData; // Matrices of each camera slot
 
-	static GLuint normalModelLocation; // Byte offset of the modeling matrix to transform normal vectors
+	static std::vector<bool> cameraSlotUsed; // True for slots that belong to a camera
 
-	static GLuint eyePositionLocation;  // Byte offset of the eye position
+	static int currentCameraSlot; // Slot that is bound for rendering
 
 	static SharedUniformBlock projViewBlock;
 	
-	static SharedUniformBlock worldEyeBlock;
+	static SharedUniformBlock cameraBlock;
 
 	static const std::string transformBlockName;
 
-	static const std::string eyeBlockName;
+	static const std::string cameraBlockName;
 
 }; // end SharedProjectionAndViewing class
 
 #endif // _SHARED_PROJECTION_AND_VIEWING_H_
-
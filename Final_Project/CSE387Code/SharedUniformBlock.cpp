@@ -1,4 +1,8 @@
 #include "SharedUniformBlock.h"
+#include "EngineCounters.h"
+#include "GLStateCache.h"
+
+#include <cstring>
 
 #define VERBOSE false
 
@@ -17,102 +21,126 @@ bool checkBlockLocationFound(const GLchar* locationName, GLuint indice)
 
 } // end checkBlockLocationFound
 
-std::vector<GLint> SharedUniformBlock::setUniformBlockForShader(GLuint shaderProgram, std::string blockName, std::vector<std::string> blockMembers)
+
+void SharedUniformBlock::setUniformBlockForShader(GLuint shaderProgram, std::string blockName)
 {
-	// Determine the size of the block and set the binding point for the block(s)
-	determineBlockSizeSetBindingPoint(shaderProgram, blockName);
+	// Only checked when debugging since it requires queries for each shader
+	if (VERBOSE) checkBlockSize(shaderProgram, blockName);
 
-	// Has the buffer been created and have the byte offset been found?
-	if (blockSizeAndOffetsSet == false ) {
+	// Has the buffer been created?
+	if (isSetUp() == false) {
 
 		// Set up the buffers and bind to binding points
-		allocateBuffer(shaderProgram);
-
-		// Find the byte offsets of the uniform block variables
-		findOffsets(shaderProgram, blockMembers);
+		allocateBuffer();
 	}
 
-	return offsets;
-
 } // end setUniformBlockForShader
 
 
-void SharedUniformBlock::determineBlockSizeSetBindingPoint(GLuint shaderProgram, std::string blockName)
+void SharedUniformBlock::setData(const void* data, GLintptr offset, GLsizeiptr size)
 {
-	// Get the index of the "projectionViewBlock"
-	GLuint blockIndex = glGetUniformBlockIndex(shaderProgram, blockName.c_str());
+	if (blockBuffer == 0) {
+		return;
+	}
 
-	if (checkBlockLocationFound(blockName.c_str(), blockIndex)) {
+	// Bind the buffer
+	GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, blockBuffer);
 
-		// Determine the size in bytes of the uniform block.
-		glGetActiveUniformBlockiv(shaderProgram, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &blockSize);
-		if ( VERBOSE ) std::cout << blockName.c_str() << " size is " << blockSize << std::endl;
+	// Invalidating the range lets the driver avoid waiting on draws that still use the old contents
+	void* bufferData = glMapBufferRange(GL_UNIFORM_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+
+	if (bufferData != nullptr) {
+
+		memcpy(bufferData, data, size);
+
+		glUnmapBuffer(GL_UNIFORM_BUFFER);
 
-		// Assign the block to a binding point. 
-		glUniformBlockBinding(shaderProgram, blockIndex, blockBindingPoint);
+		EngineCounters::add(EngineCounters::UNIFORM_BYTES, size);
 	}
 
-} // end determineBlockSizeSetBindingPoint
+	// The buffer is left bound so updating the same block again does not bind it again
 
+} // end setData
 
-void SharedUniformBlock::allocateBuffer(GLuint shaderProgram )
+
+void SharedUniformBlock::bindSlot(int slot)
 {
-	if (blockSize > 0) {
+	if (blockBuffer != 0 && slot >= 0 && slot < slotCount) {
 
-		// Get an identifier for a buffer
-		glGenBuffers(1, &blockBuffer);
+		GLStateCache::bindBufferRange(GL_UNIFORM_BUFFER, blockBindingPoint, blockBuffer, slot * slotStride, blockSize);
+	}
 
-		// Bind the buffer
-		glBindBuffer(GL_UNIFORM_BUFFER, blockBuffer);
+} // end bindSlot
 
-		// Allocate the buffer. Does not load data. Note the use of nullptr where the data would normally be.
-		// Data is not loaded because the above struct will not be byte alined with the uniform block.
-		glBufferData(GL_UNIFORM_BUFFER, blockSize, nullptr, GL_DYNAMIC_DRAW);
 
-		// Assign the buffer to a binding point to be the same as the uniform in the shader(s). 
-		glBindBufferBase(GL_UNIFORM_BUFFER, blockBindingPoint, blockBuffer);
+bool SharedUniformBlock::setSlotCount(int count)
+{
+	if (count <= slotCount) {
+		return false;
+	}
+
+	slotCount = count;
 
-		// Indicate the buffer has already been allocated and the offsets have been determined
-		blockSizeAndOffetsSet = true;
+	if (blockBuffer == 0) {
+		return false;
 	}
 
-} // end allocateBuffer
+	// Replace the buffer with a larger one
+	GLStateCache::deleteBuffers(1, &blockBuffer);
+	blockBuffer = 0;
+
+	allocateBuffer();
 
+	return true;
 
-void SharedUniformBlock::findOffsets(GLuint shaderProgram, std::vector<std::string> blockMembers)
+} // end setSlotCount
+
+
+void SharedUniformBlock::checkBlockSize(GLuint shaderProgram, std::string blockName)
 {
-	const int numberOfNames = static_cast<int>(blockMembers.size());
+	GLuint blockIndex = glGetUniformBlockIndex(shaderProgram, blockName.c_str());
 
-	GLuint* uniformIndices = new GLuint[numberOfNames];
-	GLint* uniformOffsets = new GLint[numberOfNames];
-	GLchar ** charStringNames = new GLchar *[numberOfNames];
+	if (checkBlockLocationFound(blockName.c_str(), blockIndex)) {
+
+		// Determine the size in bytes of the uniform block.
+		GLint shaderBlockSize = 0;
+		glGetActiveUniformBlockiv(shaderProgram, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &shaderBlockSize);
 
-	for (int i = 0; i < numberOfNames; i++) {
+		std::cout << blockName.c_str() << " size is " << shaderBlockSize << std::endl;
 
-		charStringNames[i] = (GLchar *)blockMembers[i].c_str();
+		if (shaderBlockSize != blockSize) {
+
+			std::cerr << blockName.c_str() << " is " << shaderBlockSize << " bytes in the shader but "
+				<< blockSize << " bytes in the struct." << std::endl;
+		}
 	}
 
-	glGetUniformIndices(shaderProgram, numberOfNames, (const GLchar **)charStringNames, uniformIndices);
+} // end checkBlockSize
 
-	for (int i = 0; i < numberOfNames; i++) {
 
-		checkBlockLocationFound(charStringNames[i], uniformIndices[i]);
-	}
+void SharedUniformBlock::allocateBuffer()
+{
+	if (blockSize > 0) {
 
-	//Get the offsets of the uniforms. The offsets in the buffer will be the same.
-	glGetActiveUniformsiv(shaderProgram, numberOfNames, uniformIndices, GL_UNIFORM_OFFSET, uniformOffsets);
+		// Slots must start at multiples of the offset alignment
+		GLint alignment = 1;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
 
-	for (int i = 0; i < numberOfNames; i++) {
+		slotStride = ((blockSize + alignment - 1) / alignment) * alignment;
 
-		if (VERBOSE) std::cout << '\t' << charStringNames[i] << " offset is " << uniformOffsets[i] << std::endl;
-			offsets.push_back(uniformOffsets[i]);
-	}
+		// Get an identifier for a buffer
+		glGenBuffers(1, &blockBuffer);
 
-	// Deallocate memory
-	delete [] uniformIndices;
-	delete [] uniformOffsets;
-	delete [] charStringNames;
+		// Bind the buffer
+		GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, blockBuffer);
 
-} // findOffsets
+		// Allocate the buffer. Does not load data. Note the use of nullptr where the data would normally be.
+		glBufferData(GL_UNIFORM_BUFFER, slotStride * slotCount, nullptr, GL_DYNAMIC_DRAW);
 
+		// Assign the first slot of the buffer to a binding point to be the same as the uniform in the shader(s). 
+		GLStateCache::bindBufferRange(GL_UNIFORM_BUFFER, blockBindingPoint, blockBuffer, 0, blockSize);
 
+		GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+} // end allocateBuffer
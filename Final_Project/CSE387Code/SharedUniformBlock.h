@@ -1,54 +1,84 @@
 #pragma once
 
 #include "MathLibsConstsFuncs.h"
+#include "GLStateCache.h"
 #include <vector>
 
+/**
+ * Buffer for a uniform block that is declared with layout(std140) and an explicit
+ * binding point in the shaders. The layout of std140 blocks is fixed, so the
+ * contents are described by a C++ struct with the same layout rather than by
+ * offsets found in a shader program. Structs should static_assert the offsets of
+ * their members.
+ *
+ * A buffer can hold several slots, each with its own copy of the block. Slots are
+ * aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT and one of them is bound to the
+ * binding point at a time with glBindBufferRange.
+ */
 class SharedUniformBlock
 {
 
 public:
 
-	SharedUniformBlock(GLint blockBindingPoint) : blockBindingPoint(blockBindingPoint) {}
+	SharedUniformBlock(GLint blockBindingPoint, GLsizeiptr blockSize, int slotCount = 1) 
+		: blockBindingPoint(blockBindingPoint), blockSize(blockSize), slotCount(slotCount) {}
 
-	~SharedUniformBlock() { glDeleteBuffers(1, &blockBuffer); }
+	~SharedUniformBlock() { GLStateCache::deleteBuffers(1, &blockBuffer); }
 
-	std::vector<GLint>  setUniformBlockForShader(GLuint shaderProgram, std::string blockName, std::vector<std::string> blockMembers);
+	// Creates the buffer and binds it to the binding point if that has not already
+	// been done. If VERBOSE is true, checks the size of the block in the shader.
+	void setUniformBlockForShader(GLuint shaderProgram, std::string blockName);
 
-	GLint getSize() { return blockSize; }
+	// Copies data into the buffer with a single memcpy into mapped memory.
+	void setData(const void* data, GLintptr offset, GLsizeiptr size);
+
+	// Copies the contents of the whole block into the buffer.
+	void setData(const void* data) { setData(data, 0, blockSize); }
+
+	// Copies the contents of the whole block into a slot of the buffer.
+	void setSlotData(int slot, const void* data) { setData(data, slot * slotStride, blockSize); }
+
+	// Binds one slot of the buffer to the binding point.
+	void bindSlot(int slot);
+
+	// Increases the number of slots. Returns true if the buffer was reallocated
+	// in which case the contents of every slot must be set again.
+	bool setSlotCount(int count);
+
+	int getSlotCount() { return slotCount; }
+
+	GLsizeiptr getSize() { return blockSize; }
 
 	GLuint getBuffer(){ return blockBuffer; }
 
+	// True once the buffer has been created
+	bool isSetUp() { return blockBuffer != 0; }
+
 private:
 
-	// Determines the size in bytes of the block and binds it to the binding point. 
-	void determineBlockSizeSetBindingPoint(GLuint shaderProgram, std::string blockName);
-	
 	// Creates the buffer and binds it to the binding point.
-	void allocateBuffer(GLuint shaderProgram);
+	void allocateBuffer();
 
-	// Finds the byte offsets of the variables in the two uniform  blocks.
-	void findOffsets(GLuint shaderProgram, std::vector<std::string> blockMembers);
-	// Identifier for the uniform block.
-	GLuint blockIndex;
+	// Compares the size of the block in the shader to the size of the struct.
+	void checkBlockSize(GLuint shaderProgram, std::string blockName);
 
-	// Size in bytes of both the buffer and the uniform block in all the the shaders.
-	GLint blockSize;
-
-	// Binding point to which the blocks and buffer will be bound
+	// Binding point to which the blocks and buffer will be bound. Must match the
+	// binding in the shaders.
 	GLint blockBindingPoint;
 
+	// Size in bytes of both the buffer and the uniform block in all the the shaders.
+	GLsizeiptr blockSize;
+
 	// Identifier for the buffer. There would only be one buffer to feed several uniform blocks.
-	GLuint blockBuffer;
+	GLuint blockBuffer = 0;
 
-	// Indicates whether or not the buffer for the blocks has been setup
-	bool blockSizeAndOffetsSet; 
+	// Number of copies of the block held by the buffer
+	int slotCount;
 
-	// Holds byte offsets for the members of the uniform block
-	std::vector<GLint> offsets;
+	// Distance in bytes between slots
+	GLsizeiptr slotStride = 0;
 
 }; // end SharedUniformBlock
 
 
 bool checkBlockLocationFound(const GLchar* locationName, GLuint indice);
-
-
@@ -23,8 +23,13 @@ void SimpleMoveComponent::update(float deltaTime)
 
 void SimpleMoveComponent::processInput()
 {
-	// Polling vs callbacks
-	GLFWwindow* win = glfwGetCurrentContext();
+	// Polling vs callbacks. The context may be current on the render thread so the
+	// window is taken from the game. Headless games have no window or input.
+	GLFWwindow* win = this->owningGameObject->getOwningGame()->getRenderWindow();
+
+	if (win == nullptr) {
+		return;
+	}
 
 	if (glfwGetKey(win, GLFW_KEY_D) == GLFW_PRESS) {
 
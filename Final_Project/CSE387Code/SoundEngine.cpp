@@ -1,11 +1,13 @@
 #include "SoundEngine.h"
+#include "CpuProfiler.h"
+#include "EngineCounters.h"
 
 #define VERBOSE false
 
 
 FMOD::System* SoundEngine::system = nullptr;
 
-bool SoundEngine::Init()
+bool SoundEngine::Init(bool nullOutput)
 {
 	if (SoundEngine::system == nullptr) {
 
@@ -19,6 +21,17 @@ bool SoundEngine::Init()
 			return false;
 		}
 
+		// Must be selected before the system is initialized
+		if (nullOutput == true) {
+
+			result = system->setOutput(FMOD_OUTPUTTYPE_NOSOUND_NRT);
+			if (result != FMOD_OK)
+			{
+				SoundEngine::HandleError(result);
+				return false;
+			}
+		}
+
 		/*
 		 By default FMOD uses a left-handed coordinate system. To use a right-handed 
 		 coordinate system FMOD must be initialized by passing FMOD_INIT_3D_RIGHTHANDED 
@@ -56,11 +69,17 @@ bool SoundEngine::Init()
 
 void SoundEngine::Update(const float & deltaTime)
 {
+	CPU_PROFILE_SCOPE("SoundEngine::Update");
+
 	/*
 	* Updates the FMOD system. This should be called once per 'game' tick, or once per frame.
 	* Gets 3D positioning for 3D sound.
 	*/
 	SoundEngine::HandleError(SoundEngine::system->update());
+
+	int playingChannels = 0;
+	SoundEngine::HandleError(SoundEngine::system->getChannelsPlaying(&playingChannels));
+	EngineCounters::set(EngineCounters::PLAYING_CHANNELS, playingChannels);
 }
 
 void SoundEngine::Stop()
@@ -71,6 +90,9 @@ void SoundEngine::Stop()
 	 */
 	SoundEngine::HandleError(SoundEngine::system->release());
 
+	// Allows the engine to be initialized again by another game
+	SoundEngine::system = nullptr;
+
 }
 
 void SoundEngine::HandleError(FMOD_RESULT result)
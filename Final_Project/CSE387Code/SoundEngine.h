@@ -12,13 +12,16 @@ class SoundEngine
 public:
 
 	/**
-	 * @fn	static bool SoundEngine::Init();
+	 * @fn	static bool SoundEngine::Init(bool nullOutput = false);
 	 *
 	 * @brief	Initialize the sound engine.
 	 *
+	 * @param	nullOutput	(Optional) True to mix sounds without an audio device and without
+	 * 						waiting for real time. Used by headless games.
+	 *
 	 * @returns	True if it succeeds, false if it fails.
 	 */
-	static bool Init();
+	static bool Init(bool nullOutput = false);
 
 	/**
 	 * @fn	static void SoundEngine::Update(const float & deltaTime = 0.0f);
@@ -1,4 +1,5 @@
 #include "SphereMeshComponent.h"
+#include "PrimitiveGeometryCache.h"
 
 // Get the Spherical texture mapping coordinates based on slice and 
 // stack angles
@@ -37,140 +38,110 @@ SphereMeshComponent::SphereMeshComponent(GLuint shaderProgram, Material * materi
 										 GLfloat radius, int updateOrder, GLint stacks, GLint slices)
 	: material(material),radius(radius), stacks(stacks), slices(slices), MeshComponent (shaderProgram, updateOrder)
 {
-	GLfloat stackInc = (PI) / (stacks);
-	GLfloat sliceInc = (2 * PI) / (slices);
-
-	GLfloat angle = -PI / 2 + stackInc;
-	stackAngles.push_back(angle);
-
-	for (int i = 1; i < stacks - 1; i++) {
+}
 
-		angle += stackInc;
-		stackAngles.push_back(angle);
-	}
 
-	angle = 0;
-	sliceAngles.push_back(angle);
+SphereMeshComponent::~SphereMeshComponent()
+{
+	PrimitiveGeometryCache::release(geometryKey);
 
-	for (int i = 0; i < slices; i++) {
+	// Buffers belong to the geometry cache. Keep the super class from deleting them.
+	for (auto& subMesh : subMeshes) {
 
-		angle += sliceInc;
-		sliceAngles.push_back(angle);
+		subMesh.vao = 0;
+		subMesh.vertexBuffer = 0;
+		subMesh.indexBuffer = 0;
 	}
 
-}
+} // end destructor
 
 
 void SphereMeshComponent::initialize()
 {
-	initializeTop();
-	initializeBody();
-	initializeBottom();
+	geometryKey = PrimitiveGeometryCache::getSphereKey(radius, stacks, slices);
 
-	this->subMeshes.push_back(MeshComponent::buildSubMesh(v, indices, material));
+	PrimitiveGeometry* geometry = PrimitiveGeometryCache::acquire(geometryKey);
 
-	// Clear the working vectors used to make the vertex data
-	v.clear();
-	stackAngles.clear();
-	sliceAngles.clear();
+	if (geometry == nullptr) {
 
-	this->collisionShape = new btSphereShape(radius);
-}
-
-void SphereMeshComponent::initializeTop()
-{
-	vec3 vertTop = vec3(0, radius, 0);
-	vec3 normTop = vec3(glm::normalize(vertTop));
+		std::vector<pntVertexData> vertexData;
+		std::vector<unsigned int> indices;
 
-	vec3 vert = sphericalToCartesion(sliceAngles[0], stackAngles[stackAngles.size() - 1], radius);
-	vec3 norm = vec3(glm::normalize(vert));
-	vec2 tex = getSphericalTextCoords(sliceAngles[0], stackAngles[stackAngles.size() - 1]);
+		buildSphere(vertexData, indices);
 
-	for (int sliceIndex = 0; sliceIndex < slices; sliceIndex++) {
+		geometry = PrimitiveGeometryCache::add(geometryKey, MeshComponent::buildSubMesh(vertexData, indices, nullptr),
+											   new btSphereShape(radius));
+	}
 
-		vec2 texTop = getSphericalTextCoords((sliceAngles[sliceIndex] + sliceAngles[sliceIndex + 1]) / 2, PI / 2);
+	// Share the buffers but use the material for this sphere
+	SubMesh subMesh = geometry->subMesh;
+	subMesh.material = material;
 
-		vec3 vert2 = vert;
-		vec3 norm2 = norm;
-		vec2 tex2 = tex;
+	this->subMeshes.push_back(subMesh);
 
-		vert = sphericalToCartesion(sliceAngles[sliceIndex + 1], stackAngles[stackAngles.size() - 1], radius);
-		norm = vec3(glm::normalize(vert));
-		tex = getSphericalTextCoords(sliceAngles[sliceIndex + 1], stackAngles[stackAngles.size() - 1]);
+	this->collisionShape = geometry->collisionShape;
 
-		v.push_back(pntVertexData(vertTop, normTop, texTop));
-		indices.push_back(indiceCounter++);
-		v.push_back(pntVertexData(vert2, norm2, tex2));
-		indices.push_back(indiceCounter++);
-		v.push_back(pntVertexData(vert, norm, tex));
-		indices.push_back(indiceCounter++);
-	}
+} // end initialize
 
-} // end initializeTop
 
-void SphereMeshComponent::initializeBody()
+void SphereMeshComponent::buildSphere(std::vector<pntVertexData>& vertexData, std::vector<unsigned int>& indices)
 {
-	for (unsigned int stackIndex = 0; stackIndex < stackAngles.size() - 1; stackIndex++) {
-
-		for (unsigned int sliceIndex = 0; sliceIndex < sliceAngles.size() - 1; sliceIndex++) {
-
-			vec3 vert0 = sphericalToCartesion(sliceAngles[sliceIndex], stackAngles[stackIndex + 1], radius);
-			vec2 text0 = getSphericalTextCoords(sliceAngles[sliceIndex], stackAngles[stackIndex + 1]);
-			vec3 vert1 = sphericalToCartesion(sliceAngles[sliceIndex], stackAngles[stackIndex], radius);
-			vec2 text1 = getSphericalTextCoords(sliceAngles[sliceIndex], stackAngles[stackIndex]);
-			vec3 vert2 = sphericalToCartesion(sliceAngles[sliceIndex + 1], stackAngles[stackIndex], radius);
-			vec2 text2 = getSphericalTextCoords(sliceAngles[sliceIndex + 1], stackAngles[stackIndex]);
-			vec3 vert3 = sphericalToCartesion(sliceAngles[sliceIndex + 1], stackAngles[stackIndex + 1], radius);
-			vec2 text3 = getSphericalTextCoords(sliceAngles[sliceIndex + 1], stackAngles[stackIndex + 1]);
-
-			v.push_back(pntVertexData(vert0, vec3(glm::normalize(vert0)), text0));
-			indices.push_back(indiceCounter++);
-			v.push_back(pntVertexData(vert1, vec3(glm::normalize(vert1)), text1));
-			indices.push_back(indiceCounter++);
-			v.push_back(pntVertexData(vert2, vec3(glm::normalize(vert2)), text2));
-			indices.push_back(indiceCounter++);
-
-			v.push_back(pntVertexData(vert0, vec3(glm::normalize(vert0)), text0));
-			indices.push_back(indiceCounter++);
-			v.push_back(pntVertexData(vert2, vec3(glm::normalize(vert2)), text2));
-			indices.push_back(indiceCounter++);
-			v.push_back(pntVertexData(vert3, vec3(glm::normalize(vert3)), text3));
-			indices.push_back(indiceCounter++);
-		}
-	}
+	GLfloat stackInc = PI / stacks;
+	GLfloat sliceInc = (2 * PI) / slices;
 
-} // end initializeBody
+	// Rows of vertices from the bottom pole to the top pole. Each row has
+	// one extra vertex so the texture coordinates can wrap around the seam.
+	for (int stackIndex = 0; stackIndex <= stacks; stackIndex++) {
 
+		GLfloat stackAngle = -PI / 2 + stackIndex * stackInc;
 
-void SphereMeshComponent::initializeBottom()
-{
-	vec3 vertBottom = vec3(0, -radius, 0);
-	vec3 normBottom = vec3(glm::normalize(vertBottom));
+		for (int sliceIndex = 0; sliceIndex <= slices; sliceIndex++) {
 
-	vec3 vert = sphericalToCartesion(sliceAngles[slices], stackAngles[0], radius);
-	vec3 norm = vec3(glm::normalize(vert));
-	vec2 tex = getSphericalTextCoords(sliceAngles[slices], stackAngles[0]);
+			GLfloat sliceAngle = sliceIndex * sliceInc;
 
-	for (int sliceIndex = slices; sliceIndex > 0; sliceIndex--) {
+			vec3 vert = sphericalToCartesion(sliceAngle, stackAngle, radius);
 
-		vec2 texBottom = getSphericalTextCoords((sliceAngles[sliceIndex] + sliceAngles[sliceIndex - 1]) / 2, -PI / 2);
+			// Vertices at the poles use the middle of the slice they are the tip of.
+			// Top pole vertices start a slice and bottom pole vertices end one.
+			vec2 tex;
+			if (stackIndex == stacks) {
+				tex = getSphericalTextCoords(sliceAngle + sliceInc / 2, stackAngle);
+			}
+			else if (stackIndex == 0) {
+				tex = getSphericalTextCoords(sliceAngle - sliceInc / 2, stackAngle);
+			}
+			else {
+				tex = getSphericalTextCoords(sliceAngle, stackAngle);
+			}
 
-		vec3 vert2 = vert;
-		vec3 norm2 = norm;
-		vec2 tex2 = tex;
+			vertexData.push_back(pntVertexData(vert, vec3(glm::normalize(vert)), tex));
+		}
+	}
 
-		vert = sphericalToCartesion(sliceAngles[sliceIndex - 1], stackAngles[0], radius);
-		norm = vec3(glm::normalize(vert));
-		tex = getSphericalTextCoords(sliceAngles[sliceIndex - 1], stackAngles[0]);
+	GLuint rowLength = slices + 1;
 
-		v.push_back(pntVertexData(vertBottom, normBottom, texBottom));
-		indices.push_back(indiceCounter++);
-		v.push_back(pntVertexData(vert2, norm2, tex2));
-		indices.push_back(indiceCounter++);
-		v.push_back(pntVertexData(vert, norm, tex));
-		indices.push_back(indiceCounter++);
-	}
+	for (int stackIndex = 0; stackIndex < stacks; stackIndex++) {
 
-} // end initializeBottom
+		for (int sliceIndex = 0; sliceIndex < slices; sliceIndex++) {
+
+			GLuint lowerLeft = stackIndex * rowLength + sliceIndex;
+			GLuint upperLeft = lowerLeft + rowLength;
+
+			// Skip the triangle that would have two vertices at the bottom pole
+			if (stackIndex > 0) {
+				indices.push_back(upperLeft);
+				indices.push_back(lowerLeft);
+				indices.push_back(lowerLeft + 1);
+			}
+
+			// Skip the triangle that would have two vertices at the top pole
+			if (stackIndex < stacks - 1) {
+				indices.push_back(upperLeft);
+				indices.push_back(lowerLeft + 1);
+				indices.push_back(upperLeft + 1);
+			}
+		}
+	}
 
+} // end buildSphere
 
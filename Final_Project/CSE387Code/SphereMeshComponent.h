@@ -6,29 +6,44 @@ public:
 
 	SphereMeshComponent(GLuint shaderProgram, Material * material, GLfloat radius = 2.0f, int updateOrder = 100, GLint stacks = 8, GLint slices = 16);
 
+	/**
+	 * @fn	SphereMeshComponent::~SphereMeshComponent();
+	 *
+	 * @brief	Destructor. Releases the shared geometry. The buffers are deleted by the
+	 * 			geometry cache when the last sphere with the same parameters is deleted.
+	 */
+	~SphereMeshComponent();
+
+	/**
+	 * @fn	virtual void SphereMeshComponent::initialize() override;
+	 *
+	 * @brief	Retrieves the geometry for spheres with the same radius, stacks, and slices
+	 * 			from the geometry cache. The geometry is built if this is the first one.
+	 */
 	virtual void initialize() override;
 
 protected:
 
-	void initializeTop();
-	void initializeBody();
-	void initializeBottom();
+	/**
+	 * @fn	void SphereMeshComponent::buildSphere(std::vector<pntVertexData>& vertexData, std::vector<unsigned int>& indices);
+	 *
+	 * @brief	Generates welded vertex data for the sphere. Each vertex is shared by all of
+	 * 			the triangles that meet at it. Vertices are only duplicated along the texture
+	 * 			seam and at the poles where the texture coordinates differ.
+	 *
+	 * @param [out]	vertexData	The vertex data.
+	 * @param [out]	indices   	The indices.
+	 */
+	void buildSphere(std::vector<pntVertexData>& vertexData, std::vector<unsigned int>& indices);
 
 	GLint stacks;
 	GLint slices;
 	GLfloat radius;
 
-	std::vector<GLfloat> stackAngles;
-	std::vector<GLfloat> sliceAngles;
-
-	std::vector<pntVertexData> v;
-	std::vector<unsigned int> indices;
-
-	unsigned int indiceCounter = 0;
-
 	Material * material;
 
-
+	/** @brief	Key of the shared geometry in the geometry cache */
+	std::string geometryKey;
 
 };
 
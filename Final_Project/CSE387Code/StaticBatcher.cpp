@@ -0,0 +1,374 @@
+#include "StaticBatcher.h"
+#include "GLStateCache.h"
+#include "MeshComponent.h"
+#include "RenderQueue.h"
+#include "ShaderVariants.h"
+#include "GameObject.h"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+#define VERBOSE false
+
+StaticBatcher::~StaticBatcher()
+{
+	clear();
+
+} // end destructor
+
+
+void StaticBatcher::build(const std::vector<MeshComponent*>& meshComps)
+{
+	clear();
+
+	addBatches(meshComps);
+
+	if (VERBOSE) cout << "Merged " << batchedMeshes.size() << " static meshes into " << batches.size() << " batches" << endl;
+
+} // end build
+
+
+void StaticBatcher::remove(MeshComponent* mesh)
+{
+	if (std::find(batchedMeshes.begin(), batchedMeshes.end(), mesh) == batchedMeshes.end()) {
+		return;
+	}
+
+	// Meshes that share a batch with the removed mesh are batched again without it. Their
+	// other sub-meshes may be in other batches, which are rebuilt as well.
+	std::vector<MeshComponent*> affectedMeshes = { mesh };
+	std::vector<bool> affectedBatches(batches.size(), false);
+
+	bool added = true;
+
+	while (added == true) {
+
+		added = false;
+
+		for (size_t i = 0; i < batches.size(); i++) {
+
+			if (affectedBatches[i] == true) {
+				continue;
+			}
+
+			for (auto source : batches[i].meshes) {
+
+				if (std::find(affectedMeshes.begin(), affectedMeshes.end(), source) != affectedMeshes.end()) {
+					affectedBatches[i] = true;
+					break;
+				}
+			}
+
+			if (affectedBatches[i] == true) {
+
+				for (auto source : batches[i].meshes) {
+
+					if (std::find(affectedMeshes.begin(), affectedMeshes.end(), source) == affectedMeshes.end()) {
+						affectedMeshes.push_back(source);
+					}
+				}
+
+				added = true;
+			}
+		}
+	}
+
+	std::vector<Batch> keptBatches;
+
+	for (size_t i = 0; i < batches.size(); i++) {
+
+		if (affectedBatches[i] == true) {
+			deleteBatch(batches[i]);
+		}
+		else {
+			keptBatches.push_back(batches[i]);
+		}
+	}
+
+	batches.swap(keptBatches);
+
+	for (auto source : affectedMeshes) {
+
+		source->setBatched(false);
+		batchedMeshes.erase(std::find(batchedMeshes.begin(), batchedMeshes.end(), source));
+	}
+
+	affectedMeshes.erase(affectedMeshes.begin());
+
+	addBatches(affectedMeshes);
+
+	if (VERBOSE) cout << "Rebuilt the batches of " << affectedMeshes.size() << " static meshes" << endl;
+
+} // end remove
+
+
+void StaticBatcher::addBatches(const std::vector<MeshComponent*>& meshComps)
+{
+	// Vertices and indices of a group of sub-meshes in world coordinates
+	struct BatchGeometry {
+
+		std::vector<pntVertexData> vertexData;
+		std::vector<unsigned int> indices;
+		glm::vec3 minimum = glm::vec3(std::numeric_limits<float>::max());
+		glm::vec3 maximum = glm::vec3(-std::numeric_limits<float>::max());
+		Material* material = nullptr;
+		GLuint shaderProgram = 0;
+		std::vector<MeshComponent*> meshes;
+	};
+
+	std::vector<BatchGeometry> groups;
+
+	// Groups by chunk coordinates, shader program, and index of a distinct material
+	std::map<std::tuple<int, int, int, GLuint, size_t>, size_t> groupIndices;
+
+	std::vector<const Material*> distinctMaterials;
+
+	// Primitive meshes share buffers so each buffer is only read once
+	std::unordered_map<GLuint, std::pair<std::vector<pntVertexData>, std::vector<unsigned int>>> readBuffers;
+
+	for (auto mesh : meshComps) {
+
+		if (mesh->isStaticGeometry() == false || mesh->owningGameObject->getState() != ACTIVE) {
+			continue;
+		}
+
+		std::vector<SubMesh>& subMeshes = mesh->getSubMeshes();
+
+		// The whole mesh is rendered individually if any sub-mesh cannot be batched
+		bool canBatch = !subMeshes.empty();
+
+		for (auto& subMesh : subMeshes) {
+
+			if (subMesh.material == nullptr || subMesh.primitiveMode != GL_TRIANGLES) {
+				canBatch = false;
+				break;
+			}
+
+			if (readBuffers.count(subMesh.vertexBuffer) == 0) {
+
+				auto& buffers = readBuffers[subMesh.vertexBuffer];
+
+				if (readSubMesh(subMesh, buffers.first, buffers.second) == false) {
+					canBatch = false;
+					break;
+				}
+			}
+		}
+
+		if (canBatch == false) {
+			continue;
+		}
+
+		glm::mat4 modelMatrix = mesh->owningGameObject->sceneNode.getModelingTransformation();
+		glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(modelMatrix)));
+
+		for (auto& subMesh : subMeshes) {
+
+			const auto& buffers = readBuffers[subMesh.vertexBuffer];
+
+			// Transform the vertices into world coordinates
+			std::vector<pntVertexData> worldVertices(buffers.first);
+			glm::vec3 minimum(std::numeric_limits<float>::max());
+			glm::vec3 maximum(-std::numeric_limits<float>::max());
+
+			for (auto& vertex : worldVertices) {
+
+				vertex.m_pos = glm::vec3(modelMatrix * glm::vec4(vertex.m_pos, 1.0f));
+				vertex.m_normal = glm::normalize(normalMatrix * vertex.m_normal);
+
+				minimum = glm::min(minimum, vertex.m_pos);
+				maximum = glm::max(maximum, vertex.m_pos);
+			}
+
+			// Sub-meshes are placed in the chunk that contains the center of their bounds
+			glm::vec3 chunk = glm::floor((minimum + maximum) * 0.5f / chunkSize);
+
+			size_t materialIndex = 0;
+			while (materialIndex < distinctMaterials.size() && !sameMaterial(distinctMaterials[materialIndex], subMesh.material)) {
+				materialIndex++;
+			}
+			if (materialIndex == distinctMaterials.size()) {
+				distinctMaterials.push_back(subMesh.material);
+			}
+
+			auto key = std::make_tuple(static_cast<int>(chunk.x), static_cast<int>(chunk.y), static_cast<int>(chunk.z),
+									   mesh->shaderProgram, materialIndex);
+
+			auto found = groupIndices.find(key);
+
+			if (found == groupIndices.end()) {
+
+				found = groupIndices.insert({ key, groups.size() }).first;
+
+				groups.push_back(BatchGeometry());
+				groups.back().material = subMesh.material;
+				groups.back().shaderProgram = mesh->shaderProgram;
+			}
+
+			BatchGeometry& group = groups[found->second];
+
+			unsigned int baseVertex = static_cast<unsigned int>(group.vertexData.size());
+
+			group.vertexData.insert(group.vertexData.end(), worldVertices.begin(), worldVertices.end());
+
+			for (auto index : buffers.second) {
+
+				group.indices.push_back(baseVertex + index);
+			}
+
+			group.minimum = glm::min(group.minimum, minimum);
+			group.maximum = glm::max(group.maximum, maximum);
+
+			if (std::find(group.meshes.begin(), group.meshes.end(), mesh) == group.meshes.end()) {
+				group.meshes.push_back(mesh);
+			}
+		}
+
+		mesh->setBatched(true);
+		batchedMeshes.push_back(mesh);
+	}
+
+	for (auto& group : groups) {
+
+		Batch batch;
+
+		// The batch keeps its own copy of the material, which may be deleted with the mesh
+		Material* material = new Material(*group.material);
+		material->retainTextures();
+
+		batch.subMesh = MeshComponent::buildSubMesh(group.vertexData, group.indices, material);
+		batch.shaderProgram = group.shaderProgram;
+		batch.minimum = group.minimum;
+		batch.maximum = group.maximum;
+		batch.meshes = group.meshes;
+
+		batches.push_back(batch);
+	}
+
+	GLStateCache::bindVertexArray(0);
+
+} // end addBatches
+
+
+void StaticBatcher::addToRenderQueue(RenderQueue& renderQueue, const Frustum& frustum, GLuint programOverride)
+{
+	static const glm::mat4 identity(1.0f);
+
+	for (auto& batch : batches) {
+
+		if (frustum.intersectsBox(batch.minimum, batch.maximum) == false) {
+			continue;
+		}
+
+		// Textures stream in the detail needed for the size of the chunk on the screen
+		glm::vec3 center = (batch.minimum + batch.maximum) * 0.5f;
+		float radius = glm::length(batch.maximum - center);
+
+		batch.subMesh.material->requestTextureDetail(MeshComponent::getProjectedSize(center, radius));
+
+		// Batches are ordered by their nearest extent so large chunks are not rendered last
+		float viewDepth = -(SharedProjectionAndViewing::getViewMatrix() * glm::vec4(center, 1.0f)).z - radius;
+
+		GLuint baseProgram = programOverride != 0 ? programOverride : batch.shaderProgram;
+
+		renderQueue.addItem(&batch.subMesh, batch.subMesh.material, ShaderVariants::getProgram(baseProgram, batch.subMesh.material), identity, viewDepth);
+	}
+
+} // end addToRenderQueue
+
+
+void StaticBatcher::clear()
+{
+	for (auto& batch : batches) {
+
+		deleteBatch(batch);
+	}
+
+	batches.clear();
+
+	for (auto mesh : batchedMeshes) {
+
+		mesh->setBatched(false);
+	}
+
+	batchedMeshes.clear();
+
+} // end clear
+
+
+void StaticBatcher::deleteBatch(Batch& batch)
+{
+	GLStateCache::deleteVertexArrays(1, &batch.subMesh.vao);
+	GLStateCache::deleteBuffers(1, &batch.subMesh.vertexBuffer);
+	GLStateCache::deleteBuffers(1, &batch.subMesh.indexBuffer);
+
+	batch.subMesh.material->releaseTextures();
+	delete batch.subMesh.material;
+	batch.subMesh.material = nullptr;
+
+} // end deleteBatch
+
+
+bool StaticBatcher::readSubMesh(const SubMesh& subMesh, std::vector<pntVertexData>& vertexData, std::vector<unsigned int>& indices)
+{
+	// The copy read target does not change the bindings of any vertex array object
+	GLint bufferSize = 0;
+	GLStateCache::bindBuffer(GL_COPY_READ_BUFFER, subMesh.vertexBuffer);
+	glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &bufferSize);
+
+	vertexData.resize(bufferSize / sizeof(pntVertexData));
+
+	if (vertexData.empty()) {
+		return false;
+	}
+
+	glGetBufferSubData(GL_COPY_READ_BUFFER, 0, vertexData.size() * sizeof(pntVertexData), &vertexData[0]);
+
+	if (subMesh.renderMode == INDEXED) {
+
+		indices.resize(subMesh.count);
+
+		GLStateCache::bindBuffer(GL_COPY_READ_BUFFER, subMesh.indexBuffer);
+		glGetBufferSubData(GL_COPY_READ_BUFFER, 0, indices.size() * sizeof(unsigned int), &indices[0]);
+	}
+	else { // renderMode == ORDERED
+
+		indices.resize(subMesh.count);
+
+		for (unsigned int i = 0; i < subMesh.count; i++) {
+
+			indices[i] = i;
+		}
+	}
+
+	GLStateCache::bindBuffer(GL_COPY_READ_BUFFER, 0);
+
+	return !indices.empty();
+
+} // end readSubMesh
+
+
+bool StaticBatcher::sameMaterial(const Material* a, const Material* b)
+{
+	if (a == b) {
+		return true;
+	}
+
+	return a->ambientMat == b->ambientMat &&
+		   a->diffuseMat == b->diffuseMat &&
+		   a->specularMat == b->specularMat &&
+		   a->specularExpMat == b->specularExpMat &&
+		   a->emissiveMat == b->emissiveMat &&
+		   a->textureMode == b->textureMode &&
+		   a->diffuseTextureEnabled == b->diffuseTextureEnabled &&
+		   a->diffuseTextureObject == b->diffuseTextureObject &&
+		   a->diffuseTextureArray == b->diffuseTextureArray &&
+		   a->diffuseLayer == b->diffuseLayer &&
+		   a->specularTextureEnabled == b->specularTextureEnabled &&
+		   a->specularTextureObject == b->specularTextureObject &&
+		   a->specularTextureArray == b->specularTextureArray &&
+		   a->specularLayer == b->specularLayer;
+
+} // end sameMaterial
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <vector>
+
+#include "SubMesh.h"
+#include "Frustum.h"
+
+class MeshComponent;
+
+/**
+ * @class	StaticBatcher
+ *
+ * @brief	Merges the sub-meshes of static meshes into combined buffers. Vertices are
+ * 			transformed into world coordinates when the batches are built so all batches are
+ * 			rendered with the identity modeling transformation. Sub-meshes are grouped by
+ * 			shader program, by material, and by the chunk of the world they are in so that
+ * 			chunks outside of the view can still be culled.
+ *
+ * 			Batches keep copies of the materials of the meshes they were built from. Call
+ * 			remove when a batched mesh is removed from the game so the batches it was merged
+ * 			into are rebuilt without it.
+ */
+class StaticBatcher
+{
+public:
+
+	/**
+	 * @fn	StaticBatcher::StaticBatcher(float chunkSize = 64.0f)
+	 *
+	 * @brief	Constructor
+	 *
+	 * @param	chunkSize	(Optional) Width of the cubes in world units that sub-meshes are
+	 * 						grouped by.
+	 */
+	StaticBatcher(float chunkSize = 64.0f) : chunkSize(chunkSize) {}
+
+	/**
+	 * @fn	StaticBatcher::~StaticBatcher();
+	 *
+	 * @brief	Destructor. Deletes the combined buffers.
+	 */
+	~StaticBatcher();
+
+	/**
+	 * @fn	void StaticBatcher::build(const std::vector<MeshComponent*>& meshComps);
+	 *
+	 * @brief	Builds batches for the static meshes in a list. Must be called after the
+	 * 			meshes are initialized. Meshes that are added to batches are marked as batched
+	 * 			and are no longer added to render queues. Meshes that are not rendered as
+	 * 			triangles or that do not have materials are rendered individually.
+	 *
+	 * @param	meshComps	The mesh components of the game.
+	 */
+	void build(const std::vector<MeshComponent*>& meshComps);
+
+	/**
+	 * @fn	void StaticBatcher::addToRenderQueue(class RenderQueue& renderQueue, const Frustum& frustum, GLuint programOverride = 0);
+	 *
+	 * @brief	Adds the batches that intersect a viewing frustum to a render queue.
+	 *
+	 * @param [in,out]	renderQueue	   	The render queue.
+	 * @param 		  	frustum		   	The frustum of the current camera.
+	 * @param 		  	programOverride	(Optional) Base program used instead of the programs of
+	 * 									the batches. Zero to use their own.
+	 */
+	void addToRenderQueue(class RenderQueue& renderQueue, const Frustum& frustum, GLuint programOverride = 0);
+
+	/**
+	 * @fn	void StaticBatcher::remove(MeshComponent* mesh);
+	 *
+	 * @brief	Rebuilds the batches a mesh was merged into without it. The other meshes of
+	 * 			those batches are batched again. Does nothing if the mesh was not batched.
+	 * 			Must be called on the thread that owns the OpenGL context.
+	 *
+	 * @param	mesh	The mesh that is being removed from the game.
+	 */
+	void remove(MeshComponent* mesh);
+
+	/**
+	 * @fn	void StaticBatcher::clear();
+	 *
+	 * @brief	Deletes all batches and marks the meshes they were built from as not batched.
+	 */
+	void clear();
+
+	/**
+	 * @fn	size_t StaticBatcher::getBatchCount() const
+	 *
+	 * @brief	Gets the number of batches.
+	 */
+	size_t getBatchCount() const { return batches.size(); }
+
+protected:
+
+	/** @brief	Combined sub-mesh and its bounds in world coordinates */
+	struct Batch {
+
+		SubMesh subMesh; // Combined buffers and a copy of the material of the source meshes
+
+		GLuint shaderProgram = 0; // Base shader program of the source meshes
+
+		glm::vec3 minimum; // Minimum corner of the bounding box
+
+		glm::vec3 maximum; // Maximum corner of the bounding box
+
+		std::vector<MeshComponent*> meshes; // Meshes with sub-meshes merged into the batch
+	};
+
+	/**
+	 * @fn	void StaticBatcher::addBatches(const std::vector<MeshComponent*>& meshComps);
+	 *
+	 * @brief	Builds batches for the static meshes in a list that are active and adds them
+	 * 			to those that were already built.
+	 */
+	void addBatches(const std::vector<MeshComponent*>& meshComps);
+
+	/**
+	 * @fn	static void StaticBatcher::deleteBatch(Batch& batch);
+	 *
+	 * @brief	Deletes the combined buffers and the material of a batch.
+	 */
+	static void deleteBatch(Batch& batch);
+
+	/**
+	 * @fn	static bool StaticBatcher::readSubMesh(const SubMesh& subMesh, std::vector<pntVertexData>& vertexData, std::vector<unsigned int>& indices);
+	 *
+	 * @brief	Reads the vertex data and indices of a sub-mesh back from GPU memory. Indices
+	 * 			are generated for sub-meshes that use ordered rendering.
+	 *
+	 * @returns	True if it succeeds, false if the sub-mesh cannot be batched.
+	 */
+	static bool readSubMesh(const SubMesh& subMesh, std::vector<pntVertexData>& vertexData, std::vector<unsigned int>& indices);
+
+	/**
+	 * @fn	static bool StaticBatcher::sameMaterial(const Material* a, const Material* b);
+	 *
+	 * @brief	Determines if two materials have the same properties and textures so their
+	 * 			sub-meshes can be rendered together.
+	 */
+	static bool sameMaterial(const Material* a, const Material* b);
+
+	/** @brief	Width of the cubes that sub-meshes are grouped by */
+	float chunkSize;
+
+	/** @brief	Batches that were built */
+	std::vector<Batch> batches;
+
+	/** @brief	Meshes that were merged into the batches */
+	std::vector<MeshComponent*> batchedMeshes;
+
+}; // end StaticBatcher class
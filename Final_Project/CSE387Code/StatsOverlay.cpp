@@ -0,0 +1,458 @@
+#include "StatsOverlay.h"
+#include "EngineCounters.h"
+#include "GLStateCache.h"
+#include "BuildShaderProgram.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdio>
+
+#define VERBOSE false
+
+// Texture unit of the font. Units below it are used by materials, occlusion culling, the G-buffer and impostors.
+#define fontTextureUnit 13
+
+// Uniform locations in overlay.vs.glsl and overlay.fs.glsl
+#define viewportSizeLocation 0
+#define fontLocation 1
+
+// Size of a glyph in the font texture including one pixel of space to its right and below it
+#define CELL_WIDTH 6
+#define CELL_HEIGHT 8
+
+// Pixels between the edge of the window, the panel and its contents
+#define MARGIN 8.0f
+
+// Size of the bars of the histogram in pixels
+#define BAR_WIDTH 8.0f
+#define BAR_SPACING 2.0f
+#define BAR_HEIGHT 48.0f
+
+// Glyphs of the characters from ' ' to '_'. Each row is five bits with the leftmost pixel in the highest bit.
+static const unsigned char font[64][7] = {
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // space
+	{ 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 }, // !
+	{ 0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00 }, // "
+	{ 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A }, // #
+	{ 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 }, // $
+	{ 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 }, // %
+	{ 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D }, // &
+	{ 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00 }, // apostrophe
+	{ 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 }, // (
+	{ 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 }, // )
+	{ 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 }, // *
+	{ 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 }, // +
+	{ 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 }, // ,
+	{ 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }, // -
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, // .
+	{ 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 }, // /
+	{ 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, // 0
+	{ 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 1
+	{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F }, // 2
+	{ 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E }, // 3
+	{ 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 }, // 4
+	{ 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E }, // 5
+	{ 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E }, // 6
+	{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, // 7
+	{ 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, // 8
+	{ 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, // 9
+	{ 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 }, // :
+	{ 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 }, // ;
+	{ 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 }, // <
+	{ 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 }, // =
+	{ 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 }, // >
+	{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 }, // ?
+	{ 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E }, // @
+	{ 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // A
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, // B
+	{ 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E }, // C
+	{ 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C }, // D
+	{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // E
+	{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 }, // F
+	{ 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F }, // G
+	{ 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // H
+	{ 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // I
+	{ 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, // J
+	{ 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, // K
+	{ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, // L
+	{ 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 }, // M
+	{ 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, // N
+	{ 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // O
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, // P
+	{ 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D }, // Q
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 }, // R
+	{ 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, // S
+	{ 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // T
+	{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // U
+	{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // V
+	{ 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A }, // W
+	{ 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, // X
+	{ 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04 }, // Y
+	{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, // Z
+	{ 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E }, // [
+	{ 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 }, // backslash
+	{ 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E }, // ]
+	{ 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 }, // ^
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }, // _
+};
+
+const float StatsOverlay::BIN_WIDTH = 2.5f;
+
+std::atomic<bool> StatsOverlay::visible(false);
+
+std::atomic<int> StatsOverlay::consoleInterval(0);
+
+
+/**
+ * @fn	static std::string formatCount(unsigned long long count)
+ *
+ * @brief	Formats a count with a K or M suffix once it no longer fits in a few digits.
+ */
+static std::string formatCount(unsigned long long count)
+{
+	char text[32];
+
+	if (count >= 10000000ULL) {
+
+		snprintf(text, sizeof(text), "%.1fM", count / 1000000.0);
+	}
+	else if (count >= 10000ULL) {
+
+		snprintf(text, sizeof(text), "%.1fK", count / 1000.0);
+	}
+	else {
+
+		snprintf(text, sizeof(text), "%llu", count);
+	}
+
+	return text;
+
+} // end formatCount
+
+
+bool StatsOverlay::initialize()
+{
+	ShaderInfo shaders[] = {
+		{ GL_VERTEX_SHADER, "Shaders/overlay.vs.glsl" },
+		{ GL_FRAGMENT_SHADER, "Shaders/overlay.fs.glsl" },
+		{ GL_NONE, NULL } // signals that there are no more shaders
+	};
+
+	program = BuildShaderProgram(shaders);
+
+	if (program == 0) {
+
+		std::cerr << "Stats overlay program failed to build." << std::endl;
+		return false;
+	}
+
+	glProgramUniform1i(program, fontLocation, fontTextureUnit);
+
+	// Every glyph side by side in one row of cells
+	std::vector<GLubyte> texels(64 * CELL_WIDTH * CELL_HEIGHT, 0);
+
+	for (int glyph = 0; glyph < 64; glyph++) {
+
+		for (int row = 0; row < 7; row++) {
+
+			for (int column = 0; column < 5; column++) {
+
+				if (font[glyph][row] & (0x10 >> column)) {
+
+					texels[row * 64 * CELL_WIDTH + glyph * CELL_WIDTH + column] = 255;
+				}
+			}
+		}
+	}
+
+	glGenTextures(1, &fontTexture);
+	GLStateCache::activeTexture(GL_TEXTURE0 + fontTextureUnit);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, fontTexture);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, 64 * CELL_WIDTH, CELL_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, &texels[0]);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE0);
+
+	// The corners of the quads come from the vertex index so the only attributes are per instance
+	glGenVertexArrays(1, &vao);
+	GLStateCache::bindVertexArray(vao);
+
+	glGenBuffers(1, &instanceBuffer);
+	GLStateCache::bindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Quad), (void*)offsetof(Quad, rect));
+	glVertexAttribDivisor(0, 1);
+	glEnableVertexAttribArray(0);
+
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Quad), (void*)offsetof(Quad, color));
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(1);
+
+	glVertexAttribIPointer(2, 1, GL_INT, sizeof(Quad), (void*)offsetof(Quad, glyph));
+	glVertexAttribDivisor(2, 1);
+	glEnableVertexAttribArray(2);
+
+	GLStateCache::bindVertexArray(0);
+
+	return true;
+
+} // end initialize
+
+
+void StatsOverlay::destroy()
+{
+	if (vao != 0) {
+
+		GLStateCache::deleteVertexArrays(1, &vao);
+		GLStateCache::deleteBuffers(1, &instanceBuffer);
+		GLStateCache::deleteTextures(1, &fontTexture);
+	}
+
+	// The program is deleted with the other shader programs
+	program = 0;
+	vao = 0;
+	instanceBuffer = 0;
+	fontTexture = 0;
+	bufferCapacity = 0;
+
+	quads.clear();
+
+} // end destroy
+
+
+void StatsOverlay::sample(const FrameStats& frameStats)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	Sample current;
+
+	// The first frame has nothing to be measured from
+	if (sampled) {
+
+		current.frameTime = std::chrono::duration<double, std::milli>(now - lastSampleTime).count();
+	}
+
+	lastSampleTime = now;
+
+	current.updateTime = EngineCounters::take(EngineCounters::UPDATE_TIME) / 1.0e6;
+	current.physicsTime = EngineCounters::take(EngineCounters::PHYSICS_TIME) / 1.0e6;
+	current.renderTime = EngineCounters::take(EngineCounters::RENDER_TIME) / 1.0e6;
+	current.gpuTime = frameStats.gpuTime * 1000.0;
+
+	current.drawCalls = EngineCounters::take(EngineCounters::DRAW_CALLS);
+	current.triangles = EngineCounters::take(EngineCounters::TRIANGLES);
+	current.uniformBytes = EngineCounters::take(EngineCounters::UNIFORM_BYTES);
+	current.materialUploads = EngineCounters::take(EngineCounters::MATERIAL_UPLOADS);
+	current.physicsSteps = EngineCounters::take(EngineCounters::PHYSICS_STEPS);
+	current.stateCallsIssued = frameStats.stateCallsIssued;
+	current.stateCallsSkipped = frameStats.stateCallsSkipped;
+
+	current.activeGameObjects = EngineCounters::get(EngineCounters::ACTIVE_GAME_OBJECTS);
+	current.rigidBodies = EngineCounters::get(EngineCounters::RIGID_BODIES);
+	current.playingChannels = EngineCounters::get(EngineCounters::PLAYING_CHANNELS);
+
+	last = current;
+
+	if (sampled) {
+
+		if (frameTimes.size() < HISTORY_FRAMES) {
+
+			frameTimes.push_back(current.frameTime);
+		}
+		else {
+
+			// The oldest frame leaves the histogram
+			histogram[std::min(static_cast<int>(frameTimes[nextFrame] / BIN_WIDTH), HISTOGRAM_BINS - 1)]--;
+
+			frameTimes[nextFrame] = current.frameTime;
+		}
+
+		histogram[std::min(static_cast<int>(current.frameTime / BIN_WIDTH), HISTOGRAM_BINS - 1)]++;
+
+		nextFrame = (nextFrame + 1) % HISTORY_FRAMES;
+	}
+
+	sampled = true;
+
+	int interval = consoleInterval;
+
+	if (interval > 0 && ++framesSincePrint >= interval) {
+
+		framesSincePrint = 0;
+
+		for (auto& line : getLines()) {
+
+			std::cout << line << std::endl;
+		}
+
+		std::cout << "HISTOGRAM";
+
+		for (int i = 0; i < HISTOGRAM_BINS; i++) {
+
+			std::cout << ' ' << histogram[i];
+		}
+
+		std::cout << std::endl;
+	}
+
+} // end sample
+
+
+std::vector<std::string> StatsOverlay::getLines() const
+{
+	std::vector<std::string> lines;
+	char text[128];
+
+	snprintf(text, sizeof(text), "FRAME %.2f MS  %.0f FPS  GPU %.2f MS", last.frameTime, last.frameTime > 0.0 ? 1000.0 / last.frameTime : 0.0, last.gpuTime);
+	lines.push_back(text);
+
+	snprintf(text, sizeof(text), "UPDATE %.2f MS  PHYSICS %.2f MS  RENDER %.2f MS", last.updateTime, last.physicsTime, last.renderTime);
+	lines.push_back(text);
+
+	lines.push_back("DRAWS " + formatCount(last.drawCalls) + "  TRIANGLES " + formatCount(last.triangles));
+
+	lines.push_back("STATE CHANGES " + formatCount(last.stateCallsIssued) + "  SKIPPED " + formatCount(last.stateCallsSkipped));
+
+	lines.push_back("UBO BYTES " + formatCount(last.uniformBytes) + "  MATERIALS " + formatCount(last.materialUploads));
+
+	lines.push_back("OBJECTS " + formatCount(last.activeGameObjects) + "  BODIES " + formatCount(last.rigidBodies) +
+					"  STEPS " + formatCount(last.physicsSteps) + "  CHANNELS " + formatCount(last.playingChannels));
+
+	return lines;
+
+} // end getLines
+
+
+void StatsOverlay::draw(GLsizei width, GLsizei height)
+{
+	if (program == 0) {
+		return;
+	}
+
+	std::vector<std::string> lines = getLines();
+
+	float glyphWidth = static_cast<float>(CELL_WIDTH * FONT_SCALE);
+	float lineHeight = static_cast<float>((CELL_HEIGHT + 1) * FONT_SCALE);
+
+	char label[64];
+	snprintf(label, sizeof(label), "FRAME TIMES 0 - %.0f MS", HISTOGRAM_BINS * BIN_WIDTH);
+	lines.push_back(label);
+
+	size_t longestLine = 0;
+
+	for (auto& line : lines) {
+		longestLine = std::max(longestLine, line.size());
+	}
+
+	float histogramWidth = HISTOGRAM_BINS * (BAR_WIDTH + BAR_SPACING) - BAR_SPACING;
+	float panelWidth = std::max(longestLine * glyphWidth, histogramWidth) + 2.0f * MARGIN;
+	float panelHeight = lines.size() * lineHeight + BAR_HEIGHT + 3.0f * MARGIN;
+
+	quads.clear();
+
+	addRect(MARGIN, MARGIN, panelWidth, panelHeight, glm::vec4(0.0f, 0.0f, 0.0f, 0.6f));
+
+	float top = 2.0f * MARGIN;
+
+	for (auto& line : lines) {
+
+		addText(2.0f * MARGIN, top, line, glm::vec4(1.0f));
+		top += lineHeight;
+	}
+
+	// Bars are scaled to the fullest bin
+	int fullest = std::max(1, *std::max_element(histogram, histogram + HISTOGRAM_BINS));
+
+	top += MARGIN;
+
+	for (int i = 0; i < HISTOGRAM_BINS; i++) {
+
+		float barHeight = BAR_HEIGHT * histogram[i] / fullest;
+
+		// Green for bins below 60 frames per second, yellow below 30 and red above
+		float binEnd = (i + 1) * BIN_WIDTH;
+		glm::vec4 color = binEnd <= 1000.0f / 60.0f ? glm::vec4(0.3f, 0.9f, 0.3f, 1.0f) :
+						  binEnd <= 1000.0f / 30.0f ? glm::vec4(0.9f, 0.9f, 0.3f, 1.0f) : glm::vec4(0.9f, 0.3f, 0.3f, 1.0f);
+
+		addRect(2.0f * MARGIN + i * (BAR_WIDTH + BAR_SPACING), top + BAR_HEIGHT - barHeight, BAR_WIDTH, barHeight, color);
+	}
+
+	GLStateCache::bindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+	// Orphan the storage so quads still being read by the last frame are not overwritten
+	bufferCapacity = std::max(bufferCapacity, quads.size());
+	glBufferData(GL_ARRAY_BUFFER, bufferCapacity * sizeof(Quad), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, quads.size() * sizeof(Quad), &quads[0]);
+
+	glViewport(0, 0, width, height);
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	GLStateCache::useProgram(program);
+	glUniform2f(viewportSizeLocation, static_cast<float>(width), static_cast<float>(height));
+
+	GLStateCache::activeTexture(GL_TEXTURE0 + fontTextureUnit);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, fontTexture);
+
+	GLStateCache::bindVertexArray(vao);
+
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(quads.size()));
+	EngineCounters::addDraw(GL_TRIANGLE_STRIP, 4, quads.size());
+
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::activeTexture(GL_TEXTURE0);
+
+	glDisable(GL_BLEND);
+	glEnable(GL_CULL_FACE);
+	glEnable(GL_DEPTH_TEST);
+
+} // end draw
+
+
+void StatsOverlay::addRect(float left, float top, float width, float height, const glm::vec4& color)
+{
+	Quad quad;
+
+	quad.rect = glm::vec4(left, top, width, height);
+	quad.color = color;
+	quad.glyph = -1;
+
+	quads.push_back(quad);
+
+} // end addRect
+
+
+void StatsOverlay::addText(float left, float top, const std::string& text, const glm::vec4& color)
+{
+	Quad quad;
+
+	quad.color = color;
+
+	for (char character : text) {
+
+		character = static_cast<char>(toupper(static_cast<unsigned char>(character)));
+
+		// Spaces are not drawn
+		if (character > ' ' && character <= '_') {
+
+			quad.rect = glm::vec4(left, top, static_cast<float>(CELL_WIDTH * FONT_SCALE), static_cast<float>(CELL_HEIGHT * FONT_SCALE));
+			quad.glyph = character - ' ';
+
+			quads.push_back(quad);
+		}
+
+		left += CELL_WIDTH * FONT_SCALE;
+	}
+
+} // end addText
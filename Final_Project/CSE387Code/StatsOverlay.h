@@ -0,0 +1,230 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "MathLibsConstsFuncs.h"
+#include "FrameStats.h"
+
+/**
+ * @class	StatsOverlay
+ *
+ * @brief	Draws the statistics of recent frames over the finished frame: a histogram of
+ * 			frame times, the time spent updating, simulating physics and rendering, and the
+ * 			work counted by EngineCounters and FrameStats. Text is drawn with a built in
+ * 			5 x 7 pixel font as instanced quads.
+ *
+ * 			The counters are taken once per rendered frame by sample, which also writes the
+ * 			text to the console at an optional interval, so the statistics are available
+ * 			even when the overlay is hidden.
+ *
+ * 			Must be used on the thread that owns the OpenGL context.
+ */
+class StatsOverlay
+{
+public:
+
+	/**
+	 * @struct	Sample
+	 *
+	 * @brief	Statistics of one rendered frame.
+	 */
+	struct Sample {
+
+		double frameTime = 0.0; // Milliseconds since the previous frame was sampled
+
+		double updateTime = 0.0; // Milliseconds spent updating the game since the previous frame
+
+		double physicsTime = 0.0; // Milliseconds of the update spent in the physics engine
+
+		double renderTime = 0.0; // Milliseconds spent rendering on the CPU
+
+		double gpuTime = 0.0; // Milliseconds of GPU time of the scene. Zero without dynamic resolution.
+
+		unsigned long long drawCalls = 0;
+
+		unsigned long long triangles = 0;
+
+		unsigned long long uniformBytes = 0;
+
+		unsigned long long materialUploads = 0;
+
+		unsigned long long physicsSteps = 0;
+
+		unsigned int stateCallsIssued = 0;
+
+		unsigned int stateCallsSkipped = 0;
+
+		unsigned long long activeGameObjects = 0;
+
+		unsigned long long rigidBodies = 0;
+
+		unsigned long long playingChannels = 0;
+
+	}; // end Sample
+
+	/**
+	 * @fn	StatsOverlay::~StatsOverlay()
+	 *
+	 * @brief	Destructor. Deletes the OpenGL objects.
+	 */
+	~StatsOverlay() { destroy(); }
+
+	/**
+	 * @fn	bool StatsOverlay::initialize();
+	 *
+	 * @brief	Builds the shader program and the font texture.
+	 *
+	 * @returns	False if the shader program could not be built.
+	 */
+	bool initialize();
+
+	/**
+	 * @fn	void StatsOverlay::destroy();
+	 *
+	 * @brief	Deletes the shader program, the font texture and the instance buffer.
+	 */
+	void destroy();
+
+	/**
+	 * @fn	bool StatsOverlay::isInitialized() const
+	 *
+	 * @brief	Returns true if the overlay can be drawn.
+	 */
+	bool isInitialized() const { return program != 0; }
+
+	/**
+	 * @fn	void StatsOverlay::sample(const FrameStats& frameStats);
+	 *
+	 * @brief	Takes the engine counters and adds the frame to the histogram. Call once per
+	 * 			rendered frame with the statistics of the last finished frame.
+	 */
+	void sample(const FrameStats& frameStats);
+
+	/**
+	 * @fn	void StatsOverlay::draw(GLsizei width, GLsizei height);
+	 *
+	 * @brief	Draws the overlay in the top left corner of the bound framebuffer.
+	 *
+	 * @param	width 	The width of the framebuffer in pixels.
+	 * @param	height	The height of the framebuffer in pixels.
+	 */
+	void draw(GLsizei width, GLsizei height);
+
+	/**
+	 * @fn	std::vector<std::string> StatsOverlay::getLines() const;
+	 *
+	 * @brief	Gets the text of the overlay for the last sampled frame.
+	 */
+	std::vector<std::string> getLines() const;
+
+	/**
+	 * @fn	const Sample& StatsOverlay::getLastSample() const
+	 *
+	 * @brief	Gets the statistics of the last sampled frame.
+	 */
+	const Sample& getLastSample() const { return last; }
+
+	/**
+	 * @fn	static void StatsOverlay::setVisible(bool visible)
+	 *
+	 * @brief	Shows or hides the overlay. May be called from any thread.
+	 */
+	static void setVisible(bool visible) { StatsOverlay::visible = visible; }
+
+	/**
+	 * @fn	static bool StatsOverlay::isVisible()
+	 *
+	 * @brief	Returns true if the overlay is drawn.
+	 */
+	static bool isVisible() { return visible; }
+
+	/**
+	 * @fn	static void StatsOverlay::setConsoleInterval(int frames)
+	 *
+	 * @brief	Sets the number of frames between writing the text of the overlay to the
+	 * 			console. Zero to not write it.
+	 */
+	static void setConsoleInterval(int frames) { consoleInterval = frames; }
+
+protected:
+
+	/**
+	 * @struct	Quad
+	 *
+	 * @brief	A glyph or a solid rectangle. Layout of the instance buffer.
+	 */
+	struct Quad {
+
+		glm::vec4 rect; // Left, top, width and height in pixels from the top left corner
+
+		glm::vec4 color;
+
+		GLint glyph; // Index in the font. Negative for a solid rectangle.
+
+	}; // end Quad
+
+	/**
+	 * @fn	void StatsOverlay::addRect(float left, float top, float width, float height, const glm::vec4& color);
+	 *
+	 * @brief	Adds a solid rectangle.
+	 */
+	void addRect(float left, float top, float width, float height, const glm::vec4& color);
+
+	/**
+	 * @fn	void StatsOverlay::addText(float left, float top, const std::string& text, const glm::vec4& color);
+	 *
+	 * @brief	Adds a line of text. Lower case letters are drawn in upper case and characters
+	 * 			the font does not have are drawn as spaces.
+	 */
+	void addText(float left, float top, const std::string& text, const glm::vec4& color);
+
+	/** @brief	Frames kept in the histogram */
+	static const int HISTORY_FRAMES = 240;
+
+	/** @brief	Bins of the histogram. The last one counts every longer frame. */
+	static const int HISTOGRAM_BINS = 20;
+
+	/** @brief	Milliseconds covered by each bin */
+	static const float BIN_WIDTH;
+
+	/** @brief	Pixels each pixel of the font is scaled to */
+	static const int FONT_SCALE = 2;
+
+	static std::atomic<bool> visible;
+
+	static std::atomic<int> consoleInterval;
+
+	GLuint program = 0;
+
+	GLuint fontTexture = 0;
+
+	GLuint vao = 0;
+
+	GLuint instanceBuffer = 0;
+
+	/** @brief	Capacity of the instance buffer in quads */
+	size_t bufferCapacity = 0;
+
+	std::vector<Quad> quads;
+
+	Sample last;
+
+	/** @brief	Frame times of the recent frames. Used as a ring. */
+	std::vector<double> frameTimes;
+
+	/** @brief	Position in frameTimes of the next frame */
+	size_t nextFrame = 0;
+
+	int histogram[HISTOGRAM_BINS] = {};
+
+	/** @brief	Frames sampled since the text was written to the console */
+	int framesSincePrint = 0;
+
+	std::chrono::steady_clock::time_point lastSampleTime;
+
+	bool sampled = false;
+
+}; // end StatsOverlay class
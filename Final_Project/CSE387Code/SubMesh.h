@@ -0,0 +1,61 @@
+#pragma once
+
+#include "MathLibsConstsFuncs.h"
+#include "SharedMaterialProperties.h"
+
+struct MeshletSet;
+
+/**
+ * @enum	RENDER_MODE
+ *
+ * @brief	Values that represent render modes to be used when a sub-mesh if rendered.
+ */
+enum RENDER_MODE { ORDERED, INDEXED };
+
+/**
+ * @struct	SubMesh
+ *
+ * @brief	Stuct containing values needed to render a sub-mesh. All visible objects
+ * 			(Meshes) are rendered using one or more sub-meshes.
+ */
+struct SubMesh {
+
+	GLuint vao = GL_INVALID_VALUE; // ID for Vertex Array Object for the sub-mesh
+
+	GLuint vertexBuffer = GL_INVALID_VALUE; // ID for vertex data buffer for the sub-mesh
+
+	GLuint indexBuffer = GL_INVALID_VALUE; // ID for index buffer for the sub-mesh (if indexed rendering is used)
+
+	Material* material = nullptr; // Pointer to material properties including textures for the sub-mesh
+
+	GLuint count = 0; // Either the number of vertices in the mesh or the number of indices
+
+	RENDER_MODE renderMode = INDEXED; // Render mode for the mesh. Either ORDERED or INDEXED
+
+	GLuint primitiveMode = GL_TRIANGLES; // Primite mode for the mesh GL_POINTS, GL_LINES, etc.
+
+	MeshletSet* meshlets = nullptr; // Clusters of triangles culled separately. Null for small sub-meshes.
+
+}; // end SubMesh
+
+
+/**
+ * @struct	pntVertexData
+ *
+ * @brief	Structure for holding vertex data for a single vertex.
+ */
+struct pntVertexData
+{
+	glm::vec3 m_pos = ZERO_V3; // Position of the vertex in Object coordinates
+	glm::vec3 m_normal = ZERO_V3; // Normal vector for the vertex in Object coordinates
+	glm::vec2 m_textCoord = ZERO_V2; // 2D vertex texture coordinates
+
+	pntVertexData() {}
+
+	pntVertexData(glm::vec3 pos, glm::vec3 normal, glm::vec2 textCoord)
+	{
+		m_pos = pos;
+		m_normal = normal;
+		m_textCoord = textCoord;
+	}
+};
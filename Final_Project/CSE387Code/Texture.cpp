@@ -1,13 +1,20 @@
 #include "Texture.h"
+#include "CpuProfiler.h"
+#include "GLStateCache.h"
+#include "TextureManager.h"
 #include "FreeImage.h"
 
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+
 #define VERBOSE false
 
 // Static variable must be defined outside the declaration
 // Map containing all textures that have been loaded
 std::unordered_map<std::string, class Texture*> Texture::loadedTextures;
 
-bool Texture::load(const std::string& fileName)
+bool Texture::readImageFile(const std::string& fileName, std::vector<GLubyte>& rgba, int& width, int& height)
 {
 	// Analyze the bitmap signature to determine the file type
 	FREE_IMAGE_FORMAT format = FreeImage_GetFileType(fileName.c_str(), 0);
@@ -15,14 +22,19 @@ bool Texture::load(const std::string& fileName)
 	// Read the bitmap from the file
 	FIBITMAP* image = FreeImage_Load(format, fileName.c_str());
 
+	if (image == nullptr) {
+		std::cerr << "ERROR: Unable to load " << fileName << "!" << std::endl;
+		return false;
+	}
+
 	// Convert the bitmap to 32 bits
 	FIBITMAP* temp = image;
 	image = FreeImage_ConvertTo32Bits(image);
 	FreeImage_Unload(temp);
 
 	// Get the dimensions of the bitmap
-	int width = FreeImage_GetWidth(image);
-	int height = FreeImage_GetHeight(image);
+	width = FreeImage_GetWidth(image);
+	height = FreeImage_GetHeight(image);
 
 	// Check bitmap parameters to determine is a valid image was loaded
 	if (image == nullptr || width == 0 || height == 0) {
@@ -31,40 +43,393 @@ bool Texture::load(const std::string& fileName)
 	}
 
 	// Create a pointer to the bitmap data with the proper type
-	GLubyte* texture = new GLubyte[4 * width * height];
+	rgba.resize(4 * width * height);
 	char* texels = (char*)FreeImage_GetBits(image);
 
 	//FreeImage loads in BGR format, so you need to swap some bytes.
 	for (int j = 0; j < width * height; j++) {
-		texture[j * 4 + 0] = texels[j * 4 + 2];
-		texture[j * 4 + 1] = texels[j * 4 + 1];
-		texture[j * 4 + 2] = texels[j * 4 + 0];
-		texture[j * 4 + 3] = texels[j * 4 + 3];
+		rgba[j * 4 + 0] = texels[j * 4 + 2];
+		rgba[j * 4 + 1] = texels[j * 4 + 1];
+		rgba[j * 4 + 2] = texels[j * 4 + 0];
+		rgba[j * 4 + 3] = texels[j * 4 + 3];
 	}
 
-	glGenTextures(1, &this->textureID);
+	FreeImage_Unload(image);
 
-	// Assign texture to ID
-	glBindTexture(GL_TEXTURE_2D, this->textureID);
+	return true;
 
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*)texture);
+} // end readImageFile
 
-	if( VERBOSE ) std::cout << "Loaded: " << fileName.c_str() << " texture. width " << width << " height " << height << std::endl;
 
-	glGenerateMipmap(GL_TEXTURE_2D);
+bool Texture::load(const std::string& fileName)
+{
+	CPU_PROFILE_SCOPE("Texture::load");
+
+	std::vector<CompressedMipLevel> levels;
+
+	if (readLevels(levels) == false) {
+		return false;
+	}
+
+	this->width = levels[0].width;
+	this->height = levels[0].height;
+
+	levelSizes.clear();
+	for (auto& level : levels) {
+		levelSizes.push_back(level.data.size());
+	}
+
+	// Only the coarse levels are uploaded at first. Finer levels are streamed in
+	// by the TextureManager once the texture is seen on screen.
+	minimumLevel = 0;
+	while (minimumLevel < getLevelCount() - 1 &&
+		   std::max(levels[minimumLevel].width, levels[minimumLevel].height) > TextureManager::getInitialResidentSize()) {
+		minimumLevel++;
+	}
+
+	glGenTextures(1, &this->textureID);
+
+	// Assign texture to ID
+	GLStateCache::bindTexture(GL_TEXTURE_2D, this->textureID);
 
+	uploadLevels(levels, minimumLevel, getLevelCount() - 1);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, minimumLevel);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, getLevelCount() - 1);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 
-	FreeImage_Unload(image);
+	residentLevel = minimumLevel;
+	requestedLevel = minimumLevel;
+	memorySize = getMemorySize(residentLevel);
+	lastUsedFrame = TextureManager::getCurrentFrame();
+
+	if (VERBOSE) std::cout << "Loaded: " << fileName.c_str() << " texture. width " << width << " height " << height
+		<< " resident level " << residentLevel << (compressed ? " (compressed)" : "") << std::endl;
+
+	return true;
+
+} // end load
+
+
+bool Texture::readLevels(std::vector<CompressedMipLevel>& levels)
+{
+	if (readMipChain(fileName, levels, this->internalFormat) == false) {
+		return false;
+	}
+
+	this->compressed = (this->internalFormat != GL_RGBA);
+
+	return true;
+
+} // end readLevels
+
+
+bool Texture::readMipChain(const std::string& fileName, std::vector<CompressedMipLevel>& levels, GLenum& internalFormat)
+{
+	// Prefer a block compressed version of the texture if the transcoder has created one
+	CompressedImage image;
+
+	bool compressToBC3 = false;
+
+	// A cache file that exists but cannot be read is replaced with one encoded from the source image
+	bool replaceCache = false;
+
+	std::string cacheFileName = getCompressedCachePath(fileName);
+
+	if (readCompressedImage(cacheFileName, image)) {
+
+		if (isCompressedFormatSupported(image.format)) {
+
+			internalFormat = image.getGLInternalFormat();
+			levels.swap(image.levels);
+
+			return true;
+		}
+
+		// Contexts without BC7 are given BC3 compressed from the source image instead
+		compressToBC3 = (image.format == BC7 && isCompressedFormatSupported(BC3));
+
+		if (VERBOSE) std::cout << "Compressed format not supported for " << fileName << std::endl;
+	}
+	else {
+
+		std::error_code error;
+		replaceCache = std::filesystem::exists(cacheFileName, error);
+	}
+
+	internalFormat = GL_RGBA;
+
+	levels.clear();
+	levels.emplace_back();
+
+	if (readImageFile(fileName, levels[0].data, levels[0].width, levels[0].height) == false) {
+		return false;
+	}
+
+	if (compressToBC3 == true) {
+
+		compressImage(levels[0].data, levels[0].width, levels[0].height, BC3, image);
+
+		internalFormat = image.getGLInternalFormat();
+		levels.swap(image.levels);
+
+		return true;
+	}
+
+	if (replaceCache == true) {
+
+		image = CompressedImage();
+		compressImage(levels[0].data, levels[0].width, levels[0].height, BC_AUTO, image);
+
+		if (writeCompressedImage(cacheFileName, image) == false) {
+			std::cerr << "ERROR: Unable to replace " << cacheFileName << std::endl;
+		}
+
+		if (isCompressedFormatSupported(image.format)) {
+
+			internalFormat = image.getGLInternalFormat();
+			levels.swap(image.levels);
+
+			return true;
+		}
+	}
+
+	// Build the mip chain
+	while (levels.back().width > 1 || levels.back().height > 1) {
+
+		CompressedMipLevel nextLevel;
+		downsampleImage(levels.back().data, levels.back().width, levels.back().height,
+						nextLevel.data, nextLevel.width, nextLevel.height);
+
+		levels.push_back(std::move(nextLevel));
+	}
 
 	return true;
 
-}
+} // end readMipChain
+
+
+bool Texture::readLevelRange(const std::string& fileName, GLenum internalFormat, int firstLevel, int lastLevel,
+							 std::vector<CompressedMipLevel>& levels)
+{
+	CPU_PROFILE_SCOPE("Texture::readLevelRange");
+
+	if (internalFormat != GL_RGBA) {
+
+		// Only the requested levels are read from the compressed texture cache
+		CompressedImage image;
+
+		if (readCompressedImage(getCompressedCachePath(fileName), image, firstLevel, lastLevel) &&
+			image.getGLInternalFormat() == internalFormat) {
+
+			levels.swap(image.levels);
+
+			return true;
+		}
+
+		// BC3 may have been compressed from the source image when the context lacks BC7
+		if (internalFormat != GL_COMPRESSED_RGBA_S3TC_DXT5_EXT) {
+			return false;
+		}
+
+		std::vector<GLubyte> rgba;
+		int width = 0;
+		int height = 0;
+
+		if (readImageFile(fileName, rgba, width, height) == false) {
+			return false;
+		}
+
+		compressImage(rgba, width, height, BC3, image);
+
+		for (int level = 0; level < static_cast<int>(image.levels.size()); level++) {
+
+			if (level < firstLevel || level > lastLevel) {
+				std::vector<unsigned char>().swap(image.levels[level].data);
+			}
+		}
+
+		levels.swap(image.levels);
+
+		return static_cast<int>(levels.size()) > lastLevel;
+	}
+
+	levels.clear();
+	levels.emplace_back();
+
+	if (readImageFile(fileName, levels[0].data, levels[0].width, levels[0].height) == false) {
+		return false;
+	}
+
+	// The chain is built down to the last level. Finer levels than the first are dropped
+	// once the next level has been built from them.
+	while (static_cast<int>(levels.size()) <= lastLevel && (levels.back().width > 1 || levels.back().height > 1)) {
+
+		CompressedMipLevel nextLevel;
+		downsampleImage(levels.back().data, levels.back().width, levels.back().height,
+						nextLevel.data, nextLevel.width, nextLevel.height);
+
+		if (static_cast<int>(levels.size()) - 1 < firstLevel) {
+			std::vector<unsigned char>().swap(levels.back().data);
+		}
+
+		levels.push_back(std::move(nextLevel));
+	}
+
+	// Coarser levels only need their dimensions
+	while (levels.back().width > 1 || levels.back().height > 1) {
+
+		CompressedMipLevel nextLevel;
+		nextLevel.width = std::max(1, levels.back().width / 2);
+		nextLevel.height = std::max(1, levels.back().height / 2);
+
+		levels.push_back(std::move(nextLevel));
+	}
+
+	return static_cast<int>(levels.size()) > lastLevel;
+
+} // end readLevelRange
+
+
+void Texture::uploadLevels(const std::vector<CompressedMipLevel>& levels, int firstLevel, int lastLevel)
+{
+	for (int level = firstLevel; level <= lastLevel; level++) {
+
+		const CompressedMipLevel& mip = levels[level];
+
+		if (compressed) {
+
+			glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, mip.width, mip.height, 0,
+				static_cast<GLsizei>(mip.data.size()), &mip.data[0]);
+		}
+		else {
+
+			glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, mip.width, mip.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, &mip.data[0]);
+		}
+	}
+
+} // end uploadLevels
+
+
+bool Texture::streamIn(const std::vector<CompressedMipLevel>& levels, int baseLevel)
+{
+	baseLevel = glm::clamp(baseLevel, 0, getLevelCount() - 1);
+
+	if (baseLevel >= residentLevel) {
+		return true;
+	}
+
+	if (static_cast<int>(levels.size()) != getLevelCount()) {
+		return false;
+	}
+
+	GLStateCache::bindTexture(GL_TEXTURE_2D, this->textureID);
+
+	uploadLevels(levels, baseLevel, residentLevel - 1);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseLevel);
+
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+
+	if (VERBOSE) std::cout << "Streamed " << fileName << " in from level " << residentLevel << " to level " << baseLevel << std::endl;
+
+	residentLevel = baseLevel;
+	memorySize = getMemorySize(residentLevel);
+
+	return true;
+
+} // end streamIn
+
+
+void Texture::streamOut(int baseLevel)
+{
+	baseLevel = glm::clamp(baseLevel, 0, getLevelCount() - 1);
+
+	if (baseLevel <= residentLevel) {
+		return;
+	}
+
+	GLStateCache::bindTexture(GL_TEXTURE_2D, this->textureID);
+
+	// Stop sampling from the finer levels before releasing them
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseLevel);
+
+	// Respecifying a level with no texels releases its storage
+	for (int level = residentLevel; level < baseLevel; level++) {
+
+		glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	}
+
+	GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+
+	if (VERBOSE) std::cout << "Streamed " << fileName << " out from level " << residentLevel << " to level " << baseLevel << std::endl;
+
+	residentLevel = baseLevel;
+	memorySize = getMemorySize(residentLevel);
+
+} // end streamOut
+
+
+size_t Texture::getMemorySize(int baseLevel) const
+{
+	size_t size = 0;
+
+	for (int level = std::max(baseLevel, 0); level < getLevelCount(); level++) {
+		size += levelSizes[level];
+	}
+
+	return size;
+
+} // end getMemorySize
+
+
+void Texture::requestDetail(float screenSize)
+{
+	// Level at which one texel covers about one pixel
+	int level = 0;
+
+	int largestDimension = std::max(width, height);
+
+	if (screenSize < largestDimension) {
+
+		level = static_cast<int>(std::floor(std::log2(largestDimension / std::max(screenSize, 1.0f))));
+		level = glm::clamp(level, 0, getLevelCount() - 1);
+	}
+
+	// Keep the finest level requested during the frame
+	if (lastUsedFrame != TextureManager::getCurrentFrame()) {
+
+		lastUsedFrame = TextureManager::getCurrentFrame();
+		requestedLevel = level;
+	}
+	else {
+
+		requestedLevel = std::min(requestedLevel, level);
+	}
+
+} // end requestDetail
+
+
+void Texture::release()
+{
+	if (referenceCount > 0) {
+
+		referenceCount--;
+	}
+
+} // end release
+
+
+std::string Texture::getCompressedCachePath(const std::string& fileName)
+{
+	return fileName + ".dds";
+
+} // end getCompressedCachePath
 
 
 void Texture::unload()
@@ -72,8 +437,15 @@ void Texture::unload()
 	// Remove the Texture object from the Map
 	loadedTextures.erase(fileName);
 
+	// Levels being read for the texture are no longer needed
+	if (streamingLevel >= 0) {
+
+		TextureManager::cancelStreaming(this);
+		streamingLevel = -1;
+	}
+
 	// Delete the texture object
-	glDeleteTextures(1, &textureID);
+	GLStateCache::deleteTextures(1, &textureID);
 
 } // unload
 
@@ -91,6 +463,7 @@ Texture* Texture::GetTexture(const std::string& fileName)
 
 		if (VERBOSE) std::cout << "Retrieving texture: " << fileName << std::endl;
 		texturePtr = iter->second;
+		texturePtr->referenceCount++;
 	}
 	else {
 
@@ -104,6 +477,7 @@ Texture* Texture::GetTexture(const std::string& fileName)
 
 			// Add the loaded texture to those that were previously loaded
 			loadedTextures.emplace(fileName, texturePtr);
+			texturePtr->referenceCount = 1;
 		}
 		else {
 			delete texturePtr;
@@ -118,10 +492,12 @@ Texture* Texture::GetTexture(const std::string& fileName)
 
 void Texture::unloadTextures()
 {
-	// Destroy textures
-	for (auto i : loadedTextures) {
-		i.second->unload();
+	// Destroy textures. Unloading removes the texture from the map.
+	while (!loadedTextures.empty()) {
+
+		Texture* texture = loadedTextures.begin()->second;
+		texture->unload();
+		delete texture;
 	}
-	loadedTextures.clear();
 
 } // end unloadTextures
@@ -3,6 +3,7 @@
 #include <unordered_map>
 
 #include "MathLibsConstsFuncs.h"
+#include "TextureCompression.h"
 
 class Texture
 {
@@ -11,7 +12,9 @@ public:
 	/**
 	 * @fn	static Texture* Texture::GetTexture(const std::string& fileName);
 	 *
-	 * @brief	Load a texture or retrieves it if it was loaded previously
+	 * @brief	Load a texture or retrieves it if it was loaded previously. Increments
+	 * 			the reference count of the texture. Call release when the texture
+	 * 			is no longer needed.
 	 *
 	 * @param	fileName	Contains the relative path and the name of the file.
 	 *
@@ -26,6 +29,72 @@ public:
 	 */
 	static void unloadTextures();
 
+	/**
+	 * @fn	static std::string Texture::getCompressedCachePath(const std::string& fileName);
+	 *
+	 * @brief	Gets the path of the block compressed version of a texture. Compressed
+	 * 			versions are created offline by the TextureTranscoder and are stored next
+	 * 			to the source image.
+	 *
+	 * @param	fileName	Relative path and name of the source image.
+	 *
+	 * @returns	The path of the compressed texture.
+	 */
+	static std::string getCompressedCachePath(const std::string& fileName);
+
+	/**
+	 * @fn	static bool Texture::readImageFile(const std::string& fileName, std::vector<GLubyte>& rgba, int& width, int& height);
+	 *
+	 * @brief	Reads an image using FreeImage and converts it to tightly packed RGBA8 texels.
+	 *
+	 * @param 		  	fileName	The name of the file containing the image.
+	 * @param [out]	rgba		The texels of the image.
+	 * @param [out]	width   	The width of the image.
+	 * @param [out]	height  	The height of the image.
+	 *
+	 * @returns	True if it succeeds, false if it fails.
+	 */
+	static bool readImageFile(const std::string& fileName, std::vector<GLubyte>& rgba, int& width, int& height);
+
+	/**
+	 * @fn	static bool Texture::readMipChain(const std::string& fileName, std::vector<CompressedMipLevel>& levels, GLenum& internalFormat);
+	 *
+	 * @brief	Reads the complete mip chain for a texture file. Block compressed levels are read
+	 * 			from the compressed texture cache if it exists and the format is supported.
+	 * 			Otherwise the source image is read with FreeImage and the mip levels are
+	 * 			built with a box filter. In that case the level data is RGBA8, or BC3 if the
+	 * 			cache holds BC7, which the context does not support.
+	 *
+	 * @param 		  	fileName	  	The name of the file containing the texture image.
+	 * @param [out]	levels		  	The mip levels.
+	 * @param [out]	internalFormat	OpenGL internal format of the levels. GL_RGBA if the
+	 * 								levels are not compressed.
+	 *
+	 * @returns	True if it succeeds, false if it fails.
+	 */
+	static bool readMipChain(const std::string& fileName, std::vector<CompressedMipLevel>& levels, GLenum& internalFormat);
+
+	/**
+	 * @fn	static bool Texture::readLevelRange(const std::string& fileName, GLenum internalFormat, int firstLevel, int lastLevel, std::vector<CompressedMipLevel>& levels);
+	 *
+	 * @brief	Reads a range of the mip levels of a texture file in the format the texture
+	 * 			was loaded with. Compressed levels are read from the compressed texture cache
+	 * 			without reading the other levels. Uncompressed levels are built from the source
+	 * 			image down to the last level, and BC3 levels that replaced BC7 are compressed
+	 * 			from it again. Makes no OpenGL calls so it can be called by the
+	 * 			TextureLoader.
+	 *
+	 * @param 		  	fileName	  	The name of the file containing the texture image.
+	 * @param 		  	internalFormat	OpenGL internal format the texture was loaded with.
+	 * @param 		  	firstLevel	  	Finest level to read.
+	 * @param 		  	lastLevel	  	Coarsest level to read.
+	 * @param [out]	levels		  	The mip levels. Only the levels of the range have data.
+	 *
+	 * @returns	True if it succeeds, false if the levels cannot be read in that format.
+	 */
+	static bool readLevelRange(const std::string& fileName, GLenum internalFormat, int firstLevel, int lastLevel,
+							   std::vector<CompressedMipLevel>& levels);
+
 	/**
 	 * @fn	int Texture::getWidth() const
 	 *
@@ -53,17 +122,100 @@ public:
 	 */
 	unsigned int getTextureObject() const { return textureID; }
 
+	/**
+	 * @fn	bool Texture::isCompressed() const
+	 *
+	 * @brief	Indicates if the texture was loaded from the compressed texture cache.
+	 *
+	 * @returns	True if the texture is block compressed.
+	 */
+	bool isCompressed() const { return compressed; }
+
+	/**
+	 * @fn	size_t Texture::getMemorySize() const
+	 *
+	 * @brief	Gets the approximate size in bytes of the mip levels that are presently
+	 * 			resident in GPU memory.
+	 *
+	 * @returns	The memory size.
+	 */
+	size_t getMemorySize() const { return memorySize; }
+
+	/**
+	 * @fn	size_t Texture::getMemorySize(int baseLevel) const;
+	 *
+	 * @brief	Gets the size in bytes of the texture if the specified level and all coarser
+	 * 			levels were resident.
+	 *
+	 * @param	baseLevel	The finest resident mip level.
+	 *
+	 * @returns	The memory size.
+	 */
+	size_t getMemorySize(int baseLevel) const;
+
+	/**
+	 * @fn	int Texture::getLevelCount() const
+	 *
+	 * @brief	Gets the number of levels in the complete mip chain.
+	 */
+	int getLevelCount() const { return static_cast<int>(levelSizes.size()); }
+
+	/**
+	 * @fn	int Texture::getResidentLevel() const
+	 *
+	 * @brief	Gets the finest mip level that is presently resident. Zero if the full
+	 * 			resolution image is resident.
+	 */
+	int getResidentLevel() const { return residentLevel; }
+
+	/**
+	 * @fn	int Texture::getReferenceCount() const
+	 *
+	 * @brief	Gets the number of users of this texture.
+	 */
+	int getReferenceCount() const { return referenceCount; }
+
+	/**
+	 * @fn	void Texture::requestDetail(float screenSize);
+	 *
+	 * @brief	Called each time the texture is used for rendering. Records when the texture
+	 * 			was last used and the mip level needed for the on-screen size of the object
+	 * 			the texture is applied to. The TextureManager uses this information to stream
+	 * 			mip levels in and out at the end of the frame.
+	 *
+	 * @param	screenSize	Approximate size in pixels of the textured object on the screen.
+	 */
+	void requestDetail(float screenSize);
+
+	/**
+	 * @fn	void Texture::release();
+	 *
+	 * @brief	Releases one reference to the texture that was obtained by calling
+	 * 			GetTexture. Textures that are no longer referenced remain loaded until
+	 * 			the TextureManager needs their memory.
+	 */
+	void release();
+
+	/**
+	 * @fn	void Texture::retain()
+	 *
+	 * @brief	Takes another reference to a texture that is already referenced, such as
+	 * 			when a material that uses it is copied. Call release when it is no longer
+	 * 			needed.
+	 */
+	void retain() { referenceCount++; }
+
 	/**
 	 * @fn	void Texture::unload();
 	 *
 	 * @brief	Deletes the texture object associated with this
-	 * 			texture. CURRENT IMPLEMENTATION DOES NOT ACCOUNT
-	 * 			MULTIPLE USES OF THE SAME TEXTURE BY DIFFERENT
-	 * 			SUB MESHES. UNLOADING IT HERE WILL REMOVE IT
-	 * 			FOR ALL SUBMESHES.
+	 * 			texture. Does not check the reference count. Use
+	 * 			release to give up a reference to the texture.
 	 */
 	void unload();
 
+	friend class TextureManager;
+
 protected:
 
 	/**
@@ -87,6 +239,48 @@ protected:
 	 */
 	bool load(const std::string& fileName);
 
+	/**
+	 * @fn	bool Texture::readLevels(std::vector<CompressedMipLevel>& levels);
+	 *
+	 * @brief	Reads the complete mip chain for this texture. See readMipChain.
+	 *
+	 * @param [out]	levels	The mip levels.
+	 *
+	 * @returns	True if it succeeds, false if it fails.
+	 */
+	bool readLevels(std::vector<CompressedMipLevel>& levels);
+
+	/**
+	 * @fn	bool Texture::streamIn(const std::vector<CompressedMipLevel>& levels, int baseLevel);
+	 *
+	 * @brief	Uploads finer mip levels that were read by the TextureLoader and makes the
+	 * 			finest of them the finest resident level. The texture object itself does not
+	 * 			change.
+	 *
+	 * @param	levels   	The mip levels. Must have data from the base level to the level
+	 * 						before the resident level.
+	 * @param	baseLevel	The new finest resident mip level.
+	 *
+	 * @returns	True if it succeeds, false if the levels do not match the texture.
+	 */
+	bool streamIn(const std::vector<CompressedMipLevel>& levels, int baseLevel);
+
+	/**
+	 * @fn	void Texture::streamOut(int baseLevel);
+	 *
+	 * @brief	Makes a coarser mip level the finest resident level. Levels that are no longer
+	 * 			needed are released.
+	 *
+	 * @param	baseLevel	The new finest resident mip level.
+	 */
+	void streamOut(int baseLevel);
+
+	/**
+	 * @fn	void Texture::uploadLevels(const std::vector<CompressedMipLevel>& levels, int firstLevel, int lastLevel);
+	 *
+	 * @brief	Uploads a range of mip levels to the bound texture object.
+	 */
+	void uploadLevels(const std::vector<CompressedMipLevel>& levels, int firstLevel, int lastLevel);
 
 	/** @brief	OpenGL ID of this texture */
 	unsigned int textureID = 0;
@@ -99,6 +293,39 @@ protected:
 	int width = 0;
 	int height = 0;
 
+	/** @brief	True if the texture was loaded from the compressed texture cache */
+	bool compressed = false;
+
+	/** @brief	Approximate size in bytes of the resident mip levels */
+	size_t memorySize = 0;
+
+	/** @brief	OpenGL internal format of the texture */
+	GLenum internalFormat = GL_RGBA;
+
+	/** @brief	Size in bytes of each level in the complete mip chain */
+	std::vector<size_t> levelSizes;
+
+	/** @brief	Finest mip level that is resident in GPU memory */
+	int residentLevel = 0;
+
+	/** @brief	Coarsest level at which the texture is kept while it is referenced */
+	int minimumLevel = 0;
+
+	/** @brief	Finest mip level needed during the frame the texture was last used */
+	int requestedLevel = 0;
+
+	/** @brief	Finest mip level being read by the TextureLoader. Negative if none are. */
+	int streamingLevel = -1;
+
+	/** @brief	Bytes of the budget reserved for the levels being read */
+	size_t streamingBytes = 0;
+
+	/** @brief	Frame in which the texture was last used for rendering */
+	unsigned int lastUsedFrame = 0;
+
+	/** @brief	Number of users that called GetTexture and have not released the texture */
+	int referenceCount = 0;
+
 	/** @brief	Map of ALL texture that have been loaded. textures loaded */
 	static std::unordered_map<std::string, class Texture*> loadedTextures;
 
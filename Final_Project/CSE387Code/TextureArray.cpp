@@ -0,0 +1,188 @@
+#include "TextureArray.h"
+#include "GLStateCache.h"
+#include "Texture.h"
+
+#define VERBOSE false
+
+// Static variables must be defined outside the declaration
+std::vector<TextureArray*> TextureArray::textureArrays;
+std::unordered_map<std::string, TextureArrayLayer> TextureArray::loadedLayers;
+bool TextureArray::arraysEnabled = false;
+
+TextureArray::TextureArray(int width, int height, GLenum internalFormat, int levelCount)
+	: width(width), height(height), internalFormat(internalFormat), levelCount(levelCount)
+{
+}
+
+
+TextureArrayLayer TextureArray::GetTextureLayer(const std::string& fileName)
+{
+	// Search for the texture among those that were previously added
+	auto iter = loadedLayers.find(fileName);
+
+	if (iter != loadedLayers.end()) {
+
+		if (VERBOSE) std::cout << "Retrieving texture layer: " << fileName << std::endl;
+		return iter->second;
+	}
+
+	TextureArrayLayer textureLayer;
+
+	std::vector<CompressedMipLevel> levels;
+	GLenum internalFormat = GL_RGBA;
+
+	if (Texture::readMipChain(fileName, levels, internalFormat) == false) {
+		return textureLayer;
+	}
+
+	int width = levels[0].width;
+	int height = levels[0].height;
+
+	GLint maxLayers = 0;
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+	// Find an array with the same size and format that has room for another layer
+	for (auto textureArray : textureArrays) {
+
+		if (textureArray->width == width && textureArray->height == height &&
+			textureArray->internalFormat == internalFormat && textureArray->getLayerCount() < maxLayers) {
+
+			textureLayer.textureArray = textureArray;
+			break;
+		}
+	}
+
+	if (textureLayer.textureArray == nullptr) {
+
+		textureLayer.textureArray = new TextureArray(width, height, internalFormat, static_cast<int>(levels.size()));
+		textureArrays.push_back(textureLayer.textureArray);
+	}
+
+	TextureArray* textureArray = textureLayer.textureArray;
+
+	textureLayer.layer = textureArray->getLayerCount();
+	textureArray->layerFileNames.push_back(fileName);
+	textureArray->pendingLayers[textureLayer.layer].swap(levels);
+	textureArray->buildNeeded = true;
+
+	loadedLayers.emplace(fileName, textureLayer);
+
+	if (VERBOSE) std::cout << "Added " << fileName << " to texture array layer " << textureLayer.layer << std::endl;
+
+	return textureLayer;
+
+} // end GetTextureLayer
+
+
+GLuint TextureArray::getTextureObject()
+{
+	if (buildNeeded) {
+
+		build();
+	}
+
+	return textureID;
+
+} // end getTextureObject
+
+
+void TextureArray::build()
+{
+	// The sizes of the levels are taken from a layer that was just added
+	if (pendingLayers.empty()) {
+
+		buildNeeded = false;
+		return;
+	}
+
+	if (textureID == 0) {
+
+		glGenTextures(1, &textureID);
+	}
+
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+
+	GLsizei layerCount = static_cast<GLsizei>(getLayerCount());
+	bool compressed = (internalFormat != GL_RGBA);
+
+	// (Re)allocate storage for all layers of every level. Respecifying the levels
+	// keeps the same texture object.
+	std::vector<CompressedMipLevel>& firstLayer = pendingLayers.begin()->second;
+
+	for (int level = 0; level < levelCount; level++) {
+
+		const CompressedMipLevel& mip = firstLayer[level];
+
+		if (compressed) {
+
+			glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, internalFormat, mip.width, mip.height, layerCount, 0,
+				static_cast<GLsizei>(mip.data.size()) * layerCount, nullptr);
+		}
+		else {
+
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA, mip.width, mip.height, layerCount, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		}
+	}
+
+	for (int layer = 0; layer < layerCount; layer++) {
+
+		std::vector<CompressedMipLevel> levels;
+		GLenum layerFormat = internalFormat;
+
+		auto pending = pendingLayers.find(layer);
+
+		if (pending != pendingLayers.end()) {
+
+			levels.swap(pending->second);
+		}
+		else if (Texture::readMipChain(layerFileNames[layer], levels, layerFormat) == false || layerFormat != internalFormat) {
+
+			std::cerr << "ERROR: Unable to reload " << layerFileNames[layer] << " into a texture array!" << std::endl;
+			continue;
+		}
+
+		for (int level = 0; level < levelCount; level++) {
+
+			const CompressedMipLevel& mip = levels[level];
+
+			if (compressed) {
+
+				glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, mip.width, mip.height, 1, internalFormat,
+					static_cast<GLsizei>(mip.data.size()), &mip.data[0]);
+			}
+			else {
+
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, mip.width, mip.height, 1, GL_RGBA, GL_UNSIGNED_BYTE, &mip.data[0]);
+			}
+		}
+	}
+
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	pendingLayers.clear();
+	buildNeeded = false;
+
+	if (VERBOSE) std::cout << "Built texture array " << width << "x" << height << " with " << layerCount << " layers" << std::endl;
+
+} // end build
+
+
+void TextureArray::unloadTextureArrays()
+{
+	for (auto textureArray : textureArrays) {
+
+		GLStateCache::deleteTextures(1, &textureArray->textureID);
+		delete textureArray;
+	}
+
+	textureArrays.clear();
+	loadedLayers.clear();
+
+} // end unloadTextureArrays
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "MathLibsConstsFuncs.h"
+#include "TextureCompression.h"
+
+/**
+ * @struct	TextureArrayLayer
+ *
+ * @brief	Identifies a single texture that was packed into a texture array.
+ */
+struct TextureArrayLayer {
+
+	class TextureArray* textureArray = nullptr; // Array holding the texture. Null if loading failed.
+
+	int layer = -1; // Layer of the array that holds the texture
+
+}; // end TextureArrayLayer
+
+
+/**
+ * @class	TextureArray
+ *
+ * @brief	Alternative to individual Texture objects. Textures with the same size and format
+ * 			are packed into the layers of a GL_TEXTURE_2D_ARRAY. Materials that use textures
+ * 			from the same array can be rendered one after another without binding a different
+ * 			texture. Materials select the texture with a layer index.
+ *
+ * 			Arrays are built the first time their texture object is needed and are rebuilt
+ * 			if more layers are added later. All layers are resident at full resolution.
+ * 			Arrays are not managed by the TextureManager.
+ */
+class TextureArray
+{
+public:
+
+	/**
+	 * @fn	static TextureArrayLayer TextureArray::GetTextureLayer(const std::string& fileName);
+	 *
+	 * @brief	Adds a texture to an array with a matching size and format, or retrieves the
+	 * 			layer if the texture was added previously.
+	 *
+	 * @param	fileName	Contains the relative path and the name of the file.
+	 *
+	 * @returns	The array and layer holding the texture. The array is null if loading fails.
+	 */
+	static TextureArrayLayer GetTextureLayer(const std::string& fileName);
+
+	/**
+	 * @fn	static void TextureArray::unloadTextureArrays();
+	 *
+	 * @brief	Deletes ALL texture arrays.
+	 */
+	static void unloadTextureArrays();
+
+	/**
+	 * @fn	static void TextureArray::setEnabled(bool enabled)
+	 *
+	 * @brief	Selects whether models pack their textures into texture arrays instead of
+	 * 			loading individual textures. Must be set before models are initialized.
+	 */
+	static void setEnabled(bool enabled) { arraysEnabled = enabled; }
+
+	/**
+	 * @fn	static bool TextureArray::isEnabled()
+	 *
+	 * @brief	Indicates if models pack their textures into texture arrays.
+	 */
+	static bool isEnabled() { return arraysEnabled; }
+
+	/**
+	 * @fn	GLuint TextureArray::getTextureObject();
+	 *
+	 * @brief	Gets the OpenGL texture object for the array. Builds the array if layers were
+	 * 			added since it was last built. The identifier does not change when the array is
+	 * 			rebuilt.
+	 *
+	 * @returns	The texture object.
+	 */
+	GLuint getTextureObject();
+
+	/**
+	 * @fn	int TextureArray::getLayerCount() const
+	 *
+	 * @brief	Gets the number of layers in the array.
+	 */
+	int getLayerCount() const { return static_cast<int>(layerFileNames.size()); }
+
+protected:
+
+	/**
+	 * @fn	TextureArray::TextureArray(int width, int height, GLenum internalFormat, int levelCount);
+	 *
+	 * @brief	Constructor. Protected so that arrays are only created by GetTextureLayer.
+	 */
+	TextureArray(int width, int height, GLenum internalFormat, int levelCount);
+
+	/**
+	 * @fn	void TextureArray::build();
+	 *
+	 * @brief	Allocates storage for all layers and uploads every mip level of every layer.
+	 * 			Layers that were uploaded by a previous build are read again.
+	 */
+	void build();
+
+	/** @brief	OpenGL ID of the array texture */
+	GLuint textureID = 0;
+
+	/** @brief	Width/height in texels of each layer */
+	int width = 0;
+	int height = 0;
+
+	/** @brief	OpenGL internal format of each layer */
+	GLenum internalFormat = GL_RGBA;
+
+	/** @brief	Number of mip levels of each layer */
+	int levelCount = 0;
+
+	/** @brief	Filename and relative path of the texture held in each layer */
+	std::vector<std::string> layerFileNames;
+
+	/** @brief	Mip levels of layers that have not been uploaded yet, by layer */
+	std::unordered_map<int, std::vector<CompressedMipLevel>> pendingLayers;
+
+	/** @brief	True if layers were added since the array was last built */
+	bool buildNeeded = true;
+
+	/** @brief	All texture arrays that have been created */
+	static std::vector<TextureArray*> textureArrays;
+
+	/** @brief	Layers for ALL textures that have been added to arrays by filename */
+	static std::unordered_map<std::string, TextureArrayLayer> loadedLayers;
+
+	/** @brief	True if models pack their textures into texture arrays */
+	static bool arraysEnabled;
+
+}; // end TextureArray class
@@ -0,0 +1,794 @@
+#include "TextureCompression.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#define VERBOSE false
+
+//********************* DDS container constants *****************************************
+
+static const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+static const uint32_t DDSD_CAPS = 0x1;
+static const uint32_t DDSD_HEIGHT = 0x2;
+static const uint32_t DDSD_WIDTH = 0x4;
+static const uint32_t DDSD_PIXELFORMAT = 0x1000;
+static const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+static const uint32_t DDSD_LINEARSIZE = 0x80000;
+
+static const uint32_t DDPF_FOURCC = 0x4;
+
+static const uint32_t DDSCAPS_COMPLEX = 0x8;
+static const uint32_t DDSCAPS_TEXTURE = 0x1000;
+static const uint32_t DDSCAPS_MIPMAP = 0x400000;
+
+// Number of 32 bit words in the DDS header and the DX10 extension of the header
+static const int DDS_HEADER_WORDS = 31;
+static const int DDS_DX10_HEADER_WORDS = 5;
+
+// Word offsets of the fields in the DDS header that are used
+static const int HEADER_SIZE = 0;
+static const int HEADER_FLAGS = 1;
+static const int HEADER_HEIGHT = 2;
+static const int HEADER_WIDTH = 3;
+static const int HEADER_LINEAR_SIZE = 4;
+static const int HEADER_MIP_COUNT = 6;
+static const int HEADER_PF_SIZE = 18;
+static const int HEADER_PF_FLAGS = 19;
+static const int HEADER_PF_FOURCC = 20;
+static const int HEADER_CAPS = 26;
+
+// Largest width or height accepted from a DDS file
+static const uint32_t MAX_DIMENSION = 16384;
+
+// DXGI formats used in the DX10 header
+static const uint32_t DXGI_FORMAT_BC1_TYPELESS = 70;
+static const uint32_t DXGI_FORMAT_BC1_UNORM = 71;
+static const uint32_t DXGI_FORMAT_BC3_TYPELESS = 76;
+static const uint32_t DXGI_FORMAT_BC3_UNORM = 77;
+static const uint32_t DXGI_FORMAT_BC5_TYPELESS = 82;
+static const uint32_t DXGI_FORMAT_BC5_UNORM = 83;
+static const uint32_t DXGI_FORMAT_BC7_TYPELESS = 97;
+static const uint32_t DXGI_FORMAT_BC7_UNORM = 98;
+
+static const uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+static uint32_t makeFourCC(char a, char b, char c, char d)
+{
+	return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+		(static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+//********************* Format information *****************************************
+
+int getBlockSize(CompressedFormat format)
+{
+	return (format == BC1) ? 8 : 16;
+
+} // end getBlockSize
+
+
+GLenum CompressedImage::getGLInternalFormat() const
+{
+	switch (format) {
+
+	case BC1:
+		return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case BC3:
+		return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case BC5:
+		return GL_COMPRESSED_RG_RGTC2;
+	case BC7:
+		return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	default:
+		return GL_NONE;
+	}
+
+} // end getGLInternalFormat
+
+
+size_t CompressedImage::getSizeInBytes() const
+{
+	size_t size = 0;
+
+	for (auto& level : levels) {
+
+		size += level.data.size();
+	}
+
+	return size;
+
+} // end getSizeInBytes
+
+
+// Searches the extension list of the current context
+static bool hasExtension(const char* name)
+{
+	GLint numExtensions = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+
+	for (GLint i = 0; i < numExtensions; i++) {
+
+		const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+
+		if (extension != nullptr && strcmp(extension, name) == 0) {
+			return true;
+		}
+	}
+
+	return false;
+
+} // end hasExtension
+
+
+bool isCompressedFormatSupported(CompressedFormat format)
+{
+	// BC5 (RGTC) is core in OpenGL 3.0
+	if (format == BC5) {
+		return true;
+	}
+
+	// Search the extension list only once for each format
+	static int s3tcSupported = -1;
+	static int bptcSupported = -1;
+
+	if (format == BC7) {
+
+		if (bptcSupported < 0) {
+
+			// BC7 (BPTC) is core in OpenGL 4.2. The game requests a 4.0 context, which may
+			// still have the extension.
+			GLint majorVersion = 0;
+			GLint minorVersion = 0;
+			glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+			glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+			bool core = majorVersion > 4 || (majorVersion == 4 && minorVersion >= 2);
+
+			bptcSupported = (core || hasExtension("GL_ARB_texture_compression_bptc")) ? 1 : 0;
+		}
+
+		return bptcSupported == 1;
+	}
+
+	// S3TC is an extension
+	if (s3tcSupported < 0) {
+
+		s3tcSupported = hasExtension("GL_EXT_texture_compression_s3tc") ? 1 : 0;
+	}
+
+	return s3tcSupported == 1;
+
+} // end isCompressedFormatSupported
+
+//********************* Block encoders *****************************************
+
+// Copies a 4x4 block of RGBA texels. Texels outside the image are clamped to the edge.
+static void fetchBlock(const GLubyte* rgba, int width, int height, int blockX, int blockY, GLubyte block[16][4])
+{
+	for (int y = 0; y < 4; y++) {
+
+		int row = std::min(blockY * 4 + y, height - 1);
+
+		for (int x = 0; x < 4; x++) {
+
+			int column = std::min(blockX * 4 + x, width - 1);
+
+			const GLubyte* texel = rgba + 4 * (row * width + column);
+
+			for (int c = 0; c < 4; c++) {
+				block[y * 4 + x][c] = texel[c];
+			}
+		}
+	}
+
+} // end fetchBlock
+
+
+// Finds end points for a block along the diagonal of its bounding box. Channels that are
+// negatively correlated with red are flipped so the diagonal follows the spread of the texels.
+static void findEndPoints(const GLubyte block[16][4], int channels, int high[4], int low[4])
+{
+	float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	for (int c = 0; c < channels; c++) {
+
+		high[c] = 0;
+		low[c] = 255;
+
+		for (int i = 0; i < 16; i++) {
+
+			high[c] = std::max(high[c], static_cast<int>(block[i][c]));
+			low[c] = std::min(low[c], static_cast<int>(block[i][c]));
+			mean[c] += block[i][c] / 16.0f;
+		}
+	}
+
+	for (int c = 1; c < channels; c++) {
+
+		float covariance = 0.0f;
+
+		for (int i = 0; i < 16; i++) {
+			covariance += (block[i][0] - mean[0]) * (block[i][c] - mean[c]);
+		}
+
+		if (covariance < 0.0f) {
+			std::swap(high[c], low[c]);
+		}
+	}
+
+} // end findEndPoints
+
+
+static unsigned short packRGB565(const int rgb[3])
+{
+	int r = (rgb[0] * 31 + 127) / 255;
+	int g = (rgb[1] * 63 + 127) / 255;
+	int b = (rgb[2] * 31 + 127) / 255;
+
+	return static_cast<unsigned short>((r << 11) | (g << 5) | b);
+
+} // end packRGB565
+
+
+static void unpackRGB565(unsigned short color, int rgb[3])
+{
+	int r = (color >> 11) & 31;
+	int g = (color >> 5) & 63;
+	int b = color & 31;
+
+	rgb[0] = (r << 3) | (r >> 2);
+	rgb[1] = (g << 2) | (g >> 4);
+	rgb[2] = (b << 3) | (b >> 2);
+
+} // end unpackRGB565
+
+
+// Encodes the color of a block as an 8 byte BC1 block using the four color mode.
+static void encodeBC1Block(const GLubyte block[16][4], unsigned char* out)
+{
+	int high[4], low[4];
+	findEndPoints(block, 3, high, low);
+
+	unsigned short color0 = packRGB565(high);
+	unsigned short color1 = packRGB565(low);
+
+	// Four color mode requires color0 > color1
+	if (color0 < color1) {
+		std::swap(color0, color1);
+	}
+
+	uint32_t indices = 0;
+
+	if (color0 != color1) {
+
+		int palette[4][3];
+		unpackRGB565(color0, palette[0]);
+		unpackRGB565(color1, palette[1]);
+
+		for (int c = 0; c < 3; c++) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		for (int i = 0; i < 16; i++) {
+
+			int bestIndex = 0;
+			int bestError = std::numeric_limits<int>::max();
+
+			for (int p = 0; p < 4; p++) {
+
+				int error = 0;
+
+				for (int c = 0; c < 3; c++) {
+					int difference = block[i][c] - palette[p][c];
+					error += difference * difference;
+				}
+
+				if (error < bestError) {
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+
+			indices |= static_cast<uint32_t>(bestIndex) << (2 * i);
+		}
+	}
+
+	out[0] = color0 & 0xFF;
+	out[1] = color0 >> 8;
+	out[2] = color1 & 0xFF;
+	out[3] = color1 >> 8;
+
+	for (int i = 0; i < 4; i++) {
+		out[4 + i] = (indices >> (8 * i)) & 0xFF;
+	}
+
+} // end encodeBC1Block
+
+
+// Encodes a single channel of a block as an 8 byte BC4 block using the eight value mode.
+static void encodeBC4Block(const GLubyte block[16][4], int channel, unsigned char* out)
+{
+	int high = 0;
+	int low = 255;
+
+	for (int i = 0; i < 16; i++) {
+		high = std::max(high, static_cast<int>(block[i][channel]));
+		low = std::min(low, static_cast<int>(block[i][channel]));
+	}
+
+	uint64_t indices = 0;
+
+	if (high != low) {
+
+		int palette[8] = { high, low };
+
+		for (int p = 2; p < 8; p++) {
+			palette[p] = ((8 - p) * high + (p - 1) * low) / 7;
+		}
+
+		for (int i = 0; i < 16; i++) {
+
+			int bestIndex = 0;
+			int bestError = std::numeric_limits<int>::max();
+
+			for (int p = 0; p < 8; p++) {
+
+				int error = abs(block[i][channel] - palette[p]);
+
+				if (error < bestError) {
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+
+			indices |= static_cast<uint64_t>(bestIndex) << (3 * i);
+		}
+	}
+
+	out[0] = static_cast<unsigned char>(high);
+	out[1] = static_cast<unsigned char>(low);
+
+	for (int i = 0; i < 6; i++) {
+		out[2 + i] = (indices >> (8 * i)) & 0xFF;
+	}
+
+} // end encodeBC4Block
+
+
+// Writes bit fields into a compressed block starting at the least significant bit.
+struct BlockBitWriter {
+
+	unsigned char* out;
+	int bit = 0;
+
+	BlockBitWriter(unsigned char* out) : out(out) {}
+
+	void write(unsigned int value, int count)
+	{
+		for (int i = 0; i < count; i++, bit++) {
+
+			if ((value >> i) & 1) {
+				out[bit >> 3] |= 1 << (bit & 7);
+			}
+		}
+	}
+};
+
+
+// Encodes a block as a 16 byte BC7 block using mode 6 (single subset, RGBA end points
+// with seven bits per channel plus a unique p-bit, four bit indices).
+static void encodeBC7Block(const GLubyte block[16][4], unsigned char* out)
+{
+	static const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	int endPoints[2][4];
+	findEndPoints(block, 4, endPoints[0], endPoints[1]);
+
+	// Quantize the end points to seven bits plus a p-bit choosing the p-bit with the least error
+	int quantized[2][4];
+	int pBits[2];
+	int reconstructed[2][4];
+
+	for (int e = 0; e < 2; e++) {
+
+		int bestError = std::numeric_limits<int>::max();
+
+		for (int p = 0; p < 2; p++) {
+
+			int error = 0;
+			int q[4], r[4];
+
+			for (int c = 0; c < 4; c++) {
+
+				q[c] = glm::clamp((endPoints[e][c] - p + 1) >> 1, 0, 127);
+				r[c] = (q[c] << 1) | p;
+				error += (r[c] - endPoints[e][c]) * (r[c] - endPoints[e][c]);
+			}
+
+			if (error < bestError) {
+
+				bestError = error;
+				pBits[e] = p;
+
+				for (int c = 0; c < 4; c++) {
+					quantized[e][c] = q[c];
+					reconstructed[e][c] = r[c];
+				}
+			}
+		}
+	}
+
+	int palette[16][4];
+
+	for (int i = 0; i < 16; i++) {
+		for (int c = 0; c < 4; c++) {
+			palette[i][c] = ((64 - weights[i]) * reconstructed[0][c] + weights[i] * reconstructed[1][c] + 32) >> 6;
+		}
+	}
+
+	int indices[16];
+
+	for (int i = 0; i < 16; i++) {
+
+		int bestError = std::numeric_limits<int>::max();
+
+		for (int p = 0; p < 16; p++) {
+
+			int error = 0;
+
+			for (int c = 0; c < 4; c++) {
+				int difference = block[i][c] - palette[p][c];
+				error += difference * difference;
+			}
+
+			if (error < bestError) {
+				bestError = error;
+				indices[i] = p;
+			}
+		}
+	}
+
+	// The most significant bit of the anchor index is implied to be zero
+	if (indices[0] & 8) {
+
+		for (int c = 0; c < 4; c++) {
+			std::swap(quantized[0][c], quantized[1][c]);
+		}
+		std::swap(pBits[0], pBits[1]);
+
+		for (int i = 0; i < 16; i++) {
+			indices[i] = 15 - indices[i];
+		}
+	}
+
+	memset(out, 0, 16);
+
+	BlockBitWriter writer(out);
+
+	// Mode 6 is signaled by six zero bits followed by a one
+	writer.write(1 << 6, 7);
+
+	for (int c = 0; c < 4; c++) {
+		writer.write(quantized[0][c], 7);
+		writer.write(quantized[1][c], 7);
+	}
+
+	writer.write(pBits[0], 1);
+	writer.write(pBits[1], 1);
+
+	writer.write(indices[0], 3);
+
+	for (int i = 1; i < 16; i++) {
+		writer.write(indices[i], 4);
+	}
+
+} // end encodeBC7Block
+
+
+// Block compresses a single mip level
+static void compressLevel(const std::vector<GLubyte>& rgba, int width, int height, CompressedFormat format, CompressedMipLevel& level)
+{
+	int blocksWide = (width + 3) / 4;
+	int blocksHigh = (height + 3) / 4;
+	int blockSize = getBlockSize(format);
+
+	level.width = width;
+	level.height = height;
+	level.data.assign(blocksWide * blocksHigh * blockSize, 0);
+
+	GLubyte block[16][4];
+
+	for (int by = 0; by < blocksHigh; by++) {
+		for (int bx = 0; bx < blocksWide; bx++) {
+
+			fetchBlock(&rgba[0], width, height, bx, by, block);
+
+			unsigned char* out = &level.data[(by * blocksWide + bx) * blockSize];
+
+			switch (format) {
+
+			case BC1:
+				encodeBC1Block(block, out);
+				break;
+			case BC3:
+				encodeBC4Block(block, 3, out);
+				encodeBC1Block(block, out + 8);
+				break;
+			case BC5:
+				encodeBC4Block(block, 0, out);
+				encodeBC4Block(block, 1, out + 8);
+				break;
+			case BC7:
+				encodeBC7Block(block, out);
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+} // end compressLevel
+
+
+void downsampleImage(const std::vector<GLubyte>& source, int width, int height,
+					 std::vector<GLubyte>& destination, int& newWidth, int& newHeight)
+{
+	newWidth = std::max(1, width / 2);
+	newHeight = std::max(1, height / 2);
+
+	destination.resize(4 * newWidth * newHeight);
+
+	for (int y = 0; y < newHeight; y++) {
+		for (int x = 0; x < newWidth; x++) {
+
+			int x0 = std::min(2 * x, width - 1);
+			int x1 = std::min(2 * x + 1, width - 1);
+			int y0 = std::min(2 * y, height - 1);
+			int y1 = std::min(2 * y + 1, height - 1);
+
+			for (int c = 0; c < 4; c++) {
+
+				int sum = source[4 * (y0 * width + x0) + c] + source[4 * (y0 * width + x1) + c] +
+						  source[4 * (y1 * width + x0) + c] + source[4 * (y1 * width + x1) + c];
+
+				destination[4 * (y * newWidth + x) + c] = static_cast<GLubyte>((sum + 2) / 4);
+			}
+		}
+	}
+
+} // end downsampleImage
+
+
+void compressImage(const std::vector<GLubyte>& rgba, int width, int height, CompressedFormat format, CompressedImage& image)
+{
+	if (format == BC_AUTO) {
+
+		format = BC1;
+
+		for (size_t i = 3; i < rgba.size(); i += 4) {
+
+			if (rgba[i] != 255) {
+				format = BC3;
+				break;
+			}
+		}
+	}
+
+	image.format = format;
+	image.levels.clear();
+
+	std::vector<GLubyte> level = rgba;
+	std::vector<GLubyte> nextLevel;
+
+	while (true) {
+
+		image.levels.emplace_back();
+		compressLevel(level, width, height, format, image.levels.back());
+
+		if (width == 1 && height == 1) {
+			break;
+		}
+
+		downsampleImage(level, width, height, nextLevel, width, height);
+		level.swap(nextLevel);
+	}
+
+	if (VERBOSE) std::cout << "Compressed " << image.levels.size() << " mip levels into " << image.getSizeInBytes() << " bytes" << std::endl;
+
+} // end compressImage
+
+//********************* DDS reading and writing *****************************************
+
+bool readCompressedImage(const std::string& fileName, CompressedImage& image, int firstLevel, int lastLevel)
+{
+	std::ifstream file(fileName, std::ios::binary);
+
+	if (!file) {
+		return false;
+	}
+
+	uint32_t magic = 0;
+	uint32_t header[DDS_HEADER_WORDS];
+
+	file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	file.read(reinterpret_cast<char*>(header), sizeof(header));
+
+	if (!file || magic != DDS_MAGIC || header[HEADER_SIZE] != 124 || !(header[HEADER_PF_FLAGS] & DDPF_FOURCC)) {
+		std::cerr << "ERROR: " << fileName << " is not a supported DDS file." << std::endl;
+		return false;
+	}
+
+	uint32_t fourCC = header[HEADER_PF_FOURCC];
+
+	if (fourCC == makeFourCC('D', 'X', '1', '0')) {
+
+		uint32_t dx10Header[DDS_DX10_HEADER_WORDS];
+		file.read(reinterpret_cast<char*>(dx10Header), sizeof(dx10Header));
+
+		if (!file) {
+			std::cerr << "ERROR: " << fileName << " is truncated." << std::endl;
+			return false;
+		}
+
+		switch (dx10Header[0]) {
+
+		case DXGI_FORMAT_BC1_TYPELESS:
+		case DXGI_FORMAT_BC1_UNORM:
+			image.format = BC1;
+			break;
+		case DXGI_FORMAT_BC3_TYPELESS:
+		case DXGI_FORMAT_BC3_UNORM:
+			image.format = BC3;
+			break;
+		case DXGI_FORMAT_BC5_TYPELESS:
+		case DXGI_FORMAT_BC5_UNORM:
+			image.format = BC5;
+			break;
+		case DXGI_FORMAT_BC7_TYPELESS:
+		case DXGI_FORMAT_BC7_UNORM:
+			image.format = BC7;
+			break;
+		default:
+			std::cerr << "ERROR: Unsupported DXGI format " << dx10Header[0] << " in " << fileName << std::endl;
+			return false;
+		}
+	}
+	else if (fourCC == makeFourCC('D', 'X', 'T', '1')) {
+		image.format = BC1;
+	}
+	else if (fourCC == makeFourCC('D', 'X', 'T', '5')) {
+		image.format = BC3;
+	}
+	else if (fourCC == makeFourCC('A', 'T', 'I', '2') || fourCC == makeFourCC('B', 'C', '5', 'U')) {
+		image.format = BC5;
+	}
+	else {
+		std::cerr << "ERROR: Unsupported compression in " << fileName << std::endl;
+		return false;
+	}
+
+	uint32_t width = header[HEADER_WIDTH];
+	uint32_t height = header[HEADER_HEIGHT];
+
+	// Damaged files are rejected so that the texture is encoded from the source image instead
+	if (width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION) {
+		std::cerr << "ERROR: " << fileName << " has an invalid size of " << width << "x" << height << "." << std::endl;
+		return false;
+	}
+
+	// A full mip chain ends with a single texel
+	int maxMipCount = 1;
+	for (uint32_t size = std::max(width, height); size > 1; size /= 2) {
+		maxMipCount++;
+	}
+
+	int mipCount = 1;
+
+	if ((header[HEADER_FLAGS] & DDSD_MIPMAPCOUNT) && header[HEADER_MIP_COUNT] > 0) {
+		mipCount = static_cast<int>(std::min<uint32_t>(header[HEADER_MIP_COUNT], maxMipCount));
+	}
+
+	size_t blockSize = getBlockSize(image.format);
+
+	// The data of every level must be in the file, including levels that are not read
+	std::streamoff dataStart = file.tellg();
+	file.seekg(0, std::ios::end);
+	std::streamoff dataSize = file.tellg() - dataStart;
+	file.seekg(dataStart);
+
+	size_t requiredSize = 0;
+	for (int i = 0; i < mipCount; i++) {
+
+		requiredSize += ((std::max(1u, width >> i) + 3) / 4) * ((std::max(1u, height >> i) + 3) / 4) * blockSize;
+	}
+
+	if (!file || dataSize < 0 || static_cast<size_t>(dataSize) < requiredSize) {
+		std::cerr << "ERROR: " << fileName << " is truncated." << std::endl;
+		return false;
+	}
+
+	if (lastLevel < 0 || lastLevel >= mipCount) {
+		lastLevel = mipCount - 1;
+	}
+
+	image.levels.resize(mipCount);
+
+	for (int i = 0; i < mipCount; i++) {
+
+		CompressedMipLevel& level = image.levels[i];
+
+		level.width = static_cast<int>(std::max(1u, width >> i));
+		level.height = static_cast<int>(std::max(1u, height >> i));
+
+		size_t levelSize = ((level.width + 3) / 4) * ((level.height + 3) / 4) * blockSize;
+
+		// Levels are stored finest first, so only the data of the range is read
+		if (i < firstLevel) {
+
+			file.seekg(levelSize, std::ios::cur);
+		}
+		else if (i <= lastLevel) {
+
+			level.data.resize(levelSize);
+			file.read(reinterpret_cast<char*>(level.data.data()), level.data.size());
+		}
+
+		if (!file) {
+			std::cerr << "ERROR: " << fileName << " is truncated." << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+
+} // end readCompressedImage
+
+
+bool writeCompressedImage(const std::string& fileName, const CompressedImage& image)
+{
+	if (image.levels.empty()) {
+		return false;
+	}
+
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+
+	if (!file) {
+		std::cerr << "ERROR: Unable to create " << fileName << std::endl;
+		return false;
+	}
+
+	uint32_t header[DDS_HEADER_WORDS];
+	memset(header, 0, sizeof(header));
+
+	header[HEADER_SIZE] = 124;
+	header[HEADER_FLAGS] = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	header[HEADER_HEIGHT] = image.levels[0].height;
+	header[HEADER_WIDTH] = image.levels[0].width;
+	header[HEADER_LINEAR_SIZE] = static_cast<uint32_t>(image.levels[0].data.size());
+	header[HEADER_MIP_COUNT] = static_cast<uint32_t>(image.levels.size());
+	header[HEADER_PF_SIZE] = 32;
+	header[HEADER_PF_FLAGS] = DDPF_FOURCC;
+	header[HEADER_PF_FOURCC] = makeFourCC('D', 'X', '1', '0');
+	header[HEADER_CAPS] = DDSCAPS_TEXTURE | DDSCAPS_MIPMAP | DDSCAPS_COMPLEX;
+
+	static const uint32_t dxgiFormats[] = { DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC3_UNORM,
+											DXGI_FORMAT_BC5_UNORM, DXGI_FORMAT_BC7_UNORM };
+
+	uint32_t dx10Header[DDS_DX10_HEADER_WORDS] = { dxgiFormats[image.format], DDS_DIMENSION_TEXTURE2D, 0, 1, 0 };
+
+	file.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(dx10Header), sizeof(dx10Header));
+
+	for (auto& level : image.levels) {
+
+		file.write(reinterpret_cast<const char*>(&level.data[0]), level.data.size());
+	}
+
+	return static_cast<bool>(file);
+
+} // end writeCompressedImage
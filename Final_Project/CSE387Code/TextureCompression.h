@@ -0,0 +1,142 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "MathLibsConstsFuncs.h"
+
+/**
+ * @enum	CompressedFormat
+ *
+ * @brief	Block compressed texture formats that can be stored in the compressed
+ * 			texture cache. All formats use 4x4 texel blocks.
+ * 			BC1 - RGB with no alpha, 8 bytes per block (8:1 versus RGBA).
+ * 			BC3 - RGBA with interpolated alpha, 16 bytes per block (4:1).
+ * 			BC5 - Two independent channels (RG), 16 bytes per block. Intended for normal maps.
+ * 			BC7 - High quality RGBA, 16 bytes per block (4:1).
+ */
+enum CompressedFormat { BC1 = 0, BC3, BC5, BC7, BC_AUTO };
+
+/**
+ * @struct	CompressedMipLevel
+ *
+ * @brief	Block compressed data for a single mip level.
+ */
+struct CompressedMipLevel {
+
+	int width = 0; // Width of the level in texels
+
+	int height = 0; // Height of the level in texels
+
+	std::vector<unsigned char> data; // Compressed blocks for the level
+
+}; // end CompressedMipLevel
+
+
+/**
+ * @struct	CompressedImage
+ *
+ * @brief	A block compressed image with a full chain of precomputed mip levels.
+ * 			Level zero is the full resolution image. Rows are stored in OpenGL
+ * 			(bottom-up) order so levels can be uploaded directly.
+ */
+struct CompressedImage {
+
+	CompressedFormat format = BC1;
+
+	std::vector<CompressedMipLevel> levels;
+
+	/**
+	 * @fn	GLenum CompressedImage::getGLInternalFormat() const;
+	 *
+	 * @brief	Gets the OpenGL internal format for the compressed data.
+	 *
+	 * @returns	The internal format to pass to glCompressedTexImage2D.
+	 */
+	GLenum getGLInternalFormat() const;
+
+	/**
+	 * @fn	size_t CompressedImage::getSizeInBytes() const;
+	 *
+	 * @brief	Gets the total size in bytes of all mip levels.
+	 */
+	size_t getSizeInBytes() const;
+
+}; // end CompressedImage
+
+
+/**
+ * @fn	int getBlockSize(CompressedFormat format);
+ *
+ * @brief	Returns the number of bytes in a single 4x4 block for the format.
+ */
+int getBlockSize(CompressedFormat format);
+
+/**
+ * @fn	bool isCompressedFormatSupported(CompressedFormat format);
+ *
+ * @brief	Determines if the current OpenGL context can sample the compressed format.
+ * 			BC5 is a core feature. BC7 requires OpenGL 4.2 or ARB_texture_compression_bptc.
+ * 			BC1 and BC3 require EXT_texture_compression_s3tc which is available on all
+ * 			desktop drivers. Must be called with a current context.
+ *
+ * @returns	True if supported, false if not.
+ */
+bool isCompressedFormatSupported(CompressedFormat format);
+
+/**
+ * @fn	void compressImage(const std::vector<GLubyte>& rgba, int width, int height, CompressedFormat format, CompressedImage& image);
+ *
+ * @brief	Builds a mip chain for an RGBA8 image using a box filter and block compresses
+ * 			every level. BC_AUTO selects BC3 for images with transparency and BC1 otherwise.
+ *
+ * @param 		  	rgba  	Tightly packed RGBA8 texels.
+ * @param 		  	width 	Width of the image in texels.
+ * @param 		  	height	Height of the image in texels.
+ * @param 		  	format	The compressed format to use.
+ * @param [out]	image 	The compressed image.
+ */
+void compressImage(const std::vector<GLubyte>& rgba, int width, int height, CompressedFormat format, CompressedImage& image);
+
+/**
+ * @fn	void downsampleImage(const std::vector<GLubyte>& source, int width, int height, std::vector<GLubyte>& destination, int& newWidth, int& newHeight);
+ *
+ * @brief	Reduces an RGBA8 image to half its size in each dimension using a box filter.
+ * 			Dimensions are never reduced below one.
+ *
+ * @param 		  	source	   	Tightly packed RGBA8 texels.
+ * @param 		  	width	   	Width of the source image.
+ * @param 		  	height	   	Height of the source image.
+ * @param [out]	destination	The reduced image.
+ * @param [out]	newWidth   	Width of the reduced image.
+ * @param [out]	newHeight  	Height of the reduced image.
+ */
+void downsampleImage(const std::vector<GLubyte>& source, int width, int height,
+					 std::vector<GLubyte>& destination, int& newWidth, int& newHeight);
+
+/**
+ * @fn	bool readCompressedImage(const std::string& fileName, CompressedImage& image, int firstLevel = 0, int lastLevel = -1);
+ *
+ * @brief	Reads a DDS container holding BC1, BC3, BC5 or BC7 data. The dimensions of every
+ * 			mip level are read, but only the data of the levels in a range. Files with an
+ * 			invalid size or less data than their levels need are rejected.
+ *
+ * @param 		  	fileName  	Name of the DDS file.
+ * @param [out]	image	  	The image. Levels outside of the range have no data.
+ * @param 		  	firstLevel	(Optional) Finest level to read.
+ * @param 		  	lastLevel 	(Optional) Coarsest level to read. Negative for the coarsest
+ * 								level in the file.
+ *
+ * @returns	True if it succeeds, false if it fails.
+ */
+bool readCompressedImage(const std::string& fileName, CompressedImage& image, int firstLevel = 0, int lastLevel = -1);
+
+/**
+ * @fn	bool writeCompressedImage(const std::string& fileName, const CompressedImage& image);
+ *
+ * @brief	Writes a compressed image and all of its mip levels to a DDS container
+ * 			using the DX10 extended header.
+ *
+ * @returns	True if it succeeds, false if it fails.
+ */
+bool writeCompressedImage(const std::string& fileName, const CompressedImage& image);
@@ -0,0 +1,138 @@
+#include "TextureLoader.h"
+#include "CpuProfiler.h"
+#include "Texture.h"
+
+#include <algorithm>
+
+#define VERBOSE false
+
+void TextureLoader::request(Texture* texture, const std::string& fileName, GLenum internalFormat, int firstLevel, int lastLevel)
+{
+	Request request;
+
+	request.texture = texture;
+	request.fileName = fileName;
+	request.internalFormat = internalFormat;
+	request.firstLevel = firstLevel;
+	request.lastLevel = lastLevel;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (worker.joinable() == false) {
+
+			stopping = false;
+			worker = std::thread(&TextureLoader::workerLoop, this);
+		}
+
+		queued.push_back(std::move(request));
+	}
+
+	condition.notify_one();
+
+} // end request
+
+
+std::vector<TextureLoader::Request> TextureLoader::takeFinished()
+{
+	std::vector<Request> requests;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	requests.swap(finished);
+
+	return requests;
+
+} // end takeFinished
+
+
+void TextureLoader::cancel(Texture* texture)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto isCancelled = [texture](const Request& request) { return request.texture == texture; };
+
+	queued.erase(std::remove_if(queued.begin(), queued.end(), isCancelled), queued.end());
+
+	finished.erase(std::remove_if(finished.begin(), finished.end(), isCancelled), finished.end());
+
+	// The worker drops the request it is reading when it finishes
+	if (reading == true && current->texture == texture) {
+
+		current->texture = nullptr;
+	}
+
+} // end cancel
+
+
+size_t TextureLoader::getPendingCount()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	return queued.size() + finished.size() + (reading ? 1 : 0);
+
+} // end getPendingCount
+
+
+void TextureLoader::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		stopping = true;
+		queued.clear();
+	}
+
+	condition.notify_all();
+
+	if (worker.joinable()) {
+
+		worker.join();
+	}
+
+	finished.clear();
+
+} // end stop
+
+
+void TextureLoader::workerLoop()
+{
+	CpuProfiler::setThreadName("Texture Loader");
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (true) {
+
+		condition.wait(lock, [this] { return stopping || !queued.empty(); });
+
+		if (stopping) {
+			return;
+		}
+
+		Request request = std::move(queued.front());
+		queued.pop_front();
+
+		current = &request;
+		reading = true;
+
+		lock.unlock();
+
+		request.succeeded = Texture::readLevelRange(request.fileName, request.internalFormat,
+													request.firstLevel, request.lastLevel, request.levels);
+
+		lock.lock();
+
+		reading = false;
+		current = nullptr;
+
+		if (request.texture != nullptr) {
+
+			finished.push_back(std::move(request));
+		}
+		else if (VERBOSE) {
+
+			std::cout << "Discarded levels of unloaded texture " << request.fileName << std::endl;
+		}
+	}
+
+} // end workerLoop
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MathLibsConstsFuncs.h"
+#include "TextureCompression.h"
+
+class Texture;
+
+/**
+ * @class	TextureLoader
+ *
+ * @brief	Reads the mip levels that textures stream in on a worker thread so that files are
+ * 			not read and decoded on the thread that renders. Levels that have been read are
+ * 			taken by the TextureManager, which uploads them on the thread that owns the
+ * 			OpenGL context. The worker never makes OpenGL calls.
+ *
+ * 			The worker is started by the first request and stopped when the loader is
+ * 			destroyed or stop is called.
+ */
+class TextureLoader
+{
+public:
+
+	/**
+	 * @struct	Request
+	 *
+	 * @brief	A range of mip levels to read for a texture and the levels that were read.
+	 */
+	struct Request {
+
+		Texture* texture = nullptr; // Texture the levels are for. Null if it was unloaded.
+
+		std::string fileName; // Relative path and name of the source image
+
+		GLenum internalFormat = GL_RGBA; // Format the texture was loaded with
+
+		int firstLevel = 0; // Finest level to read
+
+		int lastLevel = 0; // Coarsest level to read
+
+		std::vector<CompressedMipLevel> levels; // Indexed by level. Only the range has data.
+
+		bool succeeded = false;
+
+	}; // end Request
+
+	/**
+	 * @fn	TextureLoader::~TextureLoader()
+	 *
+	 * @brief	Destructor. Stops the worker.
+	 */
+	~TextureLoader() { stop(); }
+
+	/**
+	 * @fn	void TextureLoader::request(Texture* texture, const std::string& fileName, GLenum internalFormat, int firstLevel, int lastLevel);
+	 *
+	 * @brief	Queues a range of mip levels of a texture to be read.
+	 */
+	void request(Texture* texture, const std::string& fileName, GLenum internalFormat, int firstLevel, int lastLevel);
+
+	/**
+	 * @fn	std::vector<Request> TextureLoader::takeFinished();
+	 *
+	 * @brief	Gets the requests that have been read since the last call. Requests of textures
+	 * 			that were cancelled are not returned.
+	 */
+	std::vector<Request> takeFinished();
+
+	/**
+	 * @fn	void TextureLoader::cancel(Texture* texture);
+	 *
+	 * @brief	Discards the requests of a texture that is being unloaded. A request that is
+	 * 			being read finishes but is not returned.
+	 */
+	void cancel(Texture* texture);
+
+	/**
+	 * @fn	size_t TextureLoader::getPendingCount();
+	 *
+	 * @brief	Gets the number of requests that have not been taken.
+	 */
+	size_t getPendingCount();
+
+	/**
+	 * @fn	void TextureLoader::stop();
+	 *
+	 * @brief	Stops the worker after the request it is reading and discards all requests.
+	 */
+	void stop();
+
+protected:
+
+	/**
+	 * @fn	void TextureLoader::workerLoop();
+	 *
+	 * @brief	Reads queued requests until the loader is stopped.
+	 */
+	void workerLoop();
+
+	std::thread worker;
+
+	/** @brief	Guards the fields below */
+	std::mutex mutex;
+
+	std::condition_variable condition;
+
+	std::deque<Request> queued;
+
+	/** @brief	Request the worker is reading. Only valid while reading is true. */
+	Request* current = nullptr;
+
+	std::vector<Request> finished;
+
+	bool reading = false;
+
+	bool stopping = false;
+
+}; // end TextureLoader class
@@ -0,0 +1,211 @@
+#include "TextureManager.h"
+#include "Texture.h"
+#include "CpuProfiler.h"
+
+#include <algorithm>
+
+#define VERBOSE false
+
+// Static variables must be defined outside the declaration
+size_t TextureManager::memoryBudget = 256 * 1024 * 1024;
+size_t TextureManager::pendingBytes = 0;
+int TextureManager::maxUploadsPerFrame = 4;
+int TextureManager::initialResidentSize = 128;
+int TextureManager::viewportHeight = 768;
+unsigned int TextureManager::currentFrame = 1;
+TextureLoader TextureManager::loader;
+
+void TextureManager::update()
+{
+	CPU_PROFILE_SCOPE("TextureManager::update");
+
+	// Upload the levels the loader has read since the last frame. Textures are not evicted
+	// while levels are being read for them, so every finished request is still loaded.
+	std::vector<TextureLoader::Request> finished = loader.takeFinished();
+
+	for (auto& request : finished) {
+
+		Texture* texture = request.texture;
+
+		// Cleared one at a time so the textures of the requests that follow are not evicted.
+		// The reserved bytes are made available again to upload the levels.
+		texture->streamingLevel = -1;
+		releaseReservation(texture);
+
+		// The texture may have been reduced to coarser levels while the levels were read
+		if (request.succeeded == false || request.lastLevel != texture->residentLevel - 1) {
+			continue;
+		}
+
+		size_t required = texture->getMemorySize(request.firstLevel) - texture->memorySize;
+
+		if (makeRoom(required, texture)) {
+
+			texture->streamIn(request.levels, request.firstLevel);
+		}
+	}
+
+	// Find the textures that were used during this frame and need finer levels
+	std::vector<Texture*> requests;
+
+	for (auto& entry : Texture::loadedTextures) {
+
+		Texture* texture = entry.second;
+
+		if (texture->lastUsedFrame == currentFrame && texture->requestedLevel < texture->residentLevel &&
+			texture->streamingLevel < 0) {
+
+			requests.push_back(texture);
+		}
+	}
+
+	// Textures that are furthest from the detail they need are streamed first
+	std::sort(requests.begin(), requests.end(), [](const Texture* a, const Texture* b) {
+		return (a->residentLevel - a->requestedLevel) > (b->residentLevel - b->requestedLevel);
+	});
+
+	int pendingLoads = static_cast<int>(loader.getPendingCount());
+
+	for (auto texture : requests) {
+
+		if (pendingLoads >= maxUploadsPerFrame) {
+			break;
+		}
+
+		// Read the finest level that fits within the budget. The memory is made available
+		// now and the levels are uploaded in a later frame, once they have been read.
+		for (int level = texture->requestedLevel; level < texture->residentLevel; level++) {
+
+			size_t required = texture->getMemorySize(level) - texture->memorySize;
+
+			if (makeRoom(required, texture)) {
+
+				loader.request(texture, texture->fileName, texture->internalFormat, level, texture->residentLevel - 1);
+				texture->streamingLevel = level;
+
+				// Reserved until the levels are uploaded so later requests cannot use the same memory
+				texture->streamingBytes = required;
+				pendingBytes += required;
+				pendingLoads++;
+				break;
+			}
+		}
+	}
+
+	// Enforce the budget even if nothing was streamed in. The budget may have been reduced.
+	makeRoom(0, nullptr);
+
+	currentFrame++;
+
+} // end update
+
+
+bool TextureManager::makeRoom(size_t requiredBytes, Texture* requestingTexture)
+{
+	// Memory reserved for the levels being read is not available
+	size_t residentMemory = getResidentMemory() + pendingBytes;
+
+	if (residentMemory + requiredBytes <= memoryBudget) {
+		return true;
+	}
+
+	// Eviction candidates in least recently used order
+	std::vector<Texture*> candidates;
+
+	for (auto& entry : Texture::loadedTextures) {
+
+		if (entry.second != requestingTexture) {
+			candidates.push_back(entry.second);
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const Texture* a, const Texture* b) {
+		return a->lastUsedFrame < b->lastUsedFrame;
+	});
+
+	for (auto texture : candidates) {
+
+		if (residentMemory + requiredBytes <= memoryBudget) {
+			break;
+		}
+
+		if (texture->referenceCount == 0 && texture->streamingLevel < 0) {
+
+			if (VERBOSE) std::cout << "Evicting texture: " << texture->fileName << std::endl;
+
+			residentMemory -= texture->memorySize;
+
+			// Unloading removes the texture from the map of loaded textures
+			texture->unload();
+			delete texture;
+		}
+		else {
+
+			// Textures in use this frame keep the level they need
+			int level = (texture->lastUsedFrame == currentFrame) ? texture->requestedLevel : texture->minimumLevel;
+
+			if (level > texture->residentLevel) {
+
+				residentMemory -= texture->memorySize;
+				texture->streamOut(level);
+				residentMemory += texture->memorySize;
+			}
+		}
+	}
+
+	return residentMemory + requiredBytes <= memoryBudget;
+
+} // end makeRoom
+
+
+void TextureManager::cancelStreaming(Texture* texture)
+{
+	loader.cancel(texture);
+
+	releaseReservation(texture);
+
+} // end cancelStreaming
+
+
+void TextureManager::stopStreaming()
+{
+	loader.stop();
+
+	for (auto& entry : Texture::loadedTextures) {
+
+		entry.second->streamingLevel = -1;
+		entry.second->streamingBytes = 0;
+	}
+
+	pendingBytes = 0;
+
+} // end stopStreaming
+
+
+void TextureManager::releaseReservation(Texture* texture)
+{
+	pendingBytes -= texture->streamingBytes;
+	texture->streamingBytes = 0;
+
+} // end releaseReservation
+
+
+void TextureManager::setMemoryBudget(size_t budgetInBytes)
+{
+	memoryBudget = budgetInBytes;
+
+} // end setMemoryBudget
+
+
+size_t TextureManager::getResidentMemory()
+{
+	size_t residentMemory = 0;
+
+	for (auto& entry : Texture::loadedTextures) {
+
+		residentMemory += entry.second->memorySize;
+	}
+
+	return residentMemory;
+
+} // end getResidentMemory
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "MathLibsConstsFuncs.h"
+#include "TextureLoader.h"
+
+class Texture;
+
+/**
+ * @class	TextureManager
+ *
+ * @brief	Static class that keeps the textures loaded by Texture::GetTexture within a
+ * 			fixed GPU memory budget. Textures are first loaded with only their coarse mip
+ * 			levels resident. Each time a texture is used for rendering it requests the
+ * 			mip level needed for the on-screen size of the object. At the end of each frame
+ * 			finer levels are requested from the TextureLoader for the textures that need them,
+ * 			the levels it has finished reading are uploaded, and the least recently used
+ * 			textures are reduced to their coarse levels, or deleted if they are no longer
+ * 			referenced, to stay within the budget.
+ */
+class TextureManager
+{
+public:
+
+	/**
+	 * @fn	static void TextureManager::update();
+	 *
+	 * @brief	Streams mip levels in and out based on the requests made during the frame
+	 * 			and enforces the memory budget. Call once per frame after all cameras have
+	 * 			been rendered, on the thread that owns the OpenGL context.
+	 */
+	static void update();
+
+	/**
+	 * @fn	static void TextureManager::cancelStreaming(Texture* texture);
+	 *
+	 * @brief	Discards the levels being read for a texture that is being unloaded.
+	 */
+	static void cancelStreaming(Texture* texture);
+
+	/**
+	 * @fn	static void TextureManager::stopStreaming();
+	 *
+	 * @brief	Stops the TextureLoader and discards the levels it was reading. Streaming starts
+	 * 			again with the next update that needs finer levels.
+	 */
+	static void stopStreaming();
+
+	/**
+	 * @fn	static void TextureManager::setMemoryBudget(size_t budgetInBytes);
+	 *
+	 * @brief	Sets the maximum amount of GPU memory in bytes that can be used by textures.
+	 */
+	static void setMemoryBudget(size_t budgetInBytes);
+
+	/**
+	 * @fn	static size_t TextureManager::getMemoryBudget()
+	 *
+	 * @brief	Gets the maximum amount of GPU memory in bytes that can be used by textures.
+	 */
+	static size_t getMemoryBudget() { return memoryBudget; }
+
+	/**
+	 * @fn	static size_t TextureManager::getResidentMemory();
+	 *
+	 * @brief	Gets the amount of GPU memory in bytes used by all loaded textures.
+	 */
+	static size_t getResidentMemory();
+
+	/**
+	 * @fn	static void TextureManager::setMaxStreamingUploadsPerFrame(int maxUploads);
+	 *
+	 * @brief	Limits the number of textures whose finer levels are read at the same time,
+	 * 			which also limits the uploads in a frame so that streaming does not cause a
+	 * 			noticeable hitch.
+	 */
+	static void setMaxStreamingUploadsPerFrame(int maxUploads) { maxUploadsPerFrame = maxUploads; }
+
+	/**
+	 * @fn	static int TextureManager::getInitialResidentSize()
+	 *
+	 * @brief	Gets the largest dimension in texels of the finest mip level that is
+	 * 			uploaded when a texture is first loaded. The level is kept resident
+	 * 			while the texture is referenced.
+	 */
+	static int getInitialResidentSize() { return initialResidentSize; }
+
+	/**
+	 * @fn	static void TextureManager::setViewportHeight(int height)
+	 *
+	 * @brief	Sets the height in pixels of the viewport being rendered. Used to convert
+	 * 			the size of objects to on-screen sizes. Set by the active camera.
+	 */
+	static void setViewportHeight(int height) { viewportHeight = height; }
+
+	/**
+	 * @fn	static int TextureManager::getViewportHeight()
+	 *
+	 * @brief	Gets the height in pixels of the viewport being rendered.
+	 */
+	static int getViewportHeight() { return viewportHeight; }
+
+	/**
+	 * @fn	static unsigned int TextureManager::getCurrentFrame()
+	 *
+	 * @brief	Gets the number of the frame being rendered. Used to order textures
+	 * 			by when they were last used.
+	 */
+	static unsigned int getCurrentFrame() { return currentFrame; }
+
+protected:
+
+	/**
+	 * @fn	static bool TextureManager::makeRoom(size_t requiredBytes, Texture* requestingTexture);
+	 *
+	 * @brief	Frees texture memory in least recently used order until the required number
+	 * 			of bytes fits within the budget. Bytes reserved for levels that are being read
+	 * 			count as used. Unreferenced textures are deleted. Referenced
+	 * 			textures are reduced to the level they last requested, or to their coarse levels
+	 * 			if they were not used during this frame.
+	 *
+	 * @param	requiredBytes	  	Number of additional bytes needed.
+	 * @param	requestingTexture	Texture that needs the memory. It is never evicted.
+	 *
+	 * @returns	True if the memory is available, false if not.
+	 */
+	static bool makeRoom(size_t requiredBytes, Texture* requestingTexture);
+
+	/**
+	 * @fn	static void TextureManager::releaseReservation(Texture* texture);
+	 *
+	 * @brief	Returns the bytes reserved for the levels being read for a texture to the budget.
+	 */
+	static void releaseReservation(Texture* texture);
+
+	/** @brief	Maximum GPU memory in bytes for all textures */
+	static size_t memoryBudget;
+
+	/** @brief	Bytes reserved for levels that are being read and have not been uploaded */
+	static size_t pendingBytes;
+
+	/** @brief	Maximum number of textures whose finer levels are read at the same time */
+	static int maxUploadsPerFrame;
+
+	/** @brief	Largest dimension of the level that is resident when a texture is loaded */
+	static int initialResidentSize;
+
+	/** @brief	Height in pixels of the viewport being rendered */
+	static int viewportHeight;
+
+	/** @brief	Number of the frame being rendered */
+	static unsigned int currentFrame;
+
+	/** @brief	Reads the finer levels of textures on a worker thread */
+	static TextureLoader loader;
+
+}; // end TextureManager class
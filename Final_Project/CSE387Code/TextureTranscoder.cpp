@@ -0,0 +1,126 @@
+#include "TextureTranscoder.h"
+#include "Texture.h"
+
+#include <iostream>
+#include <set>
+
+#include "FreeImage.h"
+#include "assimp/Importer.hpp"
+#include "assimp/scene.h"
+
+static const char* formatNames[] = { "BC1", "BC3", "BC5", "BC7", "AUTO" };
+
+bool TextureTranscoder::transcodeTexture(const std::string& fileName, CompressedFormat format)
+{
+	std::vector<GLubyte> rgba;
+	int width = 0, height = 0;
+
+	if (Texture::readImageFile(fileName, rgba, width, height) == false) {
+		return false;
+	}
+
+	CompressedImage image;
+	compressImage(rgba, width, height, format, image);
+
+	std::string cacheFileName = Texture::getCompressedCachePath(fileName);
+
+	if (writeCompressedImage(cacheFileName, image) == false) {
+
+		std::cerr << "ERROR: Unable to write " << cacheFileName << "!" << std::endl;
+		return false;
+	}
+
+	size_t uncompressedSize = (rgba.size() * 4) / 3;
+
+	std::cout << "Transcoded " << fileName << " to " << formatNames[image.format] << " "
+		<< uncompressedSize / 1024 << "KB -> " << image.getSizeInBytes() / 1024 << "KB" << std::endl;
+
+	return true;
+
+} // end transcodeTexture
+
+
+int TextureTranscoder::transcodeModelTextures(const std::string& modelFileName, CompressedFormat format)
+{
+	Assimp::Importer importer;
+
+	// Only the materials are needed. No post processing of the meshes.
+	const aiScene* scene = importer.ReadFile(modelFileName, 0);
+
+	if (!scene) {
+
+		std::cerr << "ERROR: Unable to load " << modelFileName << "! " << importer.GetErrorString() << std::endl;
+		return 0;
+	}
+
+	// Several materials may share the same texture
+	std::set<std::string> textureFileNames;
+
+	const aiTextureType textureTypes[] = { aiTextureType_DIFFUSE, aiTextureType_SPECULAR };
+
+	for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
+
+		const aiMaterial* assimpMaterial = scene->mMaterials[i];
+
+		for (aiTextureType type : textureTypes) {
+
+			aiString path;
+
+			if (assimpMaterial->GetTextureCount(type) > 0 &&
+				AI_SUCCESS == assimpMaterial->GetTexture(type, 0, &path, nullptr, nullptr, nullptr, nullptr, nullptr)) {
+
+				textureFileNames.insert(getDirectoryPath(modelFileName) + path.C_Str());
+			}
+		}
+	}
+
+	int count = 0;
+
+	for (const std::string& textureFileName : textureFileNames) {
+
+		if (transcodeTexture(textureFileName, format)) {
+			count++;
+		}
+	}
+
+	return count;
+
+} // end transcodeModelTextures
+
+
+int TextureTranscoder::transcode(const std::vector<std::string>& fileNames, CompressedFormat format)
+{
+	int count = 0;
+
+	for (const std::string& fileName : fileNames) {
+
+		if (FreeImage_GetFileType(fileName.c_str(), 0) != FIF_UNKNOWN) {
+
+			if (transcodeTexture(fileName, format)) {
+				count++;
+			}
+		}
+		else {
+
+			count += transcodeModelTextures(fileName, format);
+		}
+	}
+
+	std::cout << "Transcoded " << count << " texture(s)." << std::endl;
+
+	return count;
+
+} // end transcode
+
+
+std::string TextureTranscoder::getDirectoryPath(const std::string& filePath)
+{
+	size_t separator = filePath.find_last_of("\\/");
+
+	if (separator == std::string::npos) {
+		return "";
+	}
+
+	return filePath.substr(0, separator + 1);
+
+} // end getDirectoryPath
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "TextureCompression.h"
+
+/**
+ * @class	TextureTranscoder
+ *
+ * @brief	Offline tool that converts textures loaded with FreeImage into block
+ * 			compressed DDS files with precomputed mip levels. The compressed files
+ * 			are written next to the source files (see Texture::getCompressedCachePath)
+ * 			where Texture::GetTexture will find them the next time the texture is
+ * 			loaded. Does not require an OpenGL context.
+ */
+class TextureTranscoder
+{
+public:
+
+	/**
+	 * @fn	static bool TextureTranscoder::transcodeTexture(const std::string& fileName, CompressedFormat format = BC_AUTO);
+	 *
+	 * @brief	Transcodes a single texture file.
+	 *
+	 * @param	fileName	Filename of the source texture.
+	 * @param	format  	(Optional) The compressed format.
+	 *
+	 * @returns	True if it succeeds, false if it fails.
+	 */
+	static bool transcodeTexture(const std::string& fileName, CompressedFormat format = BC_AUTO);
+
+	/**
+	 * @fn	static int TextureTranscoder::transcodeModelTextures(const std::string& modelFileName, CompressedFormat format = BC_AUTO);
+	 *
+	 * @brief	Transcodes all of the diffuse and specular textures referenced by the
+	 * 			materials of a model file.
+	 *
+	 * @param	modelFileName	Filename of the model.
+	 * @param	format		 	(Optional) The compressed format.
+	 *
+	 * @returns	The number of textures that were transcoded.
+	 */
+	static int transcodeModelTextures(const std::string& modelFileName, CompressedFormat format = BC_AUTO);
+
+	/**
+	 * @fn	static int TextureTranscoder::transcode(const std::vector<std::string>& fileNames, CompressedFormat format = BC_AUTO);
+	 *
+	 * @brief	Transcodes a list of files. Files FreeImage recognizes as images are
+	 * 			transcoded directly. All others are treated as model files.
+	 *
+	 * @param	fileNames	List of texture and model files.
+	 * @param	format   	(Optional) The compressed format.
+	 *
+	 * @returns	The number of textures that were transcoded.
+	 */
+	static int transcode(const std::vector<std::string>& fileNames, CompressedFormat format = BC_AUTO);
+
+protected:
+
+	/**
+	 * @fn	static std::string TextureTranscoder::getDirectoryPath(const std::string& filePath);
+	 *
+	 * @brief	Gets the directory portion of a file path including the trailing separator.
+	 */
+	static std::string getDirectoryPath(const std::string& filePath);
+
+}; // end TextureTranscoder class
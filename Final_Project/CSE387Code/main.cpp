@@ -1,11 +1,98 @@
 #pragma once
 
+#include <cctype>
+#include <string>
+#include <vector>
+
 #include "Game.h"
 #include "MathLibsConstsFuncs.h"
+#include "TextureTranscoder.h"
 
+/**
+ * @fn	int main(int argc, char** argv)
+ *
+ * @brief	Runs the game. Running with "-transcode [-bc1|-bc3|-bc5|-bc7] files..." instead
+ * 			converts the listed textures, or the textures referenced by the listed models,
+ * 			into block compressed files that are loaded in place of the originals.
+ *
+ * 			Other options:
+ * 			"-headless [steps]" simulates the game without a window or OpenGL for the given
+ * 			number of fixed updates, or until it is stopped if none are given.
+ * 			"-offscreen width height [-osmesa|-egl]" renders into a render target of a hidden
+ * 			window, optionally with a software or EGL context.
+ * 			"-capture directory" saves every rendered frame to a PNG file in the directory.
+ * 			"-steps count" ends the game after a number of fixed updates.
+ * 			"-deferred" renders with the deferred pipeline instead of forward shading.
+ */
 int main(int argc, char** argv)
 {
+	if (argc > 1 && std::string(argv[1]) == "-transcode") {
+
+		CompressedFormat format = BC_AUTO;
+		std::vector<std::string> fileNames;
+
+		for (int i = 2; i < argc; i++) {
+
+			std::string arg = argv[i];
+
+			if (arg == "-bc1") format = BC1;
+			else if (arg == "-bc3") format = BC3;
+			else if (arg == "-bc5") format = BC5;
+			else if (arg == "-bc7") format = BC7;
+			else fileNames.push_back(arg);
+		}
+
+		TextureTranscoder::transcode(fileNames, format);
+
+		return 0;
+	}
+
 	Game game;
+
+	for (int i = 1; i < argc; i++) {
+
+		std::string arg = argv[i];
+
+		if (arg == "-headless") {
+
+			Game::setHeadless(true);
+
+			if (i + 1 < argc && isdigit(argv[i + 1][0])) {
+				game.setStepLimit(std::stoi(argv[++i]));
+			}
+		}
+		else if (arg == "-offscreen" && i + 2 < argc) {
+
+			int width = std::stoi(argv[++i]);
+			int height = std::stoi(argv[++i]);
+
+			int contextCreationApi = GLFW_NATIVE_CONTEXT_API;
+
+			if (i + 1 < argc && std::string(argv[i + 1]) == "-osmesa") {
+				contextCreationApi = GLFW_OSMESA_CONTEXT_API;
+				i++;
+			}
+			else if (i + 1 < argc && std::string(argv[i + 1]) == "-egl") {
+				contextCreationApi = GLFW_EGL_CONTEXT_API;
+				i++;
+			}
+
+			game.setOffscreen(width, height, contextCreationApi);
+		}
+		else if (arg == "-capture" && i + 1 < argc) {
+
+			game.setCaptureDirectory(argv[++i]);
+		}
+		else if (arg == "-steps" && i + 1 < argc) {
+
+			game.setStepLimit(std::stoi(argv[++i]));
+		}
+		else if (arg == "-deferred") {
+
+			game.setDeferredShading(true);
+		}
+	}
+
 	bool success = game.initialize();
 
 	if (success) {
@@ -15,4 +102,3 @@ int main(int argc, char** argv)
 	return 0;
 
 }
-